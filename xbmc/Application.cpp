@@ -36,6 +36,7 @@
 #include "cores/IPlayer.h"
 #include "cores/VideoPlayer/DVDFileInfo.h"
 #include "cores/AudioEngine/AEFactory.h"
+#include "cores/AudioEngine/AELatencyCalibration.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSP.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/playercorefactory/PlayerCoreFactory.h"
@@ -149,6 +150,7 @@
 #include "dialogs/GUIDialogSubMenu.h"
 #include "dialogs/GUIDialogButtonMenu.h"
 #include "dialogs/GUIDialogSimpleMenu.h"
+#include "dialogs/GUIDialogFileBrowser.h"
 #include "addons/GUIDialogAddonSettings.h"
 
 // PVR related include Files
@@ -1529,6 +1531,18 @@ void CApplication::OnSettingAction(const CSetting *setting)
     g_windowManager.ActivateWindow(WINDOW_SCREEN_CALIBRATION);
   else if (settingId == CSettings::SETTING_VIDEOSCREEN_TESTPATTERN)
     g_windowManager.ActivateWindow(WINDOW_TEST_PATTERN);
+  else if (settingId == CSettings::SETTING_AUDIOOUTPUT_CALIBRATELATENCY ||
+           settingId == CSettings::SETTING_AUDIOOUTPUT2_CALIBRATELATENCY)
+    CAELatencyCalibration::Start(settingId == CSettings::SETTING_AUDIOOUTPUT2_CALIBRATELATENCY);
+  else if (settingId == CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTIONFILE ||
+           settingId == CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE)
+  {
+    std::string path = ((CSettingString*)setting)->GetValue();
+    VECSOURCES shares;
+    g_mediaManager.GetLocalDrives(shares);
+    if (CGUIDialogFileBrowser::ShowAndGetFile(shares, ".wav", g_localizeStrings.Get(37061), path))
+      ((CSettingString*)setting)->SetValue(path);
+  }
   else if (settingId == CSettings::SETTING_SOURCE_VIDEOS)
   {
     std::vector<std::string> params{"library://video/files.xml", "return"};
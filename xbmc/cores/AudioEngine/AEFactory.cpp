@@ -23,6 +23,8 @@
 #include "AEFactory.h"
 
 #include "Engines/ActiveAE/ActiveAE.h"
+#include "Engines/ActiveAE/ActiveAEResampleFFMPEG.h"
+#include "Engines/ActiveAE/ActiveAESoundCache.h"
 #include "Utils/AEStreamInfo.h"
 
 #include "guilib/LocalizeStrings.h"
@@ -88,6 +90,8 @@ void CAEFactory::UnLoadEngine()
     delete AE2;
     AE2 = NULL;
   }
+  ActiveAE::CActiveAEResampleCache::GetInstance().Clear();
+  ActiveAE::CActiveAESoundCache::GetInstance().Clear();
 }
 
 bool CAEFactory::StartEngine()
@@ -95,6 +99,16 @@ bool CAEFactory::StartEngine()
   if (!AE)
     return false;
 
+  // settings are loaded by now, in shared mode the main engine drives
+  // the second device and no engine of its own is needed
+  if (AE2 &&
+      CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED) &&
+      CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_SHAREDENGINE))
+  {
+    delete AE2;
+    AE2 = NULL;
+  }
+
   if (AE->Initialize())
   {
     if (AE2)
@@ -113,6 +127,30 @@ bool CAEFactory::StartEngine()
   return false;
 }
 
+bool CAEFactory::IsAudio2Enabled()
+{
+  return AE2 && CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED);
+}
+
+CAEEngineCounters *CAEFactory::GetCounters(bool bAudio2)
+{
+  if (!bAudio2)
+    return AE ? AE->GetCounters() : NULL;
+
+  if (!CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED))
+    return NULL;
+
+  // a shared engine feeds the second output itself
+  if (AE2)
+    return AE2->GetCounters();
+  return AE ? AE->GetCounters(true) : NULL;
+}
+
+void CAEFactory::SerializeResampleCache(CVariant &value)
+{
+  ActiveAE::CActiveAEResampleCache::GetInstance().Serialize(value);
+}
+
 bool CAEFactory::Suspend()
 {
   bool bRet = false;
@@ -181,6 +219,8 @@ void CAEFactory::OnSettingsChange(std::string setting, bool bAudio2)
     AE->OnSettingsChange(setting);
   if(bAudio2 && AE2)
     AE2->OnSettingsChange(setting);
+  else if(bAudio2 && AE)
+    AE->OnSettingsChange(setting);
 }
 
 void CAEFactory::EnumerateOutputDevices(AEDeviceList &devices, bool passthrough, bool bAudio2)
@@ -189,6 +229,8 @@ void CAEFactory::EnumerateOutputDevices(AEDeviceList &devices, bool passthrough,
     AE->EnumerateOutputDevices(devices, passthrough);
   if(bAudio2 && AE2)
     AE2->EnumerateOutputDevices(devices, passthrough);
+  else if(bAudio2 && AE)
+    AE->EnumerateOutputDevices(devices, passthrough);
 }
 
 void CAEFactory::VerifyOutputDevice(std::string &device, bool passthrough)
@@ -222,6 +264,8 @@ std::string CAEFactory::GetDefaultDevice(bool passthrough, bool bAudio2)
     return AE->GetDefaultDevice(passthrough);
   if(bAudio2 && AE2)
     return AE2->GetDefaultDevice(passthrough);
+  if(bAudio2 && AE)
+    return AE->GetDefaultDevice(passthrough);
 
   return "default";
 }
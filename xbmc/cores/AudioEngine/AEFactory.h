@@ -26,6 +26,7 @@
 
 class CSetting;
 class CAEStreamInfo;
+class CVariant;
 
 class CAEFactory
 {
@@ -37,6 +38,9 @@ public:
   static bool Suspend(); /** Suspends output and de-initializes output sink - used for external players or power saving */
   static bool Resume(); /** Resumes output after Suspend - re-initializes sink */
   static bool IsSuspended(); /** Returns true if output has been suspended */
+  static bool IsAudio2Enabled(); /** Returns true if the second output runs its own engine */
+  static CAEEngineCounters *GetCounters(bool bAudio2 = false); /** Counters of the engine feeding an output, may be NULL */
+  static void SerializeResampleCache(CVariant &value); /** Hit and miss counts of the resampler cache shared by both engines */
   /* wrap engine interface */
   static IAESound *MakeSound(const std::string &file, bool bAudio2 = false);
   static void FreeSound(IAESound *sound);
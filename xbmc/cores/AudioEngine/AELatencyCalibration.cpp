@@ -0,0 +1,231 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "AELatencyCalibration.h"
+#include "AEFactory.h"
+#include "cores/AudioEngine/Interfaces/AEStream.h"
+#include "cores/AudioEngine/Utils/AELatencyDetector.h"
+#include "dialogs/GUIDialogKaiToast.h"
+#include "guilib/LocalizeStrings.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/Settings.h"
+#include "utils/JobManager.h"
+#include "utils/MathUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/log.h"
+
+#if defined(HAS_ALSA)
+#include <alsa/asoundlib.h>
+#include "linux/XTimeUtils.h"
+#endif
+
+#define CALIBRATION_RATE      48000
+#define CALIBRATION_LEAD_MS   200
+#define CALIBRATION_BURST_MS  50
+#define CALIBRATION_TAIL_MS   100
+#define CALIBRATION_RECORD_MS 1500
+#define CALIBRATION_MAX_MS    500
+
+static std::atomic<bool> s_running(false);
+
+void CAELatencyCalibration::Start(bool bAudio2)
+{
+  bool expected = false;
+  if (!s_running.compare_exchange_strong(expected, true))
+  {
+    CLog::Log(LOGNOTICE, "CAELatencyCalibration::%s - calibration already running", __FUNCTION__);
+    return;
+  }
+  CJobManager::GetInstance().AddJob(new CAELatencyCalibration(bAudio2), NULL);
+}
+
+bool CAELatencyCalibration::DoWork()
+{
+  bool ret = false;
+  if (!m_bAudio2)
+    ret = Calibrate(false, CSettings::SETTING_AUDIOOUTPUT_LATENCY);
+  else if (CAEFactory::IsAudio2Enabled())
+    ret = Calibrate(true, CSettings::SETTING_AUDIOOUTPUT2_LATENCY);
+  else
+    CLog::Log(LOGNOTICE, "CAELatencyCalibration::%s - 2nd output has no engine of its own, "
+              "its latency has to be set manually", __FUNCTION__);
+
+  s_running = false;
+  return ret;
+}
+
+bool CAELatencyCalibration::Calibrate(bool bAudio2, const std::string &setting)
+{
+  int output = bAudio2 ? 2 : 1;
+  double latency;
+  if (!Measure(bAudio2, latency))
+  {
+    CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Warning, g_localizeStrings.Get(37050),
+                                          StringUtils::Format(g_localizeStrings.Get(37053).c_str(), output));
+    return false;
+  }
+
+  // the setting is already part of the delay the engine reports, the
+  // measurement is what is left over
+  int value = CSettings::GetInstance().GetInt(setting) + MathUtils::round_int(latency);
+  value = std::max(0, std::min(CALIBRATION_MAX_MS, value));
+  CSettings::GetInstance().SetInt(setting, value);
+
+  CLog::Log(LOGNOTICE, "CAELatencyCalibration::%s - output %d, residual: %.1f ms, latency: %d ms",
+            __FUNCTION__, output, latency, value);
+  CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Info, g_localizeStrings.Get(37050),
+                                        StringUtils::Format(g_localizeStrings.Get(37052).c_str(), output, value));
+  return true;
+}
+
+#if defined(HAS_ALSA)
+
+bool CAELatencyCalibration::Measure(bool bAudio2, double &latency)
+{
+  const std::string &device = g_advancedSettings.m_audioLatencyCalibrationDevice;
+  snd_pcm_t *pcm;
+  int err = snd_pcm_open(&pcm, device.c_str(), SND_PCM_STREAM_CAPTURE, SND_PCM_NONBLOCK);
+  if (err < 0)
+  {
+    CLog::Log(LOGERROR, "CAELatencyCalibration::%s - failed to open capture device %s: %s",
+              __FUNCTION__, device.c_str(), snd_strerror(err));
+    return false;
+  }
+  err = snd_pcm_set_params(pcm, SND_PCM_FORMAT_FLOAT_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                           1, CALIBRATION_RATE, 1, CALIBRATION_MAX_MS * 1000);
+  if (err < 0)
+  {
+    CLog::Log(LOGERROR, "CAELatencyCalibration::%s - failed to configure capture device %s: %s",
+              __FUNCTION__, device.c_str(), snd_strerror(err));
+    snd_pcm_close(pcm);
+    return false;
+  }
+
+  AEAudioFormat format;
+  format.m_dataFormat = AE_FMT_FLOAT;
+  format.m_sampleRate = CALIBRATION_RATE;
+  format.m_channelLayout = AE_CH_LAYOUT_2_0;
+  IAEStream *stream = CAEFactory::MakeStream(format, 0, NULL, bAudio2);
+  if (!stream)
+  {
+    CLog::Log(LOGERROR, "CAELatencyCalibration::%s - failed to create stream", __FUNCTION__);
+    snd_pcm_close(pcm);
+    return false;
+  }
+
+  // silence - burst - silence, interleaved stereo
+  std::vector<float> burst;
+  CAELatencyDetector::GenerateBurst(burst, CALIBRATION_RATE * CALIBRATION_BURST_MS / 1000, CALIBRATION_RATE);
+  unsigned int burstStart = CALIBRATION_RATE * CALIBRATION_LEAD_MS / 1000;
+  unsigned int playFrames = burstStart + burst.size() + CALIBRATION_RATE * CALIBRATION_TAIL_MS / 1000;
+  std::vector<float> play(playFrames * 2, 0.0f);
+  for (unsigned int i = 0; i < burst.size(); i++)
+    play[(burstStart + i) * 2] = play[(burstStart + i) * 2 + 1] = burst[i];
+
+  unsigned int recordFrames = CALIBRATION_RATE * CALIBRATION_RECORD_MS / 1000;
+  std::vector<float> capture(recordFrames);
+  unsigned int captured = 0;
+  unsigned int written = 0;
+  double freq = CurrentHostFrequency();
+  double captureStart = 0.0;
+  double expected = 0.0;
+
+  snd_pcm_start(pcm);
+  while (captured < recordFrames)
+  {
+    bool idle = true;
+
+    if (written < playFrames)
+    {
+      unsigned int space = stream->GetSpace() / stream->GetFrameSize();
+      unsigned int frames = std::min(space, playFrames - written);
+      if (frames)
+      {
+        const uint8_t *data = (const uint8_t*)(play.data() + written * 2);
+        written += stream->AddData(&data, 0, frames);
+        // everything added so far is ahead of the speaker, the burst
+        // start is written - burstStart frames before the end of it
+        if (written > burstStart && expected == 0.0)
+          expected = CurrentHostCounter() / freq + stream->GetDelay() -
+                     (double)(written - burstStart) / CALIBRATION_RATE;
+        idle = false;
+      }
+    }
+
+    snd_pcm_sframes_t frames = snd_pcm_readi(pcm, capture.data() + captured, recordFrames - captured);
+    if (frames == -EAGAIN)
+      frames = 0;
+    else if (frames < 0)
+    {
+      CLog::Log(LOGERROR, "CAELatencyCalibration::%s - capture error: %s",
+                __FUNCTION__, snd_strerror(frames));
+      break;
+    }
+    if (frames > 0)
+    {
+      // frames still queued in the device were recorded after the ones read
+      if (captured == 0)
+      {
+        snd_pcm_sframes_t delay = 0;
+        snd_pcm_delay(pcm, &delay);
+        captureStart = CurrentHostCounter() / freq - (double)(frames + delay) / CALIBRATION_RATE;
+      }
+      captured += frames;
+      idle = false;
+    }
+
+    if (idle)
+      Sleep(5);
+  }
+
+  stream->Drain(true);
+  CAEFactory::FreeStream(stream);
+  snd_pcm_close(pcm);
+
+  if (captured < recordFrames || expected == 0.0)
+    return false;
+
+  int pos = CAELatencyDetector::FindBurst(capture, burst);
+  if (pos < 0)
+  {
+    CLog::Log(LOGERROR, "CAELatencyCalibration::%s - burst not found on %s", __FUNCTION__, device.c_str());
+    return false;
+  }
+
+  latency = (captureStart + (double)pos / CALIBRATION_RATE - expected) * 1000;
+  return true;
+}
+
+#else
+
+bool CAELatencyCalibration::Measure(bool bAudio2, double &latency)
+{
+  CLog::Log(LOGERROR, "CAELatencyCalibration::%s - latency calibration requires ALSA", __FUNCTION__);
+  return false;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include "utils/Job.h"
+
+/**
+ * Measures the latency of an audio output by playing a test burst and
+ * locating it on the capture device configured in advancedsettings.xml.
+ * The result is added to the latency setting of the output.
+ */
+class CAELatencyCalibration : public CJob
+{
+public:
+  /**
+   * Queue a calibration run unless one is in progress
+   * @param bAudio2 calibrate the 2nd output instead of the 1st one
+   */
+  static void Start(bool bAudio2);
+
+  explicit CAELatencyCalibration(bool bAudio2) : m_bAudio2(bAudio2) {}
+
+  virtual bool DoWork() override;
+  virtual const char *GetType() const override { return "aelatencycalibration"; }
+
+private:
+  /**
+   * Play the burst on one output and capture it
+   * @param bAudio2 output to measure
+   * @param latency receives the latency not yet covered by the setting in ms
+   * @return false if the burst could not be played or was not found
+   */
+  bool Measure(bool bAudio2, double &latency);
+  bool Calibrate(bool bAudio2, const std::string &setting);
+
+  bool m_bAudio2;
+};
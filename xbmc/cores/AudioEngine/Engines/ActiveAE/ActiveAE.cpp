@@ -21,10 +21,13 @@
 #include "ActiveAE.h"
 
 using namespace ActiveAE;
+#include "ActiveAEOutput.h"
 #include "ActiveAESound.h"
+#include "ActiveAESoundCache.h"
 #include "ActiveAEStream.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSP.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSPProcess.h"
+#include "cores/AudioEngine/Utils/AEKernels.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/Utils/AEStreamInfo.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
@@ -33,10 +36,7 @@ using namespace ActiveAE;
 #include "settings/Settings.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
-
-#define MAX_CACHE_LEVEL 0.4   // total cache time of stream in seconds
-#define MAX_WATER_LEVEL 0.2   // buffered time after stream stages in seconds
-#define MAX_BUFFER_TIME 0.1   // max time of a buffer in seconds
+#include "utils/TimeUtils.h"
 
 void CEngineStats::Reset(unsigned int sampleRate, bool pcm)
 {
@@ -214,7 +214,7 @@ float CEngineStats::GetCacheTime(CActiveAEStream *stream)
 
 float CEngineStats::GetCacheTotal(CActiveAEStream *stream)
 {
-  return MAX_CACHE_LEVEL + m_sinkCacheTotal;
+  return m_cacheLevel + m_sinkCacheTotal;
 }
 
 float CEngineStats::GetWaterLevel()
@@ -248,6 +248,12 @@ void CEngineStats::SetDSP(bool state)
   m_hasDSP = state;
 }
 
+void CEngineStats::SetCacheLevel(float time)
+{
+  CSingleLock lock(m_lock);
+  m_cacheLevel = time;
+}
+
 void CEngineStats::SetCurrentSinkFormat(AEAudioFormat SinkFormat)
 {
   CSingleLock lock(m_lock);
@@ -275,6 +281,7 @@ CActiveAE::CActiveAE() :
   m_sinkBuffers = NULL;
   m_silenceBuffers = NULL;
   m_encoderBuffers = NULL;
+  m_convolveBuffers = NULL;
   m_vizBuffers = NULL;
   m_vizBuffersInput = NULL;
   m_volume = 1.0;
@@ -284,9 +291,13 @@ CActiveAE::CActiveAE() :
   m_aeMuted = false;
   m_mode = MODE_PCM;
   m_encoder = NULL;
+  m_sinkLatency = 0;
   m_vizInitialized = false;
   m_sinkHasVolume = false;
   m_aeGUISoundForce = false;
+  m_starved = false;
+  m_bufferProfile = &AEBufferProfile::Get(false);
+  m_stats.SetCacheLevel(m_bufferProfile->cacheLevel);
   m_stats.Reset(44100, true);
   m_streamIdGen = 0;
   m_bDumb = true;
@@ -307,6 +318,13 @@ void CActiveAE::Dispose()
   m_controlPort.Purge();
   m_dataPort.Purge();
   m_sink.Dispose();
+
+  for (auto output : m_outputs)
+  {
+    output->Dispose();
+    delete output;
+  }
+  m_outputs.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -325,6 +343,17 @@ enum AE_STATES
   AE_TOP_CONFIGURED_PLAY,          // 7
 };
 
+const char *AE_stateNames[] = {
+    "top",
+    "error",
+    "unconfigured",
+    "reconfiguring",
+    "configured",
+    "suspend",
+    "idle",
+    "play",
+};
+
 int AE_parentStates[] = {
     -1,
     0, //TOP_ERROR
@@ -354,7 +383,7 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           m_volume = *(float*)msg->data;
           m_volumeScaled = CAEUtil::GainToScale(CAEUtil::PercentToGain(m_volume));
           if (m_sinkHasVolume)
-            m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::VOLUME, &m_volume, sizeof(float));
+            SendSinkMessage(CSinkControlProtocol::VOLUME, &m_volume, sizeof(float));
           return;
         case CActiveAEControlProtocol::MUTE:
           m_muted = *(bool*)msg->data;
@@ -365,7 +394,7 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
         case CActiveAEControlProtocol::DISPLAYRESET:
           return;
         case CActiveAEControlProtocol::APPFOCUSED:
-          m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::APPFOCUSED, msg->data, sizeof(bool));
+          SendSinkMessage(CSinkControlProtocol::APPFOCUSED, msg->data, sizeof(bool));
           return;
         case CActiveAEControlProtocol::STREAMRESAMPLEMODE:
           MsgStreamParameter *par;
@@ -542,14 +571,19 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           if (m_streams.empty())
           {
             streaming = false;
-            m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
+            SendSinkMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
           }
           LoadSettings();
-          m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::SETNOISETYPE, &m_settings.streamNoise, sizeof(bool));
-          m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::SETSILENCETIMEOUT, &m_settings.silenceTimeout, sizeof(int));
+          m_stats.SetSinkLatency(GetSinkLatency());
+          SendSinkMessage(CSinkControlProtocol::SETNOISETYPE, &m_settings.streamNoise, sizeof(bool));
+          SendSinkMessage(CSinkControlProtocol::SETSILENCETIMEOUT, &m_settings.silenceTimeout, sizeof(int));
           ChangeResamplers();
           if (!NeedReconfigureBuffers() && !NeedReconfigureSink())
+          {
+            ConfigureRoomCorrection();
+            ConfigureOutputs();
             return;
+          }
           m_state = AE_TOP_RECONFIGURING;
           m_extTimeout = 0;
           // don't accept any data until we are reconfigured
@@ -610,7 +644,7 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           {
             FlushEngine();
             streaming = false;
-            m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
+            SendSinkMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
           }
           stream->m_paused = true;
           return;
@@ -620,7 +654,7 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
             stream->m_syncState = CAESyncInfo::AESyncState::SYNC_START;
           stream->m_paused = false;
           streaming = true;
-          m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
+          SendSinkMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
           m_extTimeout = 0;
           return;
         case CActiveAEControlProtocol::FLUSHSTREAM:
@@ -645,6 +679,7 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           return;
         case CActiveAEControlProtocol::STREAMRESAMPLERATIO:
           par = (MsgStreamParameter*)msg->data;
+          par->stream->m_resampleRatio = par->parameter.double_par;
           if (par->stream->m_processingBuffers)
           {
             par->stream->m_processingBuffers->SetRR(par->parameter.double_par, m_settings.atempoThreshold);
@@ -720,21 +755,6 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           else
             msg->Reply(CActiveAEDataProtocol::ERR);
           return;
-        case CActiveAEDataProtocol::STREAMSAMPLE:
-          MsgStreamSample *msgData;
-          CSampleBuffer *samples;
-          msgData = (MsgStreamSample*)msg->data;
-          samples = msgData->stream->m_processingSamples.front();
-          msgData->stream->m_processingSamples.pop_front();
-          if (samples != msgData->buffer)
-            CLog::Log(LOGERROR, "CActiveAE - inconsistency in stream sample message");
-          if (msgData->buffer->pkt->nb_samples == 0)
-            msgData->buffer->Return();
-          else
-            msgData->stream->m_processingBuffers->m_inputSamples.push_back(msgData->buffer);
-          m_extTimeout = 0;
-          m_state = AE_TOP_CONFIGURED_PLAY;
-          return;
         case CActiveAEDataProtocol::FREESTREAM:
           stream = *(CActiveAEStream**)msg->data;
           DiscardStream(stream);
@@ -960,6 +980,8 @@ void CActiveAE::Process()
   XbmcThreads::EndTime timer;
 
   m_state = AE_TOP_UNCONFIGURED;
+  m_counters.SetStateNames(AE_stateNames, sizeof(AE_stateNames) / sizeof(AE_stateNames[0]));
+  m_counters.SetState(m_state);
   m_extTimeout = 1000;
   m_bStateMachineSelfTrigger = false;
   m_extDrain = false;
@@ -974,6 +996,7 @@ void CActiveAE::Process()
   {
     gotMsg = false;
     timer.Set(m_extTimeout);
+    m_counters.SetState(m_state);
 
     if (m_bStateMachineSelfTrigger)
     {
@@ -999,6 +1022,11 @@ void CActiveAE::Process()
       gotMsg = true;
       port = &m_sink.m_dataPort;
     }
+    // check sink data ports of additional outputs
+    else if (ReturnOutputBuffers())
+    {
+      continue;
+    }
     else if (!m_extDeferData)
     {
       // check data port
@@ -1021,6 +1049,16 @@ void CActiveAE::Process()
           }
         }
       }
+
+      // stream samples, only taken when we can process them
+      if (!gotMsg &&
+          (m_state == AE_TOP_CONFIGURED_IDLE || m_state == AE_TOP_CONFIGURED_PLAY) &&
+          ReceiveStreamSamples())
+      {
+        m_extTimeout = 0;
+        m_state = AE_TOP_CONFIGURED_PLAY;
+        continue;
+      }
     }
 
     if (gotMsg)
@@ -1095,6 +1133,10 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   AEAudioFormat sinkInputFormat, inputFormat;
   AEAudioFormat oldInternalFormat = m_internalFormat;
   AEAudioFormat oldSinkRequestFormat = m_sinkRequestFormat;
+  const AEBufferProfile *oldBufferProfile = m_bufferProfile;
+
+  m_bufferProfile = &AEBufferProfile::Get(m_settings.lowlatency);
+  m_stats.SetCacheLevel(m_bufferProfile->cacheLevel);
 
   inputFormat = GetInputFormat(desiredFmt);
 
@@ -1102,6 +1144,8 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   ApplySettingsToFormat(m_sinkRequestFormat, m_settings, (int*)&m_mode);
   m_extKeepConfig = 0;
 
+  m_bufferProfile->ApplyToRequest(m_sinkRequestFormat);
+
   CheckDevice1(true);
   CSingleLock slock(m_sinkLock);
   CheckDevice2(true);
@@ -1110,7 +1154,8 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   CAESinkFactory::ParseDevice(device, driver);
   if ((!CompareFormat(m_sinkRequestFormat, m_sinkFormat) && !CompareFormat(m_sinkRequestFormat, oldSinkRequestFormat)) ||
       m_currDevice.compare(device) != 0 ||
-      m_settings.driver.compare(driver) != 0)
+      m_settings.driver.compare(driver) != 0 ||
+      m_bufferProfile != oldBufferProfile)
   {
     FlushEngine();
     if (!InitSink())
@@ -1123,18 +1168,12 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     m_currDevice = device;
     initSink = true;
     m_stats.Reset(m_sinkFormat.m_sampleRate, m_mode == MODE_PCM);
-    m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::VOLUME, &m_volume, sizeof(float));
+    SendSinkMessage(CSinkControlProtocol::VOLUME, &m_volume, sizeof(float));
 
-    if (m_sinkRequestFormat.m_dataFormat != AE_FMT_RAW)
-    {
-      // limit buffer size in case of sink returns large buffer
-      double buffertime = (double)m_sinkFormat.m_frames / m_sinkFormat.m_sampleRate;
-      if (buffertime > MAX_BUFFER_TIME)
-      {
-        CLog::Log(LOGWARNING, "ActiveAE::%s - sink returned large buffer of %d ms, reducing to %d ms", __FUNCTION__, (int)(buffertime * 1000), (int)(MAX_BUFFER_TIME*1000));
-        m_sinkFormat.m_frames = MAX_BUFFER_TIME * m_sinkFormat.m_sampleRate;
-      }
-    }
+    // limit buffer size in case of sink returns large buffer
+    double buffertime = (double)m_sinkFormat.m_frames / m_sinkFormat.m_sampleRate;
+    if (m_bufferProfile->LimitBuffer(m_sinkFormat))
+      CLog::Log(LOGWARNING, "ActiveAE::%s - sink returned large buffer of %d ms, reducing to %d ms", __FUNCTION__, (int)(buffertime * 1000), (int)(m_bufferProfile->bufferTime*1000));
   }
   CheckDevice2(false);
   slock.Leave();
@@ -1159,12 +1198,12 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     inputFormat.m_frameSize = inputFormat.m_channelLayout.Count() *
                               (CAEUtil::DataFormatToBits(inputFormat.m_dataFormat) >> 3);
     m_silenceBuffers = new CActiveAEBufferPool(inputFormat, m_bAudio2);
-    m_silenceBuffers->Create(MAX_WATER_LEVEL*1000);
+    m_silenceBuffers->Create(m_bufferProfile->waterLevel*1000);
     sinkInputFormat = inputFormat;
     m_internalFormat = inputFormat;
 
     bool streaming = false;
-    m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
+    SendSinkMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
 
     delete m_encoder;
     m_encoder = NULL;
@@ -1189,7 +1228,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   else
   {
     bool streaming = true;
-    m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
+    SendSinkMessage(CSinkControlProtocol::STREAMING, &streaming, sizeof(bool));
 
     AEAudioFormat outputFormat;
     if (m_mode == MODE_RAW)
@@ -1240,7 +1279,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         if (!m_encoderBuffers)
         {
           m_encoderBuffers = new CActiveAEBufferPool(format, m_bAudio2);
-          m_encoderBuffers->Create(MAX_WATER_LEVEL*1000);
+          m_encoderBuffers->Create(m_bufferProfile->waterLevel*1000);
         }
       }
 
@@ -1285,7 +1324,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
 
         // create buffer pool
         (*it)->m_inputBuffers = new CActiveAEBufferPool((*it)->m_format, m_bAudio2);
-        (*it)->m_inputBuffers->Create(MAX_CACHE_LEVEL*1000);
+        (*it)->m_inputBuffers->Create(m_bufferProfile->cacheLevel*1000);
         (*it)->m_streamSpace = (*it)->m_format.m_frameSize * (*it)->m_format.m_frames;
 
         // if input format does not follow ffmpeg channel mask, we may need to remap channels
@@ -1306,10 +1345,11 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         (*it)->m_processingBuffers = new CActiveAEStreamBuffers((*it)->m_inputBuffers->m_format, outputFormat, m_settings.resampleQuality);
         (*it)->m_processingBuffers->ForceResampler((*it)->m_forceResampler);
         (*it)->m_processingBuffers->SetDSPConfig(useDSP, (*it)->m_bypassDSP);
+        (*it)->m_processingBuffers->SetCounters(&m_counters);
 
         if (useDSP && !(*it)->m_bypassDSP)
           (*it)->m_processingBuffers->SetExtraData((*it)->m_profile, (*it)->m_matrixEncoding, (*it)->m_audioServiceType);
-        (*it)->m_processingBuffers->Create(MAX_CACHE_LEVEL*1000, false, m_settings.stereoupmix, m_settings.normalizelevels, useDSP);
+        (*it)->m_processingBuffers->Create(m_bufferProfile->cacheLevel*1000, false, m_settings.stereoupmix, m_settings.normalizelevels, useDSP);
 
         m_stats.SetDSP(useDSP);
       }
@@ -1369,7 +1409,28 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   if (!m_sinkBuffers)
   {
     m_sinkBuffers = new CActiveAEBufferPoolResample(sinkInputFormat, m_sinkFormat, m_settings.resampleQuality);
-    m_sinkBuffers->Create(MAX_WATER_LEVEL*1000, true, false);
+    m_sinkBuffers->SetCounters(&m_counters);
+    m_sinkBuffers->Create(m_bufferProfile->waterLevel*1000, true, false);
+  }
+
+  // tell why the latency stays above what the profile aims at
+  {
+    double target = m_bufferProfile->GetTarget();
+    double achieved = m_bufferProfile->waterLevel + m_stats.GetSinkCacheTotal();
+    unsigned int limits = m_bufferProfile->GetLimits(m_sinkFormat, m_stats.GetSinkCacheTotal(),
+                                                     m_mode == MODE_TRANSCODE, m_stats.HasDSP());
+    m_counters.SetLatency(m_settings.lowlatency, target, achieved, limits);
+    if (limits)
+    {
+      std::string names;
+      for (int i = 0; i < CAEEngineCounters::MAX_LIMIT; i++)
+      {
+        if (limits & (1 << i))
+          names += std::string(names.empty() ? "" : ", ") + CAEEngineCounters::GetLimitName((CAEEngineCounters::Limit)i);
+      }
+      CLog::Log(LOGNOTICE, "ActiveAE::%s%s - latency %d ms, target %d ms, limited by: %s", __FUNCTION__, STR_2ND,
+                (int)(achieved * 1000), (int)(target * 1000), names.c_str());
+    }
   }
 
   // reset gui sounds
@@ -1388,6 +1449,9 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     m_sounds_playing.clear();
   }
 
+  ConfigureRoomCorrection();
+  ConfigureOutputs();
+
   ClearDiscardedBuffers();
   m_extDrain = false;
 }
@@ -1417,6 +1481,7 @@ CActiveAEStream* CActiveAE::CreateStream(MsgStreamNew *streamMsg)
   stream->SetAudio2(m_bAudio2);
   stream->m_streamPort = new CActiveAEDataProtocol("stream",
                              &stream->m_inMsgEvent, &m_outMsgEvent);
+  stream->m_engineEvent = &m_outMsgEvent;
 
   // create buffer pool
   stream->m_inputBuffers = NULL; // create in Configure when we know the sink format
@@ -1424,6 +1489,7 @@ CActiveAEStream* CActiveAE::CreateStream(MsgStreamNew *streamMsg)
   stream->m_fadingSamples = 0;
   stream->m_started = false;
   stream->m_resampleMode = 0;
+  stream->m_resampleRatio = 1.0;
   stream->m_syncState = CAESyncInfo::AESyncState::SYNC_OFF;
 
   if (streamMsg->options & AESTREAM_PAUSED)
@@ -1491,6 +1557,9 @@ void CActiveAE::SFlushStream(CActiveAEStream *stream)
   }
   stream->m_processingBuffers->Flush();
   stream->m_streamPort->Purge();
+  // the stream waits for our reply, both sides of the queues are idle
+  stream->m_freeSamples.Clear();
+  stream->m_filledSamples.Clear();
   stream->m_bufferedTime = 0.0;
   stream->m_paused = false;
   stream->m_syncState = CAESyncInfo::AESyncState::SYNC_START;
@@ -1511,6 +1580,8 @@ void CActiveAE::FlushEngine()
     m_sinkBuffers->Flush();
   if (m_vizBuffers)
     m_vizBuffers->Flush();
+  if (m_convolveBuffers)
+    m_convolveBuffers->Flush();
 
   // send message to sink
   Message *reply;
@@ -1531,6 +1602,9 @@ void CActiveAE::FlushEngine()
     m_extError = true;
   }
   m_stats.Reset(m_sinkFormat.m_sampleRate, m_mode == MODE_PCM);
+
+  for (auto output : m_outputs)
+    output->Flush();
 }
 
 void CActiveAE::ClearDiscardedBuffers()
@@ -1742,6 +1816,7 @@ bool CActiveAE::InitSink()
   SinkConfig config;
   config.format = m_sinkRequestFormat;
   config.stats = &m_stats;
+  config.counters = &m_counters;
   config.device = (m_sinkRequestFormat.m_dataFormat == AE_FMT_RAW) ? &m_settings.passthoughdevice :
                                                                      &m_settings.device;
 
@@ -1770,7 +1845,8 @@ bool CActiveAE::InitSink()
       m_sinkFormat = data->format;
       m_sinkHasVolume = data->hasVolume;
       m_stats.SetSinkCacheTotal(data->cacheTotal);
-      m_stats.SetSinkLatency(data->latency);
+      m_sinkLatency = data->latency;
+      m_stats.SetSinkLatency(GetSinkLatency());
       m_stats.SetCurrentSinkFormat(m_sinkFormat);
 	  m_bDumb = data->isNull ? true : false;
     }
@@ -1840,6 +1916,9 @@ void CActiveAE::UnconfigureSink()
     m_extError = true;
   }
 
+  for (auto output : m_outputs)
+    output->Unconfigure();
+
   // make sure we open sink on next configure
   m_currDevice = "";
 
@@ -1847,6 +1926,119 @@ void CActiveAE::UnconfigureSink()
   m_bDumb = true;
 }
 
+void CActiveAE::ConfigureOutputs()
+{
+  // drop outputs which have been removed from settings
+  while (m_outputs.size() > m_settings.outputs.size())
+  {
+    m_outputs.back()->Dispose();
+    delete m_outputs.back();
+    m_outputs.pop_back();
+  }
+
+  for (unsigned int i = 0; i < m_settings.outputs.size(); i++)
+  {
+    if (i == m_outputs.size())
+    {
+      CActiveAEOutput *output = new CActiveAEOutput(&m_outMsgEvent, m_outputCounters);
+      output->Start();
+      m_outputs.push_back(output);
+    }
+
+    // outputs take the pcm mix or the encoded mix, they are closed while
+    // the main sink passes through a stream
+    const OutputSettings &settings = m_settings.outputs[i];
+    bool transcode = m_mode == MODE_TRANSCODE && m_encoderBuffers && settings.transcode;
+    if (m_mode == MODE_RAW ||
+        m_internalFormat.m_dataFormat == AE_FMT_INVALID ||
+        (!transcode && settings.device == m_settings.device) ||
+        (transcode && settings.passthroughdevice == m_settings.passthoughdevice))
+    {
+      if (m_outputs[i]->IsConfigured())
+        m_outputs[i]->Unconfigure();
+      continue;
+    }
+
+    // encoded frames are shared, the encoder runs once for all sinks
+    const AEAudioFormat *encodedFormat = transcode ? &m_sinkFormat : nullptr;
+    if (!m_outputs[i]->Configure(settings, m_settings, m_internalFormat, encodedFormat))
+      CLog::Log(LOGERROR, "ActiveAE::%s - failed to configure output %s", __FUNCTION__, m_settings.outputs[i].device.c_str());
+  }
+}
+
+void CActiveAE::ConfigureRoomCorrection()
+{
+  // the filters run on the pcm mix, before it is encoded
+  std::string filename = m_mode != MODE_RAW ? m_settings.roomcorrection : "";
+  if (m_convolveBuffers &&
+      (m_convolveBuffers->GetFilename() != filename ||
+       !CompareFormat(m_convolveBuffers->m_format, m_internalFormat) ||
+       m_convolveBuffers->m_format.m_frames != m_internalFormat.m_frames))
+  {
+    m_discardBufferPools.push_back(m_convolveBuffers);
+    m_convolveBuffers = NULL;
+  }
+  if (!m_convolveBuffers && !filename.empty())
+  {
+    m_convolveBuffers = new CActiveAEBufferPoolConvolve(m_internalFormat, m_bAudio2);
+    if (!m_convolveBuffers->LoadFilter(filename) ||
+        !m_convolveBuffers->Create(m_bufferProfile->waterLevel*1000))
+    {
+      CLog::Log(LOGERROR, "ActiveAE::%s%s - room correction disabled", __FUNCTION__, STR_2ND);
+      delete m_convolveBuffers;
+      m_convolveBuffers = NULL;
+    }
+  }
+  m_stats.SetSinkLatency(GetSinkLatency());
+}
+
+double CActiveAE::GetSinkLatency()
+{
+  // the device behind the sink and the filters in front of it add to the delay
+  double latency = m_sinkLatency + m_settings.latency / 1000.0;
+  if (m_convolveBuffers)
+    latency += m_convolveBuffers->GetLatency();
+  return latency;
+}
+
+bool CActiveAE::ReturnOutputBuffers()
+{
+  bool ret = false;
+  for (auto output : m_outputs)
+    ret |= output->ReturnBuffers();
+  return ret;
+}
+
+void CActiveAE::SendSinkMessage(int signal, void *data, int size)
+{
+  m_sink.m_controlPort.SendOutMessage(signal, data, size);
+  for (auto output : m_outputs)
+    output->SendControl(signal, data, size);
+}
+
+
+bool CActiveAE::ReceiveStreamSamples()
+{
+  bool received = false;
+  CSampleBuffer *buffer;
+  std::list<CActiveAEStream*>::iterator it;
+  for (it = m_streams.begin(); it != m_streams.end(); ++it)
+  {
+    while ((*it)->m_filledSamples.Pop(buffer))
+    {
+      if ((*it)->m_processingSamples.empty() || (*it)->m_processingSamples.front() != buffer)
+        CLog::Log(LOGERROR, "CActiveAE - inconsistency in stream sample queue");
+      else
+        (*it)->m_processingSamples.pop_front();
+      if (buffer->pkt->nb_samples == 0)
+        buffer->Return();
+      else
+        (*it)->m_processingBuffers->m_inputSamples.push_back(buffer);
+      received = true;
+    }
+  }
+  return received;
+}
 
 bool CActiveAE::RunStages()
 {
@@ -1875,14 +2067,21 @@ bool CActiveAE::RunStages()
       float buftime = (float)(*it)->m_inputBuffers->m_format.m_frames / (*it)->m_inputBuffers->m_format.m_sampleRate;
       if ((*it)->m_inputBuffers->m_format.m_dataFormat == AE_FMT_RAW)
         buftime = (*it)->m_inputBuffers->m_format.m_streamInfo.GetDuration() / 1000;
-      while ((time < MAX_CACHE_LEVEL || (*it)->m_streamIsBuffering) && !(*it)->m_inputBuffers->m_freeSamples.empty())
+      bool wake = false;
+      while ((time < m_bufferProfile->cacheLevel || (*it)->m_streamIsBuffering) &&
+             !(*it)->m_inputBuffers->m_freeSamples.empty() &&
+             (*it)->m_processingSamples.size() < (*it)->m_freeSamples.Capacity())
       {
+        bool wasEmpty;
         buffer = (*it)->m_inputBuffers->GetFreeBuffer();
         (*it)->m_processingSamples.push_back(buffer);
-        (*it)->m_streamPort->SendInMessage(CActiveAEDataProtocol::STREAMBUFFER, &buffer, sizeof(CSampleBuffer*));
+        (*it)->m_freeSamples.Push(buffer, &wasEmpty);
         (*it)->IncFreeBuffers();
+        wake |= wasEmpty;
         time += buftime;
       }
+      if (wake)
+        (*it)->m_inMsgEvent.Set();
     }
     else
     {
@@ -1914,8 +2113,9 @@ bool CActiveAE::RunStages()
     }
   }
 
-  if (m_stats.GetWaterLevel() < MAX_WATER_LEVEL &&
-     (m_mode != MODE_TRANSCODE || (m_encoderBuffers && !m_encoderBuffers->m_freeSamples.empty())))
+  if (m_stats.GetWaterLevel() < m_bufferProfile->waterLevel &&
+     (m_mode != MODE_TRANSCODE || (m_encoderBuffers && !m_encoderBuffers->m_freeSamples.empty())) &&
+     (!m_convolveBuffers || !m_convolveBuffers->m_freeSamples.empty()))
   {
     // calculate sync error
     for (it = m_streams.begin(); it != m_streams.end(); ++it)
@@ -1942,6 +2142,7 @@ bool CActiveAE::RunStages()
     // mix streams and sounds sounds
     if (m_mode != MODE_RAW)
     {
+      int64_t mixStart = CurrentHostCounter();
       CSampleBuffer *out = NULL;
       if (!m_sounds_playing.empty() && m_streams.empty())
       {
@@ -1962,14 +2163,23 @@ bool CActiveAE::RunStages()
       // if we deal with more than a single stream, all streams
       // must provide samples for mixing
       bool allStreamsReady = true;
+      bool starved = false;
       for (it = m_streams.begin(); it != m_streams.end(); ++it)
       {
         if ((*it)->m_paused || !(*it)->m_started || !(*it)->m_processingBuffers)
           continue;
 
         if ((*it)->m_processingBuffers->m_outputSamples.empty())
+        {
           allStreamsReady = false;
+          if (!(*it)->m_drain && !(*it)->m_streamIsBuffering)
+            starved = true;
+        }
       }
+      // count each gap once, not every time we look
+      if (starved && !m_starved)
+        m_counters.AddEvent(CAEEngineCounters::EVENT_UNDERRUN);
+      m_starved = starved;
 
       bool needClamp = false;
       for (it = m_streams.begin(); it != m_streams.end() && allStreamsReady; ++it)
@@ -2053,15 +2263,7 @@ bool CActiveAE::RunStages()
 
               for(int j=0; j<out->pkt->planes; j++)
               {
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
+                CAEKernels::Mul((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
               }
             }
           }
@@ -2122,24 +2324,8 @@ bool CActiveAE::RunStages()
               {
                 float *dst = (float*)out->pkt->data[j]+i*nb_floats;
                 float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
+                if (CAEKernels::MulAdd(dst, src, volume, nb_floats))
+                  needClamp = true;
               }
             }
             mix->Return();
@@ -2154,7 +2340,7 @@ bool CActiveAE::RunStages()
         int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
         for(int i=0; i<out->pkt->planes; i++)
         {
-          CAEUtil::ClampArray((float*)out->pkt->data[i], nb_floats);
+          CAEKernels::Clamp((float*)out->pkt->data[i], nb_floats);
         }
       }
 
@@ -2218,16 +2404,38 @@ bool CActiveAE::RunStages()
         if (!m_sinkHasVolume || m_muted)
           Deamplify(*(out->pkt));
 
+        m_counters.AddTime(CAEEngineCounters::STAGE_MIX, CurrentHostCounter() - mixStart);
+
+        // feed pcm outputs before the mix gets encoded
+        for (auto output : m_outputs)
+          output->AddSamples(out);
+
+        // pcm outputs hold the unfiltered mix and apply filters of their own
+        if (m_convolveBuffers)
+        {
+          CAEStageTimer timer(&m_counters, CAEEngineCounters::STAGE_DSP);
+          CSampleBuffer *buf = m_convolveBuffers->Process(out);
+          out->Return();
+          out = buf;
+        }
+
         if (m_mode == MODE_TRANSCODE && m_encoder)
         {
           CSampleBuffer *buf = m_encoderBuffers->GetFreeBuffer();
-          buf->pkt->nb_samples = m_encoder->Encode(out->pkt->data[0], out->pkt->planes*out->pkt->linesize,
-                                                   buf->pkt->data[0], buf->pkt->planes*buf->pkt->linesize);
+          {
+            CAEStageTimer timer(&m_counters, CAEEngineCounters::STAGE_ENCODE);
+            buf->pkt->nb_samples = m_encoder->Encode(out->pkt->data[0], out->pkt->planes*out->pkt->linesize,
+                                                     buf->pkt->data[0], buf->pkt->planes*buf->pkt->linesize);
+          }
 
           // set pts of last sample
           buf->pkt_start_offset = buf->pkt->nb_samples;
           buf->timestamp = out->timestamp;
 
+          // bitstreaming outputs share the encoded frame
+          for (auto output : m_outputs)
+            output->AddSamples(buf);
+
           out->Return();
           out = buf;
         }
@@ -2278,6 +2486,28 @@ bool CActiveAE::RunStages()
     busy = true;
   }
 
+  // serve additional outputs, they follow the delay of the main sink
+  if (!m_outputs.empty())
+  {
+    AEDelayStatus status;
+    m_stats.GetDelay(status);
+    double latency = GetSinkLatency();
+    for (auto output : m_outputs)
+      busy |= output->Serve(status, latency);
+  }
+
+  unsigned int inputUsed = 0;
+  unsigned int inputTotal = 0;
+  for (auto stream : m_streams)
+  {
+    inputTotal += stream->m_inputBuffers->m_allSamples.size();
+    inputUsed += stream->m_inputBuffers->m_allSamples.size() - stream->m_inputBuffers->m_freeSamples.size();
+  }
+  m_counters.SetPoolLevel(CAEEngineCounters::POOL_INPUT, inputUsed, inputTotal);
+  m_counters.SetPoolLevel(CAEEngineCounters::POOL_SINK,
+                          m_sinkBuffers->m_allSamples.size() - m_sinkBuffers->m_freeSamples.size(),
+                          m_sinkBuffers->m_allSamples.size());
+
   return busy;
 }
 
@@ -2289,6 +2519,11 @@ bool CActiveAE::HasWork()
     return true;
   if (!m_sinkBuffers->m_outputSamples.empty())
     return true;
+  for (auto output : m_outputs)
+  {
+    if (output->HasWork())
+      return true;
+  }
 
   std::list<CActiveAEStream*>::iterator it;
   for (it = m_streams.begin(); it != m_streams.end(); ++it)
@@ -2461,7 +2696,7 @@ CSampleBuffer* CActiveAE::SyncStream(CActiveAEStream *stream)
         stream->m_syncState = CAESyncInfo::AESyncState::SYNC_INSYNC;
         stream->m_syncError.Flush(1000);
         stream->m_resampleIntegral = 0;
-        stream->m_processingBuffers->SetRR(1.0, m_settings.atempoThreshold);
+        stream->m_processingBuffers->SetRR(stream->m_resampleRatio, m_settings.atempoThreshold);
         CLog::Log(LOGDEBUG,"ActiveAE::SyncStream - average error %f below threshold of %f", error, 30.0);
       }
     }
@@ -2481,7 +2716,8 @@ CSampleBuffer* CActiveAE::SyncStream(CActiveAEStream *stream)
   }
   else if (stream->m_processingBuffers)
   {
-    stream->m_processingBuffers->SetRR(1.0, m_settings.atempoThreshold);
+    // keep a ratio set by the client, e.g. for drift correction between outputs
+    stream->m_processingBuffers->SetRR(stream->m_resampleRatio, m_settings.atempoThreshold);
   }
   return ret;
 }
@@ -2514,12 +2750,7 @@ void CActiveAE::MixSounds(CSoundPacket &dstSample)
       out = (float*)dstSample.data[j];
       sample_buffer = (float*)(it->sound->GetSound(false)->data[j]+start);
       int nb_floats = mix_samples * dstSample.config.channels / dstSample.planes;
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulAddArray(out, sample_buffer, volume, nb_floats);
-#else
-      for (int k = 0; k < nb_floats; ++k)
-        *out++ += *sample_buffer++ * volume;
-#endif
+      CAEKernels::MulAdd(out, sample_buffer, volume, nb_floats);
     }
 
     it->samples_played += mix_samples;
@@ -2545,13 +2776,7 @@ void CActiveAE::Deamplify(CSoundPacket &dstSample)
     for(int j=0; j<dstSample.planes; j++)
     {
       buffer = (float*)dstSample.data[j];
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulArray(buffer, volume, nb_floats);
-#else
-      float *fbuffer = buffer;
-      for (int i = 0; i < nb_floats; i++)
-        *fbuffer++ *= volume;
-#endif
+      CAEKernels::Mul(buffer, volume, nb_floats);
     }
   }
 }
@@ -2592,6 +2817,30 @@ void CActiveAE::LoadSettings()
   m_settings.atempoThreshold = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT_ATEMPOTHRESHOLD) / 100.0;
   m_settings.streamNoise = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT_STREAMNOISE);
   m_settings.silenceTimeout = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT_STREAMSILENCE) * 60000;
+  m_settings.latency = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT_LATENCY);
+  m_settings.lowlatency = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT_LOWLATENCY);
+  m_settings.roomcorrection = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTION) ?
+                              CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTIONFILE) : "";
+
+  // second device shares this engine if it has no engine of its own
+  m_settings.outputs.clear();
+  if (!CAEFactory::GetEngine(true) &&
+      CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED) &&
+      CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_SHAREDENGINE))
+  {
+    OutputSettings output;
+    output.device = CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT2_AUDIODEVICE);
+    output.passthroughdevice = CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT2_PASSTHROUGHDEVICE);
+    output.channels = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT2_CHANNELS);
+    output.transcode = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_PASSTHROUGH) &&
+                       CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_AC3PASSTHROUGH) &&
+                       CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_AC3TRANSCODE);
+    output.latency = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT2_LATENCY);
+    output.lowlatency = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_LOWLATENCY);
+    output.roomcorrection = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTION) ?
+                            CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE) : "";
+    m_settings.outputs.push_back(output);
+  }
 }
 
 void CActiveAE::LoadSettings2()
@@ -2624,6 +2873,10 @@ void CActiveAE::LoadSettings2()
   m_settings.atempoThreshold = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT2_ATEMPOTHRESHOLD) / 100.0;
   m_settings.streamNoise = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_STREAMNOISE);
   m_settings.silenceTimeout = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT2_STREAMSILENCE) * 60000;
+  m_settings.latency = CSettings::GetInstance().GetInt(CSettings::SETTING_AUDIOOUTPUT2_LATENCY);
+  m_settings.lowlatency = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_LOWLATENCY);
+  m_settings.roomcorrection = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTION) ?
+                              CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE) : "";
 
   SetDisabled(!CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED));
 }
@@ -2686,6 +2939,8 @@ void CActiveAE::CheckDevice2(bool bPreInitSink)
 
 bool CActiveAE::Initialize()
 {
+  CLog::Log(LOGDEBUG, "ActiveAE::%s - using %s sample kernels", __FUNCTION__,
+            CAEKernels::GetImplementationName(CAEKernels::GetImplementation()));
   Create();
   Message *reply;
   if (m_controlPort.SendOutMessageSync(CActiveAEControlProtocol::INIT,
@@ -2748,7 +3003,22 @@ void CActiveAE::OnSettingsChange(const std::string& setting)
       setting == CSettings::SETTING_AUDIOOUTPUT_SAMPLERATE             ||
       setting == CSettings::SETTING_AUDIOOUTPUT_MAINTAINORIGINALVOLUME ||
       setting == CSettings::SETTING_AUDIOOUTPUT_GUISOUNDMODE           ||
-      setting == CSettings::SETTING_AUDIOOUTPUT_STREAMNOISE)
+      setting == CSettings::SETTING_AUDIOOUTPUT_STREAMNOISE            ||
+      setting == CSettings::SETTING_AUDIOOUTPUT_LATENCY                ||
+      setting == CSettings::SETTING_AUDIOOUTPUT_LOWLATENCY             ||
+      setting == CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTION         ||
+      setting == CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTIONFILE     ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_LATENCY               ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_LOWLATENCY            ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTION        ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE    ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_ENABLED               ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_AUDIODEVICE           ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_CHANNELS              ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_PASSTHROUGHDEVICE     ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_PASSTHROUGH           ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_AC3PASSTHROUGH        ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_AC3TRANSCODE)
   {
     m_controlPort.SendOutMessage(CActiveAEControlProtocol::RECONFIGURE);
   }
@@ -2775,7 +3045,11 @@ void CActiveAE::OnSettingsChange2(const std::string& setting)
       setting == CSettings::SETTING_AUDIOOUTPUT2_SAMPLERATE 			||
       setting == CSettings::SETTING_AUDIOOUTPUT2_MAINTAINORIGINALVOLUME ||
       setting == CSettings::SETTING_AUDIOOUTPUT2_GUISOUNDMODE           ||
-      setting == CSettings::SETTING_AUDIOOUTPUT2_STREAMNOISE)
+      setting == CSettings::SETTING_AUDIOOUTPUT2_STREAMNOISE            ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_LATENCY                ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_LOWLATENCY             ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTION         ||
+      setting == CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE)
   {
     m_controlPort.SendOutMessage(CActiveAEControlProtocol::RECONFIGURE);
   }
@@ -2904,7 +3178,8 @@ bool CActiveAE::IsSettingVisible(const std::string &settingId)
       return true;
     }
   }
-  else if (settingId == CSettings::SETTING_AUDIOOUTPUT_DSPSETTINGS)
+  else if (settingId == CSettings::SETTING_AUDIOOUTPUT_DSPSETTINGS ||
+           settingId == CSettings::SETTING_AUDIOOUTPUT_DSPPIPELINE)
   {
     if (CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT_DSPADDONSENABLED) &&
         m_sink.GetDeviceType(CSettings::GetInstance().GetString(CSettings::SETTING_AUDIOOUTPUT_AUDIODEVICE)) != AE_DEVTYPE_IEC958)
@@ -3100,6 +3375,11 @@ AEAudioFormat CActiveAE::GetCurrentSinkFormat()
   return m_stats.GetCurrentSinkFormat();
 }
 
+CAEEngineCounters *CActiveAE::GetCounters(bool output)
+{
+  return output ? &m_outputCounters : &m_counters;
+}
+
 void CActiveAE::OnLostDisplay()
 {
   Message *reply;
@@ -3187,6 +3467,16 @@ IAESound *CActiveAE::MakeSound(const std::string& file)
 
   sound = new CActiveAESound(file);
   sound->SetAudio2(m_bAudio2);
+
+  // decoded before by the other engine or the last skin load
+  std::shared_ptr<CSoundPacket> decoded = CActiveAESoundCache::GetInstance().GetDecoded(file);
+  if (decoded)
+  {
+    sound->SetSound(true, decoded);
+    m_dataPort.SendOutMessage(CActiveAEDataProtocol::NEWSOUND, &sound, sizeof(CActiveAESound*));
+    return sound;
+  }
+
   if (!sound->Prepare())
   {
     delete sound;
@@ -3308,6 +3598,9 @@ IAESound *CActiveAE::MakeSound(const std::string& file)
 
   sound->Finish();
 
+  if (sound->GetSound(true))
+    CActiveAESoundCache::GetInstance().AddDecoded(file, sound->GetSound(true));
+
   // register sound
   m_dataPort.SendOutMessage(CActiveAEDataProtocol::NEWSOUND, &sound, sizeof(CActiveAESound*));
 
@@ -3389,6 +3682,18 @@ bool CActiveAE::ResampleSound(CActiveAESound *sound)
     }
   }
 
+  SoundConversion conversion;
+  conversion.config = dst_config;
+  conversion.channel = testChannel;
+  conversion.quality = m_settings.resampleQuality;
+  std::shared_ptr<CSoundPacket> converted = CActiveAESoundCache::GetInstance().GetConverted(sound->GetSound(true), conversion);
+  if (converted)
+  {
+    sound->SetSound(false, converted);
+    sound->SetConverted(true);
+    return true;
+  }
+
   IAEResample *resampler = CAEResampleFactory::Create(AERESAMPLEFACTORY_QUICK_RESAMPLE);
   resampler->Init(dst_config.channel_layout,
                   dst_config.channels,
@@ -3426,6 +3731,7 @@ bool CActiveAE::ResampleSound(CActiveAESound *sound)
   sound->GetSound(false)->nb_samples = samples;
 
   delete resampler;
+  CActiveAESoundCache::GetInstance().AddConverted(sound->GetSound(true), conversion, sound->GetSound(false));
   sound->SetConverted(true);
   return true;
 }
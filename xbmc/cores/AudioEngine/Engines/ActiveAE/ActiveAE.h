@@ -31,6 +31,7 @@
 #include "cores/AudioEngine/Interfaces/AESound.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBuffer.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBufferProfile.h"
 
 #include "guilib/DispResource.h"
 #include <queue>
@@ -50,6 +51,18 @@ namespace ActiveAE
 
 class CActiveAESound;
 class CActiveAEStream;
+class CActiveAEOutput;
+
+struct OutputSettings
+{
+  std::string device;
+  std::string passthroughdevice;
+  int channels;
+  bool transcode;
+  int latency;
+  bool lowlatency;
+  std::string roomcorrection;
+};
 
 struct AudioSettings
 {
@@ -74,6 +87,10 @@ struct AudioSettings
   double atempoThreshold;
   bool streamNoise;
   int silenceTimeout;
+  int latency; // ms the device behind the sink adds
+  bool lowlatency; // smaller buffers for less delay, less headroom against dropouts
+  std::string roomcorrection; // wav file with the fir filters of the mix, empty if off
+  std::vector<OutputSettings> outputs; // additional sinks fed from this engine's mix
 };
 
 class CActiveAEControlProtocol : public Protocol
@@ -125,14 +142,12 @@ public:
     FREESOUND,
     NEWSTREAM,
     FREESTREAM,
-    STREAMSAMPLE,
     DRAINSTREAM,
   };
   enum InSignal
   {
     ACC,
     ERR,
-    STREAMBUFFER,
     STREAMDRAINED,
   };
 };
@@ -144,12 +159,6 @@ struct MsgStreamNew
   IAEClockCallback *clock;
 };
 
-struct MsgStreamSample
-{
-  CSampleBuffer *buffer;
-  CActiveAEStream *stream;
-};
-
 struct MsgStreamParameter
 {
   CActiveAEStream *stream;
@@ -196,12 +205,15 @@ public:
   void SetDSP(bool state);
   void SetCurrentSinkFormat(AEAudioFormat SinkFormat);
   void SetSinkCacheTotal(float time) { m_sinkCacheTotal = time; }
+  float GetSinkCacheTotal() { return m_sinkCacheTotal; }
   void SetSinkLatency(float time) { m_sinkLatency = time; }
+  void SetCacheLevel(float time);
   bool IsSuspended();
   bool HasDSP();
   AEAudioFormat GetCurrentSinkFormat();
 protected:
   float m_sinkCacheTotal;
+  float m_cacheLevel;
   float m_sinkLatency;
   int m_bufferedSamples;
   unsigned int m_sinkSampleRate;
@@ -272,6 +284,7 @@ public:
   virtual void DeviceChange();
   virtual bool HasDSP();
   virtual AEAudioFormat GetCurrentSinkFormat();
+  virtual CAEEngineCounters *GetCounters(bool output = false);
 
   virtual void RegisterAudioCallback(IAudioCallback* pCallback);
   virtual void UnregisterAudioCallback(IAudioCallback* pCallback);
@@ -282,8 +295,8 @@ public:
 
 protected:
   void PlaySound(CActiveAESound *sound);
-  uint8_t **AllocSoundSample(SampleConfig &config, int &samples, int &bytes_per_sample, int &planes, int &linesize);
-  void FreeSoundSample(uint8_t **data);
+  static uint8_t **AllocSoundSample(SampleConfig &config, int &samples, int &bytes_per_sample, int &planes, int &linesize);
+  static void FreeSoundSample(uint8_t **data);
   void GetDelay(AEDelayStatus& status, CActiveAEStream *stream) { m_stats.GetDelay(status, stream); }
   void GetSyncInfo(CAESyncInfo& info, CActiveAEStream *stream) { m_stats.GetSyncInfo(info, stream); }
   float GetCacheTime(CActiveAEStream *stream) { return m_stats.GetCacheTime(stream); }
@@ -305,6 +318,11 @@ protected:
   bool InitSink();
   void DrainSink();
   void UnconfigureSink();
+  void ConfigureOutputs();
+  void ConfigureRoomCorrection();
+  double GetSinkLatency();
+  void SendSinkMessage(int signal, void *data, int size);
+  bool ReturnOutputBuffers();
   void Start();
   void Dispose();
   void LoadSettings();
@@ -328,6 +346,7 @@ protected:
   void ChangeResamplers();
 
   bool RunStages();
+  bool ReceiveStreamSamples();
   bool HasWork();
   CSampleBuffer* SyncStream(CActiveAEStream *stream);
 
@@ -360,15 +379,21 @@ protected:
   }m_mode;
 
   CActiveAESink m_sink;
+  std::vector<CActiveAEOutput*> m_outputs;
   AEAudioFormat m_sinkFormat;
   AEAudioFormat m_sinkRequestFormat;
   AEAudioFormat m_encoderFormat;
   AEAudioFormat m_internalFormat;
   AEAudioFormat m_inputFormat;
   AudioSettings m_settings;
+  const AEBufferProfile *m_bufferProfile;
   CEngineStats m_stats;
+  CAEEngineCounters m_counters;
+  CAEEngineCounters m_outputCounters; // shared by the additional outputs
+  bool m_starved; // a playing stream had nothing when the sink needed data
   IAEEncoder *m_encoder;
   std::string m_currDevice;
+  float m_sinkLatency;
 
   // buffers
   CActiveAEBufferPoolResample *m_sinkBuffers;
@@ -376,6 +401,7 @@ protected:
   CActiveAEBufferPool *m_vizBuffersInput;
   CActiveAEBufferPool *m_silenceBuffers;  // needed to drive gui sounds if we have no streams
   CActiveAEBufferPool *m_encoderBuffers;
+  CActiveAEBufferPoolConvolve *m_convolveBuffers;
 
   // streams
   std::list<CActiveAEStream*> m_streams;
@@ -19,12 +19,18 @@
  */
 
 #include "ActiveAEBuffer.h"
-#include "ActiveAEFilter.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSPProcess.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAE.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
+#include "cores/AudioEngine/Utils/AEConvolver.h"
+#include "cores/AudioEngine/Utils/AETimeStretch.h"
+#include "filesystem/File.h"
+#include "utils/auto_buffer.h"
+#include "utils/log.h"
+
+#include <string.h>
 
 using namespace ActiveAE;
 
@@ -34,7 +40,7 @@ using namespace ActiveAE;
 CSoundPacket::CSoundPacket(SampleConfig conf, int samples, bool bAudio2) : config(conf)
 {
   m_bAudio2 = bAudio2;
-  data = AE.AllocSoundSample(config, samples, bytes_per_sample, planes, linesize);
+  data = CActiveAE::AllocSoundSample(config, samples, bytes_per_sample, planes, linesize);
   max_nb_samples = samples;
   nb_samples = 0;
   pause_burst_ms = 0;
@@ -43,7 +49,7 @@ CSoundPacket::CSoundPacket(SampleConfig conf, int samples, bool bAudio2) : confi
 CSoundPacket::~CSoundPacket()
 {
   if (data)
-    AE.FreeSoundSample(data);
+    CActiveAE::FreeSoundSample(data);
 }
 
 CSampleBuffer::CSampleBuffer() : pkt(NULL), pool(NULL)
@@ -74,6 +80,7 @@ void CSampleBuffer::Return()
 CActiveAEBufferPool::CActiveAEBufferPool(AEAudioFormat format, bool bAudio2)
 {
   m_bAudio2 = bAudio2;
+  m_counters = nullptr;
 
   m_format = format;
   if (m_format.m_dataFormat == AE_FMT_RAW)
@@ -439,24 +446,27 @@ bool CActiveAEBufferPoolResample::ResampleBuffers(int64_t timestamp)
       /*
        * DSP need always a available input packet! To pass it step by step
        * over all enabled addons and processing segments.
+       * A pipelined DSP holds back one packet, it is passed out on drain.
        */
-      if (m_useDSP && in)
+      if (m_useDSP && (in || (m_drain && m_processor->IsPipelined())))
       {
         if (!m_dspSample)
           m_dspSample = m_dspBuffer->GetFreeBuffer();
 
-        if (m_dspSample && m_processor->Process(in, m_dspSample))
+        bool processed;
         {
-          m_dspSample->timestamp = in->timestamp;
+          CAEStageTimer timer(m_counters, CAEEngineCounters::STAGE_DSP);
+          processed = m_dspSample && m_processor->Process(in, m_dspSample);
+        }
+        if (in)
           in->Return();
+        if (processed)
+        {
           in = m_dspSample;
           m_dspSample = NULL;
         }
         else
-        {
-          in->Return();
           in = NULL;
-        }
       }
 
       int start = m_procSample->pkt->nb_samples *
@@ -469,11 +479,15 @@ bool CActiveAEBufferPoolResample::ResampleBuffers(int64_t timestamp)
         m_planes[i] = m_procSample->pkt->data[i] + start;
       }
 
-      int out_samples = m_resampler->Resample(m_planes,
-                                              m_procSample->pkt->max_nb_samples - m_procSample->pkt->nb_samples,
-                                              in ? in->pkt->data : NULL,
-                                              in ? in->pkt->nb_samples : 0,
-                                              m_resampleRatio);
+      int out_samples;
+      {
+        CAEStageTimer timer(m_counters, CAEEngineCounters::STAGE_RESAMPLE);
+        out_samples = m_resampler->Resample(m_planes,
+                                            m_procSample->pkt->max_nb_samples - m_procSample->pkt->nb_samples,
+                                            in ? in->pkt->data : NULL,
+                                            in ? in->pkt->nb_samples : 0,
+                                            m_resampleRatio);
+      }
       // in case of error, trigger re-create of resampler
       if (out_samples < 0)
       {
@@ -642,6 +656,8 @@ void CActiveAEBufferPoolResample::Flush()
     m_outputSamples.front()->Return();
     m_outputSamples.pop_front();
   }
+  if (m_useDSP)
+    m_processor->Flush();
   if (m_resampler)
     ChangeResampler();
 }
@@ -689,10 +705,10 @@ void CActiveAEBufferPoolResample::SetDSPConfig(bool usedsp, bool bypassdsp)
 CActiveAEBufferPoolAtempo::CActiveAEBufferPoolAtempo(AEAudioFormat format) : CActiveAEBufferPool(format)
 {
   m_drain = false;
-  m_empty = true;
   m_tempo = 1.0;
-  m_changeFilter = false;
   m_procSample = nullptr;
+  m_lastSamplePts = 0;
+  m_fillPackets = false;
 }
 
 CActiveAEBufferPoolAtempo::~CActiveAEBufferPoolAtempo()
@@ -704,16 +720,27 @@ bool CActiveAEBufferPoolAtempo::Create(unsigned int totaltime)
 {
   CActiveAEBufferPool::Create(totaltime);
 
-  m_pTempoFilter.reset(new CActiveAEFilter());
-  m_pTempoFilter->Init(CAEUtil::GetAVSampleFormat(m_format.m_dataFormat), m_format.m_sampleRate, CAEUtil::GetAVChannelLayout(m_format.m_channelLayout));
+  // the stretcher works on float, other formats pass unchanged
+  if (m_format.m_dataFormat == AE_FMT_FLOAT || m_format.m_dataFormat == AE_FMT_FLOATP)
+  {
+    m_stretcher.reset(new CAETimeStretch());
+    m_stretcher->Init(m_format.m_channelLayout.Count(), m_format.m_sampleRate);
+    m_stretcher->SetTempo(m_tempo);
+  }
 
   return true;
 }
 
-void CActiveAEBufferPoolAtempo::ChangeFilter()
+void CActiveAEBufferPoolAtempo::PadWithZero(CSampleBuffer *buffer)
 {
-  m_pTempoFilter->SetTempo(m_tempo);
-  m_changeFilter = false;
+  int start = buffer->pkt->nb_samples *
+              buffer->pkt->bytes_per_sample *
+              buffer->pkt->config.channels /
+              buffer->pkt->planes;
+  for (int i=0; i<buffer->pkt->planes; i++)
+  {
+    memset(buffer->pkt->data[i]+start, 0, buffer->pkt->linesize-start);
+  }
 }
 
 bool CActiveAEBufferPoolAtempo::ProcessBuffers()
@@ -721,13 +748,21 @@ bool CActiveAEBufferPoolAtempo::ProcessBuffers()
   bool busy = false;
   CSampleBuffer *in;
 
-  if (!m_pTempoFilter->IsActive())
+  if (!m_stretcher || (m_tempo == 1.0 && m_stretcher->IsIdle()))
   {
-    if (m_changeFilter)
+    // output of the stretcher goes before any bypassed samples
+    if (m_procSample)
     {
-      if (m_changeFilter)
-        ChangeFilter();
-      return true;
+      if (m_procSample->pkt->nb_samples == 0)
+        m_procSample->Return();
+      else
+      {
+        if (m_fillPackets)
+          PadWithZero(m_procSample);
+        m_outputSamples.push_back(m_procSample);
+      }
+      m_procSample = nullptr;
+      busy = true;
     }
     while(!m_inputSamples.empty())
     {
@@ -739,113 +774,86 @@ bool CActiveAEBufferPoolAtempo::ProcessBuffers()
   }
   else if (m_procSample || !m_freeSamples.empty())
   {
-    bool skipInput = false;
-
-    // avoid that bufferscr grows too large
-    if (!m_pTempoFilter->NeedData())
-      skipInput = true;
-
-    bool hasInput = !m_inputSamples.empty();
-
-    if (hasInput || skipInput || m_drain || m_changeFilter)
+    if (!m_procSample)
     {
-      if (!m_procSample)
-      {
-        m_procSample = GetFreeBuffer();
-      }
-
-      if (hasInput && !skipInput && !m_changeFilter)
-      {
-        in = m_inputSamples.front();
-        m_inputSamples.pop_front();
-      }
-      else
-        in = nullptr;
-
-      int start = m_procSample->pkt->nb_samples *
-                  m_procSample->pkt->bytes_per_sample *
-                  m_procSample->pkt->config.channels /
-                  m_procSample->pkt->planes;
-
-      for (int i=0; i<m_procSample->pkt->planes; i++)
-      {
-        m_planes[i] = m_procSample->pkt->data[i] + start;
-      }
+      m_procSample = GetFreeBuffer();
+    }
 
-      int out_samples = m_pTempoFilter->ProcessFilter(m_planes,
-                                                      m_procSample->pkt->max_nb_samples - m_procSample->pkt->nb_samples,
-                                                      in ? in->pkt->data : nullptr,
-                                                      in ? in->pkt->nb_samples : 0,
-                                                      in ? in->pkt->linesize * in->pkt->planes : 0);
+    // avoid that the stretcher queues more than it needs for the next window
+    in = nullptr;
+    if (!m_inputSamples.empty() && m_stretcher->NeedData())
+    {
+      in = m_inputSamples.front();
+      m_inputSamples.pop_front();
+    }
+    bool drain = m_drain && m_inputSamples.empty();
+    bool planar = m_format.m_dataFormat == AE_FMT_FLOATP;
 
-      // in case of error, trigger re-create of filter
-      if (out_samples < 0)
-      {
-        out_samples = 0;
-        m_changeFilter = true;
-      }
+    int start = m_procSample->pkt->nb_samples *
+                m_procSample->pkt->bytes_per_sample *
+                m_procSample->pkt->config.channels /
+                m_procSample->pkt->planes;
 
-      m_procSample->pkt->nb_samples += out_samples;
-      busy = true;
-      m_empty = m_pTempoFilter->IsEof();
+    for (int i=0; i<m_procSample->pkt->planes; i++)
+    {
+      m_planes[i] = reinterpret_cast<float*>(m_procSample->pkt->data[i] + start);
+    }
 
+    int out_samples;
+    {
+      CAEStageTimer timer(m_counters, CAEEngineCounters::STAGE_DSP);
       if (in)
-      {
-        if (in->timestamp)
-          m_lastSamplePts = in->timestamp;
-        else
-          in->pkt_start_offset = 0;
-
-        // pts of last sample we added to the buffer
-        m_lastSamplePts += (in->pkt->nb_samples-in->pkt_start_offset) * 1000 / m_format.m_sampleRate;
-      }
+        m_stretcher->Put(reinterpret_cast<float**>(in->pkt->data), in->pkt->nb_samples, planar);
+      out_samples = m_stretcher->Get(m_planes,
+                                     m_procSample->pkt->max_nb_samples - m_procSample->pkt->nb_samples,
+                                     planar, drain);
+    }
 
-      // calculate pts for last sample in m_procSample
-      int bufferedSamples = m_pTempoFilter->GetBufferedSamples();
-      m_procSample->pkt_start_offset = m_procSample->pkt->nb_samples;
-      m_procSample->timestamp = m_lastSamplePts - bufferedSamples * 1000 / m_format.m_sampleRate;
+    m_procSample->pkt->nb_samples += out_samples;
+    busy = in || out_samples > 0;
 
-      if ((m_drain || m_changeFilter) && m_empty)
-      {
-        if (m_fillPackets && m_procSample->pkt->nb_samples != 0)
-        {
-          // pad with zero
-          start = m_procSample->pkt->nb_samples *
-          m_procSample->pkt->bytes_per_sample *
-          m_procSample->pkt->config.channels /
-          m_procSample->pkt->planes;
-          for (int i=0; i<m_procSample->pkt->planes; i++)
-          {
-            memset(m_procSample->pkt->data[i]+start, 0, m_procSample->pkt->linesize-start);
-          }
-        }
+    if (in)
+    {
+      if (in->timestamp)
+        m_lastSamplePts = in->timestamp;
+      else
+        in->pkt_start_offset = 0;
 
-        // check if draining is finished
-        if (m_drain && m_procSample->pkt->nb_samples == 0)
-        {
-          m_procSample->Return();
-          busy = false;
-        }
-        else
-          m_outputSamples.push_back(m_procSample);
+      // pts of last sample we added to the buffer
+      m_lastSamplePts += (in->pkt->nb_samples-in->pkt_start_offset) * 1000 / m_format.m_sampleRate;
+    }
 
-        m_procSample = nullptr;
+    // calculate pts for last sample in m_procSample
+    int bufferedSamples = m_stretcher->GetBufferedFrames();
+    m_procSample->pkt_start_offset = m_procSample->pkt->nb_samples;
+    m_procSample->timestamp = m_lastSamplePts - bufferedSamples * 1000 / m_format.m_sampleRate;
 
-        if (m_changeFilter)
-        {
-          ChangeFilter();
-        }
+    if (drain && m_stretcher->IsIdle())
+    {
+      // check if draining is finished
+      if (m_procSample->pkt->nb_samples == 0)
+      {
+        m_procSample->Return();
+        busy = false;
       }
-      // some methods like encode require completely filled packets
-      else if (!m_fillPackets || (m_procSample->pkt->nb_samples == m_procSample->pkt->max_nb_samples))
+      else
       {
+        if (m_fillPackets)
+          PadWithZero(m_procSample);
         m_outputSamples.push_back(m_procSample);
-        m_procSample = nullptr;
       }
-
-      if (in)
-        in->Return();
+      m_procSample = nullptr;
     }
+    // some methods like encode require completely filled packets
+    else if ((!m_fillPackets && m_procSample->pkt->nb_samples > 0) ||
+             (m_procSample->pkt->nb_samples == m_procSample->pkt->max_nb_samples))
+    {
+      m_outputSamples.push_back(m_procSample);
+      m_procSample = nullptr;
+    }
+
+    if (in)
+      in->Return();
   }
   return busy;
 }
@@ -867,8 +875,8 @@ void CActiveAEBufferPoolAtempo::Flush()
     m_outputSamples.front()->Return();
     m_outputSamples.pop_front();
   }
-  if (m_pTempoFilter)
-    ChangeFilter();
+  if (m_stretcher)
+    m_stretcher->Reset();
 }
 
 float CActiveAEBufferPoolAtempo::GetDelay()
@@ -888,9 +896,9 @@ float CActiveAEBufferPoolAtempo::GetDelay()
     delay += (float)buf->pkt->nb_samples / buf->pkt->config.sample_rate;
   }
 
-  if (m_pTempoFilter->IsActive())
+  if (m_stretcher)
   {
-    int samples = m_pTempoFilter->GetBufferedSamples();
+    int samples = m_stretcher->GetBufferedFrames();
     delay += (float)samples / m_format.m_sampleRate;
   }
 
@@ -904,10 +912,10 @@ void CActiveAEBufferPoolAtempo::SetTempo(float tempo)
   else if (tempo < 0.5)
     tempo = 0.5;
 
-  if (tempo != m_tempo)
-    m_changeFilter = true;
-
+  // takes effect with the next window, nothing is rebuilt
   m_tempo = tempo;
+  if (m_stretcher)
+    m_stretcher->SetTempo(m_tempo);
 }
 
 float CActiveAEBufferPoolAtempo::GetTempo()
@@ -923,6 +931,126 @@ void CActiveAEBufferPoolAtempo::FillBuffer()
 void CActiveAEBufferPoolAtempo::SetDrain(bool drain)
 {
   m_drain = drain;
-  if (!m_drain)
-    m_changeFilter = true;
+}
+
+//-----------------------------------------------------------------------------
+// Convolve
+//-----------------------------------------------------------------------------
+
+CActiveAEBufferPoolConvolve::CActiveAEBufferPoolConvolve(AEAudioFormat format, bool bAudio2) :
+  CActiveAEBufferPool(format, bAudio2),
+  m_convolver(new CAEConvolver())
+{
+}
+
+CActiveAEBufferPoolConvolve::~CActiveAEBufferPoolConvolve()
+{
+}
+
+bool CActiveAEBufferPoolConvolve::LoadFilter(const std::string &filename)
+{
+  m_filename = filename;
+  m_convolver->Deinit();
+
+  XFILE::CFile file;
+  XUTILS::auto_buffer data;
+  if (file.LoadFile(filename, data) <= 0)
+  {
+    CLog::Log(LOGERROR, "CActiveAEBufferPoolConvolve::%s - can't read %s", __FUNCTION__, filename.c_str());
+    return false;
+  }
+
+  std::vector<std::vector<float> > filters;
+  unsigned int sampleRate;
+  if (!CAEConvolver::ParseWAV((const uint8_t*)data.get(), data.size(), filters, sampleRate))
+  {
+    CLog::Log(LOGERROR, "CActiveAEBufferPoolConvolve::%s - %s is no usable wav file", __FUNCTION__, filename.c_str());
+    return false;
+  }
+
+  // filters are designed for a rate, bring them to the rate of the mix
+  if (sampleRate != m_format.m_sampleRate)
+  {
+    std::unique_ptr<IAEResample> resampler;
+    float gain = (float)sampleRate / m_format.m_sampleRate;
+    for (auto &filter : filters)
+    {
+      if (filter.empty())
+        continue;
+      resampler.reset(CAEResampleFactory::Create(AERESAMPLEFACTORY_QUICK_RESAMPLE));
+      if (!resampler->Init(AV_CH_LAYOUT_MONO, 1, m_format.m_sampleRate, AV_SAMPLE_FMT_FLT, 32, 0,
+                           AV_CH_LAYOUT_MONO, 1, sampleRate, AV_SAMPLE_FMT_FLT, 32, 0,
+                           false, false, NULL, AE_QUALITY_HIGH, false))
+      {
+        CLog::Log(LOGERROR, "CActiveAEBufferPoolConvolve::%s - failed to resample %s", __FUNCTION__, filename.c_str());
+        return false;
+      }
+      int samples = resampler->CalcDstSampleCount(filter.size(), m_format.m_sampleRate, sampleRate);
+      std::vector<float> resampled(samples + 256);
+      uint8_t *src = (uint8_t*)filter.data();
+      uint8_t *dst = (uint8_t*)resampled.data();
+      int frames = resampler->Resample(&dst, resampled.size(), &src, filter.size(), 1.0);
+      if (frames < 0)
+        return false;
+      // drain the tail of the resampler
+      dst = (uint8_t*)(resampled.data() + frames);
+      int tail = resampler->Resample(&dst, resampled.size() - frames, NULL, 0, 1.0);
+      if (tail > 0)
+        frames += tail;
+      resampled.resize(frames);
+      for (auto &tap : resampled)
+        tap *= gain;
+      filter.swap(resampled);
+    }
+  }
+
+  // one channel is used for all, otherwise channels map in order of the mix
+  // and those without a filter are delayed only
+  unsigned int channels = m_format.m_channelLayout.Count();
+  if (filters.size() == 1)
+    filters.resize(channels, filters[0]);
+  else if (filters.size() != channels)
+  {
+    CLog::Log(LOGWARNING, "CActiveAEBufferPoolConvolve::%s - %s has %d channels, the mix %d",
+              __FUNCTION__, filename.c_str(), (int)filters.size(), channels);
+    filters.resize(channels);
+  }
+
+  if (!m_convolver->Init(filters))
+    return false;
+
+  CLog::Log(LOGINFO, "CActiveAEBufferPoolConvolve::%s - %s, %d taps, latency %d frames", __FUNCTION__,
+            filename.c_str(), (int)filters[0].size(), m_convolver->GetLatency());
+  return true;
+}
+
+CSampleBuffer* CActiveAEBufferPoolConvolve::Process(CSampleBuffer *in)
+{
+  CSampleBuffer *out = GetFreeBuffer();
+  if (!out)
+    return NULL;
+
+  int bytes = in->pkt->nb_samples * in->pkt->bytes_per_sample * in->pkt->config.channels / in->pkt->planes;
+  float *planes[16];
+  for (int i = 0; i < in->pkt->planes; i++)
+  {
+    memcpy(out->pkt->data[i], in->pkt->data[i], bytes);
+    planes[i] = (float*)out->pkt->data[i];
+  }
+  out->pkt->nb_samples = in->pkt->nb_samples;
+  out->pkt_start_offset = in->pkt_start_offset;
+  out->timestamp = in->timestamp;
+
+  m_convolver->Process(planes, out->pkt->config.channels, out->pkt->nb_samples, out->pkt->planes > 1);
+  return out;
+}
+
+void CActiveAEBufferPoolConvolve::Flush()
+{
+  m_convolver->Reset();
+}
+
+double CActiveAEBufferPoolConvolve::GetLatency()
+{
+  return (double)m_convolver->GetLatency() / m_format.m_sampleRate;
 }
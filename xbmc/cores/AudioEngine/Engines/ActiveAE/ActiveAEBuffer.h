@@ -20,16 +20,21 @@
  */
 
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
+#include "cores/AudioEngine/Utils/AEEngineCounters.h"
 #include "cores/AudioEngine/Interfaces/AE.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSP.h"
 #include <deque>
 #include <memory>
+#include <string>
 
 extern "C" {
 #include "libavutil/avutil.h"
 #include "libswresample/swresample.h"
 }
 
+class CAEConvolver;
+class CAETimeStretch;
+
 namespace ActiveAE
 {
 
@@ -87,11 +92,13 @@ public:
   virtual bool Create(unsigned int totaltime);
   CSampleBuffer *GetFreeBuffer();
   void ReturnBuffer(CSampleBuffer *buffer);
+  void SetCounters(CAEEngineCounters *counters) { m_counters = counters; }
   AEAudioFormat m_format;
   std::deque<CSampleBuffer*> m_allSamples;
   std::deque<CSampleBuffer*> m_freeSamples;
 protected:
   bool m_bAudio2;
+  CAEEngineCounters *m_counters;
 };
 
 class IAEResample;
@@ -153,8 +160,6 @@ protected:
   bool m_bypassDSP;
 };
 
-class CActiveAEFilter;
-
 class CActiveAEBufferPoolAtempo : public CActiveAEBufferPool
 {
 public:
@@ -172,16 +177,34 @@ public:
   std::deque<CSampleBuffer*> m_outputSamples;
 
 protected:
-  void ChangeFilter();
-  std::unique_ptr<CActiveAEFilter> m_pTempoFilter;
-  uint8_t *m_planes[16];
+  void PadWithZero(CSampleBuffer *buffer);
+  std::unique_ptr<CAETimeStretch> m_stretcher;
+  float *m_planes[16];
   CSampleBuffer *m_procSample;
-  bool m_empty;
   bool m_drain;
-  bool m_changeFilter;
   float m_tempo;
   int64_t m_lastSamplePts;
   bool m_fillPackets;
 };
+
+/**
+ * Room correction of a pcm mix. Buffers are shared with other consumers,
+ * Process filters a copy from this pool.
+ */
+class CActiveAEBufferPoolConvolve : public CActiveAEBufferPool
+{
+public:
+  CActiveAEBufferPoolConvolve(AEAudioFormat format, bool bAudio2 = false);
+  virtual ~CActiveAEBufferPoolConvolve();
+  bool LoadFilter(const std::string &filename);
+  CSampleBuffer *Process(CSampleBuffer *in);
+  void Flush();
+  double GetLatency();
+  const std::string& GetFilename() const { return m_filename; }
+
+protected:
+  std::unique_ptr<CAEConvolver> m_convolver;
+  std::string m_filename;
+};
   
 }
@@ -0,0 +1,75 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "ActiveAEBufferProfile.h"
+#include "cores/AudioEngine/Utils/AEEngineCounters.h"
+
+using namespace ActiveAE;
+
+// cache, water level, buffer time, sink period
+static const AEBufferProfile normalProfile = { 0.4, 0.2, 0.1, 0.0 };
+static const AEBufferProfile lowLatencyProfile = { 0.1, 0.04, 0.02, 0.01 };
+
+const AEBufferProfile& AEBufferProfile::Get(bool lowLatency)
+{
+  return lowLatency ? lowLatencyProfile : normalProfile;
+}
+
+void AEBufferProfile::ApplyToRequest(AEAudioFormat &format) const
+{
+  if (format.m_dataFormat != AE_FMT_RAW)
+    format.m_frames = periodTime * format.m_sampleRate;
+}
+
+bool AEBufferProfile::LimitBuffer(AEAudioFormat &sinkFormat) const
+{
+  if (sinkFormat.m_dataFormat == AE_FMT_RAW ||
+      sinkFormat.m_frames <= bufferTime * sinkFormat.m_sampleRate)
+    return false;
+
+  sinkFormat.m_frames = bufferTime * sinkFormat.m_sampleRate;
+  return true;
+}
+
+double AEBufferProfile::GetTarget() const
+{
+  return waterLevel + 4 * periodTime;
+}
+
+unsigned int AEBufferProfile::GetLimits(const AEAudioFormat &sinkFormat, double sinkCacheTotal, bool encoder, bool dsp) const
+{
+  unsigned int limits = 0;
+  if (periodTime <= 0)
+    return limits;
+
+  // devices round to their own granularity, only flag clear misses
+  if (encoder)
+    limits |= 1 << CAEEngineCounters::LIMIT_ENCODER;
+  else if (sinkFormat.m_dataFormat == AE_FMT_RAW)
+    limits |= 1 << CAEEngineCounters::LIMIT_PASSTHROUGH;
+  else if (sinkFormat.m_frames > 1.5 * periodTime * sinkFormat.m_sampleRate)
+    limits |= 1 << CAEEngineCounters::LIMIT_SINK_PERIOD;
+  if (sinkCacheTotal > 1.5 * 4 * periodTime)
+    limits |= 1 << CAEEngineCounters::LIMIT_DEVICE_BUFFER;
+  if (dsp)
+    limits |= 1 << CAEEngineCounters::LIMIT_DSP;
+  return limits;
+}
@@ -0,0 +1,59 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEAudioFormat.h"
+
+namespace ActiveAE
+{
+
+/**
+ * Buffer sizes of an engine or output. The low latency profile trades
+ * headroom against dropouts for less delay.
+ */
+struct AEBufferProfile
+{
+  double cacheLevel;  // total cache time of stream in seconds
+  double waterLevel;  // buffered time after stream stages in seconds
+  double bufferTime;  // max time of a buffer in seconds
+  double periodTime;  // sink period to request in seconds, 0 lets the sink decide
+
+  static const AEBufferProfile& Get(bool lowLatency);
+  /**
+   * Sets the period to ask the sink for, sinks that can't honour it pick their own
+   */
+  void ApplyToRequest(AEAudioFormat &format) const;
+  /**
+   * Caps the period a sink returned to the buffer time, returns true if it was cut
+   */
+  bool LimitBuffer(AEAudioFormat &sinkFormat) const;
+  /**
+   * Latency the profile aims at: buffered samples in front of the sink
+   * plus a device buffer of four periods
+   */
+  double GetTarget() const;
+  /**
+   * Constraints that kept a configuration above the target, as bits of
+   * CAEEngineCounters::Limit. Only the low latency profile has any.
+   */
+  unsigned int GetLimits(const AEAudioFormat &sinkFormat, double sinkCacheTotal, bool encoder, bool dsp) const;
+};
+
+}
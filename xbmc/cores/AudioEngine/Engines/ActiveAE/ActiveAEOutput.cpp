@@ -0,0 +1,551 @@
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ActiveAEOutput.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace ActiveAE;
+
+#define OUTPUT_ADJUST_INTERVAL 100 // ms between delay corrections
+#define OUTPUT_MAX_ERROR    0.05  // larger delay errors are fixed by dropping or inserting samples
+#define OUTPUT_KP           0.5
+#define OUTPUT_KI           0.05
+#define OUTPUT_MAX_ADJUST   0.005 // max correction of the resample ratio
+
+static bool SameFormat(const AEAudioFormat &lhs, const AEAudioFormat &rhs)
+{
+  return lhs.m_channelLayout == rhs.m_channelLayout &&
+         lhs.m_dataFormat == rhs.m_dataFormat &&
+         lhs.m_sampleRate == rhs.m_sampleRate;
+}
+
+CActiveAEOutput::CActiveAEOutput(CEvent *inMsgEvent, CAEEngineCounters &counters) :
+  m_sink(inMsgEvent),
+  m_counters(counters)
+{
+  m_sinkBuffers = nullptr;
+  m_inputBuffers = nullptr;
+  m_silenceBuffers = nullptr;
+  m_convolveBuffers = nullptr;
+  m_resampleIntegral = 0;
+  m_latency = 0;
+  m_deviceLatency = 0;
+  m_waterLevel = 0;
+  m_flushPending = false;
+  m_latencyClamped = false;
+  m_overruns = 0;
+  m_configured = false;
+  m_raw = false;
+  m_sinkFormat.m_dataFormat = AE_FMT_INVALID;
+  m_sinkRequestFormat.m_dataFormat = AE_FMT_INVALID;
+  m_mixFormat.m_dataFormat = AE_FMT_INVALID;
+}
+
+CActiveAEOutput::~CActiveAEOutput()
+{
+  for (auto pool : m_discardBufferPools)
+    delete pool;
+}
+
+void CActiveAEOutput::Start()
+{
+  m_sink.EnumerateSinkList(false);
+  m_sink.Start();
+}
+
+void CActiveAEOutput::Dispose()
+{
+  if (m_configured)
+    Unconfigure();
+  m_sink.Dispose();
+
+  if (m_sinkBuffers)
+  {
+    m_sinkBuffers->Flush();
+    m_discardBufferPools.push_back(m_sinkBuffers);
+    m_sinkBuffers = nullptr;
+  }
+  if (m_inputBuffers)
+  {
+    m_discardBufferPools.push_back(m_inputBuffers);
+    m_inputBuffers = nullptr;
+  }
+  if (m_silenceBuffers)
+  {
+    m_discardBufferPools.push_back(m_silenceBuffers);
+    m_silenceBuffers = nullptr;
+  }
+  if (m_convolveBuffers)
+  {
+    m_discardBufferPools.push_back(m_convolveBuffers);
+    m_convolveBuffers = nullptr;
+  }
+
+  ClearDiscardedBuffers();
+}
+
+bool CActiveAEOutput::Configure(const OutputSettings &settings,
+                                const AudioSettings &engineSettings,
+                                const AEAudioFormat &mixFormat,
+                                const AEAudioFormat *encodedFormat)
+{
+  const AEBufferProfile &profile = AEBufferProfile::Get(settings.lowlatency);
+  bool raw = encodedFormat && settings.transcode;
+  const std::string &device = raw ? settings.passthroughdevice : settings.device;
+  AEAudioFormat inputFormat = raw ? *encodedFormat : mixFormat;
+
+  AEAudioFormat request = inputFormat;
+  if (!raw)
+  {
+    request.m_dataFormat = AE_IS_PLANAR(mixFormat.m_dataFormat) ? AE_FMT_FLOATP : AE_FMT_FLOAT;
+    if (settings.channels <= AE_CH_LAYOUT_2_0 ||
+        m_sink.GetDeviceType(device) == AE_DEVTYPE_IEC958)
+      request.m_channelLayout = AE_CH_LAYOUT_2_0;
+    else
+      request.m_channelLayout.ResolveChannels(CAEChannelInfo(static_cast<AEStdChLayout>(settings.channels)));
+
+    profile.ApplyToRequest(request);
+  }
+
+  if (!m_configured ||
+      m_raw != raw ||
+      m_device != device ||
+      !SameFormat(request, m_sinkRequestFormat) ||
+      request.m_frames != m_sinkRequestFormat.m_frames)
+  {
+    if (m_configured)
+      Unconfigure();
+
+    SinkConfig config;
+    config.format = request;
+    config.stats = &m_stats;
+    config.counters = &m_counters;
+    config.device = &device;
+
+    bool streamNoise = engineSettings.streamNoise;
+    int silenceTimeout = engineSettings.silenceTimeout;
+    m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::SETNOISETYPE, &streamNoise, sizeof(bool));
+    m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::SETSILENCETIMEOUT, &silenceTimeout, sizeof(int));
+
+    Message *reply;
+    if (!m_sink.m_controlPort.SendOutMessageSync(CSinkControlProtocol::CONFIGURE,
+                                                 &reply, 5000,
+                                                 &config, sizeof(config)))
+    {
+      CLog::Log(LOGERROR, "CActiveAEOutput::%s - failed to init sink %s", __FUNCTION__, device.c_str());
+      return false;
+    }
+    bool success = reply->signal == CSinkControlProtocol::ACC;
+    SinkReply *data = (SinkReply*)reply->data;
+    if (success && data)
+    {
+      m_sinkFormat = data->format;
+      m_stats.SetSinkCacheTotal(data->cacheTotal);
+      m_stats.SetSinkLatency(data->latency);
+      m_latency = data->latency;
+      m_stats.SetCurrentSinkFormat(m_sinkFormat);
+    }
+    reply->Release();
+    if (!success || (m_sinkFormat.m_dataFormat == AE_FMT_RAW) != raw)
+    {
+      CLog::Log(LOGERROR, "CActiveAEOutput::%s - sink %s returned error", __FUNCTION__, device.c_str());
+      return false;
+    }
+
+    // limit buffer size in case of sink returns large buffer
+    profile.LimitBuffer(m_sinkFormat);
+
+    m_device = device;
+    m_raw = raw;
+    m_sinkRequestFormat = request;
+    m_configured = true;
+
+    // a reopened sink starts empty, keep the stats of a running one
+    m_stats.Reset(m_sinkFormat.m_sampleRate, !m_raw);
+    m_resampleIntegral = 0;
+  }
+
+  // buffers converting from the engine mix to the sink format
+  if (!m_sinkBuffers ||
+      !SameFormat(m_sinkBuffers->m_format, m_sinkFormat) ||
+      !SameFormat(m_sinkBuffers->m_inputFormat, inputFormat) ||
+      m_sinkBuffers->m_format.m_frames != m_sinkFormat.m_frames)
+  {
+    if (m_sinkBuffers)
+    {
+      m_sinkBuffers->Flush();
+      m_discardBufferPools.push_back(m_sinkBuffers);
+    }
+    m_sinkBuffers = new CActiveAEBufferPoolResample(inputFormat, m_sinkFormat, engineSettings.resampleQuality);
+    // encoded frames pass through, pcm always goes via the resampler for drift correction
+    m_sinkBuffers->ForceResampler(!raw);
+    m_sinkBuffers->SetCounters(&m_counters);
+    m_sinkBuffers->Create(profile.waterLevel*1000, true, false);
+  }
+
+  if (!m_silenceBuffers || !SameFormat(m_silenceBuffers->m_format, inputFormat))
+  {
+    if (m_silenceBuffers)
+      m_discardBufferPools.push_back(m_silenceBuffers);
+    m_silenceBuffers = new CActiveAEBufferPool(inputFormat);
+    m_silenceBuffers->Create(profile.waterLevel*1000);
+  }
+
+  m_mixFormat = inputFormat;
+  m_waterLevel = profile.waterLevel;
+  ConfigureRoomCorrection(raw ? "" : settings.roomcorrection, profile.waterLevel);
+
+  double achieved = profile.waterLevel + m_stats.GetSinkCacheTotal();
+  m_counters.SetLatency(settings.lowlatency, profile.GetTarget(), achieved,
+                        profile.GetLimits(m_sinkFormat, m_stats.GetSinkCacheTotal(), false, false));
+
+  m_deviceLatency = settings.latency / 1000.0;
+  m_adjustTimer.Set(OUTPUT_ADJUST_INTERVAL);
+
+  CLog::Log(LOGINFO, "CActiveAEOutput::%s - device: %s, format: %s, channels: %d, samplerate: %d",
+            __FUNCTION__, m_device.c_str(), CAEUtil::DataFormatToStr(m_sinkFormat.m_dataFormat),
+            m_sinkFormat.m_channelLayout.Count(), m_sinkFormat.m_sampleRate);
+  return true;
+}
+
+void CActiveAEOutput::Unconfigure()
+{
+  if (m_sinkBuffers)
+    m_sinkBuffers->Flush();
+
+  Message *reply;
+  if (m_sink.m_controlPort.SendOutMessageSync(CSinkControlProtocol::UNCONFIGURE,
+                                              &reply, 2000))
+  {
+    if (reply->signal != CSinkControlProtocol::ACC)
+      CLog::Log(LOGERROR, "CActiveAEOutput::%s - returned error", __FUNCTION__);
+    reply->Release();
+  }
+  else
+    CLog::Log(LOGERROR, "CActiveAEOutput::%s - failed to unconfigure", __FUNCTION__);
+
+  ReturnBuffers();
+  m_flushPending = false;
+  m_device.clear();
+  m_sinkRequestFormat.m_dataFormat = AE_FMT_INVALID;
+  m_configured = false;
+}
+
+void CActiveAEOutput::Flush()
+{
+  if (!m_configured)
+    return;
+
+  if (m_sinkBuffers)
+    m_sinkBuffers->Flush();
+  if (m_convolveBuffers)
+    m_convolveBuffers->Flush();
+
+  Message *reply;
+  if (m_sink.m_controlPort.SendOutMessageSync(CSinkControlProtocol::FLUSH,
+                                              &reply, 2000))
+  {
+    if (reply->signal != CSinkControlProtocol::ACC)
+      CLog::Log(LOGERROR, "CActiveAEOutput::%s - returned error on flush", __FUNCTION__);
+    reply->Release();
+  }
+  else
+    CLog::Log(LOGERROR, "CActiveAEOutput::%s - failed to flush", __FUNCTION__);
+
+  ReturnBuffers();
+  m_flushPending = false;
+  m_stats.Reset(m_sinkFormat.m_sampleRate, !m_raw);
+  m_resampleIntegral = 0;
+}
+
+/**
+ * Drops the samples of the output right away, the sink flushes
+ * on its own. Samples are held back until the sink confirms.
+ */
+void CActiveAEOutput::FlushAsync()
+{
+  if (m_sinkBuffers)
+    m_sinkBuffers->Flush();
+  if (m_convolveBuffers)
+    m_convolveBuffers->Flush();
+
+  m_sink.m_controlPort.SendOutMessage(CSinkControlProtocol::FLUSH);
+  m_flushPending = true;
+  m_resampleIntegral = 0;
+}
+
+void CActiveAEOutput::SendControl(int signal, void *data, int size)
+{
+  m_sink.m_controlPort.SendOutMessage(signal, data, size);
+}
+
+void CActiveAEOutput::AddSamples(CSampleBuffer *buffer)
+{
+  if (!m_configured || !m_sinkBuffers || !buffer->pool)
+    return;
+
+  // pcm outputs take the mix, bitstreaming outputs the encoded frames
+  bool raw = buffer->pool && buffer->pool->m_format.m_dataFormat == AE_FMT_RAW;
+  if (raw != m_raw)
+    return;
+
+  // the buffer stays with the engine, a stalled device only runs out of
+  // buffers of its own and drops its oldest samples
+  bool convolve = m_convolveBuffers && !raw;
+  CSampleBuffer *buf = convolve ? m_convolveBuffers->Process(buffer) : CopyInput(buffer);
+  while (!buf && !m_sinkBuffers->m_inputSamples.empty())
+  {
+    DropInput();
+    buf = convolve ? m_convolveBuffers->Process(buffer) : CopyInput(buffer);
+  }
+  if (buf)
+    m_sinkBuffers->m_inputSamples.push_back(buf);
+}
+
+CSampleBuffer *CActiveAEOutput::CopyInput(CSampleBuffer *in)
+{
+  const AEAudioFormat &format = in->pool->m_format;
+  if (!m_inputBuffers ||
+      !SameFormat(m_inputBuffers->m_format, format) ||
+      m_inputBuffers->m_format.m_frames != format.m_frames)
+  {
+    if (m_inputBuffers)
+      m_discardBufferPools.push_back(m_inputBuffers);
+    m_inputBuffers = new CActiveAEBufferPool(format);
+    m_inputBuffers->Create(m_waterLevel*1000);
+  }
+
+  CSampleBuffer *out = m_inputBuffers->GetFreeBuffer();
+  if (!out)
+    return nullptr;
+
+  int bytes = in->pkt->nb_samples * in->pkt->bytes_per_sample * in->pkt->config.channels / in->pkt->planes;
+  for (int i = 0; i < in->pkt->planes; i++)
+    memcpy(out->pkt->data[i], in->pkt->data[i], bytes);
+  out->pkt->nb_samples = in->pkt->nb_samples;
+  out->pkt->pause_burst_ms = in->pkt->pause_burst_ms;
+  out->pkt_start_offset = in->pkt_start_offset;
+  out->timestamp = in->timestamp;
+  return out;
+}
+
+void CActiveAEOutput::DropInput()
+{
+  m_sinkBuffers->m_inputSamples.front()->Return();
+  m_sinkBuffers->m_inputSamples.pop_front();
+  m_overruns++;
+  m_counters.AddEvent(CAEEngineCounters::EVENT_OVERRUN);
+}
+
+bool CActiveAEOutput::Serve(const AEDelayStatus &reference, double referenceLatency)
+{
+  if (!m_configured || !m_sinkBuffers)
+    return false;
+
+  ClearDiscardedBuffers();
+
+  // the delay of the sink is not known before it has flushed
+  if (m_adjustTimer.IsTimePast() && !m_flushPending)
+  {
+    AlignDelay(reference, referenceLatency);
+    m_adjustTimer.Set(OUTPUT_ADJUST_INTERVAL);
+  }
+
+  bool busy = m_sinkBuffers->ResampleBuffers();
+  while (!m_sinkBuffers->m_outputSamples.empty() && !m_flushPending)
+  {
+    CSampleBuffer *out = m_sinkBuffers->m_outputSamples.front();
+    m_sinkBuffers->m_outputSamples.pop_front();
+    m_stats.AddSamples(m_raw ? 1 : out->pkt->nb_samples, m_noStreams);
+    m_sink.m_dataPort.SendOutMessage(CSinkDataProtocol::SAMPLE,
+                                     &out, sizeof(CSampleBuffer*));
+    busy = true;
+  }
+  m_counters.SetPoolLevel(CAEEngineCounters::POOL_SINK,
+                           m_sinkBuffers->m_allSamples.size() - m_sinkBuffers->m_freeSamples.size(),
+                           m_sinkBuffers->m_allSamples.size());
+  return busy;
+}
+
+void CActiveAEOutput::AlignDelay(const AEDelayStatus &reference, double referenceLatency)
+{
+  // both devices shall sound at the same time, an output with less latency
+  // than the main sink has to hold back more samples and vice versa
+  AEDelayStatus ref = reference;
+  double refDelay = ref.GetDelay() + referenceLatency - m_latency - m_deviceLatency;
+  if (m_convolveBuffers)
+    refDelay -= m_convolveBuffers->GetLatency();
+  if (refDelay < 0)
+  {
+    if (!m_latencyClamped)
+      CLog::Log(LOGWARNING, "CActiveAEOutput::%s - %s: latency exceeds the main output by %d ms, can't compensate",
+                __FUNCTION__, m_device.c_str(), (int)(-refDelay * 1000));
+    m_latencyClamped = true;
+    refDelay = 0;
+  }
+  else
+    m_latencyClamped = false;
+
+  AEDelayStatus status;
+  m_stats.GetDelay(status);
+  double error = status.GetDelay() + m_sinkBuffers->GetDelay() - refDelay;
+
+  if (error > OUTPUT_MAX_ERROR)
+  {
+    // too far behind, start over and catch up with silence below
+    CLog::Log(LOGDEBUG, "CActiveAEOutput::%s - %s lags by %f ms, flushing", __FUNCTION__, m_device.c_str(), error * 1000);
+    FlushAsync();
+    m_overruns++;
+    m_counters.AddEvent(CAEEngineCounters::EVENT_OVERRUN);
+    error = -refDelay;
+  }
+
+  if (error < -OUTPUT_MAX_ERROR)
+  {
+    if (m_raw)
+      InsertPause(-error * 1000);
+    else
+      InsertSilence(-error * m_mixFormat.m_sampleRate);
+    m_resampleIntegral = 0;
+    m_sinkBuffers->SetRR(1.0);
+    return;
+  }
+
+  // encoded frames can't be stretched, small errors are left alone
+  if (m_raw)
+    return;
+
+  m_resampleIntegral += OUTPUT_KI * error;
+  m_resampleIntegral = std::max(-OUTPUT_MAX_ADJUST, std::min(OUTPUT_MAX_ADJUST, m_resampleIntegral));
+  double adjust = OUTPUT_KP * error + m_resampleIntegral;
+  adjust = std::max(-OUTPUT_MAX_ADJUST, std::min(OUTPUT_MAX_ADJUST, adjust));
+  m_sinkBuffers->SetRR(1.0 - adjust);
+}
+
+void CActiveAEOutput::ConfigureRoomCorrection(const std::string &filename, double waterLevel)
+{
+  if (m_convolveBuffers &&
+      (m_convolveBuffers->GetFilename() != filename ||
+       !SameFormat(m_convolveBuffers->m_format, m_mixFormat) ||
+       m_convolveBuffers->m_format.m_frames != m_mixFormat.m_frames))
+  {
+    m_discardBufferPools.push_back(m_convolveBuffers);
+    m_convolveBuffers = nullptr;
+  }
+  if (!m_convolveBuffers && !filename.empty())
+  {
+    m_convolveBuffers = new CActiveAEBufferPoolConvolve(m_mixFormat);
+    if (!m_convolveBuffers->LoadFilter(filename) ||
+        !m_convolveBuffers->Create(waterLevel*1000))
+    {
+      CLog::Log(LOGERROR, "CActiveAEOutput::%s - room correction disabled for %s", __FUNCTION__, m_device.c_str());
+      delete m_convolveBuffers;
+      m_convolveBuffers = nullptr;
+    }
+  }
+}
+
+void CActiveAEOutput::InsertSilence(int frames)
+{
+  while (frames > 0)
+  {
+    CSampleBuffer *buf = m_silenceBuffers->GetFreeBuffer();
+    if (!buf)
+      break;
+    for (int i = 0; i < buf->pkt->planes; i++)
+      memset(buf->pkt->data[i], 0, buf->pkt->linesize);
+    buf->pkt->nb_samples = std::min(frames, buf->pkt->max_nb_samples);
+    buf->pkt_start_offset = 0;
+    buf->timestamp = 0;
+    frames -= buf->pkt->nb_samples;
+    m_sinkBuffers->m_inputSamples.push_back(buf);
+  }
+}
+
+void CActiveAEOutput::InsertPause(int millis)
+{
+  CSampleBuffer *buf = m_silenceBuffers->GetFreeBuffer();
+  if (!buf)
+    return;
+  buf->pkt->nb_samples = 0;
+  buf->pkt->pause_burst_ms = millis;
+  buf->pkt_start_offset = 0;
+  buf->timestamp = 0;
+  m_sinkBuffers->m_inputSamples.push_back(buf);
+}
+
+bool CActiveAEOutput::ReturnBuffers()
+{
+  bool ret = false;
+  Message *msg;
+
+  // the reply to FlushAsync
+  while (m_sink.m_controlPort.ReceiveInMessage(&msg))
+  {
+    if (msg->signal == CSinkControlProtocol::ACC && m_flushPending)
+    {
+      m_flushPending = false;
+      m_stats.Reset(m_sinkFormat.m_sampleRate, !m_raw);
+    }
+    msg->Release();
+    ret = true;
+  }
+
+  while (m_sink.m_dataPort.ReceiveInMessage(&msg))
+  {
+    if (msg->signal == CSinkDataProtocol::RETURNSAMPLE)
+    {
+      CSampleBuffer **buffer = (CSampleBuffer**)msg->data;
+      if (buffer)
+        (*buffer)->Return();
+    }
+    msg->Release();
+    ret = true;
+  }
+  return ret;
+}
+
+bool CActiveAEOutput::HasWork()
+{
+  // the reply of the sink wakes up the engine
+  if (!m_sinkBuffers || m_flushPending)
+    return false;
+  return !m_sinkBuffers->m_inputSamples.empty() || !m_sinkBuffers->m_outputSamples.empty();
+}
+
+void CActiveAEOutput::ClearDiscardedBuffers()
+{
+  auto it = m_discardBufferPools.begin();
+  while (it != m_discardBufferPools.end())
+  {
+    // if all buffers have returned, we can delete the buffer pool
+    if ((*it)->m_allSamples.size() == (*it)->m_freeSamples.size())
+    {
+      delete (*it);
+      it = m_discardBufferPools.erase(it);
+    }
+    else
+      ++it;
+  }
+}
@@ -0,0 +1,101 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ActiveAE.h"
+#include "ActiveAESink.h"
+#include "threads/SystemClock.h"
+
+#include <list>
+#include <string>
+
+namespace ActiveAE
+{
+
+/**
+ * An additional sink fed from the mix of the engine that owns it.
+ * Samples are copied into buffers of the output, so a stalled device
+ * runs out of its own buffers and never holds back the main sink. They
+ * are converted to the format of the output device and kept aligned to
+ * the delay of the main sink by a small resample ratio correction.
+ * If the engine transcodes and the output wants a bitstream as well, it
+ * takes the encoded frames of the engine instead of the pcm mix.
+ * Room correction of a pcm output filters the mix before conversion.
+ */
+class CActiveAEOutput
+{
+public:
+  /*!
+   \param counters counters of the engine, must outlive the output
+   */
+  CActiveAEOutput(CEvent *inMsgEvent, CAEEngineCounters &counters);
+  virtual ~CActiveAEOutput();
+  void Start();
+  void Dispose();
+  bool Configure(const OutputSettings &settings, const AudioSettings &engineSettings,
+                 const AEAudioFormat &mixFormat, const AEAudioFormat *encodedFormat);
+  void Unconfigure();
+  void Flush();
+  void SendControl(int signal, void *data, int size);
+  void AddSamples(CSampleBuffer *buffer);
+  bool Serve(const AEDelayStatus &reference, double referenceLatency);
+  bool ReturnBuffers();
+  bool HasWork();
+  bool IsConfigured() const { return m_configured; }
+  bool IsRaw() const { return m_raw; }
+  const std::string& GetDevice() const { return m_device; }
+  unsigned int GetOverruns() const { return m_overruns; }
+
+protected:
+  void AlignDelay(const AEDelayStatus &reference, double referenceLatency);
+  void FlushAsync();
+  CSampleBuffer *CopyInput(CSampleBuffer *in);
+  void DropInput();
+  void ConfigureRoomCorrection(const std::string &filename, double waterLevel);
+  void InsertSilence(int frames);
+  void InsertPause(int millis);
+  void ClearDiscardedBuffers();
+
+  CActiveAESink m_sink;
+  CEngineStats m_stats;
+  CAEEngineCounters &m_counters;
+  std::string m_device;
+  AEAudioFormat m_mixFormat; // format of the samples taken from the engine
+  AEAudioFormat m_sinkRequestFormat;
+  AEAudioFormat m_sinkFormat;
+  CActiveAEBufferPoolResample *m_sinkBuffers;
+  CActiveAEBufferPool *m_inputBuffers; // copies of the buffers of the engine
+  CActiveAEBufferPool *m_silenceBuffers;
+  CActiveAEBufferPoolConvolve *m_convolveBuffers;
+  std::list<CActiveAEBufferPool*> m_discardBufferPools;
+  std::list<CActiveAEStream*> m_noStreams;
+  XbmcThreads::EndTime m_adjustTimer;
+  double m_resampleIntegral;
+  double m_latency; // reported by the sink in seconds
+  double m_deviceLatency; // set by the user for the device behind the sink
+  double m_waterLevel;
+  bool m_flushPending; // sink drops what it holds, nothing is sent until it is done
+  bool m_latencyClamped;
+  unsigned int m_overruns;
+  bool m_configured;
+  bool m_raw;
+};
+
+}
@@ -20,7 +20,9 @@
 
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "ActiveAEResampleFFMPEG.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/Variant.h"
 
 extern "C" {
 #include "libavutil/channel_layout.h"
@@ -30,15 +32,123 @@ extern "C" {
 
 using namespace ActiveAE;
 
+ResampleKey::ResampleKey() :
+  dst_chan_layout(0),
+  src_chan_layout(0),
+  dst_channels(0), src_channels(0),
+  dst_rate(0), src_rate(0),
+  dst_fmt(AV_SAMPLE_FMT_NONE), src_fmt(AV_SAMPLE_FMT_NONE),
+  dst_bits(0), src_bits(0),
+  dst_dither(0), src_dither(0),
+  quality(0),
+  upmix(false),
+  normalize(false),
+  remapCount(0)
+{
+}
+
+bool ResampleKey::operator==(const ResampleKey &other) const
+{
+  if (dst_chan_layout != other.dst_chan_layout || src_chan_layout != other.src_chan_layout ||
+      dst_channels != other.dst_channels || src_channels != other.src_channels ||
+      dst_rate != other.dst_rate || src_rate != other.src_rate ||
+      dst_fmt != other.dst_fmt || src_fmt != other.src_fmt ||
+      dst_bits != other.dst_bits || src_bits != other.src_bits ||
+      dst_dither != other.dst_dither || src_dither != other.src_dither ||
+      quality != other.quality || upmix != other.upmix || normalize != other.normalize ||
+      remapCount != other.remapCount)
+    return false;
+
+  for (unsigned int i = 0; i < remapCount; i++)
+  {
+    if (remap[i] != other.remap[i])
+      return false;
+  }
+  return true;
+}
+
+CActiveAEResampleCache& CActiveAEResampleCache::GetInstance()
+{
+  static CActiveAEResampleCache cache;
+  return cache;
+}
+
+CActiveAEResampleCache::CActiveAEResampleCache() :
+  m_hits(0),
+  m_misses(0)
+{
+}
+
+CActiveAEResampleCache::~CActiveAEResampleCache()
+{
+  Clear();
+}
+
+SwrContext *CActiveAEResampleCache::Acquire(const ResampleKey &key)
+{
+  CSingleLock lock(m_lock);
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->key == key)
+    {
+      SwrContext *context = it->context;
+      m_entries.erase(it);
+      m_hits++;
+      return context;
+    }
+  }
+  m_misses++;
+  return NULL;
+}
+
+void CActiveAEResampleCache::Release(const ResampleKey &key, SwrContext *context)
+{
+  // drop buffered samples and the compensation, swr_init brings
+  // the context back with filter bank and matrix still in place
+  swr_close(context);
+  av_opt_set_int(context, "flags", 0, 0);
+
+  CSingleLock lock(m_lock);
+  Entry entry;
+  entry.key = key;
+  entry.context = context;
+  m_entries.push_front(entry);
+  if (m_entries.size() > MAX_ENTRIES)
+  {
+    swr_free(&m_entries.back().context);
+    m_entries.pop_back();
+  }
+}
+
+void CActiveAEResampleCache::Clear()
+{
+  CSingleLock lock(m_lock);
+  for (auto &entry : m_entries)
+    swr_free(&entry.context);
+  m_entries.clear();
+}
+
+void CActiveAEResampleCache::Serialize(CVariant &value)
+{
+  CSingleLock lock(m_lock);
+  value["hits"] = m_hits;
+  value["misses"] = m_misses;
+  value["entries"] = (uint64_t)m_entries.size();
+}
+
 CActiveAEResampleFFMPEG::CActiveAEResampleFFMPEG()
 {
   m_pContext = NULL;
   m_doesResample = false;
+  m_cacheable = false;
 }
 
 CActiveAEResampleFFMPEG::~CActiveAEResampleFFMPEG()
 {
-  swr_free(&m_pContext);
+  if (m_pContext && m_cacheable)
+    CActiveAEResampleCache::GetInstance().Release(m_key, m_pContext);
+  else
+    swr_free(&m_pContext);
 }
 
 bool CActiveAEResampleFFMPEG::Init(uint64_t dst_chan_layout, int dst_channels, int dst_rate, AVSampleFormat dst_fmt, int dst_bits, int dst_dither, uint64_t src_chan_layout, int src_channels, int src_rate, AVSampleFormat src_fmt, int src_bits, int src_dither, bool upmix, bool normalize, CAEChannelInfo *remapLayout, AEQuality quality, bool force_resample)
@@ -64,6 +174,41 @@ bool CActiveAEResampleFFMPEG::Init(uint64_t dst_chan_layout, int dst_channels, i
   if (m_src_chan_layout == 0)
     m_src_chan_layout = av_get_default_channel_layout(m_src_channels);
 
+  m_key = ResampleKey();
+  m_key.dst_chan_layout = m_dst_chan_layout;
+  m_key.src_chan_layout = m_src_chan_layout;
+  m_key.dst_channels = m_dst_channels;
+  m_key.src_channels = m_src_channels;
+  m_key.dst_rate = m_dst_rate;
+  m_key.src_rate = m_src_rate;
+  m_key.dst_fmt = m_dst_fmt;
+  m_key.src_fmt = m_src_fmt;
+  m_key.dst_bits = m_dst_bits;
+  m_key.src_bits = m_src_bits;
+  m_key.dst_dither = m_dst_dither_bits;
+  m_key.src_dither = m_src_dither_bits;
+  m_key.quality = quality;
+  m_key.upmix = upmix && m_src_channels == 2 && m_dst_channels > 2;
+  m_key.normalize = normalize;
+  if (remapLayout)
+  {
+    m_key.remapCount = remapLayout->Count();
+    for (unsigned int out=0; out<remapLayout->Count(); out++)
+      m_key.remap[out] = (*remapLayout)[out];
+  }
+
+  m_pContext = CActiveAEResampleCache::GetInstance().Acquire(m_key);
+  if (m_pContext)
+  {
+    if (swr_init(m_pContext) < 0)
+    {
+      CLog::Log(LOGERROR, "CActiveAEResampleFFMPEG::Init - init cached resampler failed");
+      return false;
+    }
+    m_cacheable = true;
+    return true;
+  }
+
   m_pContext = swr_alloc_set_opts(NULL, m_dst_chan_layout, m_dst_fmt, m_dst_rate,
                                                         m_src_chan_layout, m_src_fmt, m_src_rate,
                                                         0, NULL);
@@ -175,6 +320,7 @@ bool CActiveAEResampleFFMPEG::Init(uint64_t dst_chan_layout, int dst_channels, i
     CLog::Log(LOGERROR, "CActiveAEResampleFFMPEG::Init - init resampler failed");
     return false;
   }
+  m_cacheable = true;
   return true;
 }
 
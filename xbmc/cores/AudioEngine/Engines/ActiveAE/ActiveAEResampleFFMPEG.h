@@ -23,16 +23,73 @@
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
 #include "cores/AudioEngine/Interfaces/AE.h"
 #include "cores/AudioEngine/Interfaces/AEResample.h"
+#include "threads/CriticalSection.h"
+
+#include <list>
 
 extern "C" {
 #include "libavutil/samplefmt.h"
 }
 
 struct SwrContext;
+class CVariant;
 
 namespace ActiveAE
 {
 
+/**
+ * Everything that goes into setting up a swresample context, two setups
+ * with the same key result in identical contexts
+ */
+struct ResampleKey
+{
+  ResampleKey();
+  bool operator==(const ResampleKey &other) const;
+
+  uint64_t dst_chan_layout;
+  uint64_t src_chan_layout;
+  int dst_channels, src_channels;
+  int dst_rate, src_rate;
+  int dst_fmt, src_fmt;
+  int dst_bits, src_bits;
+  int dst_dither, src_dither;
+  int quality;
+  bool upmix;
+  bool normalize;
+  unsigned int remapCount;
+  int remap[AE_CH_MAX];
+};
+
+/**
+ * Keeps initialized swresample contexts of recently closed resamplers,
+ * building the filter bank and matrix is the expensive part of a format
+ * change and switching back to a recent setup should not pay for it again
+ */
+class CActiveAEResampleCache
+{
+public:
+  static CActiveAEResampleCache& GetInstance();
+  ~CActiveAEResampleCache();
+  SwrContext *Acquire(const ResampleKey &key);
+  void Release(const ResampleKey &key, SwrContext *context);
+  void Clear();
+  void Serialize(CVariant &value);
+
+protected:
+  CActiveAEResampleCache();
+
+  struct Entry
+  {
+    ResampleKey key;
+    SwrContext *context;
+  };
+  static const unsigned int MAX_ENTRIES = 8;
+  std::list<Entry> m_entries; // most recently released first
+  uint64_t m_hits;
+  uint64_t m_misses;
+  CCriticalSection m_lock;
+};
+
 class CActiveAEResampleFFMPEG : public IAEResample
 {
 public:
@@ -59,6 +116,8 @@ protected:
   int m_src_dither_bits, m_dst_dither_bits;
   SwrContext *m_pContext;
   double m_rematrix[AE_CH_MAX][AE_CH_MAX];
+  ResampleKey m_key;
+  bool m_cacheable;
 };
 
 }
@@ -48,6 +48,7 @@ CActiveAESink::CActiveAESink(CEvent *inMsgEvent) :
   m_inMsgEvent = inMsgEvent;
   m_sink = nullptr;
   m_stats = nullptr;
+  m_counters = nullptr;
   m_volume = 0.0;
   m_packer = nullptr;
   m_streamNoise = true;
@@ -262,6 +263,7 @@ void CActiveAESink::StateMachine(int signal, Protocol *port, Message *msg)
           {
             m_requestedFormat = data->format;
             m_stats = data->stats;
+            m_counters = data->counters;
             m_device = *(data->device);
           }
           m_extError = false;
@@ -572,6 +574,8 @@ void CActiveAESink::StateMachine(int signal, Protocol *port, Message *msg)
         switch (signal)
         {
         case CSinkControlProtocol::TIMEOUT:
+          if (m_counters)
+            m_counters->AddEvent(CAEEngineCounters::EVENT_SILENCE);
           OutputSamples(&m_sampleOfSilence);
           if (m_extError)
           {
@@ -602,7 +606,8 @@ void CActiveAESink::Process()
   Message *msg = nullptr;
   Protocol *port = nullptr;
   bool gotMsg;
-  XbmcThreads::EndTime timer;
+  XbmcThreads::EndTime deadline;
+  int lastTimeout = 1000;
 
   m_state = S_TOP_UNCONFIGURED;
   m_extTimeout = 1000;
@@ -612,7 +617,15 @@ void CActiveAESink::Process()
   while (!m_bStop)
   {
     gotMsg = false;
-    timer.Set(m_extTimeout);
+
+    // a timeout set by the state machine starts a new deadline, messages
+    // that leave it alone (e.g. volume) must not push the pending one out
+    if (m_extTimeout >= 0)
+    {
+      deadline.Set(m_extTimeout);
+      lastTimeout = m_extTimeout;
+      m_extTimeout = -1;
+    }
 
     if (m_bStateMachineSelfTrigger)
     {
@@ -651,9 +664,8 @@ void CActiveAESink::Process()
     }
 
     // wait for message
-    else if (m_outMsgEvent.WaitMSec(m_extTimeout))
+    else if (m_outMsgEvent.WaitMSec(deadline.MillisLeft()))
     {
-      m_extTimeout = timer.MillisLeft();
       continue;
     }
     // time out
@@ -664,6 +676,9 @@ void CActiveAESink::Process()
       port = 0;
       // signal timeout to state machine
       StateMachine(msg->signal, port, msg);
+      // don't spin on a timeout the state did not handle
+      if (m_extTimeout < 0)
+        m_extTimeout = lastTimeout;
       if (!m_bStateMachineSelfTrigger)
       {
         msg->Release();
@@ -929,12 +944,12 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
   unsigned int maxFrames;
   int retry = 0;
   unsigned int written = 0;
-  std::unique_ptr<uint8_t[]> mergebuffer;
   uint8_t* p_mergebuffer = NULL;
   AEDelayStatus status;
 
   if (m_requestedFormat.m_dataFormat == AE_FMT_RAW)
   {
+    CAEStageTimer packTimer(m_counters, CAEEngineCounters::STAGE_PACK);
     if (m_needIecPack)
     {
       if (frames > 0)
@@ -946,7 +961,6 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
           {
             int offset;
             int len;
-            m_packer->GetBuffer();
             for (int i=0; i<24; i++)
             {
               offset = i*2560;
@@ -1002,13 +1016,14 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
         int offset;
         int len;
         unsigned int size = 0;
-        mergebuffer.reset(new uint8_t[MAX_IEC61937_PACKET]);
-        p_mergebuffer = mergebuffer.get();
+        if (!m_mergeBuffer)
+          m_mergeBuffer.reset(new uint8_t[MAX_IEC61937_PACKET]);
+        p_mergebuffer = m_mergeBuffer.get();
         for (int i=0; i<24; i++)
         {
           offset = i*2560;
           len = (*(buffer[0] + offset+2560-2) << 8) + *(buffer[0] + offset+2560-1);
-          memcpy(&(mergebuffer.get())[size], buffer[0] + offset, len);
+          memcpy(p_mergebuffer + size, buffer[0] + offset, len);
           size += len;
         }
         buffer = &p_mergebuffer;
@@ -1030,14 +1045,23 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
   while (frames > 0)
   {
     maxFrames = std::min(frames, m_sinkFormat.m_frames);
-    written = m_sink->AddPackets(buffer, maxFrames, totalFrames - frames);
+    {
+      CAEStageTimer writeTimer(m_counters, CAEEngineCounters::STAGE_WRITE);
+      written = m_sink->AddPackets(buffer, maxFrames, totalFrames - frames);
+    }
     if (written == 0)
     {
-      Sleep(500*m_sinkFormat.m_frames/m_sinkFormat.m_sampleRate);
+      // block on the device for half a period, sleep if the sink can't tell when it has room
+      unsigned int timeout = 500*m_sinkFormat.m_frames/m_sinkFormat.m_sampleRate;
+      XbmcThreads::EndTime timer(timeout);
+      if (!m_sink->WaitReady(timeout))
+        Sleep(timer.MillisLeft());
       retry++;
       if (retry > 4)
       {
         m_extError = true;
+        if (m_counters)
+          m_counters->AddEvent(CAEEngineCounters::EVENT_SINK_ERROR);
         CLog::Log(LOGERROR, "CActiveAESink::OutputSamples - failed");
         status.SetDelay(0);
         framesOrPackets = frames;
@@ -1052,6 +1076,8 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
     else if (written > maxFrames)
     {
       m_extError = true;
+      if (m_counters)
+        m_counters->AddEvent(CAEEngineCounters::EVENT_SINK_ERROR);
       CLog::Log(LOGERROR, "CActiveAESink::OutputSamples - sink returned error");
       status.SetDelay(0);
       framesOrPackets = frames;
@@ -27,6 +27,8 @@
 #include "cores/AudioEngine/AESinkFactory.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBuffer.h"
 
+#include <memory>
+
 class CAEBitstreamPacker;
 
 namespace ActiveAE
@@ -39,6 +41,7 @@ struct SinkConfig
 {
   AEAudioFormat format;
   CEngineStats *stats;
+  CAEEngineCounters *counters;
   const std::string *device;
 };
 
@@ -126,7 +129,7 @@ protected:
   CEvent *m_inMsgEvent;
   int m_state;
   bool m_bStateMachineSelfTrigger;
-  int m_extTimeout;
+  int m_extTimeout; // starts a new deadline when set, -1 keeps the pending one
   int m_silenceTimeOut;
   bool m_extError;
   unsigned int m_extSilenceTimeout;
@@ -149,9 +152,11 @@ protected:
   IAESink *m_sink;
   AEAudioFormat m_sinkFormat, m_requestedFormat;
   CEngineStats *m_stats;
+  CAEEngineCounters *m_counters;
   float m_volume;
   int m_sinkLatency;
   CAEBitstreamPacker *m_packer;
+  std::unique_ptr<uint8_t[]> m_mergeBuffer; // TrueHD units merged for sinks packing themselves
   bool m_needIecPack;
   bool m_streamNoise;
   bool m_bAudio2;
@@ -41,8 +41,6 @@ CActiveAESound::CActiveAESound(const std::string &filename) :
   m_volume         (1.0f    ),
   m_channel        (AE_CH_NULL)
 {
-  m_orig_sound = NULL;
-  m_dst_sound = NULL;
   m_pFile = NULL;
   m_isSeekPossible = false;
   m_fileSize = 0;
@@ -51,8 +49,6 @@ CActiveAESound::CActiveAESound(const std::string &filename) :
 
 CActiveAESound::~CActiveAESound()
 {
-  delete m_orig_sound;
-  delete m_dst_sound;
   Finish();
 }
 
@@ -74,14 +70,13 @@ bool CActiveAESound::IsPlaying()
 
 uint8_t** CActiveAESound::InitSound(bool orig, SampleConfig config, int nb_samples)
 {
-  CSoundPacket **info;
+  std::shared_ptr<CSoundPacket> *info;
   if (orig)
     info = &m_orig_sound;
   else
     info = &m_dst_sound;
 
-  delete *info;
-  *info = new CSoundPacket(config, nb_samples, m_bAudio2);
+  info->reset(new CSoundPacket(config, nb_samples, m_bAudio2));
 
   (*info)->nb_samples = 0;
   m_isConverted = false;
@@ -90,7 +85,7 @@ uint8_t** CActiveAESound::InitSound(bool orig, SampleConfig config, int nb_sampl
 
 bool CActiveAESound::StoreSound(bool orig, uint8_t **buffer, int samples, int linesize)
 {
-  CSoundPacket **info;
+  std::shared_ptr<CSoundPacket> *info;
   if (orig)
     info = &m_orig_sound;
   else
@@ -116,7 +111,16 @@ bool CActiveAESound::StoreSound(bool orig, uint8_t **buffer, int samples, int li
   return true;
 }
 
-CSoundPacket *CActiveAESound::GetSound(bool orig)
+void CActiveAESound::SetSound(bool orig, const std::shared_ptr<CSoundPacket> &sound)
+{
+  if (orig)
+    m_orig_sound = sound;
+  else
+    m_dst_sound = sound;
+  m_isConverted = false;
+}
+
+const std::shared_ptr<CSoundPacket>& CActiveAESound::GetSound(bool orig)
 {
   if (orig)
     return m_orig_sound;
@@ -22,6 +22,8 @@
 #include "cores/AudioEngine/Interfaces/AESound.h"
 #include "filesystem/File.h"
 
+#include <memory>
+
 class DllAvUtil;
 
 namespace ActiveAE
@@ -44,7 +46,8 @@ public:
 
   uint8_t** InitSound(bool orig, SampleConfig config, int nb_samples);
   bool StoreSound(bool orig, uint8_t **buffer, int samples, int linesize);
-  CSoundPacket *GetSound(bool orig);
+  void SetSound(bool orig, const std::shared_ptr<CSoundPacket> &sound);
+  const std::shared_ptr<CSoundPacket>& GetSound(bool orig);
 
   bool IsConverted() { return m_isConverted; }
   void SetConverted(bool state) { m_isConverted = state; }
@@ -66,8 +69,8 @@ protected:
   float m_volume;
   AEChannel m_channel;
 
-  CSoundPacket *m_orig_sound;
-  CSoundPacket *m_dst_sound;
+  std::shared_ptr<CSoundPacket> m_orig_sound;
+  std::shared_ptr<CSoundPacket> m_dst_sound;
 
   bool m_isConverted;
 };
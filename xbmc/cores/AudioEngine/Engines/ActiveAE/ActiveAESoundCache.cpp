@@ -0,0 +1,156 @@
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ActiveAESoundCache.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+
+using namespace ActiveAE;
+
+bool SoundConversion::operator==(const SoundConversion &other) const
+{
+  return config.fmt == other.config.fmt &&
+         config.channel_layout == other.config.channel_layout &&
+         config.channels == other.config.channels &&
+         config.sample_rate == other.config.sample_rate &&
+         config.bits_per_sample == other.config.bits_per_sample &&
+         config.dither_bits == other.config.dither_bits &&
+         channel == other.channel &&
+         quality == other.quality;
+}
+
+CActiveAESoundCache& CActiveAESoundCache::GetInstance()
+{
+  static CActiveAESoundCache cache;
+  return cache;
+}
+
+CActiveAESoundCache::CActiveAESoundCache() :
+  m_bytes(0)
+{
+}
+
+CActiveAESoundCache::~CActiveAESoundCache()
+{
+  Clear();
+}
+
+std::shared_ptr<CSoundPacket> CActiveAESoundCache::GetDecoded(const std::string &filename)
+{
+  int64_t size, mtime;
+  if (!GetFileId(filename, size, mtime))
+    return nullptr;
+
+  CSingleLock lock(m_lock);
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->source || it->filename != filename)
+      continue;
+
+    // the file was replaced, converted entries of the old one age out
+    if (it->size != size || it->mtime != mtime)
+    {
+      m_bytes -= GetBytes(*it->sound);
+      m_entries.erase(it);
+      return nullptr;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    return it->sound;
+  }
+  return nullptr;
+}
+
+void CActiveAESoundCache::AddDecoded(const std::string &filename, const std::shared_ptr<CSoundPacket> &sound)
+{
+  Entry entry;
+  entry.filename = filename;
+  if (!GetFileId(filename, entry.size, entry.mtime))
+    return;
+  entry.sound = sound;
+  Insert(entry);
+}
+
+std::shared_ptr<CSoundPacket> CActiveAESoundCache::GetConverted(const std::shared_ptr<CSoundPacket> &source,
+                                                                const SoundConversion &conversion)
+{
+  CSingleLock lock(m_lock);
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->source == source && it->conversion == conversion)
+    {
+      m_entries.splice(m_entries.begin(), m_entries, it);
+      return it->sound;
+    }
+  }
+  return nullptr;
+}
+
+void CActiveAESoundCache::AddConverted(const std::shared_ptr<CSoundPacket> &source,
+                                       const SoundConversion &conversion,
+                                       const std::shared_ptr<CSoundPacket> &sound)
+{
+  Entry entry;
+  entry.size = 0;
+  entry.mtime = 0;
+  entry.source = source;
+  entry.conversion = conversion;
+  entry.sound = sound;
+  Insert(entry);
+}
+
+void CActiveAESoundCache::Clear()
+{
+  CSingleLock lock(m_lock);
+  m_entries.clear();
+  m_bytes = 0;
+}
+
+bool CActiveAESoundCache::GetFileId(const std::string &filename, int64_t &size, int64_t &mtime)
+{
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(filename, &st) != 0)
+    return false;
+  size = st.st_size;
+  mtime = st.st_mtime;
+  return true;
+}
+
+unsigned int CActiveAESoundCache::GetBytes(const CSoundPacket &sound)
+{
+  return sound.linesize * sound.planes;
+}
+
+void CActiveAESoundCache::Insert(const Entry &entry)
+{
+  unsigned int bytes = GetBytes(*entry.sound);
+  if (bytes > MAX_BYTES)
+    return;
+
+  CSingleLock lock(m_lock);
+  m_entries.push_front(entry);
+  m_bytes += bytes;
+
+  // sounds still in use keep their samples, only the cache lets go
+  while (m_bytes > MAX_BYTES)
+  {
+    m_bytes -= GetBytes(*m_entries.back().sound);
+    m_entries.pop_back();
+  }
+}
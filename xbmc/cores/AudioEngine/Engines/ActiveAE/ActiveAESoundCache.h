@@ -0,0 +1,94 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ActiveAEBuffer.h"
+#include "threads/CriticalSection.h"
+
+#include <list>
+#include <memory>
+#include <string>
+
+namespace ActiveAE
+{
+
+/**
+ * Everything that goes into converting a decoded sound for mixing
+ */
+struct SoundConversion
+{
+  bool operator==(const SoundConversion &other) const;
+
+  SampleConfig config;
+  AEChannel channel;
+  AEQuality quality;
+};
+
+/**
+ * Decoded and converted GUI sounds of both engines. Skins load the same
+ * files on every reload and with dual audio each file is loaded once per
+ * engine, all but the first load take the samples from here.
+ * Packets are shared and must not be modified once added.
+ */
+class CActiveAESoundCache
+{
+public:
+  static CActiveAESoundCache& GetInstance();
+  ~CActiveAESoundCache();
+
+  /**
+   * @return samples of the file as decoded, null if not cached or the file changed
+   */
+  std::shared_ptr<CSoundPacket> GetDecoded(const std::string &filename);
+  void AddDecoded(const std::string &filename, const std::shared_ptr<CSoundPacket> &sound);
+
+  /**
+   * @param source packet returned by GetDecoded or added by AddDecoded
+   */
+  std::shared_ptr<CSoundPacket> GetConverted(const std::shared_ptr<CSoundPacket> &source,
+                                             const SoundConversion &conversion);
+  void AddConverted(const std::shared_ptr<CSoundPacket> &source,
+                    const SoundConversion &conversion,
+                    const std::shared_ptr<CSoundPacket> &sound);
+  void Clear();
+
+protected:
+  CActiveAESoundCache();
+
+  struct Entry
+  {
+    std::string filename;                  // decoded, empty for converted
+    int64_t size;
+    int64_t mtime;
+    std::shared_ptr<CSoundPacket> source;  // converted, keeps the source alive
+    SoundConversion conversion;
+    std::shared_ptr<CSoundPacket> sound;
+  };
+  static bool GetFileId(const std::string &filename, int64_t &size, int64_t &mtime);
+  static unsigned int GetBytes(const CSoundPacket &sound);
+  void Insert(const Entry &entry);
+
+  static const unsigned int MAX_BYTES = 32 * 1024 * 1024;
+  std::list<Entry> m_entries; // most recently used first
+  unsigned int m_bytes;
+  CCriticalSection m_lock;
+};
+
+}
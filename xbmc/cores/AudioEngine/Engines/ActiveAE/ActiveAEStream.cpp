@@ -34,8 +34,12 @@ using namespace ActiveAE;
 /* typecast AE to CActiveAE */
 #define AE (*((CActiveAE*)CAEFactory::GetEngine(m_bAudio2)))
 
+#define MAX_STREAM_SAMPLES 256   // sample buffers in flight between stream and engine
+
 
 CActiveAEStream::CActiveAEStream(AEAudioFormat *format, unsigned int streamid)
+  : m_freeSamples(MAX_STREAM_SAMPLES),
+    m_filledSamples(MAX_STREAM_SAMPLES)
 {
   m_format = *format;
   m_id = streamid;
@@ -56,6 +60,7 @@ CActiveAEStream::CActiveAEStream(AEAudioFormat *format, unsigned int streamid)
   m_streamIsFlushed = false;
   m_bypassDSP = false;
   m_streamSlave = NULL;
+  m_engineEvent = NULL;
   m_leftoverBuffer = new uint8_t[m_format.m_frameSize];
   m_leftoverBytes = 0;
   m_forceResampler = false;
@@ -63,6 +68,7 @@ CActiveAEStream::CActiveAEStream(AEAudioFormat *format, unsigned int streamid)
   m_remapBuffer = NULL;
   m_streamResampleRatio = 1.0;
   m_streamResampleMode = 0;
+  m_resampleRatio = 1.0;
   m_profile = 0;
   m_matrixEncoding = AV_MATRIX_ENCODING_NONE;
   m_audioServiceType = AV_AUDIO_SERVICE_TYPE_MAIN;
@@ -236,9 +242,22 @@ unsigned int CActiveAEStream::GetSpace()
     return m_streamFreeBuffers * m_streamSpace;
 }
 
+void CActiveAEStream::QueueBuffer(CSampleBuffer *buffer)
+{
+  bool wasEmpty;
+  if (!m_filledSamples.Push(buffer, &wasEmpty))
+  {
+    CLog::Log(LOGERROR, "CActiveAEStream::QueueBuffer - sample queue overrun");
+    return;
+  }
+  // the engine drains the queue before it sleeps, one wakeup per batch
+  if (wasEmpty)
+    m_engineEvent->Set();
+}
+
 unsigned int CActiveAEStream::AddData(const uint8_t* const *data, unsigned int offset, unsigned int frames, double pts)
 {
-  Message *msg;
+  CSampleBuffer *buffer;
   unsigned int copied = 0;
   int sourceFrames = frames;
   const uint8_t* const *buf = data;
@@ -307,33 +326,20 @@ unsigned int CActiveAEStream::AddData(const uint8_t* const *data, unsigned int o
 
       if (m_currentBuffer->pkt->nb_samples == m_currentBuffer->pkt->max_nb_samples || rawPktComplete)
       {
-        MsgStreamSample msgData;
-        msgData.buffer = m_currentBuffer;
-        msgData.stream = this;
         RemapBuffer();
-        m_streamPort->SendOutMessage(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
+        QueueBuffer(m_currentBuffer);
         m_currentBuffer = NULL;
       }
       continue;
     }
-    else if (m_streamPort->ReceiveInMessage(&msg))
+    else if (m_freeSamples.Pop(buffer))
     {
-      if (msg->signal == CActiveAEDataProtocol::STREAMBUFFER)
-      {
-        m_currentBuffer = *((CSampleBuffer**)msg->data);
-        m_currentBuffer->timestamp = 0;
-        m_currentBuffer->pkt->nb_samples = 0;
-        m_currentBuffer->pkt->pause_burst_ms = 0;
-        msg->Release();
-        DecFreeBuffers();
-        continue;
-      }
-      else
-      {
-        CLog::Log(LOGERROR, "CActiveAEStream::AddData - unknown signal");
-        msg->Release();
-        break;
-      }
+      m_currentBuffer = buffer;
+      m_currentBuffer->timestamp = 0;
+      m_currentBuffer->pkt->nb_samples = 0;
+      m_currentBuffer->pkt->pause_burst_ms = 0;
+      DecFreeBuffers();
+      continue;
     }
     if (!m_inMsgEvent.WaitMSec(200))
       break;
@@ -404,33 +410,30 @@ void CActiveAEStream::Drain(bool wait)
 
   if (m_currentBuffer)
   {
-    MsgStreamSample msgData;
-    msgData.buffer = m_currentBuffer;
-    msgData.stream = this;
     RemapBuffer();
-    m_streamPort->SendOutMessage(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
+    QueueBuffer(m_currentBuffer);
     m_currentBuffer = NULL;
   }
 
   XbmcThreads::EndTime timer(2000);
   while (!timer.IsTimePast())
   {
-    if (m_streamPort->ReceiveInMessage(&msg))
+    CSampleBuffer *buffer;
+    if (m_freeSamples.Pop(buffer))
     {
-      if (msg->signal == CActiveAEDataProtocol::STREAMBUFFER)
-      {
-        MsgStreamSample msgData;
-        msgData.stream = this;
-        msgData.buffer = *((CSampleBuffer**)msg->data);
-        msg->Reply(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
-        DecFreeBuffers();
-        continue;
-      }
-      else if (msg->signal == CActiveAEDataProtocol::STREAMDRAINED)
-      {
-        msg->Release();
+      // nothing left to add, hand it back empty
+      buffer->pkt->nb_samples = 0;
+      QueueBuffer(buffer);
+      DecFreeBuffers();
+      continue;
+    }
+    else if (m_streamPort->ReceiveInMessage(&msg))
+    {
+      bool drained = msg->signal == CActiveAEDataProtocol::STREAMDRAINED;
+      msg->Release();
+      if (drained)
         return;
-      }
+      continue;
     }
     else if (!wait)
       return;
@@ -756,6 +759,12 @@ void CActiveAEStreamBuffers::SetDSPConfig(bool usedsp, bool bypassdsp)
   m_resampleBuffers->SetDSPConfig(usedsp, bypassdsp);
 }
 
+void CActiveAEStreamBuffers::SetCounters(CAEEngineCounters *counters)
+{
+  m_resampleBuffers->SetCounters(counters);
+  m_atempoBuffers->SetCounters(counters);
+}
+
 CActiveAEBufferPool* CActiveAEStreamBuffers::GetResampleBuffers()
 {
   CActiveAEBufferPool *ret = m_resampleBuffers;
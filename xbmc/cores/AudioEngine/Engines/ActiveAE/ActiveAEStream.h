@@ -22,6 +22,7 @@
 #include "cores/AudioEngine/Interfaces/AEStream.h"
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
 #include "cores/AudioEngine/Utils/AELimiter.h"
+#include "cores/AudioEngine/Utils/AESPSCQueue.h"
 #include <atomic>
 
 namespace ActiveAE
@@ -109,6 +110,7 @@ public:
   bool DoesNormalize();
   void ForceResampler(bool force);
   void SetDSPConfig(bool usedsp, bool bypassdsp);
+  void SetCounters(CAEEngineCounters *counters);
   bool HasWork();
   CActiveAEBufferPool *GetResampleBuffers();
   CActiveAEBufferPool *GetAtempoBuffers();
@@ -135,6 +137,7 @@ protected:
   void ResetFreeBuffers();
   void InitRemapper();
   void RemapBuffer();
+  void QueueBuffer(CSampleBuffer *buffer);
   double CalcResampleRatio(double error);
 
 public:
@@ -212,6 +215,12 @@ protected:
   std::deque<CSampleBuffer*> m_processingSamples;
   CActiveAEDataProtocol *m_streamPort;
   CEvent m_inMsgEvent;
+  CEvent *m_engineEvent;
+
+  // sample buffers bypass the data port: the engine pushes empty buffers
+  // to m_freeSamples and pops the filled ones from m_filledSamples
+  CAESPSCQueue<CSampleBuffer*> m_freeSamples;
+  CAESPSCQueue<CSampleBuffer*> m_filledSamples;
   bool m_drain;
   bool m_paused;
   bool m_started;
@@ -226,6 +235,7 @@ protected:
   int m_fadingTime;
   int m_profile;
   int m_resampleMode;
+  double m_resampleRatio;
   double m_resampleIntegral;
   double m_clockSpeed;
   enum AVMatrixEncoding m_matrixEncoding;
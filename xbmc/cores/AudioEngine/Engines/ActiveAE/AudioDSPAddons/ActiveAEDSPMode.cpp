@@ -58,6 +58,8 @@ CActiveAEDSPMode::CActiveAEDSPMode()
   m_bHasSettingsDialog      = false;
 
   m_fCPUUsage               = 0.0f;
+  m_fBudget                 = 0.0f;
+  m_iOverruns               = 0;
 
   m_iAddonId                = -1;
   m_iAddonModeNumber        = -1;
@@ -111,6 +113,8 @@ CActiveAEDSPMode::CActiveAEDSPMode(int modeId, const AE_DSP_BASETYPE baseType)
   m_bHasSettingsDialog      = false;
 
   m_fCPUUsage               = 0.0f;
+  m_fBudget                 = 0.0f;
+  m_iOverruns               = 0;
 
   m_iAddonId                = -1;
   m_iAddonModeNumber        = -1;
@@ -138,6 +142,8 @@ CActiveAEDSPMode::CActiveAEDSPMode(const AE_DSP_MODES::AE_DSP_MODE &mode, int iA
   m_bIsInternal             = false;
 
   m_fCPUUsage               = 0.0f;
+  m_fBudget                 = 0.0f;
+  m_iOverruns               = 0;
 
   if (m_strModeName.empty())
     m_strModeName = StringUtils::Format("%s %d", g_localizeStrings.Get(15023).c_str(), m_iModeId);
@@ -169,6 +175,8 @@ CActiveAEDSPMode &CActiveAEDSPMode::operator=(const CActiveAEDSPMode &mode)
   m_bIsInternal             = mode.m_bIsInternal;
   m_bHasSettingsDialog      = mode.m_bHasSettingsDialog;
   m_fCPUUsage               = mode.m_fCPUUsage;
+  m_fBudget                 = mode.m_fBudget;
+  m_iOverruns               = mode.m_iOverruns;
 
   return *this;
 }
@@ -390,6 +398,25 @@ float CActiveAEDSPMode::CPUUsage(void) const
   return m_fCPUUsage;
 }
 
+void CActiveAEDSPMode::SetTiming(float budget, unsigned int overruns)
+{
+  CSingleLock lock(m_critSection);
+  m_fBudget   = budget;
+  m_iOverruns = overruns;
+}
+
+float CActiveAEDSPMode::Budget(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_fBudget;
+}
+
+unsigned int CActiveAEDSPMode::Overruns(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_iOverruns;
+}
+
 
 /********** Fixed addon related Mode methods **********/
 
@@ -242,6 +242,25 @@ namespace ActiveAE
      * @param percent The percent value (0.0 - 100.0)
      */
     void SetCPUUsage(float percent);
+
+    /*!
+     * @brief Get the time this mode may take for one packet without holding up the process chain
+     * @return The budget in milliseconds, 0.0 if not in a running process chain
+     */
+    float Budget(void) const;
+
+    /*!
+     * @brief Get how often this mode took longer than its budget since the chain was set up
+     * @return The amount of overruns
+     */
+    unsigned int Overruns(void) const;
+
+    /*!
+     * @brief Set the timing budget and overruns of this mode if active and in process list
+     * @param budget The budget in milliseconds
+     * @param overruns The amount of overruns
+     */
+    void SetTiming(float budget, unsigned int overruns);
     //@}
 
     /*! @name Fixed audio dsp add-on related mode functions
@@ -311,6 +330,8 @@ namespace ActiveAE
      */
     //@{
     float             m_fCPUUsage;               /*!< if mode is active the used cpu force in percent is set here */
+    float             m_fBudget;                 /*!< if mode is active the time in ms it may take for one packet */
+    unsigned int      m_iOverruns;               /*!< if mode is active how often it exceeded its budget */
     //@}
 
     /*! @name Audio dsp add-on related mode data
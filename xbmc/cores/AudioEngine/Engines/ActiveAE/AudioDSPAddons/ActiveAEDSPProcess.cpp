@@ -34,6 +34,8 @@ extern "C" {
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/IPlayer.h"
 #include "settings/MediaSettings.h"
+#include "settings/Settings.h"
+#include "threads/Thread.h"
 #include "utils/TimeUtils.h"
 
 using namespace ADDON;
@@ -41,6 +43,89 @@ using namespace ActiveAE;
 
 #define MIN_DSP_ARRAY_SIZE 4096
 
+/*!
+ * Worker running the stages up to master processing on one packet while the
+ * calling thread passes the packet before through the rest of the chain.
+ */
+class CActiveAEDSPProcess::CPipeline : public CThread
+{
+public:
+  CPipeline(CActiveAEDSPProcess &process)
+    : CThread("ActiveAEDSPPipeline"),
+      m_process(process),
+      m_busy(false),
+      m_frames(0),
+      m_duration(0),
+      m_budget(0),
+      m_overruns(0)
+  {
+    Create();
+    SetPriority(THREAD_PRIORITY_ABOVE_NORMAL);
+  }
+
+  virtual ~CPipeline()
+  {
+    m_bStop = true;
+    m_start.Set();
+    StopThread();
+  }
+
+  void Start(unsigned int frames, uint64_t duration, uint64_t budget)
+  {
+    m_frames   = frames;
+    m_duration = duration;
+    m_budget   = budget;
+    m_busy     = true;
+    m_start.Set();
+  }
+
+  void Wait()
+  {
+    if (m_busy)
+    {
+      m_done.Wait();
+      m_busy = false;
+    }
+  }
+
+  unsigned int GetOverruns() const
+  {
+    return m_overruns;
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      m_start.Wait();
+      if (m_bStop)
+        break;
+
+      int64_t startTime = CurrentHostCounter();
+      unsigned int frames = m_frames;
+      unsigned int togglePtr = 1;
+      m_process.m_frontResult    = m_process.ProcessFront(m_process.m_frontArray, frames, togglePtr, true, m_budget);
+      m_process.m_frontFrames    = frames;
+      m_process.m_frontTogglePtr = togglePtr;
+      if ((uint64_t)(1000 * 10000 * (CurrentHostCounter() - startTime) / CurrentHostFrequency()) > m_duration)
+        m_overruns++;
+
+      m_done.Set();
+    }
+  }
+
+private:
+  CActiveAEDSPProcess &m_process;
+  CEvent              m_start;
+  CEvent              m_done;
+  bool                m_busy;
+  unsigned int        m_frames;
+  uint64_t            m_duration;
+  uint64_t            m_budget;
+  unsigned int        m_overruns;
+};
+
 CActiveAEDSPProcess::CActiveAEDSPProcess(AE_DSP_STREAM_ID streamId)
  : m_streamId(streamId)
 {
@@ -54,6 +139,16 @@ CActiveAEDSPProcess::CActiveAEDSPProcess(AE_DSP_STREAM_ID streamId)
   m_convertInput            = NULL;
   m_convertOutput           = NULL;
   m_iLastProcessTime        = 0;
+  m_iOverruns               = 0;
+  m_iLastOverruns           = 0;
+  m_pipelineEnabled         = false;
+  m_pipeline                = NULL;
+  m_frontFrames             = 0;
+  m_frontTogglePtr          = 1;
+  m_frontResult             = false;
+  m_frontPending            = false;
+  m_frontTimestamp          = 0;
+  m_frontDuration           = 0;
 
   /*!
    * Create predefined process arrays on every supported channel for audio dsp's.
@@ -66,11 +161,14 @@ CActiveAEDSPProcess::CActiveAEDSPProcess(AE_DSP_STREAM_ID streamId)
   {
     m_processArray[0][i] = (float*)calloc(m_processArraySize, sizeof(float));
     m_processArray[1][i] = (float*)calloc(m_processArraySize, sizeof(float));
+    m_frontArray[0][i]   = NULL;
+    m_frontArray[1][i]   = NULL;
   }
 }
 
 CActiveAEDSPProcess::~CActiveAEDSPProcess()
 {
+  StopPipeline();
   ResetStreamFunctionsSelection();
 
   if (m_resamplerDSPProcessor)
@@ -86,6 +184,8 @@ CActiveAEDSPProcess::~CActiveAEDSPProcess()
       free(m_processArray[0][i]);
     if(m_processArray[1][i])
       free(m_processArray[1][i]);
+    free(m_frontArray[0][i]);
+    free(m_frontArray[1][i]);
   }
 
   swr_free(&m_convertInput);
@@ -109,6 +209,8 @@ void CActiveAEDSPProcess::ResetStreamFunctionsSelection()
 bool CActiveAEDSPProcess::Create(const AEAudioFormat &inputFormat, const AEAudioFormat &outputFormat, bool upmix, AEQuality quality, AE_DSP_STREAMTYPE iStreamType,
                                  enum AVMatrixEncoding matrix_encoding, enum AVAudioServiceType audio_service_type, int profile)
 {
+  StopPipeline();
+
   m_inputFormat       = inputFormat;                        /*!< Input format of processed stream */
   m_outputFormat      = outputFormat;                       /*!< Output format of required stream (set from ADSP system on startup, to have ffmpeg compatible format */
   m_outputSamplerate  = m_inputFormat.m_sampleRate;         /*!< If no resampler addon is present output samplerate is the same as input */
@@ -628,6 +730,12 @@ bool CActiveAEDSPProcess::Create(const AEAudioFormat &inputFormat, const AEAudio
     CLog::Log(LOGDEBUG, "  | Frames               : %d", m_outputFrames);
   }
 
+  /*!
+   * Run the stages up to master processing on a worker if requested, it becomes
+   * started on first processing if any of these stages is used
+   */
+  m_pipelineEnabled = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT_DSPPIPELINE);
+
   m_forceInit = true;
   return true;
 }
@@ -825,6 +933,8 @@ void CActiveAEDSPProcess::Destroy()
   if (!CServiceBroker::GetADSP().IsActivated())
     return;
 
+  StopPipeline();
+
   for (AE_DSP_ADDONMAP_ITR itr = m_usedMap.begin(); itr != m_usedMap.end(); ++itr)
   {
     itr->second->StreamDestroy(&m_addon_Handles[itr->first]);
@@ -839,6 +949,22 @@ void CActiveAEDSPProcess::ForceReinit()
   m_forceInit = true;
 }
 
+void CActiveAEDSPProcess::Flush()
+{
+  CSingleLock lock(m_restartSection);
+
+  if (m_pipeline)
+    m_pipeline->Wait();
+  m_frontPending = false;
+}
+
+void CActiveAEDSPProcess::StopPipeline()
+{
+  delete m_pipeline;
+  m_pipeline     = NULL;
+  m_frontPending = false;
+}
+
 AE_DSP_STREAMTYPE CActiveAEDSPProcess::DetectStreamType(const CFileItem *item)
 {
   AE_DSP_STREAMTYPE detected = AE_DSP_ASTREAM_BASIC;
@@ -910,6 +1036,16 @@ float CActiveAEDSPProcess::GetCPUUsage(void) const
   return m_fLastProcessUsage;
 }
 
+unsigned int CActiveAEDSPProcess::GetOverruns(void) const
+{
+  return m_iLastOverruns;
+}
+
+bool CActiveAEDSPProcess::IsPipelined(void) const
+{
+  return m_pipeline != NULL;
+}
+
 CAEChannelInfo CActiveAEDSPProcess::GetChannelLayout()
 {
   return m_outputFormat.m_channelLayout;
@@ -1120,10 +1256,34 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
 {
   CSingleLock lock(m_restartSection);
 
-  bool needDSPAddonsReinit  = m_forceInit;
+  /* The worker must be through with its packet before anything of the chain is touched */
+  if (m_pipeline)
+    m_pipeline->Wait();
+
+  int64_t chainStart        = CurrentHostCounter();
   uint64_t iTime            = static_cast<uint64_t>(XbmcThreads::SystemClockMillis()) * 10000;
-  int64_t hostFrequency     = CurrentHostFrequency();
-  unsigned int frames       = in->pkt->nb_samples;
+
+  /**
+   * Update cpu process percent usage values for modes and total (every second)
+   */
+  if (iTime >= m_iLastProcessTime + 1000*10000)
+    CalculateCPUUsage(iTime);
+
+  unsigned int frames;
+  int64_t timestamp;
+  uint64_t duration;
+
+  /* Drain, pass out the packet still held by the pipeline */
+  if (!in)
+  {
+    if (!TakeFrontPacket(frames, timestamp, duration))
+      return false;
+
+    return ProcessOutput(out, frames, 1, timestamp, true, duration / std::max(GetBackModes(), 1u));
+  }
+
+  bool needDSPAddonsReinit  = m_forceInit;
+  frames                    = in->pkt->nb_samples;
 
   /* Detect interleaved input stream channel positions if unknown or changed */
   if (m_channelLayoutIn != in->pkt->config.channel_layout)
@@ -1257,10 +1417,41 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
     ClearArray(m_processArray[0], m_processArraySize);
     ClearArray(m_processArray[1], m_processArraySize);
 
+    /**
+     * Pipeline the chain if requested and anything runs ahead of post processing,
+     * a packet still in the pipeline belongs to the old setup and is dropped
+     */
+    m_frontPending = false;
+    if (m_pipelineEnabled && GetFrontModes() > 0)
+    {
+      for (int i = 0; i < AE_DSP_CH_MAX; ++i)
+      {
+        m_frontArray[0][i] = (float*)realloc(m_frontArray[0][i], m_processArraySize*sizeof(float));
+        m_frontArray[1][i] = (float*)realloc(m_frontArray[1][i], m_processArraySize*sizeof(float));
+        if (m_frontArray[0][i] == NULL || m_frontArray[1][i] == NULL)
+        {
+          CLog::Log(LOGERROR, "ActiveAE DSP - %s - realloc of pipeline data array failed", __FUNCTION__);
+          return false;
+        }
+      }
+      ClearArray(m_frontArray[0], m_processArraySize);
+      ClearArray(m_frontArray[1], m_processArraySize);
+
+      if (!m_pipeline)
+      {
+        m_pipeline = new CPipeline(*this);
+        CLog::Log(LOGDEBUG, "ActiveAE DSP - %s - stages up to master processing are pipelined", __FUNCTION__);
+      }
+    }
+    else
+      StopPipeline();
+
     m_forceInit         = false;
     m_iLastProcessTime  = static_cast<uint64_t>(XbmcThreads::SystemClockMillis()) * 10000;
     m_iLastProcessUsage = 0;
     m_fLastProcessUsage = 0.0f;
+    m_iOverruns         = 0;
+    m_iLastOverruns     = 0;
 
     /**
      * Setup ffmpeg convert array for input stream
@@ -1268,9 +1459,38 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
     SetFFMpegDSPProcessorArray(m_ffMpegConvertArray, m_processArray[0], NULL);
   }
 
-  int64_t startTime;
-  float **lastOutArray    = m_processArray[0];
-  unsigned int togglePtr  = 1;
+  duration = 1000 * 10000 * (uint64_t)frames / m_addonSettings.iInSamplerate;
+
+  if (m_pipeline)
+  {
+    /**
+     * The worker is idle, take its output and hand it the new packet converted
+     * to the required planar float format inside dsp system
+     */
+    unsigned int inFrames = frames;
+    uint64_t inDuration   = duration;
+    bool hasOutput        = TakeFrontPacket(frames, timestamp, duration);
+
+    SetFFMpegDSPProcessorArray(m_ffMpegConvertArray, m_frontArray[0], NULL);
+    if (swr_convert(m_convertInput, (uint8_t **)m_ffMpegConvertArray[0], m_processArraySize, (const uint8_t **)in->pkt->data , inFrames) < 0)
+    {
+      CLog::Log(LOGERROR, "ActiveAE DSP - %s - input audio convert failed", __FUNCTION__);
+      return false;
+    }
+
+    m_frontPending   = true;
+    m_frontTimestamp = in->timestamp;
+    m_frontDuration  = inDuration;
+    m_pipeline->Start(inFrames, inDuration, inDuration / GetFrontModes());
+
+    if (!hasOutput)
+      return false;
+
+    bool ret = ProcessOutput(out, frames, 1, timestamp, true, duration / std::max(GetBackModes(), 1u));
+    if ((uint64_t)(1000 * 10000 * (CurrentHostCounter() - chainStart) / CurrentHostFrequency()) > duration)
+      m_iOverruns++;
+    return ret;
+  }
 
   /**
    * Convert to required planar float format inside dsp system
@@ -1281,6 +1501,43 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
     return false;
   }
 
+  uint64_t budget         = duration / std::max(GetFrontModes() + GetBackModes(), 1u);
+  unsigned int togglePtr  = 1;
+
+  if (!ProcessFront(m_processArray, frames, togglePtr, needDSPAddonsReinit, budget))
+    return false;
+
+  bool ret = ProcessOutput(out, frames, togglePtr, in->timestamp, needDSPAddonsReinit, budget);
+  if ((uint64_t)(1000 * 10000 * (CurrentHostCounter() - chainStart) / CurrentHostFrequency()) > duration)
+    m_iOverruns++;
+  return ret;
+}
+
+bool CActiveAEDSPProcess::TakeFrontPacket(unsigned int &frames, int64_t &timestamp, uint64_t &duration)
+{
+  if (!m_frontPending)
+    return false;
+
+  m_frontPending = false;
+  if (!m_frontResult)
+    return false;
+
+  /* swap the worker output in as first process array of the calling thread */
+  float **frontOut = m_frontArray[m_frontTogglePtr ^ 1];
+  for (int i = 0; i < AE_DSP_CH_MAX; ++i)
+    std::swap(frontOut[i], m_processArray[0][i]);
+
+  frames    = m_frontFrames;
+  timestamp = m_frontTimestamp;
+  duration  = m_frontDuration;
+  return true;
+}
+
+bool CActiveAEDSPProcess::ProcessFront(float *array[2][AE_DSP_CH_MAX], unsigned int &frames, unsigned int &togglePtr, bool remap, uint64_t budget)
+{
+  int64_t startTime;
+  float **lastOutArray = array[togglePtr ^ 1];
+
     /**********************************************/
    /** DSP Processing Algorithms following here **/
   /**********************************************/
@@ -1308,13 +1565,13 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
   {
     startTime = CurrentHostCounter();
 
-    frames = m_addon_InputResample.pAddon->InputResampleProcess(&m_addon_InputResample.handle, lastOutArray, m_processArray[togglePtr], frames);
+    frames = m_addon_InputResample.pAddon->InputResampleProcess(&m_addon_InputResample.handle, lastOutArray, array[togglePtr], frames);
     if (frames == 0)
       return false;
 
-    m_addon_InputResample.iLastTime += 1000 * 10000 * (CurrentHostCounter() - startTime) / hostFrequency;
+    m_addon_InputResample.AddTime(startTime, budget);
 
-    lastOutArray = m_processArray[togglePtr];
+    lastOutArray = array[togglePtr];
     togglePtr ^= 1;
   }
 
@@ -1326,13 +1583,13 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
   {
     startTime = CurrentHostCounter();
 
-    frames = m_addons_PreProc[i].pAddon->PreProcess(&m_addons_PreProc[i].handle, m_addons_PreProc[i].iAddonModeNumber, lastOutArray, m_processArray[togglePtr], frames);
+    frames = m_addons_PreProc[i].pAddon->PreProcess(&m_addons_PreProc[i].handle, m_addons_PreProc[i].iAddonModeNumber, lastOutArray, array[togglePtr], frames);
     if (frames == 0)
       return false;
 
-    m_addons_PreProc[i].iLastTime += 1000 * 10000 * (CurrentHostCounter() - startTime) / hostFrequency;
+    m_addons_PreProc[i].AddTime(startTime, budget);
 
-    lastOutArray = m_processArray[togglePtr];
+    lastOutArray = array[togglePtr];
     togglePtr ^= 1;
   }
 
@@ -1341,17 +1598,15 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
    * Here a channel upmix/downmix for stereo surround sound can be performed
    * Only one DSP addon is allowed todo this!
    */
+  startTime = CurrentHostCounter();
+
   if (m_addons_MasterProc[m_activeMode].pAddon)
   {
-    startTime = CurrentHostCounter();
-
-    frames = m_addons_MasterProc[m_activeMode].pAddon->MasterProcess(&m_addons_MasterProc[m_activeMode].handle, lastOutArray, m_processArray[togglePtr], frames);
+    frames = m_addons_MasterProc[m_activeMode].pAddon->MasterProcess(&m_addons_MasterProc[m_activeMode].handle, lastOutArray, array[togglePtr], frames);
     if (frames == 0)
       return false;
 
-    m_addons_MasterProc[m_activeMode].iLastTime += 1000 * 10000 * (CurrentHostCounter() - startTime) / hostFrequency;
-
-    lastOutArray = m_processArray[togglePtr];
+    lastOutArray = array[togglePtr];
     togglePtr ^= 1;
   }
 
@@ -1362,10 +1617,8 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
    */
   if (m_resamplerDSPProcessor)
   {
-    startTime = CurrentHostCounter();
-
-    if (needDSPAddonsReinit)
-      SetFFMpegDSPProcessorArray(m_ffMpegProcessArray, lastOutArray, m_processArray[togglePtr]);
+    if (remap)
+      SetFFMpegDSPProcessorArray(m_ffMpegProcessArray, lastOutArray, array[togglePtr]);
 
     frames = m_resamplerDSPProcessor->Resample((uint8_t**)m_ffMpegProcessArray[FFMPEG_PROC_ARRAY_OUT], frames, (uint8_t**)m_ffMpegProcessArray[FFMPEG_PROC_ARRAY_IN], frames, 1.0);
     if (frames <= 0)
@@ -1374,12 +1627,22 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
       return false;
     }
 
-    m_addons_MasterProc[m_activeMode].iLastTime += 1000 * 10000 * (CurrentHostCounter() - startTime) / hostFrequency;
-
-    lastOutArray = m_processArray[togglePtr];
+    lastOutArray = array[togglePtr];
     togglePtr ^= 1;
   }
 
+  /* master mode and channel mixing share one budget */
+  if (m_addons_MasterProc[m_activeMode].pAddon || m_resamplerDSPProcessor)
+    m_addons_MasterProc[m_activeMode].AddTime(startTime, budget);
+
+  return true;
+}
+
+bool CActiveAEDSPProcess::ProcessOutput(CSampleBuffer *out, unsigned int frames, unsigned int togglePtr, int64_t timestamp, bool remap, uint64_t budget)
+{
+  int64_t startTime;
+  float **lastOutArray = m_processArray[togglePtr ^ 1];
+
   /**
    * DSP post processing
    * On the post processing can be things performed with additional channel upmix like 6.1 to 7.1
@@ -1394,7 +1657,7 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
     if (frames == 0)
       return false;
 
-    m_addons_PostProc[i].iLastTime += 1000 * 10000 * (CurrentHostCounter() - startTime) / hostFrequency;
+    m_addons_PostProc[i].AddTime(startTime, budget);
 
     lastOutArray = m_processArray[togglePtr];
     togglePtr ^= 1;
@@ -1413,7 +1676,7 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
     if (frames == 0)
       return false;
 
-    m_addon_OutputResample.iLastTime += 1000 * 10000 * (CurrentHostCounter() - startTime) / hostFrequency;
+    m_addon_OutputResample.AddTime(startTime, budget);
 
     lastOutArray = m_processArray[togglePtr];
     togglePtr ^= 1;
@@ -1422,7 +1685,7 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
   /**
    * Setup ffmpeg convert array for output stream, performed here to now last array
    */
-  if (needDSPAddonsReinit)
+  if (remap)
     SetFFMpegDSPProcessorArray(m_ffMpegConvertArray, NULL, lastOutArray);
 
   /**
@@ -1434,16 +1697,29 @@ bool CActiveAEDSPProcess::Process(CSampleBuffer *in, CSampleBuffer *out)
     return false;
   }
   out->pkt->nb_samples = frames;
-
-  /**
-   * Update cpu process percent usage values for modes and total (every second)
-   */
-  if (iTime >= m_iLastProcessTime + 1000*10000)
-    CalculateCPUUsage(iTime);
+  out->timestamp       = timestamp;
 
   return true;
 }
 
+unsigned int CActiveAEDSPProcess::GetFrontModes() const
+{
+  unsigned int modes = m_addons_PreProc.size();
+  if (m_addon_InputResample.pAddon)
+    modes++;
+  if (m_addons_MasterProc[m_activeMode].pAddon || m_resamplerDSPProcessor)
+    modes++;
+  return modes;
+}
+
+unsigned int CActiveAEDSPProcess::GetBackModes() const
+{
+  unsigned int modes = m_addons_PostProc.size();
+  if (m_addon_OutputResample.pAddon)
+    modes++;
+  return modes;
+}
+
 bool CActiveAEDSPProcess::RecheckProcessArray(unsigned int inputFrames)
 {
   /* Check for big enough array */
@@ -1518,6 +1794,8 @@ bool CActiveAEDSPProcess::ReallocProcessArray(unsigned int requestSize)
 void CActiveAEDSPProcess::CalculateCPUUsage(uint64_t iTime)
 {
   int64_t iUsage = CThread::GetCurrentThread()->GetAbsoluteUsage();
+  if (m_pipeline)
+    iUsage += m_pipeline->GetAbsoluteUsage();
 
   if (iTime != m_iLastProcessTime)
   {
@@ -1530,40 +1808,33 @@ void CActiveAEDSPProcess::CalculateCPUUsage(uint64_t iTime)
     float dTFactor = 100.0f / (float)(iTime - m_iLastProcessTime);
 
     if(m_addon_InputResample.pMode)
-    {
-      m_addon_InputResample.pMode->SetCPUUsage((float)(m_addon_InputResample.iLastTime)*dTFactor);
-      m_addon_InputResample.iLastTime = 0;
-    }
+      UpdateModeUsage(m_addon_InputResample, dTFactor);
 
     for (unsigned int i = 0; i < m_addons_PreProc.size(); ++i)
-    {
-      m_addons_PreProc[i].pMode->SetCPUUsage((float)(m_addons_PreProc[i].iLastTime)*dTFactor);
-      m_addons_PreProc[i].iLastTime = 0;
-    }
+      UpdateModeUsage(m_addons_PreProc[i], dTFactor);
 
     if (m_addons_MasterProc[m_activeMode].pMode)
-    {
-      m_addons_MasterProc[m_activeMode].pMode->SetCPUUsage((float)(m_addons_MasterProc[m_activeMode].iLastTime)*dTFactor);
-      m_addons_MasterProc[m_activeMode].iLastTime = 0;
-    }
+      UpdateModeUsage(m_addons_MasterProc[m_activeMode], dTFactor);
 
     for (unsigned int i = 0; i < m_addons_PostProc.size(); ++i)
-    {
-      m_addons_PostProc[i].pMode->SetCPUUsage((float)(m_addons_PostProc[i].iLastTime)*dTFactor);
-      m_addons_PostProc[i].iLastTime = 0;
-    }
+      UpdateModeUsage(m_addons_PostProc[i], dTFactor);
 
     if (m_addon_OutputResample.pMode)
-    {
-      m_addon_OutputResample.pMode->SetCPUUsage((float)(m_addon_OutputResample.iLastTime)*dTFactor);
-      m_addon_OutputResample.iLastTime = 0;
-    }
+      UpdateModeUsage(m_addon_OutputResample, dTFactor);
   }
 
+  m_iLastOverruns     = m_iOverruns + (m_pipeline ? m_pipeline->GetOverruns() : 0);
   m_iLastProcessUsage = iUsage;
   m_iLastProcessTime  = iTime;
 }
 
+void CActiveAEDSPProcess::UpdateModeUsage(sDSPProcessHandle &mode, float dTFactor)
+{
+  mode.pMode->SetCPUUsage((float)(mode.iLastTime)*dTFactor);
+  mode.pMode->SetTiming((float)mode.iBudget / 10000.0f, mode.iOverruns);
+  mode.iLastTime = 0;
+}
+
 void CActiveAEDSPProcess::SetFFMpegDSPProcessorArray(float *array_ffmpeg[2][AE_DSP_CH_MAX], float **array_in, float **array_out)
 {
   /*!
@@ -1647,6 +1918,10 @@ float CActiveAEDSPProcess::GetDelay()
   if (m_addon_OutputResample.pAddon)
     delay += m_addon_OutputResample.pAddon->OutputResampleGetDelay(&m_addon_OutputResample.handle);
 
+  /* the packet held by the pipeline */
+  if (m_frontPending)
+    delay += (float)m_frontDuration / (1000 * 10000);
+
   return delay;
 }
 
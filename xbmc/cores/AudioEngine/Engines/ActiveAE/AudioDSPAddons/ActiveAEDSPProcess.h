@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "ActiveAEDSP.h"
+#include "utils/TimeUtils.h"
 
 extern "C" {
 #include "libavcodec/avcodec.h"
@@ -124,6 +125,18 @@ namespace ActiveAE
        */
       float GetCPUUsage(void) const;
 
+      /*!>
+       * Get how often the process chain took longer than the played time of a packet
+       * @return The amount of overruns since the chain was set up
+       */
+      unsigned int GetOverruns(void) const;
+
+      /*!>
+       * Check if the stages up to master processing run on their own thread
+       * @return true if the process chain is pipelined
+       */
+      bool IsPipelined(void) const;
+
       /*!>
        * Get the channel layout which is passed out from it
        * @return Channel information class
@@ -232,12 +245,18 @@ namespace ActiveAE
 
       /*!>
        * Master processing
-       * @param in the ActiveAE input samples
-       * @param out the processed ActiveAE output samples
-       * @return true if processing becomes performed correct
+       * @param in the ActiveAE input samples, NULL to drain a pipelined chain
+       * @param out the processed ActiveAE output samples, the timestamp becomes set
+       * @return true if processing becomes performed correct and out holds samples
+       * @note if pipelined out holds the packet passed in on the call before
        */
       bool Process(CSampleBuffer *in, CSampleBuffer *out);
 
+      /*!>
+       * Drop the packet held in a pipelined chain
+       */
+      void Flush();
+
       /*!>
        * Returns the time in seconds that it will take
        * for the next added packet to be heard from the speakers.
@@ -246,6 +265,9 @@ namespace ActiveAE
       float GetDelay();
     //@}
     private:
+      class CPipeline;
+      struct sDSPProcessHandle;
+
     //@{
       /*!
        * Helper functions
@@ -262,6 +284,13 @@ namespace ActiveAE
       bool ReallocProcessArray(unsigned int requestSize);
       void CalculateCPUUsage(uint64_t iTime);
       void SetFFMpegDSPProcessorArray(float *array_ffmpeg[2][AE_DSP_CH_MAX], float **array_in, float **array_out);
+      bool ProcessFront(float *array[2][AE_DSP_CH_MAX], unsigned int &frames, unsigned int &togglePtr, bool remap, uint64_t budget);
+      bool ProcessOutput(CSampleBuffer *out, unsigned int frames, unsigned int togglePtr, int64_t timestamp, bool remap, uint64_t budget);
+      bool TakeFrontPacket(unsigned int &frames, int64_t &timestamp, uint64_t &duration);
+      unsigned int GetFrontModes() const;
+      unsigned int GetBackModes() const;
+      void StopPipeline();
+      void UpdateModeUsage(sDSPProcessHandle &mode, float dTFactor);
     //@}
     //@{
       /*!
@@ -300,12 +329,24 @@ namespace ActiveAE
         {
           iAddonModeNumber = -1;
           iLastTime        = 0;
+          iBudget          = 0;
+          iOverruns        = 0;
+        }
+        void AddTime(int64_t startTime, uint64_t budget)
+        {
+          uint64_t time = 1000 * 10000 * (CurrentHostCounter() - startTime) / CurrentHostFrequency();
+          iLastTime += time;
+          iBudget    = budget;
+          if (time > budget)
+            iOverruns++;
         }
         unsigned int        iAddonModeNumber;                       /*!< The identifier, send from addon during mode registration and can be used from addon to select mode from a function table */
         CActiveAEDSPModePtr pMode;                                  /*!< Processing mode information data */
         AE_DSP_ADDON        pAddon;                                 /*!< Addon control class */
         ADDON_HANDLE_STRUCT handle;
         uint64_t            iLastTime;                              /*!< last processing time of the mode */
+        uint64_t            iBudget;                                /*!< the time the mode may take for one packet */
+        unsigned int        iOverruns;                              /*!< how often the mode took longer than its budget */
       };
       std::vector <sDSPProcessHandle>   m_addons_InputProc;         /*!< Input processing list, called to all enabled dsp addons with the basic unchanged input stream, is read only. */
       sDSPProcessHandle                 m_addon_InputResample;      /*!< Input stream resampling over one on settings enabled input resample function only on one addon */
@@ -331,6 +372,25 @@ namespace ActiveAE
       uint64_t                          m_iLastProcessUsage;
       float                             m_fLastProcessUsage;
 
+      /*!>
+       * Timing budget, the time of a packet is shared by all modes on a thread
+       */
+      unsigned int                      m_iOverruns;                /*!< how often the chain on the calling thread took longer than the packet time */
+      unsigned int                      m_iLastOverruns;            /*!< overruns of all threads as of the last cpu usage update */
+
+      /*!>
+       * Pipelined processing, the stages up to master processing run on a worker one packet ahead
+       */
+      bool                              m_pipelineEnabled;          /*!< pipelining requested by settings */
+      CPipeline                        *m_pipeline;                 /*!< the worker, NULL if all stages run on the calling thread */
+      float                            *m_frontArray[2][AE_DSP_CH_MAX]; /*!< process arrays of the worker */
+      unsigned int                      m_frontFrames;              /*!< frames the worker produced */
+      unsigned int                      m_frontTogglePtr;           /*!< the worker output is in m_frontArray[m_frontTogglePtr ^ 1] */
+      bool                              m_frontResult;              /*!< false if the worker failed on its packet */
+      bool                              m_frontPending;             /*!< a packet was handed to the worker and not passed out yet */
+      int64_t                           m_frontTimestamp;           /*!< timestamp of the packet handed to the worker */
+      uint64_t                          m_frontDuration;            /*!< played time of the packet handed to the worker, in 100ns */
+
       /*!>
        * Internal ffmpeg process data
        */
@@ -38,6 +38,7 @@ class IAEPacketizer;
 class IAudioCallback;
 class IAEClockCallback;
 class CAEStreamInfo;
+class CAEEngineCounters;
 
 /* sound options */
 #define AE_SOUND_OFF    0 /* disable sounds */
@@ -266,6 +267,14 @@ public:
    */
   virtual bool GetCurrentSinkFormat(AEAudioFormat &SinkFormat) { return false; }
 
+  /**
+   * Get the performance counters of the engine
+   *
+   * @param output true for the additional outputs fed by this engine
+   * @return Returns nullptr if the engine does not keep counters.
+   */
+  virtual CAEEngineCounters *GetCounters(bool output = false) { return nullptr; }
+
 protected:
   bool m_bAudio2;
   bool m_bDisabled;
@@ -38,6 +38,7 @@ public:
     The sink does NOT have to honour anything in the format struct or the device
     if however it does not honour what is requested, it MUST update device/format
     with what it does support.
+    A non zero m_frames asks for a period of that many frames, 0 leaves it to the sink.
   */
   virtual bool Initialize  (AEAudioFormat &format, std::string &device) = 0;
 
@@ -65,6 +66,14 @@ public:
   */
   virtual unsigned int AddPackets(uint8_t **data, unsigned int frames, unsigned int offset) = 0;
 
+  /*!
+   * @brief Block until the device can take more frames, used when AddPackets did not consume anything
+   * @param millis max time to wait
+   * @return true once the device can take frames, false if it still can't when millis ran out
+   *         or if the sink can't wait for its device
+   */
+  virtual bool WaitReady(unsigned int millis) { return false; };
+
   /*!
    * @brief instruct the sink to add a pause
    * @param millis ms to pause
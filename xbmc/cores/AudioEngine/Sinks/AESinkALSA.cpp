@@ -95,7 +95,8 @@ CAESinkALSA::CAESinkALSA() :
   m_pcm(NULL),
   m_timeout(0),
   m_fragmented(false),
-  m_originalPeriodSize(AE_MIN_PERIODSIZE)
+  m_originalPeriodSize(AE_MIN_PERIODSIZE),
+  m_mmap(false)
 {
   /* ensure that ALSA has been initialized */
   if (!snd_config)
@@ -515,6 +516,8 @@ bool CAESinkALSA::Initialize(AEAudioFormat &format, std::string &device)
   ALSAConfig inconfig, outconfig;
   inconfig.format = format.m_dataFormat;
   inconfig.sampleRate = format.m_sampleRate;
+  // a period requested by the engine, bitstreams keep the defaults
+  inconfig.periodSize = format.m_dataFormat != AE_FMT_RAW ? format.m_frames : 0;
 
   /*
    * We can't use the better GetChannelLayout() at this point as the device
@@ -590,7 +593,14 @@ bool CAESinkALSA::Initialize(AEAudioFormat &format, std::string &device)
   }
 #endif
 
-  if (!InitializeHW(inconfig, outconfig) || !InitializeSW(outconfig))
+  bool hwInit = InitializeHW(inconfig, outconfig, g_advancedSettings.m_audioAlsaMmap);
+  if (!hwInit && m_mmap)
+  {
+    CLog::Log(LOGINFO, "CAESinkALSA::Initialize - mmap access failed, trying writei");
+    hwInit = InitializeHW(inconfig, outconfig, false);
+  }
+
+  if (!hwInit || !InitializeSW(outconfig))
   {
 #ifdef SND_CHMAP_API_VERSION
     free(selectedChmap);
@@ -659,7 +669,7 @@ snd_pcm_format_t CAESinkALSA::AEFormatToALSAFormat(const enum AEDataFormat forma
   }
 }
 
-bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig)
+bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig, bool mmap)
 {
   snd_pcm_hw_params_t *hw_params;
 
@@ -667,7 +677,11 @@ bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig
   memset(hw_params, 0, snd_pcm_hw_params_sizeof());
 
   snd_pcm_hw_params_any(m_pcm, hw_params);
-  snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+
+  /* prefer copying into the ring buffer ourselves, saves the copy of writei */
+  m_mmap = mmap && snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+  if (!m_mmap)
+    snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
 
   unsigned int sampleRate   = inconfig.sampleRate;
   snd_pcm_hw_params_set_rate_near    (m_pcm, hw_params, &sampleRate, NULL);
@@ -756,6 +770,13 @@ bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig
   */
   periodSize  = std::min(periodSize, (snd_pcm_uframes_t) sampleRate / 20);
   bufferSize  = std::min(bufferSize, (snd_pcm_uframes_t) sampleRate / 5);
+
+  /* a shorter period was requested, keep the 4 periods per buffer */
+  if (inconfig.periodSize > 0 && inconfig.periodSize < periodSize)
+  {
+    periodSize = std::max((snd_pcm_uframes_t) inconfig.periodSize, (snd_pcm_uframes_t) AE_MIN_PERIODSIZE);
+    bufferSize = std::min(bufferSize, periodSize * 4);
+  }
   
   /* 
    According to upstream we should set buffer size first - so make sure it is always at least
@@ -824,7 +845,8 @@ bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig
     }
   }
   
-  CLog::Log(LOGDEBUG, "CAESinkALSA::InitializeHW - Got: periodSize %lu, bufferSize %lu", periodSize, bufferSize);
+  CLog::Log(LOGDEBUG, "CAESinkALSA::InitializeHW - Got: periodSize %lu, bufferSize %lu, access %s",
+            periodSize, bufferSize, m_mmap ? "mmap" : "writei");
 
   /* set the format parameters */
   outconfig.sampleRate   = sampleRate;
@@ -938,18 +960,18 @@ unsigned int CAESinkALSA::AddPackets(uint8_t **data, unsigned int frames, unsign
     else // take care as we can come here a second time if the sink does not eat all data
       amount = (unsigned int) data_left;
 
-    int ret = snd_pcm_writei(m_pcm, buffer, amount);
+    int ret = Write(buffer, amount);
     if (ret < 0)
     {
-      CLog::Log(LOGERROR, "CAESinkALSA - snd_pcm_writei(%d) %s - trying to recover", ret, snd_strerror(ret));
+      CLog::Log(LOGERROR, "CAESinkALSA - write(%d) %s - trying to recover", ret, snd_strerror(ret));
       ret = snd_pcm_recover(m_pcm, ret, 1);
       if(ret < 0)
       {
-        HandleError("snd_pcm_writei(1)", ret);
-        ret = snd_pcm_writei(m_pcm, buffer, amount);
+        HandleError("write(1)", ret);
+        ret = Write(buffer, amount);
         if (ret < 0)
         {
-          HandleError("snd_pcm_writei(2)", ret);
+          HandleError("write(2)", ret);
           ret = 0;
         }
       }
@@ -968,6 +990,64 @@ unsigned int CAESinkALSA::AddPackets(uint8_t **data, unsigned int frames, unsign
   return frames_written;
 }
 
+bool CAESinkALSA::WaitReady(unsigned int millis)
+{
+  if (!m_pcm)
+    return false;
+
+  // polls the descriptors of the device, errors are left to the next write
+  return snd_pcm_wait(m_pcm, millis) > 0;
+}
+
+int CAESinkALSA::Write(void *buffer, unsigned int frames)
+{
+  if (m_mmap)
+    return MmapWrite((const uint8_t*)buffer, frames);
+  return snd_pcm_writei(m_pcm, buffer, frames);
+}
+
+int CAESinkALSA::MmapWrite(const uint8_t *buffer, unsigned int frames)
+{
+  // blocks like writei, errors are only returned if nothing was written
+  unsigned int written = 0;
+  while (written < frames)
+  {
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(m_pcm);
+    if (avail < 0)
+      return written ? written : avail;
+
+    if (avail == 0)
+    {
+      // a full ring buffer has to be started before it frees up
+      if (snd_pcm_state(m_pcm) == SND_PCM_STATE_PREPARED)
+        snd_pcm_start(m_pcm);
+      int ret = snd_pcm_wait(m_pcm, m_timeout);
+      if (ret < 0)
+        return written ? written : ret;
+      else if (ret == 0)
+        break;
+      continue;
+    }
+
+    const snd_pcm_channel_area_t *areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t size = std::min((snd_pcm_uframes_t)avail, (snd_pcm_uframes_t)(frames - written));
+    int ret = snd_pcm_mmap_begin(m_pcm, &areas, &offset, &size);
+    if (ret < 0)
+      return written ? written : ret;
+
+    // interleaved, all channels share the first area and a step is one frame
+    uint8_t *dst = (uint8_t*)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+    memcpy(dst, buffer + written * m_format.m_frameSize, size * m_format.m_frameSize);
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_pcm, offset, size);
+    if (committed < 0)
+      return written ? written : committed;
+    written += committed;
+  }
+  return written;
+}
+
 void CAESinkALSA::HandleError(const char* name, int err)
 {
   switch(err)
@@ -992,7 +1072,7 @@ void CAESinkALSA::HandleError(const char* name, int err)
       break;
 
     default:
-      CLog::Log(LOGERROR, "CAESinkALSA::HandleError(%s) - snd_pcm_writei returned %d (%s)", name, err, snd_strerror(err));
+      CLog::Log(LOGERROR, "CAESinkALSA::HandleError(%s) - write returned %d (%s)", name, err, snd_strerror(err));
       break;
   }
 }
@@ -52,6 +52,7 @@ public:
   virtual void         GetDelay        (AEDelayStatus& status);
   virtual double       GetCacheTotal   ();
   virtual unsigned int AddPackets      (uint8_t **data, unsigned int frames, unsigned int offset);
+  virtual bool         WaitReady       (unsigned int millis);
   virtual void         Drain           ();
 
   static void EnumerateDevicesEx(AEDeviceInfoList &list, bool force = false);
@@ -74,6 +75,8 @@ private:
 
   void           GetAESParams(const AEAudioFormat& format, std::string& params);
   void           HandleError(const char* name, int err);
+  int            Write(void *buffer, unsigned int frames);
+  int            MmapWrite(const uint8_t *buffer, unsigned int frames);
 
   std::string       m_initDevice;
   AEAudioFormat     m_initFormat;
@@ -87,6 +90,8 @@ private:
   // support fragmentation, e.g. looping in the sink to get a certain amount of data onto the device
   bool              m_fragmented;
   unsigned int      m_originalPeriodSize;
+  // samples are copied straight into the ring buffer of the device
+  bool              m_mmap;
 
 #if HAVE_LIBUDEV
   static CALSADeviceMonitor m_deviceMonitor;
@@ -104,7 +109,7 @@ private:
 
   static snd_pcm_format_t AEFormatToALSAFormat(const enum AEDataFormat format);
 
-  bool InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig);
+  bool InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig, bool mmap);
   bool InitializeSW(const ALSAConfig &inconfig);
 
   static void AppendParams(std::string &device, const std::string &params);
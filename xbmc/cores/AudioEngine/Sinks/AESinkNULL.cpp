@@ -22,9 +22,11 @@
 
 #include <stdint.h>
 #include <limits.h>
+#include <algorithm>
 
 #include "AESinkNULL.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
 CAESinkNULL::CAESinkNULL()
@@ -33,6 +35,7 @@ CAESinkNULL::CAESinkNULL()
     m_sink_frameSize(0),
     m_sinkbuffer_size(0),
     m_sinkbuffer_level(0),
+    m_sinkbuffer_chunk(0),
     m_sinkbuffer_sec_per_byte(0)
 {
 }
@@ -43,19 +46,32 @@ CAESinkNULL::~CAESinkNULL()
 
 bool CAESinkNULL::Initialize(AEAudioFormat &format, std::string &device)
 {
+  // a requested period gets a buffer of 4 periods drained a period at a time
+  unsigned int requested = format.m_dataFormat != AE_FMT_RAW ? format.m_frames : 0;
+
   // setup for a 250ms sink feed from SoftAE 
   format.m_dataFormat    = (format.m_dataFormat == AE_FMT_RAW) ? AE_FMT_S16NE : AE_FMT_FLOAT;
   format.m_frames        = format.m_sampleRate / 1000 * 250;
+  if (requested > 0 && requested < format.m_frames)
+    format.m_frames      = requested;
   format.m_frameSize     = format.m_channelLayout.Count() * (CAEUtil::DataFormatToBits(format.m_dataFormat) >> 3);
   m_format = format;
 
   // setup a pretend 500ms internal buffer
   m_sink_frameSize = format.m_channelLayout.Count() * CAEUtil::DataFormatToBits(format.m_dataFormat) >> 3;
   m_sinkbuffer_size = m_sink_frameSize * format.m_sampleRate / 2;
+  // pretend we have a 64k audio buffer
+  m_sinkbuffer_chunk = 64 * 1024;
+  if (requested > 0 && requested == format.m_frames)
+  {
+    m_sinkbuffer_size = std::min(m_sinkbuffer_size, 4 * format.m_frames * m_sink_frameSize);
+    m_sinkbuffer_chunk = std::min(m_sinkbuffer_chunk, format.m_frames * m_sink_frameSize);
+  }
   m_sinkbuffer_sec_per_byte = 1.0 / (double)(m_sink_frameSize * format.m_sampleRate);
 
   m_draining = false;
   m_wake.Reset();
+  m_space.Reset();
   m_inited.Reset();
   Create();
   if (!m_inited.WaitMSec(100))
@@ -100,6 +116,17 @@ unsigned int CAESinkNULL::AddPackets(uint8_t **data, unsigned int frames, unsign
   return frames;
 }
 
+bool CAESinkNULL::WaitReady(unsigned int millis)
+{
+  XbmcThreads::EndTime timer(millis);
+  while (m_sinkbuffer_level + m_sink_frameSize > m_sinkbuffer_size)
+  {
+    if (!m_space.WaitMSec(timer.MillisLeft()))
+      return false;
+  }
+  return true;
+}
+
 void CAESinkNULL::Drain()
 {
   m_draining = true;
@@ -128,18 +155,18 @@ void CAESinkNULL::Process()
       //! @todo is it correct to not take data at the appropriate rate while draining?
       m_sinkbuffer_level = 0;
       m_draining = false;
+      m_space.Set();
     }
 
-    // pretend we have a 64k audio buffer
-    unsigned int min_buffer_size = 64 * 1024;
     unsigned int read_bytes = m_sinkbuffer_level;
-    if (read_bytes > min_buffer_size)
-      read_bytes = min_buffer_size;
+    if (read_bytes > m_sinkbuffer_chunk)
+      read_bytes = m_sinkbuffer_chunk;
 
     if (read_bytes > 0)
     {
       // drain it
       m_sinkbuffer_level -= read_bytes;
+      m_space.Set();
 
       // we MUST drain at the correct audio sample rate
       // or the NULL sink will not work right. So calc
@@ -37,6 +37,7 @@ public:
   virtual void         GetDelay        (AEDelayStatus& status);
   virtual double       GetCacheTotal   ();
   virtual unsigned int AddPackets      (uint8_t **data, unsigned int frames, unsigned int offset);
+  virtual bool         WaitReady       (unsigned int millis);
   virtual void         Drain           ();
 
   static void          EnumerateDevices(AEDeviceList &devices, bool passthrough);
@@ -44,11 +45,13 @@ private:
   virtual void         Process();
 
   CEvent               m_wake;
+  CEvent               m_space;            ///< set when the buffer was drained a bit
   CEvent               m_inited;
   volatile bool        m_draining;
   AEAudioFormat        m_format;
   unsigned int         m_sink_frameSize;
   unsigned int         m_sinkbuffer_size;  ///< total size of the buffer
   unsigned int         m_sinkbuffer_level; ///< current level in the buffer
+  unsigned int         m_sinkbuffer_chunk; ///< drained at once
   double               m_sinkbuffer_sec_per_byte;
 };
@@ -23,6 +23,7 @@
 #include "utils/log.h"
 #include "Util.h"
 #include "utils/TimeUtils.h"
+#include "threads/SystemClock.h"
 #include "guilib/LocalizeStrings.h"
 #include "Application.h"
 
@@ -206,6 +207,12 @@ static void StreamLatencyUpdateCallback(pa_stream *s, void *userdata)
   pa_threaded_mainloop_signal(m, 0);
 }
 
+static void WaitReadyTimeCallback(pa_mainloop_api *api, pa_time_event *e, const struct timeval *tv, void *userdata)
+{
+  pa_threaded_mainloop *m = (pa_threaded_mainloop *)userdata;
+  pa_threaded_mainloop_signal(m, 0);
+}
+
 
 static void SinkInputInfoCallback(pa_context *c, const pa_sink_input_info *i, int eol, void *userdata)
 {
@@ -892,6 +899,37 @@ unsigned int CAESinkPULSE::AddPackets(uint8_t **data, unsigned int frames, unsig
   return res;
 }
 
+bool CAESinkPULSE::WaitReady(unsigned int millis)
+{
+  if (!m_IsAllocated)
+    return false;
+
+  pa_threaded_mainloop_lock(m_MainLoop);
+  bool ready = pa_stream_writable_size(m_Stream) >= m_periodSize;
+  if (!ready && millis > 0)
+  {
+    // the write callback signals the mainloop whenever the server requests data,
+    // a timer on the same clock wakes us up if there was no request in time
+    pa_usec_t end = pa_rtclock_now() + (pa_usec_t)millis * PA_USEC_PER_MSEC;
+    pa_time_event *timeout = pa_context_rttime_new(m_Context, end, WaitReadyTimeCallback, m_MainLoop);
+    if (timeout)
+    {
+      while (!ready && pa_rtclock_now() < end &&
+             pa_stream_get_state(m_Stream) == PA_STREAM_READY)
+      {
+        pa_threaded_mainloop_wait(m_MainLoop);
+        ready = pa_stream_writable_size(m_Stream) >= m_periodSize;
+      }
+      pa_threaded_mainloop_get_api(m_MainLoop)->time_free(timeout);
+    }
+    else
+      CLog::Log(LOGERROR, "CAESinkPULSE::WaitReady - failed to create timer");
+  }
+  pa_threaded_mainloop_unlock(m_MainLoop);
+
+  return ready;
+}
+
 void CAESinkPULSE::Drain()
 {
   if (!m_IsAllocated)
@@ -43,6 +43,7 @@ public:
   virtual void         GetDelay        (AEDelayStatus& status);
   virtual double       GetCacheTotal   ();
   virtual unsigned int AddPackets      (uint8_t **data, unsigned int frames, unsigned int offset);
+  virtual bool         WaitReady       (unsigned int millis);
   virtual void         Drain           ();
 
   virtual bool HasVolume() { return true; };
@@ -0,0 +1,163 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBufferProfile.h"
+#include "cores/AudioEngine/Sinks/AESinkNULL.h"
+#include "cores/AudioEngine/Utils/AEEngineCounters.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+class TestAESinkNULL : public ::testing::Test
+{
+protected:
+  TestAESinkNULL() : m_open(false) {}
+
+  virtual void TearDown()
+  {
+    if (m_open)
+      m_sink.Deinitialize();
+  }
+
+  // period 0 leaves it to the sink
+  void Open(unsigned int period = 0)
+  {
+    m_format.m_dataFormat = AE_FMT_FLOAT;
+    m_format.m_sampleRate = 48000;
+    m_format.m_channelLayout = AE_CH_LAYOUT_2_0;
+    m_format.m_frames = period;
+    ASSERT_TRUE(m_sink.Initialize(m_format, m_device));
+    m_buffer.resize(m_format.m_frames * m_format.m_frameSize);
+    m_open = true;
+  }
+
+  // opens the sink the way the engine does for the given profile
+  void Configure(const ActiveAE::AEBufferProfile &profile)
+  {
+    m_format.m_dataFormat = AE_FMT_FLOAT;
+    m_format.m_sampleRate = 48000;
+    m_format.m_channelLayout = AE_CH_LAYOUT_2_0;
+    m_format.m_frames = 0;
+    profile.ApplyToRequest(m_format);
+    ASSERT_TRUE(m_sink.Initialize(m_format, m_device));
+    profile.LimitBuffer(m_format);
+    m_open = true;
+  }
+
+  // fills the pretend device buffer, returns the number of periods it took
+  unsigned int Fill()
+  {
+    uint8_t *data = m_buffer.data();
+    unsigned int periods = 0;
+    while (m_sink.AddPackets(&data, m_format.m_frames, 0) > 0)
+      periods++;
+    return periods;
+  }
+
+  CAESinkNULL m_sink;
+  AEAudioFormat m_format;
+  std::string m_device;
+  std::vector<uint8_t> m_buffer;
+  bool m_open;
+};
+
+TEST_F(TestAESinkNULL, WaitReadyReturnsWhenDrained)
+{
+  Open();
+  EXPECT_GT(Fill(), 0u);
+
+  // the drain thread makes room well within the bound
+  EXPECT_TRUE(m_sink.WaitReady(10000));
+
+  uint8_t *data = m_buffer.data();
+  EXPECT_GT(m_sink.AddPackets(&data, m_format.m_frames, 0), 0u);
+}
+
+TEST_F(TestAESinkNULL, WaitReadyWithRoom)
+{
+  Open();
+  // nothing queued, ready without waiting at all
+  EXPECT_TRUE(m_sink.WaitReady(0));
+}
+
+TEST_F(TestAESinkNULL, WaitReadyTimesOut)
+{
+  Open();
+  // without the drain thread the buffer stays full
+  m_sink.Deinitialize();
+  m_open = false;
+  EXPECT_GT(Fill(), 0u);
+
+  EXPECT_FALSE(m_sink.WaitReady(10));
+  uint8_t *data = m_buffer.data();
+  EXPECT_EQ(0u, m_sink.AddPackets(&data, m_format.m_frames, 0));
+}
+
+TEST_F(TestAESinkNULL, RequestedPeriod)
+{
+  // 10ms as asked for by the low latency profile
+  Open(480);
+  EXPECT_EQ(480u, m_format.m_frames);
+  EXPECT_NEAR(0.04, m_sink.GetCacheTotal(), 0.001);
+}
+
+TEST_F(TestAESinkNULL, LowLatencyProfile)
+{
+  const ActiveAE::AEBufferProfile &profile = ActiveAE::AEBufferProfile::Get(true);
+  Configure(profile);
+
+  // 10ms periods, a device buffer of four of them
+  EXPECT_EQ(480u, m_format.m_frames);
+  EXPECT_DOUBLE_EQ(0.04, m_sink.GetCacheTotal());
+  EXPECT_EQ(0u, profile.GetLimits(m_format, m_sink.GetCacheTotal(), false, false));
+  EXPECT_DOUBLE_EQ(0.08, profile.GetTarget());
+}
+
+TEST_F(TestAESinkNULL, NormalProfile)
+{
+  const ActiveAE::AEBufferProfile &profile = ActiveAE::AEBufferProfile::Get(false);
+  Configure(profile);
+
+  // the sink picks 250ms, the engine cuts that down to its buffer time
+  EXPECT_EQ(4800u, m_format.m_frames);
+  EXPECT_DOUBLE_EQ(0.5, m_sink.GetCacheTotal());
+  EXPECT_EQ(0u, profile.GetLimits(m_format, m_sink.GetCacheTotal(), false, false));
+}
+
+TEST_F(TestAESinkNULL, LowLatencyProfileLimits)
+{
+  const ActiveAE::AEBufferProfile &profile = ActiveAE::AEBufferProfile::Get(true);
+  AEAudioFormat format;
+  format.m_dataFormat = AE_FMT_FLOAT;
+  format.m_sampleRate = 48000;
+  format.m_frames = 4800;
+
+  // a sink that ignores the requested period is reported
+  EXPECT_EQ(1u << CAEEngineCounters::LIMIT_SINK_PERIOD | 1u << CAEEngineCounters::LIMIT_DEVICE_BUFFER,
+            profile.GetLimits(format, 0.5, false, false));
+
+  // passthrough keeps its own period
+  format.m_dataFormat = AE_FMT_RAW;
+  profile.ApplyToRequest(format);
+  EXPECT_EQ(4800u, format.m_frames);
+  EXPECT_FALSE(profile.LimitBuffer(format));
+  EXPECT_EQ(1u << CAEEngineCounters::LIMIT_PASSTHROUGH, profile.GetLimits(format, 0.04, false, false));
+}
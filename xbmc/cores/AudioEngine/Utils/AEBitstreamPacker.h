@@ -45,13 +45,9 @@ private:
   void PackDTSHD(CAEStreamInfo &info, uint8_t* data, int size);
   void PackEAC3(CAEStreamInfo &info, uint8_t* data, int size);
 
-  /* we keep the trueHD and dtsHD buffers seperate so that we can handle a fast stream switch */
-  uint8_t      *m_trueHD;
+  /* TrueHD and DTS-HD are assembled in m_packedBuffer, m_trueHDPos is the next unit of the MAT frame */
   unsigned int  m_trueHDPos;
 
-  uint8_t      *m_dtsHD;
-  unsigned int  m_dtsHDSize;
-
   uint8_t      *m_eac3;
   unsigned int  m_eac3Size;
   unsigned int  m_eac3FramesCount;
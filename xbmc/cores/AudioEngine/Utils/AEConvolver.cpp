@@ -0,0 +1,367 @@
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEConvolver.h"
+#include "AEKernels.h"
+#include "utils/log.h"
+#include "utils/rfft.h"
+
+#include <algorithm>
+#include <string.h>
+
+#define WAVE_FORMAT_PCM 0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+namespace
+{
+
+inline uint16_t Read16(const uint8_t *data)
+{
+  return data[0] | (data[1] << 8);
+}
+
+inline uint32_t Read32(const uint8_t *data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+float ReadSample(const uint8_t *data, unsigned int bits, bool isFloat)
+{
+  if (isFloat)
+  {
+    if (bits == 32)
+    {
+      uint32_t value = Read32(data);
+      float sample;
+      memcpy(&sample, &value, sizeof(sample));
+      return sample;
+    }
+    uint64_t value = Read32(data) | ((uint64_t)Read32(data + 4) << 32);
+    double sample;
+    memcpy(&sample, &value, sizeof(sample));
+    return (float)sample;
+  }
+
+  switch (bits)
+  {
+    case 16:
+      return (int16_t)Read16(data) / 32768.0f;
+    case 24:
+      return (int32_t)((data[0] << 8) | (data[1] << 16) | ((uint32_t)data[2] << 24)) / 2147483648.0f;
+    default:
+      return (int32_t)Read32(data) / 2147483648.0f;
+  }
+}
+
+}
+
+const unsigned int CAEConvolver::MAX_TAPS;
+const unsigned int CAEConvolver::MIN_BLOCK_SIZE;
+const unsigned int CAEConvolver::MAX_BLOCK_SIZE;
+
+CAEConvolver::CAEConvolver() :
+  m_blockSize(0),
+  m_bins(0),
+  m_partitions(0),
+  m_head(0),
+  m_pos(0)
+{
+}
+
+CAEConvolver::~CAEConvolver()
+{
+}
+
+unsigned int CAEConvolver::GetBlockSize(unsigned int taps)
+{
+  // partitions cost more than the fft, aim at ~64 of them
+  unsigned int size = MIN_BLOCK_SIZE;
+  while (size < MAX_BLOCK_SIZE && size * 64 < taps)
+    size <<= 1;
+  return size;
+}
+
+bool CAEConvolver::Init(const std::vector<std::vector<float> > &filters, unsigned int blockSize)
+{
+  Deinit();
+
+  unsigned int taps = 0;
+  for (auto &filter : filters)
+    taps = std::max(taps, (unsigned int)filter.size());
+  if (!taps)
+    return false;
+
+  taps = std::min(taps, MAX_TAPS);
+  m_blockSize = blockSize ? blockSize : GetBlockSize(taps);
+  m_bins = m_blockSize + 1;
+  m_partitions = (taps + m_blockSize - 1) / m_blockSize;
+  m_fft.reset(new RFFT(2 * m_blockSize));
+  m_accRe.resize(m_bins);
+  m_accIm.resize(m_bins);
+  m_spectrum.resize(2 * m_bins);
+
+  // transform the partitions of all filters once, the 1/n of the
+  // inverse transform goes into the filter as well
+  std::vector<float> segment(2 * m_blockSize);
+  kiss_fft_cpx *spectrum = reinterpret_cast<kiss_fft_cpx*>(m_spectrum.data());
+  float scale = 1.0f / (2 * m_blockSize);
+
+  m_channels.resize(filters.size());
+  for (unsigned int c = 0; c < filters.size(); c++)
+  {
+    Channel &channel = m_channels[c];
+    channel.filtered = !filters[c].empty();
+    channel.input.assign(m_blockSize, 0.0f);
+    channel.output.assign(m_blockSize, 0.0f);
+    if (!channel.filtered)
+      continue;
+
+    channel.time.assign(2 * m_blockSize, 0.0f);
+    channel.filterRe.resize(m_partitions * m_bins);
+    channel.filterIm.resize(m_partitions * m_bins);
+    channel.historyRe.assign(m_partitions * m_bins, 0.0f);
+    channel.historyIm.assign(m_partitions * m_bins, 0.0f);
+
+    unsigned int length = std::min((unsigned int)filters[c].size(), MAX_TAPS);
+    for (unsigned int p = 0; p < m_partitions; p++)
+    {
+      std::fill(segment.begin(), segment.end(), 0.0f);
+      unsigned int start = p * m_blockSize;
+      if (start < length)
+        std::copy(filters[c].begin() + start, filters[c].begin() + std::min(start + m_blockSize, length), segment.begin());
+
+      m_fft->forward(segment.data(), spectrum);
+      for (unsigned int k = 0; k < m_bins; k++)
+      {
+        channel.filterRe[p * m_bins + k] = spectrum[k].r * scale;
+        channel.filterIm[p * m_bins + k] = spectrum[k].i * scale;
+      }
+    }
+  }
+
+  CLog::Log(LOGDEBUG, "CAEConvolver::%s - %u channels, %u taps, %u partitions of %u frames",
+            __FUNCTION__, (unsigned int)m_channels.size(), taps, m_partitions, m_blockSize);
+  return true;
+}
+
+void CAEConvolver::Deinit()
+{
+  m_channels.clear();
+  m_fft.reset();
+  m_accRe.clear();
+  m_accIm.clear();
+  m_spectrum.clear();
+  m_blockSize = 0;
+  m_bins = 0;
+  m_partitions = 0;
+  m_head = 0;
+  m_pos = 0;
+}
+
+void CAEConvolver::Reset()
+{
+  for (auto &channel : m_channels)
+  {
+    std::fill(channel.input.begin(), channel.input.end(), 0.0f);
+    std::fill(channel.output.begin(), channel.output.end(), 0.0f);
+    std::fill(channel.time.begin(), channel.time.end(), 0.0f);
+    std::fill(channel.historyRe.begin(), channel.historyRe.end(), 0.0f);
+    std::fill(channel.historyIm.begin(), channel.historyIm.end(), 0.0f);
+  }
+  m_head = 0;
+  m_pos = 0;
+}
+
+void CAEConvolver::Process(float **data, unsigned int channels, unsigned int frames, bool planar)
+{
+  if (!IsActive())
+    return;
+
+  // channels beyond the filters pass unchanged but still count for the interleave
+  unsigned int filtered = std::min(channels, (unsigned int)m_channels.size());
+  unsigned int done = 0;
+  while (done < frames)
+  {
+    // stage the input and hand out the result of the previous block
+    unsigned int count = std::min(frames - done, m_blockSize - m_pos);
+    for (unsigned int c = 0; c < filtered; c++)
+    {
+      Channel &channel = m_channels[c];
+      if (planar)
+      {
+        float *samples = data[c] + done;
+        memcpy(channel.input.data() + m_pos, samples, count * sizeof(float));
+        memcpy(samples, channel.output.data() + m_pos, count * sizeof(float));
+      }
+      else
+      {
+        float *samples = data[0] + done * channels + c;
+        for (unsigned int i = 0; i < count; i++, samples += channels)
+        {
+          channel.input[m_pos + i] = *samples;
+          *samples = channel.output[m_pos + i];
+        }
+      }
+    }
+    done += count;
+    m_pos += count;
+
+    if (m_pos == m_blockSize)
+    {
+      for (auto &channel : m_channels)
+        ProcessBlock(channel);
+      m_head = (m_head + 1) % m_partitions;
+      m_pos = 0;
+    }
+  }
+}
+
+void CAEConvolver::ProcessBlock(Channel &channel)
+{
+  if (!channel.filtered)
+  {
+    channel.output.swap(channel.input);
+    return;
+  }
+
+  // the previous block followed by the current one
+  float *time = channel.time.data();
+  memcpy(time + m_blockSize, channel.input.data(), m_blockSize * sizeof(float));
+
+  kiss_fft_cpx *spectrum = reinterpret_cast<kiss_fft_cpx*>(m_spectrum.data());
+  m_fft->forward(time, spectrum);
+  float *historyRe = channel.historyRe.data() + m_head * m_bins;
+  float *historyIm = channel.historyIm.data() + m_head * m_bins;
+  for (unsigned int k = 0; k < m_bins; k++)
+  {
+    historyRe[k] = spectrum[k].r;
+    historyIm[k] = spectrum[k].i;
+  }
+
+  // partition p of the filter meets the input of p blocks ago
+  std::fill(m_accRe.begin(), m_accRe.end(), 0.0f);
+  std::fill(m_accIm.begin(), m_accIm.end(), 0.0f);
+  for (unsigned int p = 0; p < m_partitions; p++)
+  {
+    unsigned int slot = (m_head + m_partitions - p) % m_partitions;
+    CAEKernels::ComplexMulAdd(m_accRe.data(), m_accIm.data(),
+                              channel.historyRe.data() + slot * m_bins, channel.historyIm.data() + slot * m_bins,
+                              channel.filterRe.data() + p * m_bins, channel.filterIm.data() + p * m_bins,
+                              m_bins);
+  }
+
+  for (unsigned int k = 0; k < m_bins; k++)
+  {
+    spectrum[k].r = m_accRe[k];
+    spectrum[k].i = m_accIm[k];
+  }
+
+  // the first half is wrapped around, the second one is the result
+  m_fft->inverse(spectrum, time);
+  memcpy(channel.output.data(), time + m_blockSize, m_blockSize * sizeof(float));
+  memcpy(time, channel.input.data(), m_blockSize * sizeof(float));
+}
+
+bool CAEConvolver::ParseWAV(const uint8_t *data, unsigned int size, std::vector<std::vector<float> > &filters,
+                            unsigned int &sampleRate)
+{
+  filters.clear();
+  if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+  {
+    CLog::Log(LOGERROR, "CAEConvolver::%s - not a RIFF WAVE file", __FUNCTION__);
+    return false;
+  }
+
+  unsigned int channels = 0;
+  unsigned int bits = 0;
+  unsigned int blockAlign = 0;
+  bool isFloat = false;
+  const uint8_t *samples = NULL;
+  unsigned int samplesSize = 0;
+
+  unsigned int pos = 12;
+  while (pos + 8 <= size)
+  {
+    const uint8_t *chunk = data + pos;
+    unsigned int chunkSize = Read32(chunk + 4);
+    unsigned int available = std::min(chunkSize, size - pos - 8);
+
+    if (!memcmp(chunk, "fmt ", 4) && available >= 16)
+    {
+      unsigned int format = Read16(chunk + 8);
+      channels = Read16(chunk + 10);
+      sampleRate = Read32(chunk + 12);
+      blockAlign = Read16(chunk + 20);
+      bits = Read16(chunk + 22);
+      if (format == WAVE_FORMAT_EXTENSIBLE && available >= 40)
+        format = Read16(chunk + 32);
+      if (format == WAVE_FORMAT_IEEE_FLOAT)
+        isFloat = true;
+      else if (format != WAVE_FORMAT_PCM)
+      {
+        CLog::Log(LOGERROR, "CAEConvolver::%s - unsupported sample format 0x%x", __FUNCTION__, format);
+        return false;
+      }
+    }
+    else if (!memcmp(chunk, "data", 4))
+    {
+      samples = chunk + 8;
+      samplesSize = available;
+    }
+
+    // chunks are word aligned
+    uint64_t next = (uint64_t)pos + 8 + chunkSize + (chunkSize & 1);
+    if (next > size)
+      break;
+    pos = (unsigned int)next;
+  }
+
+  bool validBits = isFloat ? (bits == 32 || bits == 64) : (bits == 16 || bits == 24 || bits == 32);
+  if (!samples || !channels || channels > 32 || !sampleRate || !validBits || blockAlign < channels * bits / 8)
+  {
+    CLog::Log(LOGERROR, "CAEConvolver::%s - invalid or missing format, %u channels, %u bits",
+              __FUNCTION__, channels, bits);
+    return false;
+  }
+
+  unsigned int frames = samplesSize / blockAlign;
+  if (frames > MAX_TAPS)
+  {
+    CLog::Log(LOGWARNING, "CAEConvolver::%s - impulse response truncated from %u to %u taps",
+              __FUNCTION__, frames, MAX_TAPS);
+    frames = MAX_TAPS;
+  }
+  if (!frames)
+  {
+    CLog::Log(LOGERROR, "CAEConvolver::%s - no samples", __FUNCTION__);
+    return false;
+  }
+
+  filters.resize(channels);
+  for (unsigned int c = 0; c < channels; c++)
+  {
+    filters[c].resize(frames);
+    const uint8_t *sample = samples + c * bits / 8;
+    for (unsigned int i = 0; i < frames; i++, sample += blockAlign)
+      filters[c][i] = ReadSample(sample, bits, isFloat);
+  }
+  return true;
+}
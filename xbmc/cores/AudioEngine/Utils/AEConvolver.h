@@ -0,0 +1,114 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+class RFFT;
+
+/**
+ * FIR filter for long impulse responses, i.e. room correction.
+ * The filters are cut into partitions of one block and transformed once,
+ * the input is convolved block by block in the frequency domain
+ * (uniformly partitioned overlap-save). Cost per sample grows with
+ * taps / block size, the price is a latency of one block.
+ */
+class CAEConvolver
+{
+public:
+  static const unsigned int MAX_TAPS = 1 << 18;
+  static const unsigned int MIN_BLOCK_SIZE = 256;
+  static const unsigned int MAX_BLOCK_SIZE = 2048;
+
+  CAEConvolver();
+  ~CAEConvolver();
+
+  /**
+   * Set up the filters, clears the history
+   * @param filters impulse response per channel, an empty one only delays the channel
+   * @param blockSize partition size, a power of 2, 0 picks one from the filter length
+   * @return false if there is nothing to convolve
+   */
+  bool Init(const std::vector<std::vector<float> > &filters, unsigned int blockSize = 0);
+  void Deinit();
+  bool IsActive() const { return !m_channels.empty(); }
+
+  /**
+   * Filter samples in place
+   * @param data one plane per channel or interleaved samples in data[0]
+   * @param channels channels of the data, channels with an empty filter are delayed,
+   *                 channels beyond the filters pass unchanged
+   * @param frames number of frames
+   * @param planar layout of data
+   */
+  void Process(float **data, unsigned int channels, unsigned int frames, bool planar);
+
+  /**
+   * Drop the history, i.e. after a flush
+   */
+  void Reset();
+
+  /**
+   * Delay added by the filter in frames
+   */
+  unsigned int GetLatency() const { return IsActive() ? m_blockSize : 0; }
+  unsigned int GetBlockSize() const { return m_blockSize; }
+
+  /**
+   * The block size Init picks for a filter length
+   */
+  static unsigned int GetBlockSize(unsigned int taps);
+
+  /**
+   * Read the impulse responses of a RIFF WAVE file
+   * 16, 24 and 32 bit integer or 32 and 64 bit float samples, one filter per channel
+   * @return false if the file can't be used
+   */
+  static bool ParseWAV(const uint8_t *data, unsigned int size, std::vector<std::vector<float> > &filters,
+                       unsigned int &sampleRate);
+
+protected:
+  struct Channel
+  {
+    bool filtered;
+    std::vector<float> input;        // staging of the current block
+    std::vector<float> output;       // result of the last block
+    std::vector<float> time;         // previous and current block for overlap-save
+    std::vector<float> filterRe;     // partitions x bins
+    std::vector<float> filterIm;
+    std::vector<float> historyRe;    // spectra of the last partitions inputs
+    std::vector<float> historyIm;
+  };
+
+  void ProcessBlock(Channel &channel);
+
+  std::vector<Channel> m_channels;
+  std::unique_ptr<RFFT> m_fft;
+  std::vector<float> m_accRe;
+  std::vector<float> m_accIm;
+  std::vector<float> m_spectrum;     // kiss_fft_cpx[bins]
+  unsigned int m_blockSize;
+  unsigned int m_bins;
+  unsigned int m_partitions;
+  unsigned int m_head;               // history slot of the current block
+  unsigned int m_pos;                // frames staged in the current block
+};
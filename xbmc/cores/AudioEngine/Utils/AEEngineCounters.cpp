@@ -0,0 +1,273 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEEngineCounters.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+static const char *stageNames[] =
+{
+  "decode",
+  "resample",
+  "dsp",
+  "mix",
+  "encode",
+  "pack",
+  "write"
+};
+
+static const char *eventNames[] =
+{
+  "underruns",
+  "silence",
+  "overruns",
+  "sinkerrors"
+};
+
+static const char *poolNames[] =
+{
+  "input",
+  "sink"
+};
+
+static const char *limitNames[] =
+{
+  "passthrough",
+  "encoder",
+  "sinkperiod",
+  "devicebuffer",
+  "dsp"
+};
+
+const unsigned int CAEEngineCounters::HISTOGRAM_BUCKETS;
+const unsigned int CAEEngineCounters::MAX_STATES;
+
+CAEEngineCounters::CAEEngineCounters() :
+  m_transitions(0),
+  m_state(-1),
+  m_lowLatency(false),
+  m_latencyTarget(0),
+  m_latencyAchieved(0),
+  m_latencyLimits(0),
+  m_stateNames(nullptr),
+  m_stateCount(0)
+{
+  for (auto &stage : m_stages)
+  {
+    stage.count = 0;
+    stage.ticks = 0;
+    stage.max = 0;
+    for (auto &bucket : stage.histogram)
+      bucket = 0;
+  }
+  for (auto &event : m_events)
+    event = 0;
+  for (auto &pool : m_pools)
+  {
+    pool.used = 0;
+    pool.peak = 0;
+    pool.total = 0;
+  }
+  for (auto &entries : m_stateEntries)
+    entries = 0;
+
+  int64_t freq = CurrentHostFrequency();
+  for (unsigned int i = 0; i < HISTOGRAM_BUCKETS - 1; i++)
+    m_bucketTicks[i] = freq * ((int64_t)1 << i) / 1000000;
+  m_start = CurrentHostCounter();
+}
+
+void CAEEngineCounters::SetStateNames(const char * const *names, unsigned int count)
+{
+  m_stateNames = names;
+  m_stateCount = count < MAX_STATES ? count : MAX_STATES;
+}
+
+void CAEEngineCounters::AddTime(Stage stage, int64_t ticks)
+{
+  StageCounters &counters = m_stages[stage];
+  counters.count.fetch_add(1, std::memory_order_relaxed);
+  counters.ticks.fetch_add(ticks, std::memory_order_relaxed);
+
+  int64_t max = counters.max.load(std::memory_order_relaxed);
+  while (ticks > max &&
+         !counters.max.compare_exchange_weak(max, ticks, std::memory_order_relaxed))
+    ;
+
+  // most durations fall into the first buckets
+  unsigned int bucket = 0;
+  while (bucket < HISTOGRAM_BUCKETS - 1 && ticks >= m_bucketTicks[bucket])
+    bucket++;
+  counters.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CAEEngineCounters::AddEvent(Event event)
+{
+  m_events[event].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CAEEngineCounters::SetState(int state)
+{
+  if (m_state.exchange(state, std::memory_order_relaxed) == state)
+    return;
+  m_transitions.fetch_add(1, std::memory_order_relaxed);
+  if (state >= 0 && state < (int)MAX_STATES)
+    m_stateEntries[state].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CAEEngineCounters::SetPoolLevel(Pool pool, unsigned int used, unsigned int total)
+{
+  PoolLevel &level = m_pools[pool];
+  level.used.store(used, std::memory_order_relaxed);
+  level.total.store(total, std::memory_order_relaxed);
+  if (used > level.peak.load(std::memory_order_relaxed))
+    level.peak.store(used, std::memory_order_relaxed);
+}
+
+void CAEEngineCounters::SetLatency(bool lowLatency, double target, double achieved, unsigned int limits)
+{
+  m_lowLatency.store(lowLatency, std::memory_order_relaxed);
+  m_latencyTarget.store((unsigned int)(target * 1000000.0), std::memory_order_relaxed);
+  m_latencyAchieved.store((unsigned int)(achieved * 1000000.0), std::memory_order_relaxed);
+  m_latencyLimits.store(limits, std::memory_order_relaxed);
+}
+
+uint64_t CAEEngineCounters::GetCount(Stage stage) const
+{
+  return m_stages[stage].count.load(std::memory_order_relaxed);
+}
+
+uint64_t CAEEngineCounters::GetEvents(Event event) const
+{
+  return m_events[event].load(std::memory_order_relaxed);
+}
+
+unsigned int CAEEngineCounters::GetLatencyLimits() const
+{
+  return m_latencyLimits.load(std::memory_order_relaxed);
+}
+
+double CAEEngineCounters::GetMeanTime(Stage stage) const
+{
+  uint64_t count = m_stages[stage].count.load(std::memory_order_relaxed);
+  if (!count)
+    return 0.0;
+  double ticks = (double)m_stages[stage].ticks.load(std::memory_order_relaxed);
+  return ticks * 1000000.0 / CurrentHostFrequency() / count;
+}
+
+std::string CAEEngineCounters::GetSummary() const
+{
+  return StringUtils::Format("mix:%.0fus wr:%.0fus ur:%llu sil:%llu",
+                             GetMeanTime(STAGE_MIX),
+                             GetMeanTime(STAGE_WRITE),
+                             (unsigned long long)GetEvents(EVENT_UNDERRUN),
+                             (unsigned long long)GetEvents(EVENT_SILENCE));
+}
+
+void CAEEngineCounters::Serialize(CVariant &value) const
+{
+  double usPerTick = 1000000.0 / CurrentHostFrequency();
+
+  value["uptime"] = (CurrentHostCounter() - m_start) * usPerTick / 1000000.0;
+
+  CVariant stages(CVariant::VariantTypeObject);
+  for (int i = 0; i < MAX_STAGE; i++)
+  {
+    const StageCounters &counters = m_stages[i];
+    CVariant stage(CVariant::VariantTypeObject);
+    uint64_t count = counters.count.load(std::memory_order_relaxed);
+    double total = counters.ticks.load(std::memory_order_relaxed) * usPerTick;
+    stage["count"] = count;
+    stage["total"] = total / 1000.0;
+    stage["mean"] = count ? total / count : 0.0;
+    stage["max"] = counters.max.load(std::memory_order_relaxed) * usPerTick;
+    CVariant histogram(CVariant::VariantTypeArray);
+    for (auto &bucket : counters.histogram)
+      histogram.push_back(bucket.load(std::memory_order_relaxed));
+    stage["histogram"] = histogram;
+    stages[stageNames[i]] = stage;
+  }
+  value["stages"] = stages;
+
+  for (int i = 0; i < MAX_EVENT; i++)
+    value[eventNames[i]] = m_events[i].load(std::memory_order_relaxed);
+
+  CVariant pools(CVariant::VariantTypeObject);
+  for (int i = 0; i < MAX_POOL; i++)
+  {
+    CVariant pool(CVariant::VariantTypeObject);
+    pool["used"] = m_pools[i].used.load(std::memory_order_relaxed);
+    pool["peak"] = m_pools[i].peak.load(std::memory_order_relaxed);
+    pool["total"] = m_pools[i].total.load(std::memory_order_relaxed);
+    pools[poolNames[i]] = pool;
+  }
+  value["pools"] = pools;
+
+  int state = m_state.load(std::memory_order_relaxed);
+  value["state"] = (state >= 0 && (unsigned int)state < m_stateCount) ? m_stateNames[state] : "";
+  value["transitions"] = m_transitions.load(std::memory_order_relaxed);
+  CVariant states(CVariant::VariantTypeObject);
+  for (unsigned int i = 0; i < m_stateCount; i++)
+    states[m_stateNames[i]] = m_stateEntries[i].load(std::memory_order_relaxed);
+  value["states"] = states;
+
+  CVariant latency(CVariant::VariantTypeObject);
+  latency["profile"] = m_lowLatency.load(std::memory_order_relaxed) ? "low" : "normal";
+  latency["target"] = m_latencyTarget.load(std::memory_order_relaxed) / 1000.0;
+  latency["achieved"] = m_latencyAchieved.load(std::memory_order_relaxed) / 1000.0;
+  CVariant limits(CVariant::VariantTypeArray);
+  unsigned int bits = m_latencyLimits.load(std::memory_order_relaxed);
+  for (int i = 0; i < MAX_LIMIT; i++)
+  {
+    if (bits & (1 << i))
+      limits.push_back(limitNames[i]);
+  }
+  latency["limits"] = limits;
+  value["latency"] = latency;
+}
+
+const char *CAEEngineCounters::GetStageName(Stage stage)
+{
+  if (stage < 0 || stage >= MAX_STAGE)
+    return "";
+  return stageNames[stage];
+}
+
+const char *CAEEngineCounters::GetLimitName(Limit limit)
+{
+  if (limit < 0 || limit >= MAX_LIMIT)
+    return "";
+  return limitNames[limit];
+}
+
+CAEStageTimer::CAEStageTimer(CAEEngineCounters *counters, CAEEngineCounters::Stage stage) :
+  m_counters(counters),
+  m_stage(stage),
+  m_start(counters ? CurrentHostCounter() : 0)
+{
+}
+
+CAEStageTimer::~CAEStageTimer()
+{
+  if (m_counters)
+    m_counters->AddTime(m_stage, CurrentHostCounter() - m_start);
+}
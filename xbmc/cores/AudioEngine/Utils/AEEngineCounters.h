@@ -0,0 +1,165 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/ISerializable.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+/**
+ * Performance counters of one audio engine, for diagnostics.
+ *
+ * Counters are only ever incremented, with relaxed atomics, so recording
+ * costs a few nanoseconds and never blocks the engine or sink threads.
+ * Readers get a consistent enough view for monitoring, not a snapshot.
+ * Durations are kept in host counter ticks and converted on read.
+ */
+class CAEEngineCounters : public ISerializable
+{
+public:
+  enum Stage
+  {
+    STAGE_DECODE = 0,
+    STAGE_RESAMPLE,
+    STAGE_DSP,
+    STAGE_MIX,
+    STAGE_ENCODE,
+    STAGE_PACK,
+    STAGE_WRITE,
+    MAX_STAGE
+  };
+
+  enum Event
+  {
+    EVENT_UNDERRUN = 0, // a playing stream had nothing for the mix
+    EVENT_SILENCE,      // the sink was fed silence, nothing arrived in time
+    EVENT_OVERRUN,      // samples were dropped because the sink was full
+    EVENT_SINK_ERROR,
+    MAX_EVENT
+  };
+
+  enum Pool
+  {
+    POOL_INPUT = 0,     // buffers handed to the streams
+    POOL_SINK,          // buffers queued for the sink
+    MAX_POOL
+  };
+
+  // constraints that kept the latency above the target of the buffer profile
+  enum Limit
+  {
+    LIMIT_PASSTHROUGH = 0,  // bitstream packets have a fixed size
+    LIMIT_ENCODER,          // transcoding works on whole encoder frames
+    LIMIT_SINK_PERIOD,      // the sink chose a larger period than requested
+    LIMIT_DEVICE_BUFFER,    // the device buffers more than requested
+    LIMIT_DSP,              // audio dsp addons add their own delay
+    MAX_LIMIT
+  };
+
+  // bucket i counts durations below 2^i microseconds, the last one the rest
+  static const unsigned int HISTOGRAM_BUCKETS = 16;
+  static const unsigned int MAX_STATES = 16;
+
+  CAEEngineCounters();
+
+  /**
+   * Names used for the state machine transitions, set once by the owner
+   */
+  void SetStateNames(const char * const *names, unsigned int count);
+
+  void AddTime(Stage stage, int64_t ticks);
+  void AddEvent(Event event);
+  void SetState(int state);
+  void SetPoolLevel(Pool pool, unsigned int used, unsigned int total);
+  /**
+   * Latency of the current configuration in seconds
+   * @param limits bit i set if Limit i kept the latency above the target
+   */
+  void SetLatency(bool lowLatency, double target, double achieved, unsigned int limits);
+
+  uint64_t GetCount(Stage stage) const;
+  uint64_t GetEvents(Event event) const;
+  unsigned int GetLatencyLimits() const;
+  /**
+   * Mean duration of a stage in microseconds
+   */
+  double GetMeanTime(Stage stage) const;
+
+  /**
+   * One line for the debug overlay
+   */
+  std::string GetSummary() const;
+
+  virtual void Serialize(CVariant &value) const override;
+
+  static const char *GetStageName(Stage stage);
+  static const char *GetLimitName(Limit limit);
+
+private:
+  CAEEngineCounters(const CAEEngineCounters&) = delete;
+  CAEEngineCounters& operator=(const CAEEngineCounters&) = delete;
+
+  struct StageCounters
+  {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> ticks;
+    std::atomic<int64_t> max;
+    std::atomic<uint64_t> histogram[HISTOGRAM_BUCKETS];
+  };
+
+  struct PoolLevel
+  {
+    std::atomic<unsigned int> used;
+    std::atomic<unsigned int> peak;
+    std::atomic<unsigned int> total;
+  };
+
+  StageCounters m_stages[MAX_STAGE];
+  std::atomic<uint64_t> m_events[MAX_EVENT];
+  PoolLevel m_pools[MAX_POOL];
+  std::atomic<uint64_t> m_stateEntries[MAX_STATES];
+  std::atomic<uint64_t> m_transitions;
+  std::atomic<int> m_state;
+  std::atomic<bool> m_lowLatency;
+  std::atomic<unsigned int> m_latencyTarget;   // microseconds
+  std::atomic<unsigned int> m_latencyAchieved; // microseconds
+  std::atomic<unsigned int> m_latencyLimits;
+  const char * const *m_stateNames;
+  unsigned int m_stateCount;
+  int64_t m_start;
+  int64_t m_bucketTicks[HISTOGRAM_BUCKETS - 1];
+};
+
+/**
+ * Adds the time of its scope to a stage, does nothing without counters
+ */
+class CAEStageTimer
+{
+public:
+  CAEStageTimer(CAEEngineCounters *counters, CAEEngineCounters::Stage stage);
+  ~CAEStageTimer();
+
+private:
+  CAEEngineCounters *m_counters;
+  CAEEngineCounters::Stage m_stage;
+  int64_t m_start;
+};
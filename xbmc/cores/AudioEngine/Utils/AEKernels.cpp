@@ -0,0 +1,617 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+#include "AEUtil.h"
+#include "utils/CPUInfo.h"
+
+#include <atomic>
+#include <math.h>
+
+#if defined(HAVE_SSE) && defined(__SSE__) && defined(__GNUC__)
+#define AE_KERNELS_AVX2
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define AE_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+struct KernelTable
+{
+  void (*mul)(float *data, float mul, unsigned int count);
+  bool (*mulAdd)(float *data, const float *add, float mul, unsigned int count);
+  void (*clamp)(float *data, unsigned int count);
+  void (*interleave)(float *dst, const float * const *src, unsigned int channels, unsigned int frames);
+  void (*complexMulAdd)(float *re, float *im, const float *aRe, const float *aIm,
+                        const float *bRe, const float *bIm, unsigned int count);
+  float (*dotProduct)(const float *a, const float *b, unsigned int count);
+};
+
+//-----------------------------------------------------------------------------
+// scalar, the reference for all other implementations
+//-----------------------------------------------------------------------------
+
+inline float SoftClamp(float x)
+{
+  /*
+     This is a rational function to approximate a tanh-like soft clipper.
+     It is based on the pade-approximation of the tanh function with tweaked coefficients.
+     See: http://www.musicdsp.org/showone.php?id=238
+  */
+  if (x < -3.0f)
+    return -1.0f;
+  else if (x > 3.0f)
+    return 1.0f;
+  float y = x * x;
+  return x * (27.0f + y) / (27.0f + 9.0f * y);
+}
+
+void MulC(float *data, float mul, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    data[i] *= mul;
+}
+
+bool MulAddC(float *data, const float *add, float mul, unsigned int count)
+{
+  bool clip = false;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    data[i] += add[i] * mul;
+    if (fabs(data[i]) > 1.0f)
+      clip = true;
+  }
+  return clip;
+}
+
+void ClampC(float *data, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    data[i] = SoftClamp(data[i]);
+}
+
+void InterleaveC(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  for (unsigned int i = 0; i < frames; i++)
+    for (unsigned int j = 0; j < channels; j++)
+      *dst++ = src[j][i];
+}
+
+void ComplexMulAddC(float *re, float *im, const float *aRe, const float *aIm,
+                    const float *bRe, const float *bIm, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    float r = aRe[i] * bRe[i] - aIm[i] * bIm[i];
+    float j = aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    re[i] += r;
+    im[i] += j;
+  }
+}
+
+// lanes are folded as (0+4, 1+5, 2+6, 3+7), then (0+2, 1+3), then 0+1
+inline float FoldLanes(const float *lane)
+{
+  float t0 = lane[0] + lane[4];
+  float t1 = lane[1] + lane[5];
+  float t2 = lane[2] + lane[6];
+  float t3 = lane[3] + lane[7];
+  return (t0 + t2) + (t1 + t3);
+}
+
+inline float DotProductTail(float sum, const float *a, const float *b, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+float DotProductC(const float *a, const float *b, unsigned int count)
+{
+  float lane[8] = { 0.0f };
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+  {
+    for (unsigned int j = 0; j < 8; j++)
+      lane[j] += a[i + j] * b[i + j];
+  }
+  return DotProductTail(FoldLanes(lane), a + even, b + even, count - even);
+}
+
+//-----------------------------------------------------------------------------
+// SSE
+//-----------------------------------------------------------------------------
+
+#if defined(HAVE_SSE) && defined(__SSE__)
+
+void MulSSE(float *data, float mul, unsigned int count)
+{
+  const __m128 m = _mm_set_ps1(mul);
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), m));
+  MulC(data + even, mul, count - even);
+}
+
+bool MulAddSSE(float *data, const float *add, float mul, unsigned int count)
+{
+  const __m128 m = _mm_set_ps1(mul);
+  const __m128 sign = _mm_set_ps1(-0.0f);
+  const __m128 one = _mm_set_ps1(1.0f);
+  __m128 clip = _mm_setzero_ps();
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    __m128 out = _mm_add_ps(_mm_loadu_ps(data + i), _mm_mul_ps(_mm_loadu_ps(add + i), m));
+    _mm_storeu_ps(data + i, out);
+    clip = _mm_or_ps(clip, _mm_cmpgt_ps(_mm_andnot_ps(sign, out), one));
+  }
+  bool tail = MulAddC(data + even, add + even, mul, count - even);
+  return _mm_movemask_ps(clip) || tail;
+}
+
+void ClampSSE(float *data, unsigned int count)
+{
+  const __m128 sign = _mm_set_ps1(-0.0f);
+  const __m128 c1 = _mm_set_ps1(1.0f);
+  const __m128 c3 = _mm_set_ps1(3.0f);
+  const __m128 c9 = _mm_set_ps1(9.0f);
+  const __m128 c27 = _mm_set_ps1(27.0f);
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(data + i);
+    __m128 y = _mm_mul_ps(x, x);
+    __m128 soft = _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(c27, y)),
+                             _mm_add_ps(c27, _mm_mul_ps(c9, y)));
+    __m128 hard = _mm_or_ps(_mm_and_ps(sign, x), c1);
+    __m128 over = _mm_cmpgt_ps(_mm_andnot_ps(sign, x), c3);
+    _mm_storeu_ps(data + i, _mm_or_ps(_mm_and_ps(over, hard), _mm_andnot_ps(over, soft)));
+  }
+  ClampC(data + even, count - even);
+}
+
+void InterleaveSSE(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  if (channels != 2)
+  {
+    InterleaveC(dst, src, channels, frames);
+    return;
+  }
+  unsigned int even = frames & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    __m128 l = _mm_loadu_ps(src[0] + i);
+    __m128 r = _mm_loadu_ps(src[1] + i);
+    _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(l, r));
+  }
+  for (unsigned int i = even; i < frames; i++)
+  {
+    dst[2 * i] = src[0][i];
+    dst[2 * i + 1] = src[1][i];
+  }
+}
+
+void ComplexMulAddSSE(float *re, float *im, const float *aRe, const float *aIm,
+                      const float *bRe, const float *bIm, unsigned int count)
+{
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    __m128 ar = _mm_loadu_ps(aRe + i);
+    __m128 ai = _mm_loadu_ps(aIm + i);
+    __m128 br = _mm_loadu_ps(bRe + i);
+    __m128 bi = _mm_loadu_ps(bIm + i);
+    __m128 r = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+    __m128 j = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+    _mm_storeu_ps(re + i, _mm_add_ps(_mm_loadu_ps(re + i), r));
+    _mm_storeu_ps(im + i, _mm_add_ps(_mm_loadu_ps(im + i), j));
+  }
+  ComplexMulAddC(re + even, im + even, aRe + even, aIm + even, bRe + even, bIm + even, count - even);
+}
+
+float DotProductSSE(const float *a, const float *b, unsigned int count)
+{
+  __m128 lo = _mm_setzero_ps();
+  __m128 hi = _mm_setzero_ps();
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+  {
+    lo = _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    hi = _mm_add_ps(hi, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+  }
+  float lane[8];
+  _mm_storeu_ps(lane, lo);
+  _mm_storeu_ps(lane + 4, hi);
+  return DotProductTail(FoldLanes(lane), a + even, b + even, count - even);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+// AVX2, built for the target of the function only, no fused multiply-add
+// so the results match the other implementations
+//-----------------------------------------------------------------------------
+
+#if defined(AE_KERNELS_AVX2)
+
+TARGET_AVX2 void MulAVX2(float *data, float mul, unsigned int count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), m));
+  for (unsigned int i = even; i < count; i++)
+    data[i] *= mul;
+}
+
+TARGET_AVX2 bool MulAddAVX2(float *data, const float *add, float mul, unsigned int count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  __m256 clip = _mm256_setzero_ps();
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+  {
+    __m256 out = _mm256_add_ps(_mm256_loadu_ps(data + i), _mm256_mul_ps(_mm256_loadu_ps(add + i), m));
+    _mm256_storeu_ps(data + i, out);
+    clip = _mm256_or_ps(clip, _mm256_cmp_ps(_mm256_andnot_ps(sign, out), one, _CMP_GT_OQ));
+  }
+  bool ret = _mm256_movemask_ps(clip) != 0;
+  for (unsigned int i = even; i < count; i++)
+  {
+    data[i] += add[i] * mul;
+    if (fabs(data[i]) > 1.0f)
+      ret = true;
+  }
+  return ret;
+}
+
+TARGET_AVX2 void ClampAVX2(float *data, unsigned int count)
+{
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 c1 = _mm256_set1_ps(1.0f);
+  const __m256 c3 = _mm256_set1_ps(3.0f);
+  const __m256 c9 = _mm256_set1_ps(9.0f);
+  const __m256 c27 = _mm256_set1_ps(27.0f);
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(data + i);
+    __m256 y = _mm256_mul_ps(x, x);
+    __m256 soft = _mm256_div_ps(_mm256_mul_ps(x, _mm256_add_ps(c27, y)),
+                                _mm256_add_ps(c27, _mm256_mul_ps(c9, y)));
+    __m256 hard = _mm256_or_ps(_mm256_and_ps(sign, x), c1);
+    __m256 over = _mm256_cmp_ps(_mm256_andnot_ps(sign, x), c3, _CMP_GT_OQ);
+    _mm256_storeu_ps(data + i, _mm256_blendv_ps(soft, hard, over));
+  }
+  for (unsigned int i = even; i < count; i++)
+    data[i] = SoftClamp(data[i]);
+}
+
+TARGET_AVX2 void InterleaveAVX2(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  if (channels != 2)
+  {
+    InterleaveC(dst, src, channels, frames);
+    return;
+  }
+  unsigned int even = frames & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+  {
+    __m256 l = _mm256_loadu_ps(src[0] + i);
+    __m256 r = _mm256_loadu_ps(src[1] + i);
+    // unpack works within 128 bit lanes, put the lanes in order afterwards
+    __m256 lo = _mm256_unpacklo_ps(l, r);
+    __m256 hi = _mm256_unpackhi_ps(l, r);
+    _mm256_storeu_ps(dst + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(dst + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+  }
+  for (unsigned int i = even; i < frames; i++)
+  {
+    dst[2 * i] = src[0][i];
+    dst[2 * i + 1] = src[1][i];
+  }
+}
+
+TARGET_AVX2 void ComplexMulAddAVX2(float *re, float *im, const float *aRe, const float *aIm,
+                                   const float *bRe, const float *bIm, unsigned int count)
+{
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+  {
+    __m256 ar = _mm256_loadu_ps(aRe + i);
+    __m256 ai = _mm256_loadu_ps(aIm + i);
+    __m256 br = _mm256_loadu_ps(bRe + i);
+    __m256 bi = _mm256_loadu_ps(bIm + i);
+    __m256 r = _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+    __m256 j = _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+    _mm256_storeu_ps(re + i, _mm256_add_ps(_mm256_loadu_ps(re + i), r));
+    _mm256_storeu_ps(im + i, _mm256_add_ps(_mm256_loadu_ps(im + i), j));
+  }
+  for (unsigned int i = even; i < count; i++)
+  {
+    float r = aRe[i] * bRe[i] - aIm[i] * bIm[i];
+    float j = aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    re[i] += r;
+    im[i] += j;
+  }
+}
+
+TARGET_AVX2 float DotProductAVX2(const float *a, const float *b, unsigned int count)
+{
+  __m256 acc = _mm256_setzero_ps();
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  float lane[8];
+  _mm256_storeu_ps(lane, acc);
+  return DotProductTail(FoldLanes(lane), a + even, b + even, count - even);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+// NEON
+//-----------------------------------------------------------------------------
+
+#if defined(AE_KERNELS_NEON)
+
+void MulNEON(float *data, float mul, unsigned int count)
+{
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+    vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), mul));
+  MulC(data + even, mul, count - even);
+}
+
+bool MulAddNEON(float *data, const float *add, float mul, unsigned int count)
+{
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  uint32x4_t clip = vdupq_n_u32(0);
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    // separate multiply and add, vmla may be fused
+    float32x4_t out = vaddq_f32(vld1q_f32(data + i), vmulq_n_f32(vld1q_f32(add + i), mul));
+    vst1q_f32(data + i, out);
+    clip = vorrq_u32(clip, vcagtq_f32(out, one));
+  }
+  uint32x2_t fold = vorr_u32(vget_low_u32(clip), vget_high_u32(clip));
+  bool tail = MulAddC(data + even, add + even, mul, count - even);
+  return (vget_lane_u32(fold, 0) | vget_lane_u32(fold, 1)) || tail;
+}
+
+#if defined(__aarch64__)
+void ClampNEON(float *data, unsigned int count)
+{
+  const float32x4_t c1 = vdupq_n_f32(1.0f);
+  const float32x4_t c3 = vdupq_n_f32(3.0f);
+  const float32x4_t c27 = vdupq_n_f32(27.0f);
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    float32x4_t x = vld1q_f32(data + i);
+    float32x4_t y = vmulq_f32(x, x);
+    float32x4_t soft = vdivq_f32(vmulq_f32(x, vaddq_f32(c27, y)),
+                                 vaddq_f32(c27, vmulq_n_f32(y, 9.0f)));
+    // copy the sign of x to 1.0
+    float32x4_t hard = vbslq_f32(vdupq_n_u32(0x80000000), x, c1);
+    uint32x4_t over = vcagtq_f32(x, c3);
+    vst1q_f32(data + i, vbslq_f32(over, hard, soft));
+  }
+  ClampC(data + even, count - even);
+}
+#else
+// no vector division on armv7, an estimate would not match the reference
+#define ClampNEON ClampC
+#endif
+
+void InterleaveNEON(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  if (channels != 2)
+  {
+    InterleaveC(dst, src, channels, frames);
+    return;
+  }
+  unsigned int even = frames & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    float32x4x2_t lr;
+    lr.val[0] = vld1q_f32(src[0] + i);
+    lr.val[1] = vld1q_f32(src[1] + i);
+    vst2q_f32(dst + 2 * i, lr);
+  }
+  for (unsigned int i = even; i < frames; i++)
+  {
+    dst[2 * i] = src[0][i];
+    dst[2 * i + 1] = src[1][i];
+  }
+}
+
+void ComplexMulAddNEON(float *re, float *im, const float *aRe, const float *aIm,
+                       const float *bRe, const float *bIm, unsigned int count)
+{
+  unsigned int even = count & ~3;
+  for (unsigned int i = 0; i < even; i += 4)
+  {
+    float32x4_t ar = vld1q_f32(aRe + i);
+    float32x4_t ai = vld1q_f32(aIm + i);
+    float32x4_t br = vld1q_f32(bRe + i);
+    float32x4_t bi = vld1q_f32(bIm + i);
+    float32x4_t r = vsubq_f32(vmulq_f32(ar, br), vmulq_f32(ai, bi));
+    float32x4_t j = vaddq_f32(vmulq_f32(ar, bi), vmulq_f32(ai, br));
+    vst1q_f32(re + i, vaddq_f32(vld1q_f32(re + i), r));
+    vst1q_f32(im + i, vaddq_f32(vld1q_f32(im + i), j));
+  }
+  ComplexMulAddC(re + even, im + even, aRe + even, aIm + even, bRe + even, bIm + even, count - even);
+}
+
+float DotProductNEON(const float *a, const float *b, unsigned int count)
+{
+  float32x4_t lo = vdupq_n_f32(0.0f);
+  float32x4_t hi = vdupq_n_f32(0.0f);
+  unsigned int even = count & ~7;
+  for (unsigned int i = 0; i < even; i += 8)
+  {
+    lo = vaddq_f32(lo, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    hi = vaddq_f32(hi, vmulq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+  }
+  float lane[8];
+  vst1q_f32(lane, lo);
+  vst1q_f32(lane + 4, hi);
+  return DotProductTail(FoldLanes(lane), a + even, b + even, count - even);
+}
+
+#endif
+
+const KernelTable s_tables[CAEKernels::MAX_IMPLEMENTATION] =
+{
+  { MulC, MulAddC, ClampC, InterleaveC, ComplexMulAddC, DotProductC },
+#if defined(HAVE_SSE) && defined(__SSE__)
+  { MulSSE, MulAddSSE, ClampSSE, InterleaveSSE, ComplexMulAddSSE, DotProductSSE },
+#else
+  { NULL, NULL, NULL, NULL, NULL, NULL },
+#endif
+#if defined(AE_KERNELS_AVX2)
+  { MulAVX2, MulAddAVX2, ClampAVX2, InterleaveAVX2, ComplexMulAddAVX2, DotProductAVX2 },
+#else
+  { NULL, NULL, NULL, NULL, NULL, NULL },
+#endif
+#if defined(AE_KERNELS_NEON)
+  { MulNEON, MulAddNEON, ClampNEON, InterleaveNEON, ComplexMulAddNEON, DotProductNEON },
+#else
+  { NULL, NULL, NULL, NULL, NULL, NULL },
+#endif
+};
+
+const char *s_names[CAEKernels::MAX_IMPLEMENTATION] =
+{
+  "scalar", "sse", "avx2", "neon"
+};
+
+std::atomic<int> s_implementation(-1);
+
+CAEKernels::Implementation Detect()
+{
+#if defined(AE_KERNELS_AVX2)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_AVX2)
+    return CAEKernels::AVX2;
+#endif
+#if defined(HAVE_SSE) && defined(__SSE__)
+  // the whole build requires sse already
+  return CAEKernels::SSE;
+#elif defined(AE_KERNELS_NEON)
+#if !defined(__aarch64__)
+  if (!(g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_NEON))
+    return CAEKernels::SCALAR;
+#endif
+  return CAEKernels::NEON;
+#else
+  return CAEKernels::SCALAR;
+#endif
+}
+
+inline const KernelTable &Kernels()
+{
+  int impl = s_implementation.load(std::memory_order_relaxed);
+  if (impl < 0)
+  {
+    // racing callers come to the same result
+    impl = Detect();
+    s_implementation = impl;
+  }
+  return s_tables[impl];
+}
+
+}
+
+void CAEKernels::Mul(float *data, float mul, unsigned int count)
+{
+  Kernels().mul(data, mul, count);
+}
+
+bool CAEKernels::MulAdd(float *data, const float *add, float mul, unsigned int count)
+{
+  return Kernels().mulAdd(data, add, mul, count);
+}
+
+void CAEKernels::Clamp(float *data, unsigned int count)
+{
+  Kernels().clamp(data, count);
+}
+
+void CAEKernels::Interleave(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  Kernels().interleave(dst, src, channels, frames);
+}
+
+void CAEKernels::ComplexMulAdd(float *re, float *im, const float *aRe, const float *aIm,
+                               const float *bRe, const float *bIm, unsigned int count)
+{
+  Kernels().complexMulAdd(re, im, aRe, aIm, bRe, bIm, count);
+}
+
+float CAEKernels::DotProduct(const float *a, const float *b, unsigned int count)
+{
+  return Kernels().dotProduct(a, b, count);
+}
+
+CAEKernels::Implementation CAEKernels::GetImplementation()
+{
+  Kernels();
+  return (Implementation)s_implementation.load();
+}
+
+const char *CAEKernels::GetImplementationName(Implementation impl)
+{
+  if (impl < SCALAR || impl >= MAX_IMPLEMENTATION)
+    return "unknown";
+  return s_names[impl];
+}
+
+bool CAEKernels::IsSupported(Implementation impl)
+{
+  if (impl < SCALAR || impl >= MAX_IMPLEMENTATION || !s_tables[impl].mul)
+    return false;
+  if (impl == AVX2)
+    return (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_AVX2) != 0;
+#if defined(AE_KERNELS_NEON) && !defined(__aarch64__)
+  if (impl == NEON)
+    return (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_NEON) != 0;
+#endif
+  return true;
+}
+
+bool CAEKernels::SetImplementation(Implementation impl)
+{
+  if (!IsSupported(impl))
+    return false;
+  s_implementation = impl;
+  return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Float sample kernels of the audio engine.
+ *
+ * The fastest implementation supported by the cpu is selected once, from
+ * the features reported by CCPUInfo. All implementations produce the same
+ * output as the scalar one, there is no alignment requirement.
+ */
+class CAEKernels
+{
+public:
+  enum Implementation
+  {
+    SCALAR = 0,
+    SSE,
+    AVX2,
+    NEON,
+    MAX_IMPLEMENTATION
+  };
+
+  /**
+   * data[i] *= mul
+   */
+  static void Mul(float *data, float mul, unsigned int count);
+
+  /**
+   * data[i] += add[i] * mul
+   * @return true if a result exceeds full scale and has to be clamped
+   */
+  static bool MulAdd(float *data, const float *add, float mul, unsigned int count);
+
+  /**
+   * Soft clip to [-1, 1] with a tanh like curve
+   */
+  static void Clamp(float *data, unsigned int count);
+
+  /**
+   * Interleave planar channels
+   * @param dst receives frames * channels samples
+   * @param src one plane per channel
+   */
+  static void Interleave(float *dst, const float * const *src, unsigned int channels, unsigned int frames);
+
+  /**
+   * Complex multiply-add on split real and imaginary parts
+   * (re[i], im[i]) += (aRe[i], aIm[i]) * (bRe[i], bIm[i])
+   */
+  static void ComplexMulAdd(float *re, float *im, const float *aRe, const float *aIm,
+                            const float *bRe, const float *bIm, unsigned int count);
+
+  /**
+   * sum of a[i] * b[i], summed in 8 lanes so that all implementations agree
+   */
+  static float DotProduct(const float *a, const float *b, unsigned int count);
+
+  static Implementation GetImplementation();
+  static const char *GetImplementationName(Implementation impl);
+
+  /**
+   * Force an implementation, for tests and benchmarks
+   * @return false if it is not supported by this cpu or build
+   */
+  static bool SetImplementation(Implementation impl);
+  static bool IsSupported(Implementation impl);
+};
@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AELatencyDetector.h"
+
+#include <algorithm>
+#include <math.h>
+
+#define BURST_LOW_FREQ  500.0
+#define BURST_HIGH_FREQ 5000.0
+#define BURST_LEVEL     0.5
+
+void CAELatencyDetector::GenerateBurst(std::vector<float> &burst, unsigned int frames, unsigned int sampleRate)
+{
+  burst.resize(frames);
+  if (!frames || !sampleRate)
+    return;
+
+  double duration = (double)frames / sampleRate;
+  double sweep = (BURST_HIGH_FREQ - BURST_LOW_FREQ) / duration;
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    double t = (double)i / sampleRate;
+    double phase = 2.0 * M_PI * (BURST_LOW_FREQ * t + 0.5 * sweep * t * t);
+    double window = 0.5 - 0.5 * cos(2.0 * M_PI * i / frames);
+    burst[i] = (float)(BURST_LEVEL * window * sin(phase));
+  }
+}
+
+int CAELatencyDetector::FindBurst(const std::vector<float> &capture, const std::vector<float> &burst, float threshold)
+{
+  int captureFrames = capture.size();
+  int burstFrames = burst.size();
+  if (burstFrames == 0 || captureFrames < burstFrames)
+    return -1;
+
+  double burstEnergy = 0;
+  for (float s : burst)
+    burstEnergy += s * s;
+  if (burstEnergy <= 0)
+    return -1;
+
+  // coarse search for the loudest part of the recording, the exact
+  // position is refined by correlation around it
+  int hop = std::max(burstFrames / 8, 1);
+  int loudest = 0;
+  double maxEnergy = -1;
+  for (int pos = 0; pos + burstFrames <= captureFrames; pos += hop)
+  {
+    double energy = 0;
+    for (int i = 0; i < burstFrames; i++)
+      energy += capture[pos + i] * capture[pos + i];
+    if (energy > maxEnergy)
+    {
+      maxEnergy = energy;
+      loudest = pos;
+    }
+  }
+
+  int start = std::max(loudest - burstFrames, 0);
+  int end = std::min(loudest + burstFrames, captureFrames - burstFrames);
+  int best = -1;
+  double bestCorr = 0;
+  for (int pos = start; pos <= end; pos++)
+  {
+    double corr = 0;
+    double energy = 0;
+    for (int i = 0; i < burstFrames; i++)
+    {
+      corr += capture[pos + i] * burst[i];
+      energy += capture[pos + i] * capture[pos + i];
+    }
+    if (energy <= 0)
+      continue;
+    corr /= sqrt(energy * burstEnergy);
+    if (corr > bestCorr)
+    {
+      bestCorr = corr;
+      best = pos;
+    }
+  }
+
+  if (bestCorr < threshold)
+    return -1;
+  return best;
+}
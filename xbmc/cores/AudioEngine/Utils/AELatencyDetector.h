@@ -0,0 +1,49 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+/**
+ * Test signal for measuring the latency of an output path.
+ * The burst is a windowed chirp so its position can be found in a
+ * recording with sub-millisecond accuracy even if the path attenuates
+ * or adds noise.
+ */
+class CAELatencyDetector
+{
+public:
+  /**
+   * Fill buffer with the mono test burst
+   * @param burst receives the samples
+   * @param frames length of the burst
+   * @param sampleRate sample rate of the burst
+   */
+  static void GenerateBurst(std::vector<float> &burst, unsigned int frames, unsigned int sampleRate);
+
+  /**
+   * Locate the burst in a mono recording
+   * @param capture the recorded samples
+   * @param burst the burst returned by GenerateBurst
+   * @param threshold min normalized correlation to accept a match
+   * @return offset of the first frame of the burst or -1 if not found
+   */
+  static int FindBurst(const std::vector<float> &capture, const std::vector<float> &burst, float threshold = 0.5f);
+};
@@ -0,0 +1,110 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Bounded wait-free queue for exactly one producer and one consumer thread.
+ *
+ * Push reports whether the queue was empty before, so the producer only has
+ * to wake the consumer once per batch: a consumer which found the queue
+ * empty is guaranteed to be woken by the next push. This requires the
+ * consumer to drain the queue before it goes to sleep.
+ * Clear may only be called while the other side is known to be idle.
+ */
+template<typename T>
+class CAESPSCQueue
+{
+public:
+  explicit CAESPSCQueue(unsigned int size) :
+    m_write(0),
+    m_read(0)
+  {
+    unsigned int capacity = 1;
+    while (capacity < size)
+      capacity <<= 1;
+    m_items.resize(capacity);
+    m_mask = capacity - 1;
+  }
+
+  /**
+   * Add an item, producer only
+   * @param wasEmpty receives true if the consumer has to be woken
+   * @return false if the queue is full
+   */
+  bool Push(const T &item, bool *wasEmpty = NULL)
+  {
+    unsigned int write = m_write.load(std::memory_order_relaxed);
+    if (write - m_read.load(std::memory_order_acquire) > m_mask)
+      return false;
+    m_items[write & m_mask] = item;
+    m_write.store(write + 1);
+    // pairs with Pop: either the consumer sees the new item or we see that
+    // it has taken everything before it
+    if (wasEmpty)
+      *wasEmpty = m_read.load() == write;
+    return true;
+  }
+
+  /**
+   * Take the oldest item, consumer only
+   * @return false if the queue is empty
+   */
+  bool Pop(T &item)
+  {
+    unsigned int read = m_read.load(std::memory_order_relaxed);
+    if (read == m_write.load())
+      return false;
+    item = m_items[read & m_mask];
+    m_read.store(read + 1);
+    return true;
+  }
+
+  bool IsEmpty() const
+  {
+    return m_read.load(std::memory_order_acquire) == m_write.load(std::memory_order_acquire);
+  }
+
+  unsigned int Size() const
+  {
+    return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+  }
+
+  unsigned int Capacity() const { return m_mask + 1; }
+
+  void Clear()
+  {
+    m_read.store(m_write.load());
+  }
+
+private:
+  CAESPSCQueue(const CAESPSCQueue&) = delete;
+  CAESPSCQueue& operator=(const CAESPSCQueue&) = delete;
+
+  std::vector<T> m_items;
+  unsigned int m_mask;
+  // keep the indices on separate cache lines, each is written by one side only
+  std::atomic<unsigned int> m_write;
+  char m_pad[64];
+  std::atomic<unsigned int> m_read;
+};
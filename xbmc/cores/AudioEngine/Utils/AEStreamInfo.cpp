@@ -23,6 +23,13 @@
 #include <algorithm>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define AE_STREAM_NEON
+#include <arm_neon.h>
+#endif
+
 #define DTS_PREAMBLE_14BE  0x1FFFE800
 #define DTS_PREAMBLE_14LE  0xFF1F00E8
 #define DTS_PREAMBLE_16BE  0x7FFE8001
@@ -58,9 +65,72 @@ static const uint32_t DTSSampleRates[DTS_SFREQ_COUNT] =
   192000
 };
 
+/* the first byte of a DTS or AC3 sync word, or the TrueHD sync word 4 bytes in */
+static inline bool IsSyncCandidate(const uint8_t *data)
+{
+  switch (data[0])
+  {
+    case 0x1F: case 0xFF: case 0x7F: case 0xFE: case 0x0B:
+      return true;
+    default:
+      return data[4] == 0xF8;
+  }
+}
+
+/* position of the first possible sync word in data[0 .. count), reads up to data[count + 3] */
+static unsigned int FindSyncCandidate(const uint8_t *data, unsigned int count)
+{
+  unsigned int i = 0;
+#if defined(__SSE2__)
+  const __m128i dts14be = _mm_set1_epi8((char)0x1F);
+  const __m128i dts14le = _mm_set1_epi8((char)0xFF);
+  const __m128i dts16be = _mm_set1_epi8((char)0x7F);
+  const __m128i dts16le = _mm_set1_epi8((char)0xFE);
+  const __m128i ac3     = _mm_set1_epi8((char)0x0B);
+  const __m128i truehd  = _mm_set1_epi8((char)0xF8);
+  for (; i + 16 <= count; i += 16)
+  {
+    __m128i head = _mm_loadu_si128((const __m128i*)(data + i));
+    __m128i major = _mm_loadu_si128((const __m128i*)(data + i + 4));
+    __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(head, dts14be), _mm_cmpeq_epi8(head, dts14le)),
+                               _mm_or_si128(_mm_cmpeq_epi8(head, dts16be), _mm_cmpeq_epi8(head, dts16le)));
+    hit = _mm_or_si128(hit, _mm_or_si128(_mm_cmpeq_epi8(head, ac3), _mm_cmpeq_epi8(major, truehd)));
+    int mask = _mm_movemask_epi8(hit);
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+#elif defined(AE_STREAM_NEON)
+  const uint8x16_t dts14be = vdupq_n_u8(0x1F);
+  const uint8x16_t dts14le = vdupq_n_u8(0xFF);
+  const uint8x16_t dts16be = vdupq_n_u8(0x7F);
+  const uint8x16_t dts16le = vdupq_n_u8(0xFE);
+  const uint8x16_t ac3     = vdupq_n_u8(0x0B);
+  const uint8x16_t truehd  = vdupq_n_u8(0xF8);
+  for (; i + 16 <= count; i += 16)
+  {
+    uint8x16_t head = vld1q_u8(data + i);
+    uint8x16_t major = vld1q_u8(data + i + 4);
+    uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(head, dts14be), vceqq_u8(head, dts14le)),
+                              vorrq_u8(vceqq_u8(head, dts16be), vceqq_u8(head, dts16le)));
+    hit = vorrq_u8(hit, vorrq_u8(vceqq_u8(head, ac3), vceqq_u8(major, truehd)));
+    uint64x2_t any = vreinterpretq_u64_u8(hit);
+    if (vgetq_lane_u64(any, 0) | vgetq_lane_u64(any, 1))
+      break;
+  }
+#endif
+  for (; i < count; i++)
+  {
+    if (IsSyncCandidate(data + i))
+      return i;
+  }
+  return count;
+}
+
 CAEStreamParser::CAEStreamParser() :
   m_bufferSize    (0),
   m_skipBytes     (0),
+  m_noCopy        (false),
+  m_frameBytes    (0),
   m_coreOnly      (false),
   m_needBytes     (0),
   m_syncFunc      (&CAEStreamParser::DetectType),
@@ -141,12 +211,61 @@ void CAEStreamParser::Reset()
 {
   m_skipBytes = 0;
   m_bufferSize = 0;
+  m_frameBytes = 0;
   m_needBytes = 0;
   m_hasSync = false;
 }
 
+int CAEStreamParser::AddDataNoCopy(uint8_t *data, unsigned int size, uint8_t **frame, unsigned int *frameSize)
+{
+  DropFrame();
+
+  /*
+    Once in sync and with nothing buffered, a frame starting at data is
+    parsed in place. E-AC3 is left to AddData, it concatenates dependent
+    substreams from several calls.
+  */
+  if (size && m_hasSync && !m_bufferSize && !m_skipBytes && !m_needBytes && !m_fsizeMain &&
+      m_info.m_type != CAEStreamInfo::STREAM_TYPE_EAC3)
+  {
+    CAEStreamInfo info   = m_info;
+    ParseFunc syncFunc   = m_syncFunc;
+    unsigned int dtsBlocks = m_dtsBlocks;
+    int substreams       = m_substreams;
+
+    unsigned int offset = (this->*m_syncFunc)(data, std::min(size, (unsigned int)sizeof(m_buffer)));
+    if (m_hasSync && !m_needBytes && !offset && m_fsize && m_fsize <= size)
+    {
+      *frame = data;
+      *frameSize = m_info.m_type == CAEStreamInfo::STREAM_TYPE_DTSHD_CORE ? m_coreSize : m_fsize;
+      unsigned int consumed = m_fsize;
+      m_fsize = 0;
+      m_coreSize = 0;
+      return consumed;
+    }
+
+    /* partial frame or lost sync, rewind and take the buffered path */
+    m_info       = info;
+    m_syncFunc   = syncFunc;
+    m_dtsBlocks  = dtsBlocks;
+    m_substreams = substreams;
+    m_hasSync    = true;
+    m_needBytes  = 0;
+    m_fsize      = 0;
+    m_fsizeMain  = 0;
+    m_coreSize   = 0;
+  }
+
+  m_noCopy = true;
+  int consumed = AddData(data, size, frame, frameSize);
+  m_noCopy = false;
+  return consumed;
+}
+
 int CAEStreamParser::AddData(uint8_t *data, unsigned int size, uint8_t **buffer/* = NULL */, unsigned int *bufferSize/* = 0 */)
 {
+  DropFrame();
+
   if (size == 0)
   {
     if (bufferSize)
@@ -256,6 +375,18 @@ void CAEStreamParser::GetPacket(uint8_t **buffer, unsigned int *bufferSize)
     if (m_info.m_type == CAEStreamInfo::STREAM_TYPE_DTSHD_CORE)
       size = m_coreSize;
 
+    /* leave the frame where it is, it is removed on the next call */
+    if (m_noCopy)
+    {
+      *buffer = m_buffer;
+      if (bufferSize)
+        *bufferSize = size;
+      m_frameBytes = m_fsize;
+      m_fsize = 0;
+      m_coreSize = 0;
+      return;
+    }
+
     /* make sure the buffer is allocated and big enough */
     if (!*buffer || !bufferSize || *bufferSize < size)
     {
@@ -276,6 +407,16 @@ void CAEStreamParser::GetPacket(uint8_t **buffer, unsigned int *bufferSize)
   m_coreSize = 0;
 }
 
+void CAEStreamParser::DropFrame()
+{
+  if (!m_frameBytes)
+    return;
+
+  m_bufferSize -= m_frameBytes;
+  memmove(m_buffer, m_buffer + m_frameBytes, m_bufferSize);
+  m_frameBytes = 0;
+}
+
 /* SYNC FUNCTIONS */
 
 /*
@@ -291,6 +432,14 @@ unsigned int CAEStreamParser::DetectType(uint8_t *data, unsigned int size)
 
   while (size > 8)
   {
+    /* skip to the next byte that can start a sync word */
+    unsigned int next = FindSyncCandidate(data, size - 8);
+    skipped += next;
+    data    += next;
+    size    -= next;
+    if (size <= 8)
+      break;
+
     /* if it could be DTS */
     unsigned int header = data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
     if (header == DTS_PREAMBLE_14LE ||
@@ -68,6 +68,16 @@ public:
 
   int AddData(uint8_t *data, unsigned int size, uint8_t **buffer = NULL, unsigned int *bufferSize = 0);
 
+  /**
+   * Same as AddData without copying the frame. If a complete frame starts at
+   * data, frame points into data and nothing is buffered. Otherwise data is
+   * buffered as in AddData and frame points into the parser.
+   * @param frame receives the frame if frameSize is not 0, valid until data is
+   *        released or the next call to the parser
+   * @return number of bytes consumed
+   */
+  int AddDataNoCopy(uint8_t *data, unsigned int size, uint8_t **frame, unsigned int *frameSize);
+
   void SetCoreOnly(bool value) { m_coreOnly = value; }
   unsigned int IsValid() { return m_hasSync; }
   unsigned int GetSampleRate() { return m_info.m_sampleRate; }
@@ -78,7 +88,7 @@ public:
   unsigned int GetEAC3BlocksDiv() { return m_info.m_repeat; }
   enum CAEStreamInfo::DataType GetDataType() { return m_info.m_type; }
   bool IsLittleEndian() { return m_info.m_dataIsLE; }
-  unsigned int GetBufferSize() { return m_bufferSize; }
+  unsigned int GetBufferSize() { return m_bufferSize - m_frameBytes; }
   CAEStreamInfo& GetStreamInfo() { return m_info; }
   void Reset();
 
@@ -86,6 +96,8 @@ private:
   uint8_t m_buffer[MAX_IEC61937_PACKET];
   unsigned int m_bufferSize;
   unsigned int m_skipBytes;
+  bool m_noCopy;                   /* hand out frames in m_buffer */
+  unsigned int m_frameBytes;       /* size of the frame handed out from m_buffer */
 
   typedef unsigned int (CAEStreamParser::*ParseFunc)(uint8_t *data, unsigned int size);
 
@@ -103,6 +115,7 @@ private:
   AVCRC m_crcTrueHD[1024];  /* TrueHD crc table */
 
   void GetPacket(uint8_t **buffer, unsigned int *bufferSize);
+  void DropFrame();
   unsigned int DetectType(uint8_t *data, unsigned int size);
   unsigned int SyncAC3(uint8_t *data, unsigned int size);
   unsigned int SyncDTS(uint8_t *data, unsigned int size);
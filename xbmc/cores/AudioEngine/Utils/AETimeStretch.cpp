@@ -0,0 +1,313 @@
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AETimeStretch.h"
+#include "AEKernels.h"
+
+#include <algorithm>
+#include <math.h>
+
+#define COARSE_STEP 4   // the search tries every 4th shift, then refines around the best
+
+const unsigned int CAETimeStretch::WINDOW_MS;
+const unsigned int CAETimeStretch::SEARCH_MS;
+
+CAETimeStretch::CAETimeStretch()
+{
+  m_channels = 0;
+  m_hop = 0;
+  m_search = 0;
+  m_tempo = 1.0;
+  Reset();
+}
+
+CAETimeStretch::~CAETimeStretch()
+{
+}
+
+void CAETimeStretch::Init(unsigned int channels, unsigned int sampleRate)
+{
+  m_channels = channels;
+  m_hop = std::max(32u, sampleRate * WINDOW_MS / 2000);
+  m_search = sampleRate * SEARCH_MS / 1000;
+
+  // halves of a hann window, they add up to 1 so tempo 1 is transparent
+  m_fadeIn.resize(m_hop);
+  m_fadeOut.resize(m_hop);
+  for (unsigned int i = 0; i < m_hop; i++)
+  {
+    m_fadeIn[i] = 0.5f - 0.5f * (float)cos(M_PI * i / m_hop);
+    m_fadeOut[i] = 1.0f - m_fadeIn[i];
+  }
+
+  m_input.assign(channels, std::vector<float>());
+  m_overlap.assign(channels, std::vector<float>(m_hop));
+  m_output.assign(channels, std::vector<float>(m_hop));
+  m_planes.resize(channels);
+  Reset();
+}
+
+void CAETimeStretch::SetTempo(double tempo)
+{
+  m_tempo = tempo;
+}
+
+void CAETimeStretch::Reset()
+{
+  for (auto &input : m_input)
+    input.clear();
+  m_mono.clear();
+  m_engaged = false;
+  m_pos = 0;
+  m_prev = 0;
+  m_rawPos = 0;
+  m_outputPos = 0;
+  m_outputFrames = 0;
+}
+
+void CAETimeStretch::Put(const float * const *data, unsigned int frames, bool planar)
+{
+  Compact();
+
+  unsigned int start = m_mono.size();
+  for (unsigned int c = 0; c < m_channels; c++)
+  {
+    std::vector<float> &input = m_input[c];
+    if (planar)
+      input.insert(input.end(), data[c], data[c] + frames);
+    else
+    {
+      input.resize(start + frames);
+      const float *src = data[0] + c;
+      for (unsigned int i = 0; i < frames; i++)
+        input[start + i] = src[i * m_channels];
+    }
+  }
+
+  float scale = 1.0f / m_channels;
+  m_mono.resize(start + frames);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    float sum = 0.0f;
+    for (unsigned int c = 0; c < m_channels; c++)
+      sum += m_input[c][start + i];
+    m_mono[start + i] = sum * scale;
+  }
+}
+
+unsigned int CAETimeStretch::Get(float **data, unsigned int frames, bool planar, bool drain)
+{
+  unsigned int done = 0;
+  while (done < frames)
+  {
+    if (m_outputPos < m_outputFrames)
+    {
+      for (unsigned int c = 0; c < m_channels; c++)
+        m_planes[c] = m_output[c].data() + m_outputPos;
+      unsigned int count = CopyOutput(data, done, m_planes.data(), std::min(frames - done, m_outputFrames - m_outputPos), planar);
+      m_outputPos += count;
+      done += count;
+      continue;
+    }
+
+    if (m_engaged && m_tempo == 1.0)
+      Disengage();
+    if (!m_engaged && m_tempo != 1.0 && Available() >= m_rawPos + m_hop)
+      Engage();
+
+    if (m_engaged)
+    {
+      if (ProcessWindow())
+        continue;
+      if (!drain)
+        break;
+      // not enough left for a window, the tail is copied
+      Disengage();
+    }
+    else if (m_tempo != 1.0 && !drain)
+      break;
+
+    unsigned int count = std::min(frames - done, Available() - m_rawPos);
+    if (!count)
+      break;
+    for (unsigned int c = 0; c < m_channels; c++)
+      m_planes[c] = m_input[c].data() + m_rawPos;
+    CopyOutput(data, done, m_planes.data(), count, planar);
+    m_rawPos += count;
+    done += count;
+  }
+  return done;
+}
+
+bool CAETimeStretch::NeedData() const
+{
+  if (m_outputPos < m_outputFrames)
+    return false;
+  if (m_engaged && m_tempo != 1.0)
+    return (int)floor(m_pos + 0.5) + (int)(m_search + 2 * m_hop) > (int)Available();
+
+  unsigned int pos = m_engaged ? m_prev + m_hop : m_rawPos;
+  if (m_tempo == 1.0)
+    return pos >= Available();
+  return pos + m_search + 2 * m_hop > Available();
+}
+
+bool CAETimeStretch::IsIdle() const
+{
+  return !m_engaged && m_rawPos >= Available() && m_outputPos >= m_outputFrames;
+}
+
+unsigned int CAETimeStretch::GetBufferedFrames() const
+{
+  unsigned int pos = m_engaged ? m_prev + m_hop : m_rawPos;
+  double frames = Available() - std::min(pos, Available());
+  frames += (m_outputFrames - m_outputPos) * m_tempo;
+  return (unsigned int)frames;
+}
+
+void CAETimeStretch::Engage()
+{
+  // the frames at m_rawPos become the tail of a virtual last window
+  m_prev = (int)m_rawPos - (int)m_hop;
+  m_pos = m_rawPos;
+  for (unsigned int c = 0; c < m_channels; c++)
+  {
+    const float *src = m_input[c].data() + m_rawPos;
+    for (unsigned int i = 0; i < m_hop; i++)
+      m_overlap[c][i] = src[i] * m_fadeOut[i];
+  }
+  m_engaged = true;
+}
+
+void CAETimeStretch::Disengage()
+{
+  // faded out plus faded in is the plain input, copying on from the
+  // tail of the last window joins without a seam
+  m_rawPos = m_prev + m_hop;
+  m_engaged = false;
+}
+
+bool CAETimeStretch::ProcessWindow()
+{
+  int nominal = (int)floor(m_pos + 0.5);
+  int lo = std::max(0, nominal - (int)m_search);
+  int hi = nominal + m_search;
+  if (hi + 2 * m_hop > Available())
+    return false;
+
+  int best = Search(m_prev + m_hop, lo, hi, nominal);
+
+  for (unsigned int c = 0; c < m_channels; c++)
+  {
+    const float *src = m_input[c].data() + best;
+    float *out = m_output[c].data();
+    float *overlap = m_overlap[c].data();
+    for (unsigned int i = 0; i < m_hop; i++)
+    {
+      out[i] = overlap[i] + src[i] * m_fadeIn[i];
+      overlap[i] = src[m_hop + i] * m_fadeOut[i];
+    }
+  }
+  m_outputPos = 0;
+  m_outputFrames = m_hop;
+
+  m_prev = best;
+  m_pos += m_hop * m_tempo;
+  return true;
+}
+
+int CAETimeStretch::Search(int target, int lo, int hi, int nominal)
+{
+  // energies of all candidates from a running sum of squares
+  m_energy.resize(hi - lo + m_hop + 1);
+  m_energy[0] = 0.0;
+  const float *mono = m_mono.data() + lo;
+  for (unsigned int i = 0; i < m_energy.size() - 1; i++)
+    m_energy[i + 1] = m_energy[i] + (double)mono[i] * mono[i];
+
+  const float *ref = m_mono.data() + target;
+  auto score = [&](int pos)
+  {
+    double energy = m_energy[pos - lo + m_hop] - m_energy[pos - lo];
+    double corr = CAEKernels::DotProduct(ref, m_mono.data() + pos, m_hop);
+    return corr / sqrt(energy + 1e-9);
+  };
+
+  // nominal wins ties, silence is not shifted
+  int best = std::max(lo, nominal);
+  double bestScore = score(best);
+  for (int pos = lo; pos <= hi; pos += COARSE_STEP)
+  {
+    double s = score(pos);
+    if (s > bestScore)
+    {
+      bestScore = s;
+      best = pos;
+    }
+  }
+
+  int coarse = best;
+  for (int pos = std::max(lo, coarse - COARSE_STEP + 1); pos <= std::min(hi, coarse + COARSE_STEP - 1); pos++)
+  {
+    if (pos == coarse)
+      continue;
+    double s = score(pos);
+    if (s > bestScore)
+    {
+      bestScore = s;
+      best = pos;
+    }
+  }
+  return best;
+}
+
+void CAETimeStretch::Compact()
+{
+  int base;
+  if (m_engaged)
+    base = std::min(m_prev + (int)m_hop, (int)floor(m_pos + 0.5) - (int)m_search);
+  else
+    base = m_rawPos;
+
+  // frames before base are not looked at again, drop them once in a while
+  if (base < (int)(4 * m_hop))
+    return;
+
+  for (auto &input : m_input)
+    input.erase(input.begin(), input.begin() + base);
+  m_mono.erase(m_mono.begin(), m_mono.begin() + base);
+  m_prev -= base;
+  m_pos -= base;
+  if (!m_engaged)
+    m_rawPos -= base;
+}
+
+unsigned int CAETimeStretch::CopyOutput(float **data, unsigned int offset, const float * const *src,
+                                        unsigned int frames, bool planar)
+{
+  if (planar)
+  {
+    for (unsigned int c = 0; c < m_channels; c++)
+      std::copy(src[c], src[c] + frames, data[c] + offset);
+  }
+  else
+    CAEKernels::Interleave(data[0] + offset * m_channels, src, m_channels, frames);
+  return frames;
+}
@@ -0,0 +1,105 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2016 Team Kodi
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+/**
+ * Time stretching of float samples without change of pitch (WSOLA).
+ * Output is made of half overlapping windows taken from the input at the
+ * nominal position for the tempo, each shifted by up to a few ms to where
+ * it best continues the previous one. The tempo can change at any time,
+ * it applies from the next window on. At tempo 1 samples are copied.
+ */
+class CAETimeStretch
+{
+public:
+  static const unsigned int WINDOW_MS = 24;
+  static const unsigned int SEARCH_MS = 8;
+
+  CAETimeStretch();
+  ~CAETimeStretch();
+
+  void Init(unsigned int channels, unsigned int sampleRate);
+
+  /**
+   * @param tempo playback speed, > 1 is faster
+   */
+  void SetTempo(double tempo);
+  double GetTempo() const { return m_tempo; }
+
+  /**
+   * Queue input
+   * @param data one plane per channel or interleaved samples in data[0]
+   */
+  void Put(const float * const *data, unsigned int frames, bool planar);
+
+  /**
+   * Take output
+   * @param drain stretch what can be stretched, copy the rest of the input
+   * @return frames written, less than requested if more input is needed
+   */
+  unsigned int Get(float **data, unsigned int frames, bool planar, bool drain);
+
+  /**
+   * Nothing can be taken without more input
+   */
+  bool NeedData() const;
+
+  /**
+   * Tempo 1 and nothing queued, samples may bypass the stretcher
+   */
+  bool IsIdle() const;
+
+  /**
+   * Queued frames in input time, for timestamps and delay
+   */
+  unsigned int GetBufferedFrames() const;
+
+  void Reset();
+
+protected:
+  unsigned int Available() const { return m_mono.size(); }
+  void Engage();
+  void Disengage();
+  bool ProcessWindow();
+  int Search(int target, int lo, int hi, int nominal);
+  void Compact();
+  unsigned int CopyOutput(float **data, unsigned int offset, const float * const *src, unsigned int frames, bool planar);
+
+  unsigned int m_channels;
+  unsigned int m_hop;                          // frames of output per window, half a window
+  unsigned int m_search;                       // max shift of a window
+  double m_tempo;
+  bool m_engaged;
+  double m_pos;                                // nominal input position of the next window
+  int m_prev;                                  // input position of the last window
+  unsigned int m_rawPos;                       // next frame to copy at tempo 1
+  std::vector<std::vector<float> > m_input;    // per channel
+  std::vector<float> m_mono;                   // mix of the channels for the search
+  std::vector<double> m_energy;                // running sum of squares over the search range
+  std::vector<std::vector<float> > m_overlap;  // faded second half of the last window
+  std::vector<std::vector<float> > m_output;   // one hop of output
+  unsigned int m_outputPos;
+  unsigned int m_outputFrames;
+  std::vector<float> m_fadeIn;
+  std::vector<float> m_fadeOut;
+  std::vector<const float*> m_planes;
+};
@@ -142,8 +142,6 @@ private:
     static __m128i m_sseSeed;
   #endif
 
-  static float SoftClamp(const float x);
-
 public:
   static CAEChannelInfo          GuessChLayout     (const unsigned int channels);
   static const char*             GetStdChLayoutName(const enum AEStdChLayout layout);
@@ -211,12 +209,6 @@ public:
     return 20*log10(scale);
   }
 
-  #if defined(HAVE_SSE) && defined(__SSE__)
-  static void SSEMulArray     (float *data, const float mul, uint32_t count);
-  static void SSEMulAddArray  (float *data, float *add, const float mul, uint32_t count);
-  #endif
-  static void ClampArray(float *data, uint32_t count);
-
   /*
     Rand implementations based on:
     http://software.intel.com/en-us/articles/fast-random-number-generator-on-the-intel-pentiumr-4-processor/
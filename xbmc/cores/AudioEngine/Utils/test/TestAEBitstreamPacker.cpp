@@ -0,0 +1,158 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEBitstreamPacker.h"
+#include "cores/AudioEngine/Utils/AEStreamInfo.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+/*
+  The golden values are FNV-1a hashes of bursts captured from the packer
+  before TrueHD was assembled in place, for a fixed pseudo random input.
+  Bursts are byte swapped on little endian hosts only.
+*/
+
+#ifndef __BIG_ENDIAN__
+
+static uint64_t Hash(const uint8_t *data, unsigned int size)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned int i = 0; i < size; i++)
+  {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static std::vector<uint8_t> Noise(unsigned int size, uint32_t seed)
+{
+  std::vector<uint8_t> data(size);
+  for (auto &byte : data)
+  {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+  return data;
+}
+
+static CAEStreamInfo Info(CAEStreamInfo::DataType type, unsigned int sampleRate)
+{
+  CAEStreamInfo info;
+  info.m_type = type;
+  info.m_sampleRate = sampleRate;
+  info.m_channels = 8;
+  info.m_dataIsLE = false;
+  info.m_dtsPeriod = 2048;
+  info.m_repeat = 1;
+  return info;
+}
+
+/* 24 TrueHD access units of different sizes make a MAT frame */
+static uint64_t PackTrueHD(CAEBitstreamPacker &packer, uint32_t seed, unsigned int *size)
+{
+  CAEStreamInfo info = Info(CAEStreamInfo::STREAM_TYPE_TRUEHD, 48000);
+  for (unsigned int i = 0; i < 24; i++)
+  {
+    std::vector<uint8_t> unit = Noise((600 + (i * 187) % 650) * 2, seed + i);
+    packer.Pack(info, unit.data(), unit.size());
+    if (i < 23)
+      EXPECT_EQ(0u, packer.GetSize());
+  }
+  *size = packer.GetSize();
+  return Hash(packer.GetBuffer(), packer.GetSize());
+}
+
+TEST(TestAEBitstreamPacker, TrueHD)
+{
+  CAEBitstreamPacker packer;
+  unsigned int size;
+
+  uint64_t first = PackTrueHD(packer, 1, &size);
+  EXPECT_EQ(61440u, size);
+  EXPECT_EQ(0xBABDB4BF4B1C102AULL, first);
+
+  // the second frame must not carry anything over from the first
+  uint64_t second = PackTrueHD(packer, 100, &size);
+  EXPECT_EQ(61440u, size);
+  EXPECT_EQ(0x2811A494CCFDBADCULL, second);
+}
+
+TEST(TestAEBitstreamPacker, DTSHD)
+{
+  CAEBitstreamPacker packer;
+  CAEStreamInfo info = Info(CAEStreamInfo::STREAM_TYPE_DTSHD, 48000);
+  std::vector<uint8_t> frame = Noise(3006, 2);
+  packer.Pack(info, frame.data(), frame.size());
+  EXPECT_EQ(8192u, packer.GetSize());
+  EXPECT_EQ(0xE1D9371A7856C0CDULL, Hash(packer.GetBuffer(), packer.GetSize()));
+
+  // a smaller frame after a bigger one
+  frame = Noise(2000, 3);
+  packer.Pack(info, frame.data(), frame.size());
+  EXPECT_EQ(8192u, packer.GetSize());
+  EXPECT_EQ(0x10DA52245E7CD99BULL, Hash(packer.GetBuffer(), packer.GetSize()));
+}
+
+TEST(TestAEBitstreamPacker, AC3)
+{
+  CAEBitstreamPacker packer;
+  CAEStreamInfo info = Info(CAEStreamInfo::STREAM_TYPE_AC3, 48000);
+  std::vector<uint8_t> frame = Noise(1792, 4);
+  packer.Pack(info, frame.data(), frame.size());
+  EXPECT_EQ(6144u, packer.GetSize());
+  EXPECT_EQ(0x7F85BF8F7E49E3A9ULL, Hash(packer.GetBuffer(), packer.GetSize()));
+}
+
+TEST(TestAEBitstreamPacker, EAC3)
+{
+  CAEBitstreamPacker packer;
+  CAEStreamInfo info = Info(CAEStreamInfo::STREAM_TYPE_EAC3, 48000);
+  info.m_repeat = 6;
+  for (unsigned int i = 0; i < 6; i++)
+  {
+    std::vector<uint8_t> frame = Noise(512, 5 + i);
+    packer.Pack(info, frame.data(), frame.size());
+  }
+  EXPECT_EQ(24576u, packer.GetSize());
+  EXPECT_EQ(0x1E24338B50CE696EULL, Hash(packer.GetBuffer(), packer.GetSize()));
+}
+
+TEST(TestAEBitstreamPacker, DTS)
+{
+  CAEBitstreamPacker packer;
+  CAEStreamInfo info = Info(CAEStreamInfo::STREAM_TYPE_DTS_512, 48000);
+  std::vector<uint8_t> frame = Noise(1006, 11);
+  packer.Pack(info, frame.data(), frame.size());
+  EXPECT_EQ(2048u, packer.GetSize());
+  EXPECT_EQ(0x53138366E579F3B7ULL, Hash(packer.GetBuffer(), packer.GetSize()));
+}
+
+TEST(TestAEBitstreamPacker, Pause)
+{
+  CAEBitstreamPacker packer;
+  CAEStreamInfo info = Info(CAEStreamInfo::STREAM_TYPE_TRUEHD, 48000);
+  packer.PackPause(info, 20, true);
+  EXPECT_EQ(0xF28480D1FC26A842ULL, Hash(packer.GetBuffer(), packer.GetSize()));
+}
+
+#endif
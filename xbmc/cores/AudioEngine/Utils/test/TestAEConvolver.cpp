@@ -0,0 +1,260 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEConvolver.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static std::vector<float> Noise(unsigned int count, float amplitude, unsigned int seed)
+{
+  std::vector<float> data(count);
+  srand(seed);
+  for (unsigned int i = 0; i < count; i++)
+    data[i] = amplitude * (2.0f * rand() / RAND_MAX - 1.0f);
+  return data;
+}
+
+// direct form reference, delayed by the latency of the convolver
+static std::vector<float> Convolve(const std::vector<float> &input, const std::vector<float> &filter, unsigned int delay)
+{
+  std::vector<float> output(input.size(), 0.0f);
+  for (unsigned int i = delay; i < input.size(); i++)
+  {
+    double sum = 0.0;
+    unsigned int n = i - delay;
+    for (unsigned int j = 0; j < filter.size() && j <= n; j++)
+      sum += (double)filter[j] * input[n - j];
+    output[i] = (float)sum;
+  }
+  return output;
+}
+
+static void AppendWAV(std::vector<uint8_t> &wav, const char *id, const std::vector<uint8_t> &data)
+{
+  wav.insert(wav.end(), id, id + 4);
+  uint32_t size = data.size();
+  for (int i = 0; i < 4; i++)
+    wav.push_back(size >> (i * 8));
+  wav.insert(wav.end(), data.begin(), data.end());
+  if (size & 1)
+    wav.push_back(0);
+}
+
+static std::vector<uint8_t> MakeWAV(uint16_t format, uint16_t channels, uint32_t rate, uint16_t bits,
+                                    const std::vector<uint8_t> &samples)
+{
+  uint16_t align = channels * bits / 8;
+  uint32_t byteRate = rate * align;
+  std::vector<uint8_t> fmt;
+  for (uint32_t value : { (uint32_t)format, (uint32_t)channels })
+    fmt.insert(fmt.end(), { (uint8_t)value, (uint8_t)(value >> 8) });
+  for (uint32_t value : { rate, byteRate })
+    fmt.insert(fmt.end(), { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) });
+  fmt.insert(fmt.end(), { (uint8_t)align, (uint8_t)(align >> 8), (uint8_t)bits, (uint8_t)(bits >> 8) });
+
+  std::vector<uint8_t> body = { 'W', 'A', 'V', 'E' };
+  AppendWAV(body, "fmt ", fmt);
+  AppendWAV(body, "LIST", std::vector<uint8_t>(3, 0));
+  AppendWAV(body, "data", samples);
+
+  std::vector<uint8_t> wav;
+  AppendWAV(wav, "RIFF", body);
+  return wav;
+}
+
+TEST(TestAEConvolver, BlockSize)
+{
+  EXPECT_EQ(CAEConvolver::MIN_BLOCK_SIZE, CAEConvolver::GetBlockSize(1));
+  EXPECT_EQ(1024u, CAEConvolver::GetBlockSize(65536));
+  EXPECT_EQ(CAEConvolver::MAX_BLOCK_SIZE, CAEConvolver::GetBlockSize(CAEConvolver::MAX_TAPS));
+}
+
+TEST(TestAEConvolver, MatchesDirectForm)
+{
+  const unsigned int block = 64;
+  std::vector<float> filter = Noise(5 * block + 17, 0.2f, 1);
+  std::vector<float> input = Noise(40 * block, 0.5f, 2);
+  std::vector<float> ref = Convolve(input, filter, block);
+
+  // packets smaller, bigger and not a multiple of the block
+  for (unsigned int packet : { 1u, 37u, block, 3 * block + 5 })
+  {
+    CAEConvolver convolver;
+    ASSERT_TRUE(convolver.Init({ filter }, block));
+    EXPECT_EQ(block, convolver.GetLatency());
+
+    std::vector<float> out = input;
+    for (unsigned int pos = 0; pos < out.size(); pos += packet)
+    {
+      float *data = out.data() + pos;
+      convolver.Process(&data, 1, std::min(packet, (unsigned int)out.size() - pos), true);
+    }
+    for (unsigned int i = 0; i < out.size(); i++)
+      ASSERT_NEAR(ref[i], out[i], 1e-4) << "packet " << packet << " frame " << i;
+  }
+}
+
+TEST(TestAEConvolver, Interleaved)
+{
+  const unsigned int block = 32;
+  const unsigned int frames = 20 * block;
+  std::vector<float> left = Noise(frames, 0.5f, 3);
+  std::vector<float> right = Noise(frames, 0.5f, 4);
+  std::vector<float> filter = Noise(3 * block, 0.3f, 5);
+
+  // the second channel has no filter and is only delayed
+  CAEConvolver convolver;
+  ASSERT_TRUE(convolver.Init({ filter, std::vector<float>() }, block));
+
+  std::vector<float> stereo(2 * frames);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    stereo[2 * i] = left[i];
+    stereo[2 * i + 1] = right[i];
+  }
+  for (unsigned int pos = 0; pos < frames; pos += 50)
+  {
+    float *data = stereo.data() + 2 * pos;
+    convolver.Process(&data, 2, std::min(50u, frames - pos), false);
+  }
+
+  std::vector<float> ref = Convolve(left, filter, block);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    ASSERT_NEAR(ref[i], stereo[2 * i], 1e-4) << "frame " << i;
+    ASSERT_EQ(i < block ? 0.0f : right[i - block], stereo[2 * i + 1]) << "frame " << i;
+  }
+}
+
+TEST(TestAEConvolver, MoreChannelsThanFilters)
+{
+  const unsigned int block = 32;
+  const unsigned int frames = 20 * block;
+  std::vector<float> left = Noise(frames, 0.5f, 8);
+  std::vector<float> right = Noise(frames, 0.5f, 9);
+  std::vector<float> filter = Noise(2 * block, 0.3f, 10);
+
+  // a filter for the first channel only, the second one is left alone
+  CAEConvolver convolver;
+  ASSERT_TRUE(convolver.Init({ filter }, block));
+
+  std::vector<float> stereo(2 * frames);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    stereo[2 * i] = left[i];
+    stereo[2 * i + 1] = right[i];
+  }
+  for (unsigned int pos = 0; pos < frames; pos += 50)
+  {
+    float *data = stereo.data() + 2 * pos;
+    convolver.Process(&data, 2, std::min(50u, frames - pos), false);
+  }
+
+  std::vector<float> ref = Convolve(left, filter, block);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    ASSERT_NEAR(ref[i], stereo[2 * i], 1e-4) << "frame " << i;
+    ASSERT_EQ(right[i], stereo[2 * i + 1]) << "frame " << i;
+  }
+}
+
+TEST(TestAEConvolver, Reset)
+{
+  const unsigned int block = 64;
+  CAEConvolver convolver;
+  ASSERT_TRUE(convolver.Init({ Noise(4 * block, 0.3f, 6) }, block));
+
+  std::vector<float> noise = Noise(10 * block, 0.5f, 7);
+  float *data = noise.data();
+  convolver.Process(&data, 1, noise.size(), true);
+
+  // nothing of the old signal must come out after a reset
+  convolver.Reset();
+  std::vector<float> silence(10 * block, 0.0f);
+  data = silence.data();
+  convolver.Process(&data, 1, silence.size(), true);
+  for (float sample : silence)
+    ASSERT_EQ(0.0f, sample);
+}
+
+TEST(TestAEConvolver, NoFilter)
+{
+  CAEConvolver convolver;
+  EXPECT_FALSE(convolver.Init({ std::vector<float>(), std::vector<float>() }));
+  EXPECT_FALSE(convolver.IsActive());
+  EXPECT_EQ(0u, convolver.GetLatency());
+
+  // inactive, samples pass unchanged
+  std::vector<float> data = { 0.5f, -0.5f };
+  float *planes = data.data();
+  convolver.Process(&planes, 1, data.size(), true);
+  EXPECT_EQ(0.5f, data[0]);
+}
+
+TEST(TestAEConvolver, ParseWAV)
+{
+  // 2 channels, 16 bit
+  std::vector<uint8_t> samples = { 0x00, 0x40, 0x00, 0xC0,   // 0.5, -0.5
+                                   0xFF, 0x7F, 0x00, 0x00 }; // ~1.0, 0
+  std::vector<uint8_t> wav = MakeWAV(1, 2, 44100, 16, samples);
+  std::vector<std::vector<float> > filters;
+  unsigned int rate = 0;
+  ASSERT_TRUE(CAEConvolver::ParseWAV(wav.data(), wav.size(), filters, rate));
+  EXPECT_EQ(44100u, rate);
+  ASSERT_EQ(2u, filters.size());
+  ASSERT_EQ(2u, filters[0].size());
+  EXPECT_EQ(0.5f, filters[0][0]);
+  EXPECT_EQ(-0.5f, filters[1][0]);
+  EXPECT_NEAR(1.0f, filters[0][1], 1e-4);
+  EXPECT_EQ(0.0f, filters[1][1]);
+
+  // mono, 24 bit
+  samples = { 0x00, 0x00, 0x40, 0x00, 0x00, 0xE0 };           // 0.5, -0.25
+  wav = MakeWAV(1, 1, 48000, 24, samples);
+  ASSERT_TRUE(CAEConvolver::ParseWAV(wav.data(), wav.size(), filters, rate));
+  ASSERT_EQ(1u, filters.size());
+  EXPECT_EQ(0.5f, filters[0][0]);
+  EXPECT_EQ(-0.25f, filters[0][1]);
+
+  // mono, float
+  float value = -0.125f;
+  samples.resize(sizeof(value));
+  memcpy(samples.data(), &value, sizeof(value));
+#ifdef WORDS_BIGENDIAN
+  std::reverse(samples.begin(), samples.end());
+#endif
+  wav = MakeWAV(3, 1, 96000, 32, samples);
+  ASSERT_TRUE(CAEConvolver::ParseWAV(wav.data(), wav.size(), filters, rate));
+  EXPECT_EQ(96000u, rate);
+  EXPECT_EQ(-0.125f, filters[0][0]);
+
+  // a-law, truncated, garbage
+  wav = MakeWAV(6, 1, 8000, 8, samples);
+  EXPECT_FALSE(CAEConvolver::ParseWAV(wav.data(), wav.size(), filters, rate));
+  wav = MakeWAV(1, 1, 48000, 16, samples);
+  EXPECT_FALSE(CAEConvolver::ParseWAV(wav.data(), 20, filters, rate));
+  EXPECT_FALSE(CAEConvolver::ParseWAV(samples.data(), samples.size(), filters, rate));
+}
@@ -0,0 +1,138 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEEngineCounters.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+static int64_t Micros(int64_t us)
+{
+  return CurrentHostFrequency() * us / 1000000;
+}
+
+TEST(TestAEEngineCounters, Stages)
+{
+  CAEEngineCounters counters;
+  counters.AddTime(CAEEngineCounters::STAGE_MIX, Micros(100));
+  counters.AddTime(CAEEngineCounters::STAGE_MIX, Micros(300));
+
+  EXPECT_EQ(2u, counters.GetCount(CAEEngineCounters::STAGE_MIX));
+  EXPECT_EQ(0u, counters.GetCount(CAEEngineCounters::STAGE_WRITE));
+  EXPECT_NEAR(200.0, counters.GetMeanTime(CAEEngineCounters::STAGE_MIX), 1.0);
+  EXPECT_EQ(0.0, counters.GetMeanTime(CAEEngineCounters::STAGE_WRITE));
+
+  CVariant value;
+  counters.Serialize(value);
+  const CVariant &mix = value["stages"]["mix"];
+  EXPECT_EQ(2u, mix["count"].asUnsignedInteger());
+  EXPECT_NEAR(0.4, mix["total"].asDouble(), 0.01);
+  EXPECT_NEAR(300.0, mix["max"].asDouble(), 1.0);
+  EXPECT_TRUE(value["stages"].isMember("decode"));
+  EXPECT_TRUE(value["stages"].isMember("write"));
+}
+
+TEST(TestAEEngineCounters, Histogram)
+{
+  CAEEngineCounters counters;
+  counters.AddTime(CAEEngineCounters::STAGE_WRITE, 0);
+  // 100us falls into [64, 128)
+  counters.AddTime(CAEEngineCounters::STAGE_WRITE, Micros(100));
+  // far beyond the last limit
+  counters.AddTime(CAEEngineCounters::STAGE_WRITE, Micros(10000000));
+
+  CVariant value;
+  counters.Serialize(value);
+  const CVariant &histogram = value["stages"]["write"]["histogram"];
+  ASSERT_EQ(CAEEngineCounters::HISTOGRAM_BUCKETS, histogram.size());
+  EXPECT_EQ(1u, histogram[0].asUnsignedInteger());
+  EXPECT_EQ(1u, histogram[7].asUnsignedInteger());
+  EXPECT_EQ(1u, histogram[CAEEngineCounters::HISTOGRAM_BUCKETS - 1].asUnsignedInteger());
+}
+
+TEST(TestAEEngineCounters, EventsAndPools)
+{
+  CAEEngineCounters counters;
+  counters.AddEvent(CAEEngineCounters::EVENT_UNDERRUN);
+  counters.AddEvent(CAEEngineCounters::EVENT_UNDERRUN);
+  counters.AddEvent(CAEEngineCounters::EVENT_SILENCE);
+  counters.SetPoolLevel(CAEEngineCounters::POOL_SINK, 7, 10);
+  counters.SetPoolLevel(CAEEngineCounters::POOL_SINK, 3, 10);
+
+  EXPECT_EQ(2u, counters.GetEvents(CAEEngineCounters::EVENT_UNDERRUN));
+
+  CVariant value;
+  counters.Serialize(value);
+  EXPECT_EQ(2u, value["underruns"].asUnsignedInteger());
+  EXPECT_EQ(1u, value["silence"].asUnsignedInteger());
+  EXPECT_EQ(0u, value["overruns"].asUnsignedInteger());
+  EXPECT_EQ(3u, value["pools"]["sink"]["used"].asUnsignedInteger());
+  EXPECT_EQ(7u, value["pools"]["sink"]["peak"].asUnsignedInteger());
+  EXPECT_EQ(10u, value["pools"]["sink"]["total"].asUnsignedInteger());
+}
+
+TEST(TestAEEngineCounters, States)
+{
+  static const char *names[] = { "idle", "play" };
+  CAEEngineCounters counters;
+  counters.SetStateNames(names, 2);
+  counters.SetState(0);
+  counters.SetState(0);
+  counters.SetState(1);
+  counters.SetState(0);
+
+  CVariant value;
+  counters.Serialize(value);
+  EXPECT_EQ("idle", value["state"].asString());
+  EXPECT_EQ(3u, value["transitions"].asUnsignedInteger());
+  EXPECT_EQ(2u, value["states"]["idle"].asUnsignedInteger());
+  EXPECT_EQ(1u, value["states"]["play"].asUnsignedInteger());
+}
+
+TEST(TestAEEngineCounters, Latency)
+{
+  CAEEngineCounters counters;
+  counters.SetLatency(true, 0.09, 0.25, (1 << CAEEngineCounters::LIMIT_SINK_PERIOD) |
+                                        (1 << CAEEngineCounters::LIMIT_DEVICE_BUFFER));
+
+  CVariant value;
+  counters.Serialize(value);
+  const CVariant &latency = value["latency"];
+  EXPECT_EQ("low", latency["profile"].asString());
+  EXPECT_NEAR(90.0, latency["target"].asDouble(), 0.01);
+  EXPECT_NEAR(250.0, latency["achieved"].asDouble(), 0.01);
+  ASSERT_EQ(2u, latency["limits"].size());
+  EXPECT_EQ("sinkperiod", latency["limits"][0].asString());
+  EXPECT_EQ("devicebuffer", latency["limits"][1].asString());
+}
+
+TEST(TestAEEngineCounters, Timer)
+{
+  CAEEngineCounters counters;
+  {
+    CAEStageTimer timer(&counters, CAEEngineCounters::STAGE_ENCODE);
+  }
+  {
+    // no counters, nothing to record
+    CAEStageTimer timer(nullptr, CAEEngineCounters::STAGE_ENCODE);
+  }
+  EXPECT_EQ(1u, counters.GetCount(CAEEngineCounters::STAGE_ENCODE));
+}
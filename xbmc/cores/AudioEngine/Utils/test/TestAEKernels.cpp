@@ -0,0 +1,251 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEKernels.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// odd sizes and offsets exercise the scalar tails and unaligned access
+static const unsigned int sizes[] = { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 1024, 1031 };
+static const unsigned int offsets[] = { 0, 1, 3 };
+
+static std::vector<float> Noise(unsigned int count, float amplitude, unsigned int seed)
+{
+  std::vector<float> data(count);
+  srand(seed);
+  for (unsigned int i = 0; i < count; i++)
+    data[i] = amplitude * (2.0f * rand() / RAND_MAX - 1.0f);
+  // values on and around the edges of the clamp curve
+  static const float edges[] = { 0.0f, -0.0f, 1.0f, -1.0f, 3.0f, -3.0f, 3.0001f, -3.0001f };
+  for (unsigned int i = 0; i < count && i < sizeof(edges) / sizeof(edges[0]); i++)
+    data[count - 1 - i] = edges[i];
+  return data;
+}
+
+class TestAEKernels : public ::testing::TestWithParam<int>
+{
+protected:
+  virtual void SetUp()
+  {
+    m_default = CAEKernels::GetImplementation();
+    m_impl = (CAEKernels::Implementation)GetParam();
+  }
+
+  virtual void TearDown()
+  {
+    CAEKernels::SetImplementation(m_default);
+  }
+
+  // false if the implementation can't run here
+  bool Use(CAEKernels::Implementation impl)
+  {
+    return CAEKernels::SetImplementation(impl);
+  }
+
+  CAEKernels::Implementation m_default;
+  CAEKernels::Implementation m_impl;
+};
+
+TEST_P(TestAEKernels, Mul)
+{
+  for (unsigned int size : sizes)
+    for (unsigned int offset : offsets)
+    {
+      std::vector<float> ref = Noise(size + offset, 2.0f, size);
+      std::vector<float> out = ref;
+
+      ASSERT_TRUE(Use(CAEKernels::SCALAR));
+      CAEKernels::Mul(ref.data() + offset, 0.7f, size);
+      if (!Use(m_impl))
+        return;
+      CAEKernels::Mul(out.data() + offset, 0.7f, size);
+
+      EXPECT_EQ(0, memcmp(ref.data(), out.data(), ref.size() * sizeof(float))) << "size " << size << " offset " << offset;
+    }
+}
+
+TEST_P(TestAEKernels, MulAdd)
+{
+  for (unsigned int size : sizes)
+    for (unsigned int offset : offsets)
+    {
+      std::vector<float> add = Noise(size + offset, 1.0f, size + 1);
+      std::vector<float> ref = Noise(size + offset, 0.5f, size);
+      std::vector<float> out = ref;
+
+      ASSERT_TRUE(Use(CAEKernels::SCALAR));
+      bool refClip = CAEKernels::MulAdd(ref.data() + offset, add.data() + offset, 0.6f, size);
+      if (!Use(m_impl))
+        return;
+      bool outClip = CAEKernels::MulAdd(out.data() + offset, add.data() + offset, 0.6f, size);
+
+      EXPECT_EQ(refClip, outClip) << "size " << size << " offset " << offset;
+#if defined(__aarch64__)
+      // the compiler may fuse multiply and add of the reference
+      for (unsigned int i = 0; i < ref.size(); i++)
+        EXPECT_FLOAT_EQ(ref[i], out[i]);
+#else
+      EXPECT_EQ(0, memcmp(ref.data(), out.data(), ref.size() * sizeof(float))) << "size " << size << " offset " << offset;
+#endif
+    }
+}
+
+TEST_P(TestAEKernels, MulAddClip)
+{
+  std::vector<float> data(37, 0.5f);
+  std::vector<float> add(37, 0.5f);
+  if (!Use(m_impl))
+    return;
+
+  EXPECT_FALSE(CAEKernels::MulAdd(data.data(), add.data(), 1.0f, data.size()));
+  // once in the vector part, once in the tail
+  add[5] = -2.0f;
+  EXPECT_TRUE(CAEKernels::MulAdd(data.data(), add.data(), 1.0f, 8));
+  add[5] = 0.0f;
+  add[36] = 2.0f;
+  EXPECT_TRUE(CAEKernels::MulAdd(data.data() + 16, add.data() + 16, 1.0f, 21));
+}
+
+TEST_P(TestAEKernels, Clamp)
+{
+  for (unsigned int size : sizes)
+    for (unsigned int offset : offsets)
+    {
+      std::vector<float> ref = Noise(size + offset, 5.0f, size);
+      std::vector<float> out = ref;
+
+      ASSERT_TRUE(Use(CAEKernels::SCALAR));
+      CAEKernels::Clamp(ref.data() + offset, size);
+      if (!Use(m_impl))
+        return;
+      CAEKernels::Clamp(out.data() + offset, size);
+
+      EXPECT_EQ(0, memcmp(ref.data(), out.data(), ref.size() * sizeof(float))) << "size " << size << " offset " << offset;
+      for (unsigned int i = offset; i < ref.size(); i++)
+        EXPECT_LE(fabs(out[i]), 1.0f);
+    }
+}
+
+TEST_P(TestAEKernels, Interleave)
+{
+  for (unsigned int channels = 1; channels <= 8; channels++)
+    for (unsigned int size : sizes)
+    {
+      std::vector<std::vector<float> > planes;
+      std::vector<const float*> src;
+      for (unsigned int j = 0; j < channels; j++)
+      {
+        planes.push_back(Noise(size + 1, 1.0f, j));
+        src.push_back(planes[j].data() + 1);
+      }
+      std::vector<float> ref(size * channels + 1, 0.0f);
+      std::vector<float> out = ref;
+
+      ASSERT_TRUE(Use(CAEKernels::SCALAR));
+      CAEKernels::Interleave(ref.data() + 1, src.data(), channels, size);
+      if (!Use(m_impl))
+        return;
+      CAEKernels::Interleave(out.data() + 1, src.data(), channels, size);
+
+      EXPECT_EQ(0, memcmp(ref.data(), out.data(), ref.size() * sizeof(float))) << "channels " << channels << " size " << size;
+      if (size > 1)
+      {
+        EXPECT_EQ(planes[channels - 1][2], ref[1 + channels + channels - 1]);
+      }
+    }
+}
+
+TEST_P(TestAEKernels, ComplexMulAdd)
+{
+  for (unsigned int size : sizes)
+    for (unsigned int offset : offsets)
+    {
+      std::vector<float> aRe = Noise(size + offset, 1.0f, size + 1);
+      std::vector<float> aIm = Noise(size + offset, 1.0f, size + 2);
+      std::vector<float> bRe = Noise(size + offset, 1.0f, size + 3);
+      std::vector<float> bIm = Noise(size + offset, 1.0f, size + 4);
+      std::vector<float> refRe = Noise(size + offset, 0.5f, size);
+      std::vector<float> refIm = Noise(size + offset, 0.5f, size + 5);
+      std::vector<float> outRe = refRe;
+      std::vector<float> outIm = refIm;
+
+      ASSERT_TRUE(Use(CAEKernels::SCALAR));
+      CAEKernels::ComplexMulAdd(refRe.data() + offset, refIm.data() + offset, aRe.data() + offset, aIm.data() + offset,
+                                bRe.data() + offset, bIm.data() + offset, size);
+      if (!Use(m_impl))
+        return;
+      CAEKernels::ComplexMulAdd(outRe.data() + offset, outIm.data() + offset, aRe.data() + offset, aIm.data() + offset,
+                                bRe.data() + offset, bIm.data() + offset, size);
+
+#if defined(__aarch64__)
+      for (unsigned int i = 0; i < refRe.size(); i++)
+      {
+        EXPECT_FLOAT_EQ(refRe[i], outRe[i]);
+        EXPECT_FLOAT_EQ(refIm[i], outIm[i]);
+      }
+#else
+      EXPECT_EQ(0, memcmp(refRe.data(), outRe.data(), refRe.size() * sizeof(float))) << "size " << size << " offset " << offset;
+      EXPECT_EQ(0, memcmp(refIm.data(), outIm.data(), refIm.size() * sizeof(float))) << "size " << size << " offset " << offset;
+#endif
+    }
+
+  // (1 + 2i) * (3 - i) = 5 + 5i
+  float re = 1.0f, im = -1.0f;
+  const float aRe = 1.0f, aIm = 2.0f, bRe = 3.0f, bIm = -1.0f;
+  if (!Use(m_impl))
+    return;
+  CAEKernels::ComplexMulAdd(&re, &im, &aRe, &aIm, &bRe, &bIm, 1);
+  EXPECT_EQ(6.0f, re);
+  EXPECT_EQ(4.0f, im);
+}
+
+TEST_P(TestAEKernels, DotProduct)
+{
+  for (unsigned int size : sizes)
+    for (unsigned int offset : offsets)
+    {
+      std::vector<float> a = Noise(size + offset, 1.0f, size + 1);
+      std::vector<float> b = Noise(size + offset, 1.0f, size + 2);
+
+      ASSERT_TRUE(Use(CAEKernels::SCALAR));
+      float ref = CAEKernels::DotProduct(a.data() + offset, b.data() + offset, size);
+      if (!Use(m_impl))
+        return;
+      float out = CAEKernels::DotProduct(a.data() + offset, b.data() + offset, size);
+
+#if defined(__aarch64__)
+      EXPECT_NEAR(ref, out, 1e-4f * (size + 1)) << "size " << size << " offset " << offset;
+#else
+      EXPECT_EQ(ref, out) << "size " << size << " offset " << offset;
+#endif
+    }
+
+  const float a[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f };
+  EXPECT_EQ(285.0f, CAEKernels::DotProduct(a, a, 9));
+  EXPECT_EQ(0.0f, CAEKernels::DotProduct(a, a, 0));
+}
+
+INSTANTIATE_TEST_CASE_P(AllImplementations, TestAEKernels,
+                        ::testing::Values(CAEKernels::SCALAR, CAEKernels::SSE, CAEKernels::AVX2, CAEKernels::NEON));
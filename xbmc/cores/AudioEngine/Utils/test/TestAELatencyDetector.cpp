@@ -0,0 +1,77 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AELatencyDetector.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+
+#define RATE 48000
+#define BURST_FRAMES (RATE / 20)
+
+static std::vector<float> Record(const std::vector<float> &burst, int offset, float gain, float noise)
+{
+  std::vector<float> capture(RATE);
+  srand(1);
+  for (size_t i = 0; i < capture.size(); i++)
+    capture[i] = noise * ((float)rand() / RAND_MAX - 0.5f);
+  for (size_t i = 0; i < burst.size() && offset + i < capture.size(); i++)
+    capture[offset + i] += gain * burst[i];
+  return capture;
+}
+
+TEST(TestAELatencyDetector, FindsBurst)
+{
+  std::vector<float> burst;
+  CAELatencyDetector::GenerateBurst(burst, BURST_FRAMES, RATE);
+  ASSERT_EQ(BURST_FRAMES, (int)burst.size());
+
+  std::vector<float> capture = Record(burst, 12345, 1.0f, 0.0f);
+  EXPECT_EQ(12345, CAELatencyDetector::FindBurst(capture, burst));
+}
+
+TEST(TestAELatencyDetector, FindsAttenuatedBurstInNoise)
+{
+  std::vector<float> burst;
+  CAELatencyDetector::GenerateBurst(burst, BURST_FRAMES, RATE);
+
+  std::vector<float> capture = Record(burst, 30000, 0.1f, 0.02f);
+  int offset = CAELatencyDetector::FindBurst(capture, burst);
+  EXPECT_NEAR(30000, offset, 1);
+}
+
+TEST(TestAELatencyDetector, RejectsNoise)
+{
+  std::vector<float> burst;
+  CAELatencyDetector::GenerateBurst(burst, BURST_FRAMES, RATE);
+
+  std::vector<float> capture = Record(burst, RATE, 0.0f, 0.5f);
+  EXPECT_EQ(-1, CAELatencyDetector::FindBurst(capture, burst));
+}
+
+TEST(TestAELatencyDetector, ShortCapture)
+{
+  std::vector<float> burst;
+  CAELatencyDetector::GenerateBurst(burst, BURST_FRAMES, RATE);
+
+  std::vector<float> capture(BURST_FRAMES / 2);
+  EXPECT_EQ(-1, CAELatencyDetector::FindBurst(capture, burst));
+}
@@ -0,0 +1,146 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AESPSCQueue.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+// items passed in the threaded test, about 7 minutes of AAC frames at 48 kHz
+#define ITEMS 20000
+
+TEST(TestAESPSCQueue, Order)
+{
+  CAESPSCQueue<int> queue(4);
+  int item;
+
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_FALSE(queue.Pop(item));
+  for (int round = 0; round < 3; round++)
+  {
+    for (int i = 0; i < 3; i++)
+      EXPECT_TRUE(queue.Push(round * 10 + i));
+    EXPECT_EQ(3u, queue.Size());
+    for (int i = 0; i < 3; i++)
+    {
+      EXPECT_TRUE(queue.Pop(item));
+      EXPECT_EQ(round * 10 + i, item);
+    }
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(TestAESPSCQueue, Full)
+{
+  CAESPSCQueue<int> queue(5);
+  int item;
+
+  EXPECT_EQ(8u, queue.Capacity());
+  for (int i = 0; i < 8; i++)
+    EXPECT_TRUE(queue.Push(i));
+  EXPECT_FALSE(queue.Push(8));
+  EXPECT_TRUE(queue.Pop(item));
+  EXPECT_EQ(0, item);
+  EXPECT_TRUE(queue.Push(8));
+  EXPECT_EQ(8u, queue.Size());
+
+  queue.Clear();
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_FALSE(queue.Pop(item));
+}
+
+TEST(TestAESPSCQueue, WasEmpty)
+{
+  CAESPSCQueue<int> queue(4);
+  bool wasEmpty;
+  int item;
+
+  EXPECT_TRUE(queue.Push(1, &wasEmpty));
+  EXPECT_TRUE(wasEmpty);
+  EXPECT_TRUE(queue.Push(2, &wasEmpty));
+  EXPECT_FALSE(wasEmpty);
+  EXPECT_TRUE(queue.Pop(item));
+  EXPECT_TRUE(queue.Push(3, &wasEmpty));
+  EXPECT_FALSE(wasEmpty);
+  while (queue.Pop(item));
+  EXPECT_TRUE(queue.Push(4, &wasEmpty));
+  EXPECT_TRUE(wasEmpty);
+}
+
+namespace
+{
+
+// producer side of the threaded test, wakes the consumer per batch
+class QueueProducer : public IRunnable
+{
+public:
+  QueueProducer(CAESPSCQueue<intptr_t> &queue, CEvent &dataEvent, CEvent &spaceEvent) :
+    m_queue(queue), m_dataEvent(dataEvent), m_spaceEvent(spaceEvent) {}
+
+  virtual void Run() override
+  {
+    for (intptr_t i = 1; i <= ITEMS; )
+    {
+      bool wasEmpty;
+      if (!m_queue.Push(i, &wasEmpty))
+      {
+        m_spaceEvent.WaitMSec(10);
+        continue;
+      }
+      if (wasEmpty)
+        m_dataEvent.Set();
+      i++;
+    }
+  }
+
+  CAESPSCQueue<intptr_t> &m_queue;
+  CEvent &m_dataEvent;
+  CEvent &m_spaceEvent;
+};
+
+}
+
+TEST(TestAESPSCQueue, Threaded)
+{
+  CAESPSCQueue<intptr_t> queue(256);
+  CEvent dataEvent;
+  CEvent spaceEvent;
+  QueueProducer producer(queue, dataEvent, spaceEvent);
+
+  CThread thread(&producer, "SPSCProducer");
+  thread.Create();
+
+  intptr_t expected = 1;
+  intptr_t item;
+  while (expected <= ITEMS)
+  {
+    if (queue.Pop(item))
+    {
+      ASSERT_EQ(expected, item);
+      expected++;
+      continue;
+    }
+    spaceEvent.Set();
+    // a lost wakeup shows up as a timeout here
+    ASSERT_TRUE(dataEvent.WaitMSec(5000));
+  }
+  thread.StopThread(true);
+}
@@ -0,0 +1,284 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEStreamInfo.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+#include <vector>
+
+/*
+  The streams are built frame by frame with just enough of a valid header
+  for the parser, the payload is noise.
+*/
+
+static const unsigned int DTS_CORE_SIZE = 1006;
+static const unsigned int DTS_HD_SIZE = 2000;
+static const unsigned int TRUEHD_UNIT_SIZE = 1200;
+static const unsigned int TRUEHD_SUBSTREAMS = 2;
+
+static void Noise(uint8_t *data, unsigned int size, uint32_t &seed)
+{
+  for (unsigned int i = 0; i < size; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    // keep the noise free of TrueHD sync words
+    data[i] = (seed >> 16) & 0x7F;
+  }
+}
+
+/* 16 bit BE DTS core, 512 samples, 48kHz, 5.1, followed by a DTS-HD extension */
+static void AppendDTSHD(std::vector<uint8_t> &stream, uint32_t &seed)
+{
+  unsigned int start = stream.size();
+  stream.resize(start + DTS_CORE_SIZE + DTS_HD_SIZE);
+  uint8_t *data = &stream[start];
+  Noise(data, DTS_CORE_SIZE + DTS_HD_SIZE, seed);
+
+  unsigned int fsize = DTS_CORE_SIZE - 1;
+  unsigned int blocks = 512 / 32 - 1;
+  unsigned int amode = 9;
+  unsigned int sfreq = 13;
+  data[0] = 0x7F;
+  data[1] = 0xFE;
+  data[2] = 0x80;
+  data[3] = 0x01;
+  data[4] = 0x00;
+  data[5] = (blocks << 2) | (fsize >> 12);
+  data[6] = (fsize >> 4) & 0xFF;
+  data[7] = ((fsize & 0xF) << 4) | (amode >> 2);
+  data[8] = ((amode & 0x3) << 6) | (sfreq << 2);
+  data[10] = 0x02;
+
+  uint8_t *hd = data + DTS_CORE_SIZE;
+  unsigned int hdsize = DTS_HD_SIZE - 1;
+  hd[0] = 0x64;
+  hd[1] = 0x58;
+  hd[2] = 0x20;
+  hd[3] = 0x25;
+  hd[5] = 0x00;
+  hd[6] = (hdsize >> 11) & 0x1F;
+  hd[7] = (hdsize >> 3) & 0xFF;
+  hd[8] = (hdsize & 0x7) << 5;
+}
+
+/* 48kHz TrueHD access unit, with a major sync every 8 units */
+static void AppendTrueHD(std::vector<uint8_t> &stream, uint32_t &seed, bool major)
+{
+  unsigned int start = stream.size();
+  stream.resize(start + TRUEHD_UNIT_SIZE);
+  uint8_t *data = &stream[start];
+  Noise(data, TRUEHD_UNIT_SIZE, seed);
+
+  unsigned int length = TRUEHD_UNIT_SIZE / 2;
+  data[0] = (length >> 8) & 0x0F;
+  data[1] = length & 0xFF;
+
+  if (major)
+  {
+    data[4] = 0xF8;
+    data[5] = 0x72;
+    data[6] = 0x6F;
+    data[7] = 0xBA;
+    data[8] = 0x00;
+    data[10] = 0x00;
+    data[11] = 0x0F;
+    data[20] = TRUEHD_SUBSTREAMS << 4;
+    data[29] = 0x00;
+
+    AVCRC crcTable[1024];
+    av_crc_init(crcTable, 0, 16, 0x2D, sizeof(crcTable));
+    uint16_t crc = av_crc(crcTable, 0, data + 4, 24);
+    crc ^= (data[29] << 8) | data[28];
+    data[30] = crc & 0xFF;
+    data[31] = crc >> 8;
+  }
+  else
+  {
+    // substream directory without extra words, the parity nibble makes the header check out
+    uint8_t check = data[0] ^ data[1] ^ data[2] ^ data[3];
+    for (unsigned int i = 0; i < TRUEHD_SUBSTREAMS; i++)
+      check ^= data[4 + i * 2] ^ data[5 + i * 2];
+    data[0] |= (0xF ^ (check >> 4) ^ check) << 4;
+  }
+}
+
+static std::vector<uint8_t> MakeDTSHD(unsigned int frames)
+{
+  std::vector<uint8_t> stream;
+  uint32_t seed = 1;
+  for (unsigned int i = 0; i < frames; i++)
+    AppendDTSHD(stream, seed);
+  return stream;
+}
+
+static std::vector<uint8_t> MakeTrueHD(unsigned int frames)
+{
+  std::vector<uint8_t> stream;
+  uint32_t seed = 1;
+  for (unsigned int i = 0; i < frames; i++)
+    AppendTrueHD(stream, seed, i % 8 == 0);
+  return stream;
+}
+
+typedef std::vector<std::vector<uint8_t> > Frames;
+
+/* feed the stream in packets of packetSize bytes, returns the number of frames */
+static unsigned int Parse(CAEStreamParser &parser, std::vector<uint8_t> &stream, unsigned int packetSize,
+                          bool noCopy, Frames *frames = NULL, unsigned int *views = NULL)
+{
+  unsigned int count = 0;
+  uint8_t *buffer = NULL;
+  unsigned int bufferSize = 0;
+
+  for (unsigned int pos = 0; pos < stream.size(); pos += packetSize)
+  {
+    uint8_t *packet = &stream[pos];
+    unsigned int left = std::min(packetSize, (unsigned int)stream.size() - pos);
+    while (left)
+    {
+      uint8_t *frame = NULL;
+      unsigned int frameSize = bufferSize;
+      int consumed;
+      if (noCopy)
+        consumed = parser.AddDataNoCopy(packet, left, &frame, &frameSize);
+      else
+      {
+        consumed = parser.AddData(packet, left, &buffer, &frameSize);
+        bufferSize = std::max(bufferSize, frameSize);
+        frame = buffer;
+      }
+
+      if (frameSize)
+      {
+        count++;
+        if (views && frame >= packet && frame < packet + left)
+          (*views)++;
+        if (frames)
+          frames->push_back(std::vector<uint8_t>(frame, frame + frameSize));
+      }
+      packet += consumed;
+      left -= consumed;
+    }
+  }
+
+  delete[] buffer;
+  return count;
+}
+
+TEST(TestAEStreamParser, DTSHD)
+{
+  std::vector<uint8_t> stream = MakeDTSHD(16);
+  CAEStreamParser parser;
+  Frames frames;
+  Parse(parser, stream, DTS_CORE_SIZE + DTS_HD_SIZE, false, &frames);
+
+  EXPECT_EQ(CAEStreamInfo::STREAM_TYPE_DTSHD, parser.GetDataType());
+  EXPECT_EQ(48000u, parser.GetSampleRate());
+  ASSERT_LE(15u, frames.size());
+  for (auto &frame : frames)
+  {
+    ASSERT_EQ(DTS_CORE_SIZE + DTS_HD_SIZE, frame.size());
+    EXPECT_EQ(0x7Fu, frame[0]);
+  }
+}
+
+TEST(TestAEStreamParser, DTSHDCore)
+{
+  std::vector<uint8_t> stream = MakeDTSHD(16);
+  CAEStreamParser parser;
+  parser.SetCoreOnly(true);
+  Frames frames;
+  Parse(parser, stream, DTS_CORE_SIZE + DTS_HD_SIZE, true, &frames);
+
+  EXPECT_EQ(CAEStreamInfo::STREAM_TYPE_DTSHD_CORE, parser.GetDataType());
+  ASSERT_LE(15u, frames.size());
+  for (auto &frame : frames)
+    EXPECT_EQ(DTS_CORE_SIZE, frame.size());
+}
+
+TEST(TestAEStreamParser, TrueHD)
+{
+  std::vector<uint8_t> stream = MakeTrueHD(64);
+  CAEStreamParser parser;
+  Frames frames;
+  Parse(parser, stream, TRUEHD_UNIT_SIZE, false, &frames);
+
+  EXPECT_EQ(CAEStreamInfo::STREAM_TYPE_TRUEHD, parser.GetDataType());
+  EXPECT_EQ(48000u, parser.GetSampleRate());
+  ASSERT_LE(63u, frames.size());
+  for (auto &frame : frames)
+    EXPECT_EQ(TRUEHD_UNIT_SIZE, frame.size());
+}
+
+TEST(TestAEStreamParser, NoCopyMatchesCopy)
+{
+  // whole frames per packet and frames split across packets
+  const unsigned int packetSizes[] = { TRUEHD_UNIT_SIZE, 1000, 777 };
+  for (unsigned int packetSize : packetSizes)
+  {
+    std::vector<uint8_t> stream = MakeTrueHD(64);
+    CAEStreamParser parser, parserNoCopy;
+    unsigned int views = 0;
+    Frames frames, framesNoCopy;
+    Parse(parser, stream, packetSize, false, &frames);
+    Parse(parserNoCopy, stream, packetSize, true, &framesNoCopy, &views);
+
+    EXPECT_EQ(frames, framesNoCopy) << "packet size " << packetSize;
+    if (packetSize == TRUEHD_UNIT_SIZE)
+    {
+      EXPECT_LE(framesNoCopy.size() - 1, views) << "packet size " << packetSize;
+    }
+  }
+}
+
+TEST(TestAEStreamParser, NoCopyViewsIntoPacket)
+{
+  std::vector<uint8_t> stream = MakeDTSHD(16);
+  CAEStreamParser parser;
+  unsigned int views = 0;
+  Frames frames;
+  Parse(parser, stream, DTS_CORE_SIZE + DTS_HD_SIZE, true, &frames, &views);
+
+  // the first frame is needed to acquire sync, all others come straight from the packet
+  ASSERT_LE(15u, frames.size());
+  EXPECT_LE(frames.size() - 1, views);
+  EXPECT_EQ(0u, parser.GetBufferSize());
+}
+
+TEST(TestAEStreamParser, SyncAfterGarbage)
+{
+  // garbage of all lengths around the vector width, with and without false sync candidates
+  for (unsigned int garbage = 0; garbage < 70; garbage++)
+  {
+    for (uint8_t fill : { (uint8_t)0x00, (uint8_t)0x0B, (uint8_t)0xF8 })
+    {
+      std::vector<uint8_t> stream(garbage, fill);
+      std::vector<uint8_t> frames = MakeTrueHD(16);
+      stream.insert(stream.end(), frames.begin(), frames.end());
+
+      CAEStreamParser parser;
+      unsigned int parsed = Parse(parser, stream, 1000, true);
+      EXPECT_EQ(CAEStreamInfo::STREAM_TYPE_TRUEHD, parser.GetDataType()) << "garbage " << garbage;
+      EXPECT_LE(15u, parsed) << "garbage " << garbage;
+    }
+  }
+}
@@ -0,0 +1,205 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AETimeStretch.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+static const unsigned int rate = 48000;
+
+static std::vector<float> Sine(unsigned int frames, double freq, float amplitude = 0.5f)
+{
+  std::vector<float> data(frames);
+  for (unsigned int i = 0; i < frames; i++)
+    data[i] = amplitude * (float)sin(2.0 * M_PI * freq * i / rate);
+  return data;
+}
+
+// feed a mono signal in packets, tempo may change per packet
+static std::vector<float> Stretch(CAETimeStretch &stretch, const std::vector<float> &input, unsigned int packet,
+                                  double (*tempo)(unsigned int packet) = nullptr)
+{
+  std::vector<float> output;
+  std::vector<float> buffer(4 * packet + 4096);
+  float *out = buffer.data();
+  unsigned int n = 0;
+  for (unsigned int pos = 0; pos < input.size(); pos += packet, n++)
+  {
+    if (tempo)
+      stretch.SetTempo(tempo(n));
+    const float *in = input.data() + pos;
+    stretch.Put(&in, std::min(packet, (unsigned int)input.size() - pos), true);
+    unsigned int frames;
+    while ((frames = stretch.Get(&out, buffer.size(), true, false)) > 0)
+      output.insert(output.end(), out, out + frames);
+  }
+  unsigned int frames;
+  while ((frames = stretch.Get(&out, buffer.size(), true, true)) > 0)
+    output.insert(output.end(), out, out + frames);
+  return output;
+}
+
+static double MaxStep(const std::vector<float> &data, unsigned int start)
+{
+  double step = 0;
+  for (unsigned int i = start + 1; i < data.size(); i++)
+    step = std::max(step, fabs((double)data[i] - data[i - 1]));
+  return step;
+}
+
+// frequency from the zero crossings of the middle part
+static double Frequency(const std::vector<float> &data)
+{
+  unsigned int start = data.size() / 4;
+  unsigned int end = data.size() * 3 / 4;
+  int first = -1, last = -1, crossings = 0;
+  for (unsigned int i = start + 1; i < end; i++)
+  {
+    if (data[i - 1] < 0.0f && data[i] >= 0.0f)
+    {
+      if (first < 0)
+        first = i;
+      last = i;
+      crossings++;
+    }
+  }
+  return (crossings - 1) * (double)rate / (last - first);
+}
+
+TEST(TestAETimeStretch, TempoOneIsTransparent)
+{
+  std::vector<float> input = Sine(rate, 440.0);
+  for (unsigned int packet : { 1u, 100u, 1024u })
+  {
+    CAETimeStretch stretch;
+    stretch.Init(1, rate);
+    std::vector<float> output = Stretch(stretch, input, packet);
+    ASSERT_EQ(input.size(), output.size());
+    EXPECT_TRUE(std::equal(input.begin(), input.end(), output.begin())) << "packet " << packet;
+    EXPECT_TRUE(stretch.IsIdle());
+  }
+}
+
+TEST(TestAETimeStretch, KeepsPitch)
+{
+  const double freq = 1000.0;
+  std::vector<float> input = Sine(2 * rate, freq);
+  for (double tempo : { 0.5, 0.8, 1.25, 2.0 })
+  {
+    CAETimeStretch stretch;
+    stretch.Init(1, rate);
+    stretch.SetTempo(tempo);
+    std::vector<float> output = Stretch(stretch, input, 512);
+
+    // length follows the tempo, pitch stays
+    EXPECT_NEAR(input.size() / tempo, output.size(), rate * 0.05) << "tempo " << tempo;
+    EXPECT_NEAR(freq, Frequency(output), freq * 0.01) << "tempo " << tempo;
+
+    // windows join in phase, no step larger than the slope of the sine
+    double slope = 0.5 * 2.0 * M_PI * freq / rate;
+    EXPECT_LT(MaxStep(output, 0), slope * 1.2) << "tempo " << tempo;
+  }
+}
+
+static double Sweep(unsigned int packet)
+{
+  // back and forth around 1, with stretches at exactly 1
+  if ((packet / 20) % 3 == 2)
+    return 1.0;
+  return 1.0 + 0.1 * sin(packet * 0.1);
+}
+
+TEST(TestAETimeStretch, ContinuousTempoChange)
+{
+  const double freq = 500.0;
+  std::vector<float> input = Sine(4 * rate, freq);
+  CAETimeStretch stretch;
+  stretch.Init(1, rate);
+  std::vector<float> output = Stretch(stretch, input, 256, Sweep);
+
+  double slope = 0.5 * 2.0 * M_PI * freq / rate;
+  EXPECT_LT(MaxStep(output, 0), slope * 1.2);
+  EXPECT_NEAR(freq, Frequency(output), freq * 0.01);
+  EXPECT_TRUE(stretch.IsIdle());
+}
+
+TEST(TestAETimeStretch, Interleaved)
+{
+  std::vector<float> left = Sine(rate / 2, 300.0);
+  std::vector<float> right = Sine(rate / 2, 700.0);
+  std::vector<float> stereo(2 * left.size());
+  for (unsigned int i = 0; i < left.size(); i++)
+  {
+    stereo[2 * i] = left[i];
+    stereo[2 * i + 1] = right[i];
+  }
+
+  CAETimeStretch planar, interleaved;
+  planar.Init(2, rate);
+  interleaved.Init(2, rate);
+  planar.SetTempo(1.3);
+  interleaved.SetTempo(1.3);
+
+  const float *planes[] = { left.data(), right.data() };
+  const float *data = stereo.data();
+  planar.Put(planes, left.size(), true);
+  interleaved.Put(&data, left.size(), false);
+
+  std::vector<float> outLeft(left.size()), outRight(left.size()), outStereo(stereo.size());
+  float *outPlanes[] = { outLeft.data(), outRight.data() };
+  float *outData = outStereo.data();
+  unsigned int frames = planar.Get(outPlanes, outLeft.size(), true, true);
+  ASSERT_EQ(frames, interleaved.Get(&outData, outLeft.size(), false, true));
+  ASSERT_GT(frames, 0u);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    ASSERT_EQ(outLeft[i], outStereo[2 * i]);
+    ASSERT_EQ(outRight[i], outStereo[2 * i + 1]);
+  }
+}
+
+TEST(TestAETimeStretch, BufferedFrames)
+{
+  CAETimeStretch stretch;
+  stretch.Init(1, rate);
+  stretch.SetTempo(1.5);
+  EXPECT_TRUE(stretch.NeedData());
+
+  std::vector<float> input = Sine(4800, 440.0);
+  const float *in = input.data();
+  stretch.Put(&in, input.size(), true);
+  EXPECT_EQ(4800u, stretch.GetBufferedFrames());
+
+  std::vector<float> buffer(input.size());
+  float *out = buffer.data();
+  unsigned int frames = stretch.Get(&out, buffer.size(), true, false);
+  EXPECT_GT(frames, 0u);
+  EXPECT_TRUE(stretch.NeedData());
+  // what came out used about frames * tempo of the input
+  EXPECT_NEAR(4800.0 - frames * 1.5, stretch.GetBufferedFrames(), rate * 0.02);
+
+  stretch.Reset();
+  EXPECT_TRUE(stretch.IsIdle() || stretch.GetTempo() != 1.0);
+  EXPECT_EQ(0u, stretch.GetBufferedFrames());
+}
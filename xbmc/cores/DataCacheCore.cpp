@@ -25,6 +25,8 @@
 CDataCacheCore::CDataCacheCore()
 {
   m_hasAVInfoChanges = false;
+  m_playerAudio2Skew = 0.0;
+  m_cacheStatus = XFILE::SCacheStatus();
 }
 
 CDataCacheCore& GetInstance()
@@ -267,6 +269,20 @@ int CDataCacheCore::GetAudioBitsPerSample(bool bAudio2)
   return m_playerAudioInfo.bitsPerSample;
 }
 
+void CDataCacheCore::SetAudio2Skew(double skew)
+{
+  CSingleLock lock(m_audio2PlayerSection);
+
+  m_playerAudio2Skew = skew;
+}
+
+double CDataCacheCore::GetAudio2Skew()
+{
+  CSingleLock lock(m_audio2PlayerSection);
+
+  return m_playerAudio2Skew;
+}
+
 void CDataCacheCore::SetRenderClockSync(bool enable)
 {
   CSingleLock lock(m_renderSection);
@@ -295,3 +311,18 @@ bool CDataCacheCore::CDataCacheCore::IsSeeking()
 
   return m_stateInfo.m_stateSeeking;
 }
+
+// cache info
+void CDataCacheCore::SetCacheStatus(const XFILE::SCacheStatus &status)
+{
+  CSingleLock lock(m_cacheSection);
+
+  m_cacheStatus = status;
+}
+
+XFILE::SCacheStatus CDataCacheCore::GetCacheStatus()
+{
+  CSingleLock lock(m_cacheSection);
+
+  return m_cacheStatus;
+}
@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <string>
+#include "filesystem/IFileTypes.h"
 #include "threads/CriticalSection.h"
 
 class CDataCacheCore
@@ -58,6 +59,9 @@ public:
   int GetAudioSampleRate(bool bAudio2 = false);
   void SetAudioBitsPerSample(int bitsPerSample, bool bAudio2 = false);
   int GetAudioBitsPerSample(bool bAudio2 = false);
+  // delay of output 1 minus delay of output 2 in seconds
+  void SetAudio2Skew(double skew);
+  double GetAudio2Skew();
 
   // render info
   void SetRenderClockSync(bool enabled);
@@ -67,6 +71,10 @@ public:
   void SetStateSeeking(bool active);
   bool IsSeeking();
 
+  // cache info, state of the read rate controller of the input
+  void SetCacheStatus(const XFILE::SCacheStatus &status);
+  XFILE::SCacheStatus GetCacheStatus();
+
 protected:
   std::atomic_bool m_hasAVInfoChanges;
 
@@ -91,6 +99,7 @@ protected:
     int sampleRate;
     int bitsPerSample;
   } m_playerAudioInfo, m_playerAudio2Info;
+  double m_playerAudio2Skew;
 
   CCriticalSection m_renderSection;
   struct SRenderInfo
@@ -103,4 +112,7 @@ protected:
   {
     bool m_stateSeeking;
   } m_stateInfo;
+
+  CCriticalSection m_cacheSection;
+  XFILE::SCacheStatus m_cacheStatus;
 };
@@ -0,0 +1,162 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Audio2Frames.h"
+#include "utils/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// slabs grow in steps of this size
+#define AUDIO2_POOL_INCREMENT (64 * 1024)
+
+const unsigned int CAudio2Frames::MAX_FRAMES;
+const unsigned int CAudio2Frames::MAX_PLANES;
+
+CAudio2Frames::CAudio2Frames()
+{
+  for (unsigned int i = 0; i < MAX_PLANES; i++)
+  {
+    m_data[i] = NULL;
+    m_capacity[i] = 0;
+  }
+  m_size = 0;
+  m_planes = 0;
+  m_count = 0;
+  m_retained = 0;
+  m_highWater = 0;
+}
+
+CAudio2Frames::~CAudio2Frames()
+{
+  for (unsigned int i = 0; i < MAX_PLANES; i++)
+    free(m_data[i]);
+}
+
+unsigned int CAudio2Frames::PlaneSize(const DVDAudioFrame &af)
+{
+  return af.nb_frames * af.framesize / af.planes;
+}
+
+bool CAudio2Frames::Add(const DVDAudioFrame &af)
+{
+  if (!af.data[0] || !af.nb_frames || !af.planes)
+    return false;
+
+  // layout changed, frames queued so far can't be merged with this one
+  if (m_count && (af.planes != m_frames[0].planes || af.framesize != m_frames[0].framesize))
+  {
+    CLog::Log(LOGDEBUG, "CAudio2Frames::Add - format changed, dropping %u frames", m_count);
+    Clear();
+  }
+
+  if (m_count >= MAX_FRAMES)
+  {
+    CLog::Log(LOGWARNING, "CAudio2Frames::Add - queue full, dropping frame");
+    return false;
+  }
+
+  m_planes = af.planes < MAX_PLANES ? af.planes : MAX_PLANES;
+  m_frames[m_count++] = af;
+  return true;
+}
+
+bool CAudio2Frames::Reserve(unsigned int size)
+{
+  for (unsigned int i = 0; i < m_planes; i++)
+  {
+    if (size <= m_capacity[i])
+      continue;
+
+    unsigned int capacity = (size / AUDIO2_POOL_INCREMENT + 1) * AUDIO2_POOL_INCREMENT;
+    uint8_t *data = (uint8_t*)realloc(m_data[i], capacity);
+    if (!data)
+      return false;
+    m_data[i] = data;
+    m_capacity[i] = capacity;
+  }
+  return true;
+}
+
+void CAudio2Frames::Retain()
+{
+  for (; m_retained < m_count; m_retained++)
+  {
+    DVDAudioFrame &af = m_frames[m_retained];
+    unsigned int size = PlaneSize(af);
+    if (!Reserve(m_size + size))
+    {
+      CLog::Log(LOGERROR, "CAudio2Frames::Retain - out of memory, dropping %u frames", m_count - m_retained);
+      m_count = m_retained;
+      break;
+    }
+
+    for (unsigned int i = 0; i < m_planes; i++)
+    {
+      if (af.data[i])
+        memcpy(m_data[i] + m_size, af.data[i], size);
+      else
+        memset(m_data[i] + m_size, 0, size);
+      af.data[i] = m_data[i] + m_size;
+    }
+    m_size += size;
+  }
+
+  if (m_size > m_highWater)
+    m_highWater = m_size;
+}
+
+bool CAudio2Frames::Merge(DVDAudioFrame &af)
+{
+  if (!m_count)
+    return false;
+
+  // common case, decoders of both outputs are in step: hand out the frame as it is
+  if (m_count == 1)
+  {
+    af = m_frames[0];
+    return true;
+  }
+
+  // frames in the pool are contiguous, move the remaining references behind them
+  Retain();
+  if (!m_count)
+    return false;
+
+  af = m_frames[0];
+  for (unsigned int i = 0; i < m_planes; i++)
+    af.data[i] = m_data[i];
+  af.duration = 0;
+  af.nb_frames = 0;
+  for (unsigned int i = 0; i < m_count; i++)
+  {
+    af.duration += m_frames[i].duration;
+    af.nb_frames += m_frames[i].nb_frames;
+  }
+  return true;
+}
+
+void CAudio2Frames::Clear()
+{
+  m_count = 0;
+  m_retained = 0;
+  m_size = 0;
+  m_planes = 0;
+}
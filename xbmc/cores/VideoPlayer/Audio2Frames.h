@@ -0,0 +1,76 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "DVDCodecs/Audio/DVDAudioCodec.h"
+
+/*!
+ * \brief Collects the frames of the decoder for the 2nd audio output until
+ * the 1st output has a frame ready.
+ *
+ * Frames are queued by reference to the decoder's buffers. Only frames that
+ * have to survive another call to Decode are copied, into per plane slabs
+ * which grow to a high-water mark and are never shrunk, so steady-state
+ * playback does not touch the heap.
+ */
+class CAudio2Frames
+{
+public:
+  CAudio2Frames();
+  ~CAudio2Frames();
+
+  /*!
+   * \brief Queue a frame, only a reference to its data is kept
+   * \return false if the queue is full and the frame was dropped
+   */
+  bool Add(const DVDAudioFrame &af);
+
+  /*!
+   * \brief Move referenced frames into the pool. Must be called before the
+   * decoder which owns the referenced data is invoked again.
+   */
+  void Retain();
+
+  /*!
+   * \brief Get all queued frames as one frame with contiguous planes
+   * The data stays valid until the next call to Add or Retain.
+   */
+  bool Merge(DVDAudioFrame &af);
+
+  void Clear();
+
+  unsigned int GetHighWaterMark() const { return m_highWater; }
+
+  static const unsigned int MAX_FRAMES = 64;
+  static const unsigned int MAX_PLANES = 16;
+
+protected:
+  bool Reserve(unsigned int size);
+  static unsigned int PlaneSize(const DVDAudioFrame &af);
+
+  uint8_t*      m_data[MAX_PLANES];
+  unsigned int  m_capacity[MAX_PLANES];
+  unsigned int  m_size;
+  unsigned int  m_planes;
+  DVDAudioFrame m_frames[MAX_FRAMES];
+  unsigned int  m_count;
+  unsigned int  m_retained;
+  unsigned int  m_highWater;
+};
@@ -0,0 +1,110 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Audio2Sync.h"
+#include "DVDClock.h"
+
+#include <algorithm>
+#include <math.h>
+
+// time constant of the skew filter
+#define AUDIO2_SYNC_FILTER      DVD_MSEC_TO_TIME(500)
+// interval between ratio updates, every update is a message to the engine
+#define AUDIO2_SYNC_INTERVAL    DVD_MSEC_TO_TIME(100)
+// beyond this the coarse sync of the engine takes over
+#define AUDIO2_SYNC_MAXSKEW     DVD_MSEC_TO_TIME(100)
+// skew considered in sync
+#define AUDIO2_SYNC_LOCKED      DVD_MSEC_TO_TIME(1)
+// controller gains, per second of skew, critically damped
+#define AUDIO2_SYNC_KP          0.2
+#define AUDIO2_SYNC_KI          0.01
+// measurements further apart restart the filter, e.g. after a pause
+#define AUDIO2_SYNC_MAXGAP      DVD_SEC_TO_TIME(1)
+// max deviation from 1.0, keep well below the atempo threshold
+#define AUDIO2_SYNC_MAXADJUST   0.005
+
+CAudio2Sync::CAudio2Sync()
+{
+  Reset();
+}
+
+void CAudio2Sync::Reset()
+{
+  m_skew = 0.0;
+  m_integral = 0.0;
+  m_ratio = 1.0;
+  m_lastTime = 0.0;
+  m_lastUpdate = 0.0;
+  m_started = false;
+}
+
+bool CAudio2Sync::IsLocked() const
+{
+  return m_started && fabs(m_skew) < AUDIO2_SYNC_LOCKED;
+}
+
+bool CAudio2Sync::Update(double skew, double time)
+{
+  if (!m_started || time - m_lastTime > AUDIO2_SYNC_MAXGAP)
+  {
+    // the integral holds the drift between the clocks, it is still valid
+    m_skew = skew;
+    m_lastTime = time;
+    m_lastUpdate = time;
+    m_started = true;
+    return false;
+  }
+
+  double dt = time - m_lastTime;
+  if (dt <= 0.0)
+    return false;
+  m_lastTime = time;
+
+  m_skew += (skew - m_skew) * std::min(1.0, dt / AUDIO2_SYNC_FILTER);
+
+  if (fabs(m_skew) > AUDIO2_SYNC_MAXSKEW)
+  {
+    // leave it to the engine, don't wind up
+    bool changed = m_ratio != 1.0;
+    m_integral = 0.0;
+    m_ratio = 1.0;
+    return changed;
+  }
+
+  if (time - m_lastUpdate < AUDIO2_SYNC_INTERVAL)
+    return false;
+
+  double interval = (time - m_lastUpdate) / DVD_TIME_BASE;
+  double error = m_skew / DVD_TIME_BASE;
+  m_lastUpdate = time;
+
+  m_integral += AUDIO2_SYNC_KI * error * interval;
+  m_integral = std::max(-AUDIO2_SYNC_MAXADJUST, std::min(AUDIO2_SYNC_MAXADJUST, m_integral));
+
+  double adjust = AUDIO2_SYNC_KP * error + m_integral;
+  adjust = std::max(-AUDIO2_SYNC_MAXADJUST, std::min(AUDIO2_SYNC_MAXADJUST, adjust));
+
+  double ratio = 1.0 + adjust;
+  if (ratio == m_ratio)
+    return false;
+
+  m_ratio = ratio;
+  return true;
+}
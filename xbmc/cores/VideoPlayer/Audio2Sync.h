@@ -0,0 +1,57 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/*!
+ * \brief Closed loop controller which keeps the 2nd audio output in step
+ * with the 1st one.
+ *
+ * The skew between both outputs is low pass filtered and fed into a PI
+ * controller. Its output is a resample ratio for the 2nd output, which
+ * compensates for the drift between the clocks of the two devices
+ * without inserting silence or dropping frames.
+ */
+class CAudio2Sync
+{
+public:
+  CAudio2Sync();
+  void Reset();
+
+  /*!
+   * \brief Feed a new measurement
+   * \param skew delay of output 1 minus delay of output 2, positive if output 2 is ahead
+   * \param time absolute clock of the measurement
+   * both in DVD_TIME_BASE units
+   * \return true if the resample ratio has changed and should be applied to output 2
+   */
+  bool Update(double skew, double time);
+
+  double GetRatio() const { return m_ratio; }
+  double GetSkew() const { return m_skew; }
+  bool IsLocked() const;
+
+protected:
+  double m_skew;
+  double m_integral;
+  double m_ratio;
+  double m_lastTime;
+  double m_lastUpdate;
+  bool m_started;
+};
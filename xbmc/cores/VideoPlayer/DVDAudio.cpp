@@ -324,6 +324,15 @@ void CDVDAudio::SetResampleMode(int mode)
   }
 }
 
+void CDVDAudio::SetResampleRatio(double ratio)
+{
+  CSingleLock lock (m_critSection);
+  if(m_pAudioStream)
+  {
+    m_pAudioStream->SetResampleRatio(ratio);
+  }
+}
+
 double CDVDAudio::GetClock()
 {
   if (m_pClock)
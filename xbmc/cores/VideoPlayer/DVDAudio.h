@@ -62,6 +62,7 @@ public:
   void SetSyncErrorCorrection(double correction);
   double GetResampleRatio();
   void SetResampleMode(int mode);
+  void SetResampleRatio(double ratio);
   void Flush();
   void Drain();
   void AbortAddPackets();
@@ -37,6 +37,7 @@ CDVDAudioCodecPassthrough::CDVDAudioCodecPassthrough(CProcessInfo &processInfo)
   CDVDAudioCodec(processInfo),
   m_buffer(NULL),
   m_bufferSize(0),
+  m_frame(NULL),
   m_trueHDoffset(0)
 {
 }
@@ -111,6 +112,7 @@ void CDVDAudioCodecPassthrough::Dispose()
     delete[] m_buffer;
     m_buffer = NULL;
   }
+  m_frame = NULL;
 
   m_bufferSize = 0;
 }
@@ -124,6 +126,7 @@ int CDVDAudioCodecPassthrough::Decode(uint8_t* pData, int iSize, double dts, dou
     m_dataSize = m_bufferSize;
     unsigned int consumed = m_parser.AddData(m_backlogBuffer, m_backlogSize, &m_buffer, &m_dataSize);
     m_bufferSize = std::max(m_bufferSize, m_dataSize);
+    m_frame = m_buffer;
     if (consumed != m_backlogSize)
     {
       memmove(m_backlogBuffer, m_backlogBuffer+consumed, m_backlogSize-consumed);
@@ -171,9 +174,8 @@ int CDVDAudioCodecPassthrough::Decode(uint8_t* pData, int iSize, double dts, dou
     if (iSize <= 0)
       return used + skip;
 
-    m_dataSize = m_bufferSize;
-    used = m_parser.AddData(pData, iSize, &m_buffer, &m_dataSize);
-    m_bufferSize = std::max(m_bufferSize, m_dataSize);
+    // the frame is taken from the packet or the parser, no need to copy it here
+    used = m_parser.AddDataNoCopy(pData, iSize, &m_frame, &m_dataSize);
 
     if (used != iSize)
     {
@@ -211,7 +213,7 @@ int CDVDAudioCodecPassthrough::Decode(uint8_t* pData, int iSize, double dts, dou
     if (!m_trueHDoffset)
       memset(m_trueHDBuffer.get(), 0, TRUEHD_BUF_SIZE);
 
-    memcpy(&(m_trueHDBuffer.get())[m_trueHDoffset], m_buffer, m_dataSize);
+    memcpy(&(m_trueHDBuffer.get())[m_trueHDoffset], m_frame, m_dataSize);
     uint8_t highByte = (m_dataSize >> 8) & 0xFF;
     uint8_t lowByte = m_dataSize & 0xFF;
     m_trueHDBuffer[m_trueHDoffset+2560-2] = highByte;
@@ -252,7 +254,7 @@ int CDVDAudioCodecPassthrough::GetData(uint8_t** dst)
   if (m_format.m_streamInfo.m_type == CAEStreamInfo::STREAM_TYPE_TRUEHD)
     *dst = m_trueHDBuffer.get();
   else
-    *dst = m_buffer;
+    *dst = m_frame;
   return m_dataSize;
 }
 
@@ -51,6 +51,7 @@ private:
   CAEStreamParser m_parser;
   uint8_t* m_buffer;
   unsigned int m_bufferSize;
+  uint8_t* m_frame; // points into m_buffer, the packet or the parser
   unsigned int m_dataSize;
   AEAudioFormat m_format;
   uint8_t m_backlogBuffer[61440];
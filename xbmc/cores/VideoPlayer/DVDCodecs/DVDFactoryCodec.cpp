@@ -174,7 +174,7 @@ CDVDVideoCodec* CDVDFactoryCodec::CreateVideoCodec(CDVDStreamInfo &hint, CProces
   return nullptr;;
 }
 
-CDVDAudioCodec* CDVDFactoryCodec::CreateAudioCodec(CDVDStreamInfo &hint, CProcessInfo &processInfo, bool allowpassthrough, bool allowdtshddecode, bool bAudio2)
+CDVDAudioCodec* CDVDFactoryCodec::CreateAudioCodec(CDVDStreamInfo &hint, CProcessInfo &processInfo, bool allowpassthrough, bool allowdtshddecode, bool bAudio2, bool allowdecode)
 {
   CDVDAudioCodec* pCodec = NULL;
   CDVDCodecOptions options;
@@ -190,6 +190,10 @@ CDVDAudioCodec* CDVDFactoryCodec::CreateAudioCodec(CDVDStreamInfo &hint, CProces
       return pCodec;
   }
 
+  // caller only wants a passthrough codec, e.g. 2nd output sharing the decoder of the 1st one
+  if (!allowdecode)
+    return nullptr;
+
   pCodec = OpenCodec(new CDVDAudioCodecFFmpeg(processInfo), hint, options, bAudio2);
   if (pCodec)
     return pCodec;
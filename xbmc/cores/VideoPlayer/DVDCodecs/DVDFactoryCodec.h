@@ -42,7 +42,8 @@ public:
                                           CProcessInfo &processInfo,
                                           const CRenderInfo &info = CRenderInfo());
   static CDVDAudioCodec* CreateAudioCodec(CDVDStreamInfo &hint, CProcessInfo &processInfo,
-                                          bool allowpassthrough = true, bool allowdtshddecode = true, bool bAudio2 = false);
+                                          bool allowpassthrough = true, bool allowdtshddecode = true, bool bAudio2 = false,
+                                          bool allowdecode = true);
   static CDVDOverlayCodec* CreateOverlayCodec(CDVDStreamInfo &hint );
 
   static CDVDAudioCodec* OpenCodec(CDVDAudioCodec* pCodec, CDVDStreamInfo &hint, CDVDCodecOptions &options, bool bAudio2 = false );
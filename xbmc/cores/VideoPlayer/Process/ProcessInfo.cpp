@@ -38,6 +38,7 @@ CProcessInfo* CProcessInfo::CreateInstance()
 CProcessInfo::CProcessInfo()
 {
   ResetVideoCodecInfo();
+  SetCacheStatus(XFILE::SCacheStatus());
 }
 
 CProcessInfo::~CProcessInfo()
@@ -258,11 +259,13 @@ void CProcessInfo::ResetAudioCodecInfo()
   m_audio2Channels = "unknown";
   m_audio2SampleRate = 0;;
   m_audio2BitsPerSample = 0;
+  m_audio2Skew = 0.0;
 
   CServiceBroker::GetDataCacheCore().SetAudioDecoderName(m_audio2DecoderName, true);
   CServiceBroker::GetDataCacheCore().SetAudioChannels(m_audio2Channels, true);
   CServiceBroker::GetDataCacheCore().SetAudioSampleRate(m_audio2SampleRate, true);
   CServiceBroker::GetDataCacheCore().SetAudioBitsPerSample(m_audio2BitsPerSample, true);
+  CServiceBroker::GetDataCacheCore().SetAudio2Skew(m_audio2Skew);
  }
 }
 
@@ -398,6 +401,22 @@ int CProcessInfo::GetAudioBitsPerSample(bool bAudio2)
   return m_audioBitsPerSample;
 }
 
+void CProcessInfo::SetAudio2Skew(double skew)
+{
+  CSingleLock lock(m_audio2CodecSection);
+
+  m_audio2Skew = skew;
+
+  CServiceBroker::GetDataCacheCore().SetAudio2Skew(m_audio2Skew);
+}
+
+double CProcessInfo::GetAudio2Skew()
+{
+  CSingleLock lock(m_audio2CodecSection);
+
+  return m_audio2Skew;
+}
+
 bool CProcessInfo::AllowDTSHDDecode()
 {
   return true;
@@ -464,3 +483,20 @@ bool CProcessInfo::IsSeeking()
 
   return m_stateSeeking;
 }
+
+// cache info
+void CProcessInfo::SetCacheStatus(const XFILE::SCacheStatus &status)
+{
+  CSingleLock lock(m_cacheSection);
+
+  m_cacheStatus = status;
+
+  CServiceBroker::GetDataCacheCore().SetCacheStatus(m_cacheStatus);
+}
+
+XFILE::SCacheStatus CProcessInfo::GetCacheStatus()
+{
+  CSingleLock lock(m_cacheSection);
+
+  return m_cacheStatus;
+}
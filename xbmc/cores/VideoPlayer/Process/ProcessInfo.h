@@ -21,6 +21,7 @@
 
 #include "cores/IPlayer.h"
 #include "cores/VideoPlayer/VideoRenderers/RenderFormats.h"
+#include "filesystem/IFileTypes.h"
 #include "threads/CriticalSection.h"
 #include <list>
 #include <string>
@@ -63,6 +64,8 @@ public:
   int GetAudioSampleRate(bool bAudio2 = false);
   void SetAudioBitsPerSample(int bitsPerSample, bool bAudio2 = false);
   int GetAudioBitsPerSample(bool bAudio2 = false);
+  void SetAudio2Skew(double skew);
+  double GetAudio2Skew();
   virtual bool AllowDTSHDDecode();
 
   // render info
@@ -76,6 +79,10 @@ public:
   void SetStateSeeking(bool active);
   bool IsSeeking();
 
+  // cache info
+  void SetCacheStatus(const XFILE::SCacheStatus &status);
+  XFILE::SCacheStatus GetCacheStatus();
+
 protected:
   CProcessInfo();
 
@@ -103,6 +110,7 @@ protected:
   std::string m_audio2Channels;
   int m_audio2SampleRate;
   int m_audio2BitsPerSample;
+  double m_audio2Skew;
   CCriticalSection m_audio2CodecSection;
 
   // render info
@@ -116,4 +124,8 @@ protected:
   // player states
   CCriticalSection m_stateSection;
   bool m_stateSeeking;
+
+  // cache info
+  CCriticalSection m_cacheSection;
+  XFILE::SCacheStatus m_cacheStatus;
 };
@@ -3225,6 +3225,13 @@ void CVideoPlayer::GetGeneralInfo(std::string& strGeneralInfo)
                                       , m_State.cache_level * 100);
         if(m_playSpeed == 0 || m_caching == CACHESTATE_FULL)
           strBuf += StringUtils::Format(" %d msec", DVD_TIME_TO_MSEC(m_State.cache_delay));
+
+        XFILE::SCacheStatus cache = m_processInfo->GetCacheStatus();
+        if(cache.bandwidth > 0)
+          strBuf += StringUtils::Format(" bw:%s/s pace:%s/s read:%s"
+                                        , StringUtils::SizeToString(cache.bandwidth).c_str()
+                                        , cache.pacerate ? StringUtils::SizeToString(cache.pacerate).c_str() : "-"
+                                        , StringUtils::SizeToString(cache.readsize).c_str());
       }
 
       strGeneralInfo = StringUtils::Format("C( a/v:% 6.3f%s, %s amp:% 5.2f )"
@@ -3251,6 +3258,13 @@ void CVideoPlayer::GetGeneralInfo(std::string& strGeneralInfo)
                                       , m_State.cache_level * 100);
         if(m_playSpeed == 0 || m_caching == CACHESTATE_FULL)
           strBuf += StringUtils::Format(" %d msec", DVD_TIME_TO_MSEC(m_State.cache_delay));
+
+        XFILE::SCacheStatus cache = m_processInfo->GetCacheStatus();
+        if(cache.bandwidth > 0)
+          strBuf += StringUtils::Format(" bw:%s/s pace:%s/s read:%s"
+                                        , StringUtils::SizeToString(cache.bandwidth).c_str()
+                                        , cache.pacerate ? StringUtils::SizeToString(cache.pacerate).c_str() : "-"
+                                        , StringUtils::SizeToString(cache.readsize).c_str());
       }
 
       strGeneralInfo = StringUtils::Format("Player: a/v:% 6.3f, %s"
@@ -4974,9 +4988,13 @@ void CVideoPlayer::UpdatePlayState(double timeout)
     state.cache_bytes = status.forward;
     if(state.time_total)
       state.cache_bytes += m_pInputStream->GetLength() * (int64_t) (GetQueueTime() / state.time_total);
+    m_processInfo->SetCacheStatus(status);
   }
   else
+  {
     state.cache_bytes = 0;
+    m_processInfo->SetCacheStatus(XFILE::SCacheStatus());
+  }
 
   state.timestamp = m_clock.GetAbsoluteClock();
 
@@ -27,6 +27,7 @@
 #include "utils/log.h"
 #include "utils/MathUtils.h"
 #include "cores/AudioEngine/AEFactory.h"
+#include "cores/AudioEngine/Utils/AEEngineCounters.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #ifdef TARGET_RASPBERRY_PI
 #include "linux/RBP.h"
@@ -60,89 +61,6 @@ public:
   CDVDStreamInfo  m_hints;
 };
 
-CAudio2Frames::CAudio2Frames()
-{
-  pcap = sizeof(data)/sizeof(uint8_t*);
-  incr = 64*1024;
-  for (int i=0; i < (int)pcap; i++)
-  {
-    data[i] = NULL;
-    capa[i] = 0;
-    size[i] = 0;
-  }
-  plns = 0;
-}
-
-CAudio2Frames::~CAudio2Frames()
-{
-  for (int i=0; i < (int)pcap; i++)
-  {
-    if(data[i]) free(data[i]);
-  }
-}
-
-void CAudio2Frames::Add(DVDAudioFrame af)
-{
-  if(!af.data[0] || !af.nb_frames || !af.planes)
-    return;
-
-  if(plns == 0)
-  {
-	plns = af.planes < pcap ? af.planes : pcap;
-  }
-
-  int af_size = af.nb_frames * af.framesize / af.planes;
-  for (int i=0; i < (int)af.planes; i++)
-  {
-    if(size[i] + af_size > capa[i])
-    {
-      capa[i] = ((size[i] + af_size) / incr + 1) * incr;
-      data[i] = (uint8_t*)realloc(data[i], capa[i]);
-    }
-    if(af.data[i])
-    {
-      memcpy(data[i]+size[i], af.data[i], af_size);
-    }
-    else
-    {
-      memset(data[i]+size[i], 0, af_size);
-    }
-    af.data[i] = data[i] + size[i];
-    size[i] += af_size;
-  }
-  afs.push_back(af);
-}
-
-bool CAudio2Frames::Merge(DVDAudioFrame& af)
-{
-  if (!afs.size())
-    return false;
-  af = afs.front();
-  for (int i=0; i < (int)plns; i++)
-  {
-    af.data[i] = data[i];
-  }
-  af.duration = 0;
-  af.nb_frames = 0;
-  for (std::list<DVDAudioFrame>::iterator it = afs.begin(); it != afs.end(); ++it)
-  {
-    af.duration += it->duration;
-    af.nb_frames += it->nb_frames;
-  }
-  return true;
-}
-
-void CAudio2Frames::Clear()
-{
-  afs.clear();
-  for (int i=0; i < (int)pcap; i++)
-  {
-    size[i] = 0;
-  }
-  plns = 0;
-}
-
-
 CVideoPlayerAudio::CVideoPlayerAudio(CDVDClock* pClock, CDVDMessageQueue& parent, CProcessInfo &processInfo)
 : CThread("VideoPlayerAudio"), IDVDStreamPlayerAudio(processInfo)
 , m_messageQueue("audio")
@@ -181,7 +99,7 @@ CVideoPlayerAudio::~CVideoPlayerAudio()
 
 bool CVideoPlayerAudio::OpenStream(CDVDStreamInfo &hints)
 {
-  m_bAudio2 = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED) ? true : false;
+  m_bAudio2 = CAEFactory::IsAudio2Enabled();
 
   m_processInfo.ResetAudioCodecInfo();
 
@@ -198,8 +116,7 @@ bool CVideoPlayerAudio::OpenStream(CDVDStreamInfo &hints)
   CDVDAudioCodec* codec2 = NULL;
   if (m_bAudio2)
   {
-    codec2 = CDVDFactoryCodec::CreateAudioCodec(hints, m_processInfo, allowpassthrough, m_processInfo.AllowDTSHDDecode(), m_bAudio2);
-    if( !codec2 )
+    if (!CreateAudioCodec2(hints, codec, allowpassthrough, codec2))
     {
       CLog::Log(LOGERROR, "Unsupported 2nd audio codec");
       m_dvdAudio2.Destroy();
@@ -219,6 +136,31 @@ bool CVideoPlayerAudio::OpenStream(CDVDStreamInfo &hints)
   return true;
 }
 
+bool CVideoPlayerAudio::CreateAudioCodec2(CDVDStreamInfo &hints, CDVDAudioCodec* codec, bool allowpassthrough, CDVDAudioCodec* &codec2)
+{
+  codec2 = NULL;
+
+  if (codec->NeedPassthrough())
+  {
+    // 1st output is passthrough, 2nd one may need a real decoder
+    codec2 = CDVDFactoryCodec::CreateAudioCodec(hints, m_processInfo, allowpassthrough, m_processInfo.AllowDTSHDDecode(), true);
+    return codec2 != NULL;
+  }
+
+  // 1st output decodes to PCM. Only open a 2nd codec if the 2nd output wants
+  // passthrough, otherwise both outputs are fed from the same decoded frames
+  // and each engine does its own format conversion
+  if (allowpassthrough)
+    codec2 = CDVDFactoryCodec::CreateAudioCodec(hints, m_processInfo, allowpassthrough, m_processInfo.AllowDTSHDDecode(), true, false);
+
+  if (!codec2)
+  {
+    CLog::Log(LOGNOTICE, "CVideoPlayerAudio::CreateAudioCodec2 - sharing decoder with 2nd audio output");
+    m_processInfo.SetAudioDecoderName(m_processInfo.GetAudioDecoderName(), true);
+  }
+  return true;
+}
+
 void CVideoPlayerAudio::OpenStream(CDVDStreamInfo &hints, CDVDAudioCodec* codec, CDVDAudioCodec* codec2)
 {
   if (m_pAudioCodec)
@@ -338,10 +280,21 @@ void CVideoPlayerAudio::UpdatePlayerInfo()
     s << ", rr:" << std::fixed << std::setprecision(5) << 1.0 / m_dvdAudio.GetResampleRatio();
 
   if (m_bAudio2)
+  {
     s << ", a1/a2:" << std::fixed << std::setprecision(3) << m_audiodiff;
+    s << ", rr2:" << std::fixed << std::setprecision(5) << 1.0 / m_audio2Sync.GetRatio();
+  }
 
   s << ", att:" << std::fixed << std::setprecision(1) << log(GetCurrentAttenuation()) * 20.0f << " dB";
 
+  // engine counters, a starving second output shows up here first
+  CAEEngineCounters *counters = CAEFactory::GetCounters();
+  if (counters)
+    s << ", ae " << counters->GetSummary();
+  counters = CAEFactory::GetCounters(true);
+  if (counters)
+    s << ", ae2 " << counters->GetSummary();
+
   SInfo info;
   info.info        = s.str();
   info.pts         = m_dvdAudio.GetPlayingPts();
@@ -361,6 +314,7 @@ void CVideoPlayerAudio::Process()
   m_audioStats.Start();
   m_audiodiff = 0.0;
   m_bAudio2Skip = false;
+  m_audio2Sync.Reset();
 
   while (!m_bStop)
   {
@@ -428,6 +382,7 @@ void CVideoPlayerAudio::Process()
       }
       m_syncState = IDVDStreamPlayer::SYNC_INSYNC;
       m_syncTimer.Set(3000);
+      m_audio2Sync.Reset();
     }
     else if (pMsg->IsType(CDVDMsg::GENERAL_RESET))
     {
@@ -435,6 +390,8 @@ void CVideoPlayerAudio::Process()
         m_pAudioCodec->Reset();
       if (m_pAudioCodec2)
         m_pAudioCodec2->Reset();
+      m_audio2frames.Clear();
+      m_audio2Sync.Reset();
       m_dvdAudio.Flush();
       if (m_bAudio2)
         m_dvdAudio2.Flush();
@@ -463,6 +420,8 @@ void CVideoPlayerAudio::Process()
         m_pAudioCodec->Reset();
       if (m_pAudioCodec2)
         m_pAudioCodec2->Reset();
+      m_audio2frames.Clear();
+      m_audio2Sync.Reset();
     }
     else if (pMsg->IsType(CDVDMsg::GENERAL_EOF))
     {
@@ -509,14 +468,14 @@ void CVideoPlayerAudio::Process()
       DemuxPacket* pPacket = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
       bool bPacketDrop  = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacketDrop();
 
-      int consumed = m_pAudioCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
-      if (m_bAudio2)
-        m_pAudioCodec2->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      int consumed = Decode1(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      if (m_pAudioCodec2)
+        Decode2(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
       if (consumed < 0)
       {
         CLog::Log(LOGERROR, "CVideoPlayerAudio::DecodeFrame - Decode Error. Skipping audio packet (%d)", consumed);
         m_pAudioCodec->Reset();
-        if (m_bAudio2)
+        if (m_pAudioCodec2)
           m_pAudioCodec2->Reset();
         pMsg->Release();
         continue;
@@ -528,8 +487,7 @@ void CVideoPlayerAudio::Process()
       // make sure the sent frame is clean
       audioframe.nb_frames = 0;
       audioframe2.nb_frames = 0;
-      m_audio2frames.Clear();
-	  
+
       // loop while no error and decoder produces output
       while (!m_bStop)
       {
@@ -538,7 +496,7 @@ void CVideoPlayerAudio::Process()
         if (audioframe.format.m_dataFormat == AE_FMT_RAW )
           audioframe.framesize = audioframe.format.m_frameSize;
 
-        if (m_bAudio2)
+        if (m_pAudioCodec2)
         {
           m_pAudioCodec2->GetData(audioframe2);
           if (audioframe2.nb_frames > 0)
@@ -553,14 +511,14 @@ void CVideoPlayerAudio::Process()
         {
           if (consumed >= pPacket->iSize)
             break;
-          int ret = m_pAudioCodec->Decode(pPacket->pData+consumed, pPacket->iSize-consumed, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
-          if (m_bAudio2)
-            m_pAudioCodec2->Decode(pPacket->pData+consumed, pPacket->iSize-consumed, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+          int ret = Decode1(pPacket->pData+consumed, pPacket->iSize-consumed, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+          if (m_pAudioCodec2)
+            Decode2(pPacket->pData+consumed, pPacket->iSize-consumed, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
           if (ret < 0)
           {
             CLog::Log(LOGERROR, "CVideoPlayerAudio::DecodeFrame - Decode Error. Skipping audio packet (%d)", ret);
             m_pAudioCodec->Reset();
-            if (m_bAudio2)
+            if (m_pAudioCodec2)
               m_pAudioCodec2->Reset();
             break;
           }
@@ -579,9 +537,12 @@ void CVideoPlayerAudio::Process()
           m_audioClock = audioframe.pts;
         }
 
-        if (m_bAudio2)
+        if (m_pAudioCodec2)
         {
-          m_audio2frames.Merge(audioframe2);
+          // frames handed out stay valid until the next Decode2
+          if (!m_audio2frames.Merge(audioframe2))
+            audioframe2.nb_frames = 0;
+          m_audio2frames.Clear();
 
           if (audioframe2.nb_frames > 0)
           {
@@ -615,6 +576,11 @@ void CVideoPlayerAudio::Process()
         if (m_streaminfo.codec == AV_CODEC_ID_FLAC && m_streaminfo.channellayout)
           audioframe.format.m_channelLayout = CAEUtil::GetAEChannelLayout(m_streaminfo.channellayout);
 
+        // shared decode: 2nd output gets the very same frame, its engine converts on its own.
+        // data is valid until the next Decode call, both outputs have consumed it by then
+        if (IsAudio2Shared())
+          audioframe2 = audioframe;
+
         // we have succesfully decoded an audio frame, setup renderer to match
         if (!m_dvdAudio.IsValidFormat(audioframe))
         {
@@ -645,8 +611,10 @@ void CVideoPlayerAudio::Process()
             m_dvdAudio2.Drain();
 
           m_dvdAudio2.Destroy();
+          m_audio2Sync.Reset();
 
-          if(!m_dvdAudio2.Create(audioframe2, m_streaminfo.codec, m_setsynctype == SYNC_RESAMPLE, m_bAudio2))
+          // always ask for a resampler, drift to output 1 is corrected by resampling
+          if(!m_dvdAudio2.Create(audioframe2, m_streaminfo.codec, true, m_bAudio2))
             CLog::Log(LOGERROR, "%s - failed to create 2nd audio renderer", __FUNCTION__);
 
           if (m_syncState == IDVDStreamPlayer::SYNC_INSYNC)
@@ -695,25 +663,43 @@ void CVideoPlayerAudio::Process()
         // guess next pts
         m_audioClock += audioframe.duration;
 
-        int ret = m_pAudioCodec->Decode(nullptr, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
-        if (m_bAudio2)
-          m_pAudioCodec2->Decode(nullptr, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+        int ret = Decode1(nullptr, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+        if (m_pAudioCodec2)
+          Decode2(nullptr, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
         if (ret < 0)
         {
           CLog::Log(LOGERROR, "CVideoPlayerAudio::DecodeFrame - Decode Error. Skipping audio packet (%d)", ret);
           m_pAudioCodec->Reset();
-          if (m_bAudio2)
+          if (m_pAudioCodec2)
             m_pAudioCodec2->Reset();
           break;
         }
       } // while decoder produces output
 
+      // queued frames of the 2nd output may point into the packet
+      if (m_pAudioCodec2)
+        m_audio2frames.Retain();
+
     } // demuxer packet
     
     pMsg->Release();
   }
 }
 
+int CVideoPlayerAudio::Decode1(uint8_t* pData, int iSize, double dts, double pts)
+{
+  CAEStageTimer timer(CAEFactory::GetCounters(), CAEEngineCounters::STAGE_DECODE);
+  return m_pAudioCodec->Decode(pData, iSize, dts, pts);
+}
+
+int CVideoPlayerAudio::Decode2(uint8_t* pData, int iSize, double dts, double pts)
+{
+  // queued frames still point into the decoder's buffers
+  m_audio2frames.Retain();
+  CAEStageTimer timer(CAEFactory::GetCounters(true), CAEEngineCounters::STAGE_DECODE);
+  return m_pAudioCodec2->Decode(pData, iSize, dts, pts);
+}
+
 void CVideoPlayerAudio::SetSyncType(bool passthrough)
 {
   //set the synctype from the gui
@@ -762,10 +748,14 @@ void CVideoPlayerAudio::HandleSyncAudio2(DVDAudioFrame &audioframe2)
 
   if (ddiff > threshold)
   {
-    int size2 = audioframe2.nb_frames * audioframe2.framesize / audioframe2.planes;
+    // pad with silence from our own buffer, frame data may belong to the decoder of output 1
+    DVDAudioFrame silence = audioframe2;
+    unsigned int size2 = audioframe2.nb_frames * audioframe2.framesize / audioframe2.planes;
+    if (m_audio2silence.size() < size2)
+      m_audio2silence.resize(size2, 0);
     for (unsigned int i=0; i<audioframe2.planes; i++)
-      memset(audioframe2.data[i], 0, size2);
-    m_dvdAudio2.AddPackets(audioframe2);
+      silence.data[i] = m_audio2silence.data();
+    m_dvdAudio2.AddPackets(silence);
   }
 
   if (ddiff < -threshold)
@@ -793,11 +783,26 @@ bool CVideoPlayerAudio::OutputPacket(DVDAudioFrame &audioframe, DVDAudioFrame &a
   }
   m_dvdAudio.AddPackets(audioframe);
   if (bAddAudio2)
+  {
     m_dvdAudio2.AddPackets(audioframe2);
+    if (!audioframe2.passthrough && m_syncState == IDVDStreamPlayer::SYNC_INSYNC)
+      HandleDriftAudio2();
+  }
 
   return true;
 }
 
+void CVideoPlayerAudio::HandleDriftAudio2()
+{
+  // the clocks of both devices drift apart, large errors are left to the engine
+  double skew = m_dvdAudio.GetDelay() - m_dvdAudio2.GetDelay();
+  if (m_audio2Sync.Update(skew, m_pClock->GetAbsoluteClock()))
+    m_dvdAudio2.SetResampleRatio(m_audio2Sync.GetRatio());
+
+  m_audiodiff = m_audio2Sync.GetSkew() / DVD_TIME_BASE;
+  m_processInfo.SetAudio2Skew(m_audiodiff);
+}
+
 void CVideoPlayerAudio::OnExit()
 {
 #ifdef TARGET_WINDOWS
@@ -849,15 +854,17 @@ bool CVideoPlayerAudio::SwitchCodecIfNeeded()
 
   if (m_bAudio2)
   {
-    CDVDAudioCodec *codec2 = CDVDFactoryCodec::CreateAudioCodec(m_streaminfo, m_processInfo, allowpassthrough, m_processInfo.AllowDTSHDDecode(), true);
-    if (codec2 != NULL)
+    CDVDAudioCodec *codec2 = NULL;
+    if (CreateAudioCodec2(m_streaminfo, m_pAudioCodec, allowpassthrough, codec2))
     {
-      if (!codec2 || codec2->NeedPassthrough() == m_pAudioCodec2->NeedPassthrough()) {
+      if (codec2 && m_pAudioCodec2 && codec2->NeedPassthrough() == m_pAudioCodec2->NeedPassthrough()) {
         // passthrough state has not changed
         delete codec2;
-      } else {
+      } else if (codec2 || m_pAudioCodec2) {
+        // switched between own and shared decoder
         delete m_pAudioCodec2;
         m_pAudioCodec2 = codec2;
+        m_audio2frames.Clear();
       }
     }
   }
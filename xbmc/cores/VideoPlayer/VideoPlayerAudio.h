@@ -19,9 +19,11 @@
  */
 
 #pragma once
-#include <list>
 #include <utility>
+#include <vector>
 
+#include "Audio2Frames.h"
+#include "Audio2Sync.h"
 #include "DVDAudio.h"
 #include "DVDClock.h"
 #include "DVDMessageQueue.h"
@@ -35,25 +37,6 @@ class CVideoPlayer;
 class CDVDAudioCodec;
 class CDVDAudioCodec;
 
-class CAudio2Frames
-{
-public:
-  CAudio2Frames();
-  ~CAudio2Frames();
-  void Add(DVDAudioFrame af);
-  bool Merge(DVDAudioFrame& af);
-  void Clear();
-
-protected:
-  uint8_t*                  data[16];
-  unsigned int              size[16];
-  unsigned int              capa[16];
-  unsigned int              incr;
-  unsigned int              plns;
-  unsigned int              pcap;
-  std::list<DVDAudioFrame>  afs;
-};
-
 class CVideoPlayerAudio : public CThread, public IDVDStreamPlayerAudio
 {
 public:
@@ -98,6 +81,11 @@ protected:
 
   void UpdatePlayerInfo();
   void OpenStream(CDVDStreamInfo &hints, CDVDAudioCodec* codec, CDVDAudioCodec* codec2);
+  //! Create the codec for the 2nd output. codec2 is left NULL if the 2nd output
+  //! can share the PCM output of codec, returns false if no codec could be opened.
+  bool CreateAudioCodec2(CDVDStreamInfo &hints, CDVDAudioCodec* codec, bool allowpassthrough, CDVDAudioCodec* &codec2);
+  //! true if the 2nd output is fed by the decoder of the 1st output
+  bool IsAudio2Shared() const                           { return m_bAudio2 && !m_pAudioCodec2; }
   //! Switch codec if needed. Called when the sample rate gotten from the
   //! codec changes, in which case we may want to switch passthrough on/off.
   bool SwitchCodecIfNeeded();
@@ -109,6 +97,7 @@ protected:
   double m_audioClock;
 
   CAudio2Frames m_audio2frames;
+  CAudio2Sync m_audio2Sync;
 
   CDVDAudio m_dvdAudio; // audio output device
   CDVDAudio m_dvdAudio2; // audio output device 2
@@ -124,6 +113,8 @@ protected:
   XbmcThreads::EndTime m_syncTimer;
 
   bool OutputPacket(DVDAudioFrame &audioframe, DVDAudioFrame &audioframe2);
+  int  Decode1(uint8_t* pData, int iSize, double dts, double pts);
+  int  Decode2(uint8_t* pData, int iSize, double dts, double pts);
 
   //SYNC_DISCON, SYNC_SKIPDUP, SYNC_RESAMPLE
   int    m_synctype;
@@ -132,6 +123,7 @@ protected:
 
   void   SetSyncType(bool passthrough);
   void   HandleSyncAudio2(DVDAudioFrame &audioframe2);
+  void   HandleDriftAudio2();
 
   bool   m_prevskipped;
   double m_maxspeedadjust;
@@ -155,5 +147,6 @@ protected:
   bool   m_bAudio2Skip;
   bool   m_bAudio2Dumb;
   double m_audiodiff;
+  std::vector<uint8_t> m_audio2silence;
 };
 
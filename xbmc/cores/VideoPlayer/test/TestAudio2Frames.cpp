@@ -0,0 +1,140 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/Audio2Frames.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+static const unsigned int PLANES = 6;
+static const unsigned int FRAMES = 1536;
+
+static DVDAudioFrame MakeFrame(uint8_t **planes, unsigned int nb_planes, unsigned int nb_frames)
+{
+  DVDAudioFrame af;
+  memset(af.data, 0, sizeof(af.data));
+  for (unsigned int i = 0; i < nb_planes; i++)
+    af.data[i] = planes[i];
+  af.pts = DVD_NOPTS_VALUE;
+  af.hasTimestamp = false;
+  af.nb_frames = nb_frames;
+  af.planes = nb_planes;
+  af.framesize = nb_planes * sizeof(float);
+  af.duration = (double)nb_frames * DVD_TIME_BASE / 48000;
+  return af;
+}
+
+class TestAudio2Frames : public ::testing::Test
+{
+protected:
+  TestAudio2Frames()
+  {
+    for (unsigned int i = 0; i < PLANES; i++)
+    {
+      buffer[i].assign(FRAMES * sizeof(float), (uint8_t)(i + 1));
+      planes[i] = buffer[i].data();
+    }
+  }
+
+  std::vector<uint8_t> buffer[PLANES];
+  uint8_t *planes[PLANES];
+};
+
+TEST_F(TestAudio2Frames, SingleFrameIsNotCopied)
+{
+  CAudio2Frames frames;
+  DVDAudioFrame af;
+
+  EXPECT_TRUE(frames.Add(MakeFrame(planes, PLANES, FRAMES)));
+  EXPECT_TRUE(frames.Merge(af));
+  EXPECT_EQ(FRAMES, af.nb_frames);
+  for (unsigned int i = 0; i < PLANES; i++)
+    EXPECT_EQ(planes[i], af.data[i]);
+}
+
+TEST_F(TestAudio2Frames, RetainedFramesAreMerged)
+{
+  CAudio2Frames frames;
+  DVDAudioFrame af;
+
+  EXPECT_TRUE(frames.Add(MakeFrame(planes, PLANES, FRAMES)));
+  frames.Retain();
+  // decoder overwrites its buffer
+  buffer[0].assign(buffer[0].size(), 0x7f);
+  EXPECT_TRUE(frames.Add(MakeFrame(planes, PLANES, FRAMES)));
+  EXPECT_TRUE(frames.Merge(af));
+
+  EXPECT_EQ(2 * FRAMES, af.nb_frames);
+  EXPECT_EQ(1, af.data[0][0]);
+  EXPECT_EQ(0x7f, af.data[0][FRAMES * sizeof(float)]);
+  EXPECT_EQ(PLANES, af.data[PLANES - 1][2 * FRAMES * sizeof(float) - 1]);
+}
+
+TEST_F(TestAudio2Frames, SteadyStateDoesNotAllocate)
+{
+  CAudio2Frames frames;
+  DVDAudioFrame af;
+
+  // warm up, pool grows to its high-water mark
+  for (unsigned int n = 0; n < 4; n++)
+  {
+    frames.Add(MakeFrame(planes, PLANES, FRAMES));
+    frames.Retain();
+  }
+  EXPECT_TRUE(frames.Merge(af));
+  frames.Clear();
+
+  // the slabs the merged frames are in
+  uint8_t *pool[PLANES];
+  for (unsigned int i = 0; i < PLANES; i++)
+  {
+    pool[i] = af.data[i];
+    EXPECT_NE(planes[i], pool[i]);
+  }
+  unsigned int highWater = frames.GetHighWaterMark();
+  EXPECT_EQ(4 * FRAMES * sizeof(float), highWater);
+
+  for (unsigned int loop = 0; loop < 1000; loop++)
+  {
+    for (unsigned int n = 0; n < 1 + loop % 4; n++)
+    {
+      frames.Add(MakeFrame(planes, PLANES, FRAMES));
+      frames.Retain();
+    }
+    EXPECT_TRUE(frames.Merge(af));
+    frames.Clear();
+
+    // a slab that had to grow would have moved
+    for (unsigned int i = 0; i < PLANES; i++)
+      ASSERT_EQ(pool[i], af.data[i]) << "loop " << loop << " plane " << i;
+  }
+
+  EXPECT_EQ(highWater, frames.GetHighWaterMark());
+}
+
+TEST_F(TestAudio2Frames, QueueIsBounded)
+{
+  CAudio2Frames frames;
+
+  for (unsigned int n = 0; n < CAudio2Frames::MAX_FRAMES; n++)
+    EXPECT_TRUE(frames.Add(MakeFrame(planes, PLANES, 32)));
+  EXPECT_FALSE(frames.Add(MakeFrame(planes, PLANES, 32)));
+}
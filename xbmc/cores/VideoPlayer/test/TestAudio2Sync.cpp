@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/Audio2Sync.h"
+#include "cores/VideoPlayer/DVDClock.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <deque>
+
+// simulates two sinks with drifting clocks, the ratio reaches the sink
+// with some latency and the delay readings are noisy
+static double Simulate(CAudio2Sync &sync, double drift, double seconds, double *maxLateSkew)
+{
+  const double step = DVD_MSEC_TO_TIME(20);
+  const double latency = DVD_MSEC_TO_TIME(200);
+  double skew = DVD_MSEC_TO_TIME(20);
+  double ratio = 1.0;
+  std::deque<std::pair<double, double> > pending;
+
+  srand(1);
+  *maxLateSkew = 0.0;
+  for (double time = 0; time < DVD_SEC_TO_TIME(seconds); time += step)
+  {
+    while (!pending.empty() && pending.front().first <= time)
+    {
+      ratio = pending.front().second;
+      pending.pop_front();
+    }
+
+    // output 2 consumes faster by drift, a ratio > 1 produces more samples
+    skew += (drift - (ratio - 1.0)) * step;
+
+    double noise = DVD_MSEC_TO_TIME(2) * ((double)rand() / RAND_MAX - 0.5);
+    if (sync.Update(skew + noise, time))
+      pending.push_back(std::make_pair(time + latency, sync.GetRatio()));
+
+    if (time > DVD_SEC_TO_TIME(seconds - 60))
+      *maxLateSkew = std::max(*maxLateSkew, fabs(skew));
+  }
+  return ratio;
+}
+
+TEST(TestAudio2Sync, ConvergesOnPositiveDrift)
+{
+  CAudio2Sync sync;
+  double maxSkew;
+  double ratio = Simulate(sync, 100e-6, 300, &maxSkew);
+  EXPECT_LT(maxSkew, DVD_MSEC_TO_TIME(1));
+  EXPECT_NEAR(ratio, 1.0 + 100e-6, 20e-6);
+  EXPECT_TRUE(sync.IsLocked());
+}
+
+TEST(TestAudio2Sync, ConvergesOnNegativeDrift)
+{
+  CAudio2Sync sync;
+  double maxSkew;
+  double ratio = Simulate(sync, -100e-6, 300, &maxSkew);
+  EXPECT_LT(maxSkew, DVD_MSEC_TO_TIME(1));
+  EXPECT_NEAR(ratio, 1.0 - 100e-6, 20e-6);
+}
+
+TEST(TestAudio2Sync, LargeSkewIsLeftToEngine)
+{
+  CAudio2Sync sync;
+  sync.Update(DVD_MSEC_TO_TIME(10), 0);
+  EXPECT_TRUE(sync.Update(DVD_MSEC_TO_TIME(10), DVD_MSEC_TO_TIME(200)));
+  EXPECT_GT(sync.GetRatio(), 1.0);
+
+  for (double time = DVD_MSEC_TO_TIME(400); time < DVD_SEC_TO_TIME(5); time += DVD_MSEC_TO_TIME(100))
+    sync.Update(DVD_MSEC_TO_TIME(500), time);
+  EXPECT_EQ(1.0, sync.GetRatio());
+  EXPECT_FALSE(sync.IsLocked());
+}
+
+TEST(TestAudio2Sync, RatioIsBounded)
+{
+  CAudio2Sync sync;
+  for (double time = 0; time < DVD_SEC_TO_TIME(60); time += DVD_MSEC_TO_TIME(100))
+    sync.Update(DVD_MSEC_TO_TIME(90), time);
+  EXPECT_LE(sync.GetRatio(), 1.005);
+  EXPECT_GT(sync.GetRatio(), 1.0);
+}
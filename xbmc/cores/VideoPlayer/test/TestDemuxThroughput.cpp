@@ -0,0 +1,139 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/VideoPlayer/DVDInputStreams/DVDInputStreamFile.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "test/TestUtils.h"
+#include "FileItem.h"
+
+#include <string.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const int64_t DATA_SIZE = 64 * 1024 * 1024;
+
+// demuxes a large file read from disk directly and through the file cache
+class TestDemuxThroughput : public testing::Test
+{
+protected:
+  TestDemuxThroughput() : m_file(NULL), m_cacheBufferMode(g_advancedSettings.m_cacheBufferMode)
+  {
+    av_register_all();
+  }
+
+  ~TestDemuxThroughput()
+  {
+    g_advancedSettings.m_cacheBufferMode = m_cacheBufferMode;
+    XBMC_DELETETEMPFILE(m_file);
+  }
+
+  static void PutLE(std::vector<unsigned char> &buf, size_t pos, uint32_t value, int bytes)
+  {
+    for (int i = 0; i < bytes; i++)
+      buf[pos + i] = (unsigned char)(value >> (8 * i));
+  }
+
+  // 16 bit stereo pcm at 48kHz, about six minutes
+  bool CreateWav()
+  {
+    m_file = XBMC_CREATETEMPFILE(".wav");
+    if (!m_file)
+      return false;
+
+    std::vector<unsigned char> buf(44);
+    memcpy(&buf[0], "RIFF", 4);
+    PutLE(buf, 4, (uint32_t)(36 + DATA_SIZE), 4);
+    memcpy(&buf[8], "WAVEfmt ", 8);
+    PutLE(buf, 16, 16, 4);
+    PutLE(buf, 20, 1, 2);          // pcm
+    PutLE(buf, 22, 2, 2);          // channels
+    PutLE(buf, 24, 48000, 4);      // sample rate
+    PutLE(buf, 28, 48000 * 4, 4);  // byte rate
+    PutLE(buf, 32, 4, 2);          // block align
+    PutLE(buf, 34, 16, 2);         // bits per sample
+    memcpy(&buf[36], "data", 4);
+    PutLE(buf, 40, (uint32_t)DATA_SIZE, 4);
+    if (m_file->Write(buf.data(), buf.size()) != (ssize_t)buf.size())
+      return false;
+
+    buf.resize(1024 * 1024);
+    for (size_t i = 0; i < buf.size(); i++)
+      buf[i] = (unsigned char)(i * 7 + (i >> 11));
+    for (int64_t written = 0; written < DATA_SIZE; written += buf.size())
+    {
+      if (m_file->Write(buf.data(), buf.size()) != (ssize_t)buf.size())
+        return false;
+    }
+    m_file->Close();
+    return true;
+  }
+
+  /* demux the whole file, returns false on failure */
+  bool Demux(int64_t &bytes)
+  {
+    bytes = 0;
+    CFileItem item(XBMC_TEMPFILEPATH(m_file), false);
+    CDVDInputStreamFile input(item);
+    if (!input.Open())
+      return false;
+
+    CDVDDemuxFFmpeg demuxer;
+    if (!demuxer.Open(&input, true, false))
+      return false;
+
+    DemuxPacket *packet;
+    while ((packet = demuxer.Read()) != NULL)
+    {
+      bytes += packet->iSize;
+      CDVDDemuxUtils::FreeDemuxPacket(packet);
+    }
+    demuxer.Dispose();
+    input.Close();
+
+    return true;
+  }
+
+  XFILE::CFile *m_file;
+  unsigned int m_cacheBufferMode;
+};
+
+TEST_F(TestDemuxThroughput, Direct)
+{
+  ASSERT_TRUE(CreateWav());
+  g_advancedSettings.m_cacheBufferMode = CACHE_BUFFER_MODE_NONE;
+
+  int64_t bytes;
+  ASSERT_TRUE(Demux(bytes));
+  EXPECT_EQ(DATA_SIZE, bytes);
+}
+
+TEST_F(TestDemuxThroughput, Cached)
+{
+  ASSERT_TRUE(CreateWav());
+  g_advancedSettings.m_cacheBufferMode = CACHE_BUFFER_MODE_ALL;
+
+  int64_t bytes;
+  ASSERT_TRUE(Demux(bytes));
+  EXPECT_EQ(DATA_SIZE, bytes);
+}
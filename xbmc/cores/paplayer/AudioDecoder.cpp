@@ -37,8 +37,7 @@ CAudioDecoder::CAudioDecoder()
   m_status = STATUS_NO_FILE;
   m_canPlay = false;
 
-  m_bAudio2 = false;
-  m_bCheckAudio2 = false;
+  m_bDualOutput = false;
 
   // output buffer (for transferring data from the Pcm Buffer to the rest of the audio chain)
   memset(&m_outputBuffer, 0, OUTPUT_SAMPLES * sizeof(float));
@@ -89,8 +88,7 @@ bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset)
   m_codec=CodecFactory::CreateCodecDemux(file, filecache * 1024);
   if (m_codec)
   {
-    m_codec->SetAudio2(m_bAudio2);
-    m_codec->SetCheckAudio2(m_bCheckAudio2);
+    m_codec->SetDualOutput(m_bDualOutput);
   }
 
   if (!m_codec || !m_codec->Init(file, filecache * 1024))
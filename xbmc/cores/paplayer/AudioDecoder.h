@@ -76,9 +76,7 @@ public:
   uint8_t* GetRawData(int &size);
   ICodec *GetCodec() const { return m_codec; }
   float GetReplayGain(float &peakVal);
-  void SetAudio2(bool bAudio2){ m_bAudio2 = bAudio2; }
-  void SetCheckAudio2(bool bCheckAudio2){ m_bCheckAudio2 = m_bAudio2 ? false : bCheckAudio2; }
-  bool IsReusableForAudio2(){ return m_codec ? m_codec->IsReusableForAudio2() : false; }
+  void SetDualOutput(bool dualOutput){ m_bDualOutput = dualOutput; }
 
 private:
   // pcm buffer
@@ -104,6 +102,5 @@ private:
 
   CCriticalSection m_critSection;
 
-  bool    m_bAudio2;
-  bool    m_bCheckAudio2;
+  bool    m_bDualOutput;
 };
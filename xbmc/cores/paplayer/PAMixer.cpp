@@ -0,0 +1,858 @@
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PAMixer.h"
+#include "cores/AudioEngine/AEFactory.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "cores/VideoPlayer/DVDClock.h"
+#include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#define MIXER_BUFFER_TIME 0.25     /* seconds of decoded audio held per track */
+#define MIXER_CHUNK_TIME  0.02     /* max seconds mixed at once */
+#define MIXER_IDLE_TIME   10       /* ms to wait if there is nothing to mix */
+#define MIXER_SYNC_TIME   0.1      /* seconds between skew measurements */
+#define MIXER_MAX_SKEW    0.1      /* above this the 2nd output is padded or cut */
+
+static bool SameFormat(const AEAudioFormat &a, const AEAudioFormat &b)
+{
+  return a.m_sampleRate == b.m_sampleRate &&
+         a.m_channelLayout == b.m_channelLayout;
+}
+
+/* planar input is converted plane by plane into the interleaved buffer */
+static AEDataFormat PackedFormat(AEDataFormat format)
+{
+  switch (format)
+  {
+    case AE_FMT_U8P:         return AE_FMT_U8;
+    case AE_FMT_S16NEP:      return AE_FMT_S16NE;
+    case AE_FMT_S32NEP:      return AE_FMT_S32NE;
+    case AE_FMT_S24NE4P:     return AE_FMT_S24NE4;
+    case AE_FMT_S24NE4MSBP:  return AE_FMT_S24NE4MSB;
+    case AE_FMT_S24NE3P:     return AE_FMT_S24NE3;
+    case AE_FMT_DOUBLEP:     return AE_FMT_DOUBLE;
+    case AE_FMT_FLOATP:      return AE_FMT_FLOAT;
+    default:                 return format;
+  }
+}
+
+static bool CanConvert(AEDataFormat format)
+{
+  format = PackedFormat(format);
+  switch (format)
+  {
+    case AE_FMT_U8:
+    case AE_FMT_S16NE:
+    case AE_FMT_S24NE4:
+    case AE_FMT_S24NE4MSB:
+    case AE_FMT_S24NE3:
+    case AE_FMT_S32NE:
+    case AE_FMT_FLOAT:
+    case AE_FMT_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void ToFloat(AEDataFormat format, const uint8_t *src, float *dest, unsigned int samples, unsigned int stride)
+{
+  switch (format)
+  {
+    case AE_FMT_U8:
+      for (unsigned int i = 0; i < samples; i++)
+        dest[i * stride] = ((int)src[i] - 128) * (1.0f / 128.0f);
+      break;
+    case AE_FMT_S16NE:
+    {
+      const int16_t *s = (const int16_t*)src;
+      for (unsigned int i = 0; i < samples; i++)
+        dest[i * stride] = s[i] * (1.0f / 32768.0f);
+      break;
+    }
+    case AE_FMT_S24NE4:
+    {
+      const int32_t *s = (const int32_t*)src;
+      for (unsigned int i = 0; i < samples; i++)
+        dest[i * stride] = ((s[i] << 8) >> 8) * (1.0f / 8388608.0f);
+      break;
+    }
+    case AE_FMT_S24NE4MSB:
+    case AE_FMT_S32NE:
+    {
+      const int32_t *s = (const int32_t*)src;
+      for (unsigned int i = 0; i < samples; i++)
+        dest[i * stride] = s[i] * (1.0f / 2147483648.0f);
+      break;
+    }
+    case AE_FMT_S24NE3:
+      for (unsigned int i = 0; i < samples; i++, src += 3)
+      {
+#ifdef WORDS_BIGENDIAN
+        uint32_t s = ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8);
+#else
+        uint32_t s = ((uint32_t)src[2] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[0] << 8);
+#endif
+        dest[i * stride] = (int32_t)s * (1.0f / 2147483648.0f);
+      }
+      break;
+    case AE_FMT_FLOAT:
+    {
+      if (stride == 1)
+      {
+        memcpy(dest, src, samples * sizeof(float));
+        break;
+      }
+      const float *s = (const float*)src;
+      for (unsigned int i = 0; i < samples; i++)
+        dest[i * stride] = s[i];
+      break;
+    }
+    case AE_FMT_DOUBLE:
+    {
+      const double *s = (const double*)src;
+      for (unsigned int i = 0; i < samples; i++)
+        dest[i * stride] = (float)s[i];
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// CPAMixerStream
+//-----------------------------------------------------------------------------
+
+CPAMixerStream::CPAMixerStream(CPAMixer &mixer, const AEAudioFormat &format, bool paused) :
+  m_mixer(mixer),
+  m_format(format)
+{
+  m_channels = m_format.m_channelLayout.Count();
+  m_planar = AE_IS_PLANAR(m_format.m_dataFormat);
+  m_packedFormat = PackedFormat(m_format.m_dataFormat);
+  m_frameSize = (CAEUtil::DataFormatToBits(m_format.m_dataFormat) >> 3) * m_channels;
+  m_capacity = m_format.m_sampleRate * MIXER_BUFFER_TIME;
+  m_buffer.resize(m_capacity * m_channels);
+  m_readPos = 0;
+  m_used = 0;
+
+  m_paused = paused;
+  m_started = !paused;
+  m_buffering = true;
+  m_draining = false;
+  m_drained = false;
+  m_slave = NULL;
+
+  m_volume = 1.0f;
+  m_rgain = 1.0f;
+  m_limiter.SetSamplerate(m_format.m_sampleRate);
+  m_fading = false;
+  m_fadingBase = 0.0f;
+  m_fadingTarget = 0.0f;
+  m_fadingTime = 0;
+  m_fadingSamples = 0;
+  m_fadingStep = 0.0f;
+}
+
+unsigned int CPAMixerStream::GetSpace()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  if (m_draining)
+    return 0;
+  return (m_capacity - m_used) * m_frameSize;
+}
+
+unsigned int CPAMixerStream::AddData(const uint8_t* const *data, unsigned int offset, unsigned int frames, double pts)
+{
+  CSingleLock lock(m_mixer.m_lock);
+  if (m_draining)
+    return 0;
+
+  unsigned int copied = 0;
+  frames = std::min(frames, m_capacity - m_used);
+  while (copied < frames)
+  {
+    unsigned int writePos = (m_readPos + m_used) % m_capacity;
+    unsigned int n = std::min(frames - copied, m_capacity - writePos);
+    float *dest = &m_buffer[writePos * m_channels];
+    if (m_planar)
+    {
+      unsigned int sampleSize = m_frameSize / m_channels;
+      for (unsigned int ch = 0; ch < m_channels; ch++)
+        ToFloat(m_packedFormat, data[ch] + (offset + copied) * sampleSize, dest + ch, n, m_channels);
+    }
+    else
+      ToFloat(m_packedFormat, data[0] + (offset + copied) * m_frameSize, dest, n * m_channels, 1);
+    m_used += n;
+    copied += n;
+  }
+
+  if (m_used * 2 >= m_capacity)
+    m_buffering = false;
+
+  return copied;
+}
+
+double CPAMixerStream::GetDelay()
+{
+  double delay;
+  {
+    CSingleLock lock(m_mixer.m_lock);
+    delay = (double)m_used / m_format.m_sampleRate;
+  }
+  return delay + m_mixer.GetOutputDelay();
+}
+
+CAESyncInfo CPAMixerStream::GetSyncInfo()
+{
+  CAESyncInfo info;
+  info.delay = 0;
+  info.error = 0;
+  info.rr = 1.0;
+  info.errortime = 0;
+  info.state = CAESyncInfo::SYNC_OFF;
+  return info;
+}
+
+bool CPAMixerStream::IsBuffering()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return m_buffering;
+}
+
+double CPAMixerStream::GetCacheTime()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return (double)m_used / m_format.m_sampleRate;
+}
+
+double CPAMixerStream::GetCacheTotal()
+{
+  return (double)m_capacity / m_format.m_sampleRate;
+}
+
+void CPAMixerStream::Pause()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  m_paused = true;
+}
+
+void CPAMixerStream::Resume()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  m_paused = false;
+  m_started = true;
+  m_mixer.Wake();
+}
+
+void CPAMixerStream::Drain(bool wait)
+{
+  {
+    CSingleLock lock(m_mixer.m_lock);
+    m_draining = true;
+    m_buffering = false;
+    m_mixer.Wake();
+  }
+
+  while (wait && !IsDrained())
+    m_mixer.m_drainEvent.WaitMSec(MIXER_IDLE_TIME);
+}
+
+bool CPAMixerStream::IsDraining()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return m_draining;
+}
+
+bool CPAMixerStream::IsDrained()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return m_drained;
+}
+
+void CPAMixerStream::Flush()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  m_readPos = 0;
+  m_used = 0;
+  m_buffering = true;
+  m_draining = false;
+  m_drained = false;
+}
+
+float CPAMixerStream::GetVolume()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return m_volume;
+}
+
+void CPAMixerStream::SetVolume(float volume)
+{
+  CSingleLock lock(m_mixer.m_lock);
+  m_volume = std::max(0.0f, std::min(1.0f, volume));
+}
+
+float CPAMixerStream::GetReplayGain()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return m_rgain;
+}
+
+void CPAMixerStream::SetReplayGain(float factor)
+{
+  CSingleLock lock(m_mixer.m_lock);
+  m_rgain = std::max(0.0f, factor);
+}
+
+float CPAMixerStream::GetAmplification()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return m_limiter.GetAmplification();
+}
+
+void CPAMixerStream::SetAmplification(float amplify)
+{
+  CSingleLock lock(m_mixer.m_lock);
+  m_limiter.SetAmplification(amplify);
+}
+
+const unsigned int CPAMixerStream::GetFrameSize() const
+{
+  return m_frameSize;
+}
+
+const unsigned int CPAMixerStream::GetChannelCount() const
+{
+  return m_channels;
+}
+
+const unsigned int CPAMixerStream::GetSampleRate() const
+{
+  return m_format.m_sampleRate;
+}
+
+const enum AEDataFormat CPAMixerStream::GetDataFormat() const
+{
+  return m_format.m_dataFormat;
+}
+
+void CPAMixerStream::RegisterAudioCallback(IAudioCallback* pCallback)
+{
+  m_mixer.SetAudioCallback(this, pCallback);
+}
+
+void CPAMixerStream::UnRegisterAudioCallback()
+{
+  m_mixer.SetAudioCallback(this, NULL);
+}
+
+void CPAMixerStream::FadeVolume(float from, float target, unsigned int time)
+{
+  if (time == 0)
+    return;
+
+  CSingleLock lock(m_mixer.m_lock);
+  m_fading = true;
+  m_fadingBase = from;
+  m_fadingTarget = target;
+  m_fadingTime = time;
+  m_fadingSamples = -1;
+}
+
+bool CPAMixerStream::IsFading()
+{
+  CSingleLock lock(m_mixer.m_lock);
+  return m_fading;
+}
+
+void CPAMixerStream::RegisterSlave(IAEStream *stream)
+{
+  CSingleLock lock(m_mixer.m_lock);
+  m_slave = static_cast<CPAMixerStream*>(stream);
+}
+
+unsigned int CPAMixerStream::Mix(float *dest, unsigned int frames)
+{
+  // same ramp as the engine, the fade moves the volume itself
+  if (m_fadingSamples == -1)
+  {
+    m_fadingSamples = m_format.m_sampleRate * (float)m_fadingTime / 1000.0f;
+    if (m_fadingSamples > 0)
+    {
+      m_volume = m_fadingBase;
+      m_fadingStep = (m_fadingTarget - m_fadingBase) / m_fadingSamples;
+    }
+    else
+    {
+      m_volume = m_fadingTarget;
+      m_fading = false;
+    }
+  }
+
+  bool limit = m_limiter.GetAmplification() != 1.0f;
+  frames = std::min(frames, m_used);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    if (m_fadingSamples > 0)
+    {
+      m_volume += m_fadingStep;
+      if (--m_fadingSamples == 0)
+      {
+        m_volume = m_fadingTarget;
+        m_fading = false;
+      }
+    }
+
+    float *src = &m_buffer[m_readPos * m_channels];
+    float volume = m_volume * m_rgain;
+    if (limit)
+      volume *= m_limiter.Run(&src, m_channels);
+
+    for (unsigned int j = 0; j < m_channels; j++)
+      dest[j] += src[j] * volume;
+    dest += m_channels;
+
+    if (++m_readPos == m_capacity)
+      m_readPos = 0;
+  }
+  m_used -= frames;
+
+  return frames;
+}
+
+//-----------------------------------------------------------------------------
+// CPAMixer
+//-----------------------------------------------------------------------------
+
+CPAMixer::CPAMixer() : CThread("PAMixer")
+{
+  m_outputs[0] = NULL;
+  m_outputs[1] = NULL;
+  m_channels = 0;
+  m_outputsPaused = false;
+  m_lastSync = 0.0;
+  m_discard2 = 0;
+  m_callbackStream = NULL;
+  m_audioCallback = NULL;
+}
+
+CPAMixer::~CPAMixer()
+{
+  Close();
+}
+
+IAEStream *CPAMixer::MakeStream(AEAudioFormat &audioFormat, unsigned int options)
+{
+  if (!CanConvert(audioFormat.m_dataFormat))
+  {
+    CLog::Log(LOGERROR, "CPAMixer::%s - unsupported format %s", __FUNCTION__,
+              CAEUtil::DataFormatToStr(audioFormat.m_dataFormat));
+    return NULL;
+  }
+
+  CPAMixerStream *stream = new CPAMixerStream(*this, audioFormat, (options & AESTREAM_PAUSED) != 0);
+  {
+    CSingleLock lock(m_lock);
+    m_streams.push_back(stream);
+  }
+
+  if (!IsRunning())
+    Create();
+  Wake();
+
+  return stream;
+}
+
+void CPAMixer::FreeStream(IAEStream *stream)
+{
+  CSingleLock lock(m_lock);
+  for (std::list<CPAMixerStream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+  {
+    if (*it == stream)
+    {
+      m_streams.erase(it);
+      break;
+    }
+  }
+  for (std::list<CPAMixerStream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+  {
+    if ((*it)->m_slave == stream)
+      (*it)->m_slave = NULL;
+  }
+  lock.Leave();
+
+  {
+    CSingleLock outputLock(m_outputLock);
+    if (m_callbackStream == stream)
+      m_callbackStream = NULL;
+  }
+
+  delete static_cast<CPAMixerStream*>(stream);
+}
+
+void CPAMixer::Drain()
+{
+  StopThread();
+  CloseOutputs(true);
+}
+
+void CPAMixer::Close()
+{
+  StopThread();
+  CloseOutputs(false);
+
+  {
+    CSingleLock lock(m_lock);
+    for (std::list<CPAMixerStream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+      delete *it;
+    m_streams.clear();
+  }
+
+  CSingleLock outputLock(m_outputLock);
+  m_callbackStream = NULL;
+  m_audioCallback = NULL;
+}
+
+void CPAMixer::Process()
+{
+  while (!m_bStop)
+  {
+    if (!Mix())
+      m_wakeEvent.WaitMSec(MIXER_IDLE_TIME);
+  }
+}
+
+IAEStream *CPAMixer::MakeOutput(AEAudioFormat &format, unsigned int options, bool secondary)
+{
+  return CAEFactory::MakeStream(format, options, NULL, secondary);
+}
+
+void CPAMixer::FreeOutput(IAEStream *stream)
+{
+  CAEFactory::FreeStream(stream);
+}
+
+/**
+ * Looks at the tracks under m_lock, the engines are called without it,
+ * so an engine that is slow to answer doesn't block the player adding
+ * data or asking for the delay of a track.
+ */
+bool CPAMixer::Mix()
+{
+  AEAudioFormat format;
+  bool open = false;
+  bool play = false;
+  bool pending = false;
+  bool hold = false;
+  {
+    CSingleLock lock(m_lock);
+    for (std::list<CPAMixerStream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+    {
+      CPAMixerStream *stream = *it;
+      if (stream->m_drained)
+        continue;
+      if (stream->m_paused)
+      {
+        // a paused track that played before holds the outputs, a queued one doesn't
+        hold |= stream->m_started;
+        continue;
+      }
+      if (!m_outputs[0])
+      {
+        format = stream->m_format;
+        open = true;
+        break;
+      }
+      if (SameFormat(stream->m_format, m_format))
+        play = true;
+      else
+        pending = true;
+    }
+  }
+
+  if (open)
+  {
+    if (!OpenOutputs(format))
+    {
+      // nothing can be played, let the player move on
+      CSingleLock lock(m_lock);
+      for (std::list<CPAMixerStream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+      {
+        CPAMixerStream *stream = *it;
+        if (!stream->m_drained && !stream->m_paused && SameFormat(stream->m_format, format))
+          stream->m_drained = true;
+      }
+      m_drainEvent.Set();
+    }
+    return true;
+  }
+
+  if (!play)
+  {
+    if (pending)
+    {
+      // format change, no crossfade possible, play out what we have and reopen
+      CloseOutputs(true);
+      return true;
+    }
+    if (hold)
+      PauseOutputs(true);
+    return false;
+  }
+  PauseOutputs(false);
+
+  unsigned int frames = std::min(GetOutputSpace(), (unsigned int)(m_format.m_sampleRate * MIXER_CHUNK_TIME));
+  {
+    CSingleLock lock(m_lock);
+    frames = MixStreams(frames);
+  }
+  if (!frames)
+    return false;
+
+  WriteOutputs(m_mixBuffer.data(), frames);
+  SyncOutputs();
+
+  return true;
+}
+
+/**
+ * Mixes up to frames of the playing tracks into m_mixBuffer, the
+ * caller holds m_lock. Returns the frames to write.
+ */
+unsigned int CPAMixer::MixStreams(unsigned int frames)
+{
+  std::vector<CPAMixerStream*> active;
+  for (std::list<CPAMixerStream*>::iterator it = m_streams.begin(); it != m_streams.end(); ++it)
+  {
+    CPAMixerStream *stream = *it;
+    if (stream->m_drained || stream->m_paused || !SameFormat(stream->m_format, m_format))
+      continue;
+    active.push_back(stream);
+    if (!stream->m_draining)
+      frames = std::min(frames, stream->Available());
+  }
+  if (active.empty() || !frames)
+    return 0;
+
+  m_mixBuffer.assign(frames * m_channels, 0.0f);
+  float *mix = m_mixBuffer.data();
+  unsigned int used = 0;
+  for (std::vector<CPAMixerStream*>::iterator it = active.begin(); it != active.end(); ++it)
+  {
+    CPAMixerStream *stream = *it;
+    unsigned int mixed = stream->Mix(mix, frames);
+    if (mixed == frames || !stream->m_draining)
+    {
+      used = std::max(used, mixed);
+      continue;
+    }
+
+    stream->m_drained = true;
+    m_drainEvent.Set();
+    CPAMixerStream *slave = stream->m_slave;
+    stream->m_slave = NULL;
+    if (slave)
+    {
+      // gapless, the next track starts right after the last frame
+      slave->m_paused = false;
+      slave->m_started = true;
+      if (SameFormat(slave->m_format, m_format) &&
+          std::find(active.begin(), active.end(), slave) == active.end())
+        mixed += slave->Mix(mix + mixed * m_channels, frames - mixed);
+    }
+    used = std::max(used, mixed);
+  }
+
+  // the end of the last track is not padded with silence
+  return used;
+}
+
+bool CPAMixer::OpenOutputs(const AEAudioFormat &format)
+{
+  m_format = format;
+  m_format.m_dataFormat = AE_FMT_FLOAT;
+  m_channels = m_format.m_channelLayout.Count();
+
+  IAEStream *outputs[2];
+  AEAudioFormat outFormat = m_format;
+  outputs[0] = MakeOutput(outFormat, 0, false);
+  if (!outputs[0])
+  {
+    CLog::Log(LOGERROR, "CPAMixer::%s - failed to get stream for output 1", __FUNCTION__);
+    return false;
+  }
+
+  // the 2nd output follows the 1st one via its resample ratio
+  outFormat = m_format;
+  outputs[1] = MakeOutput(outFormat, AESTREAM_FORCE_RESAMPLE, true);
+  if (!outputs[1])
+    CLog::Log(LOGWARNING, "CPAMixer::%s - failed to get stream for output 2", __FUNCTION__);
+
+  {
+    CSingleLock lock(m_outputLock);
+    m_outputs[0] = outputs[0];
+    m_outputs[1] = outputs[1];
+    if (m_audioCallback)
+      m_outputs[0]->RegisterAudioCallback(m_audioCallback);
+  }
+
+  m_outputsPaused = false;
+  m_sync.Reset();
+  m_lastSync = 0.0;
+  m_discard2 = 0;
+  m_silence.assign(m_format.m_sampleRate * MIXER_MAX_SKEW * m_channels, 0.0f);
+
+  CLog::Log(LOGDEBUG, "CPAMixer::%s - channels: %d, samplerate: %d", __FUNCTION__,
+            m_channels, m_format.m_sampleRate);
+  return true;
+}
+
+void CPAMixer::CloseOutputs(bool drain)
+{
+  IAEStream *outputs[2];
+  {
+    CSingleLock lock(m_outputLock);
+    outputs[0] = m_outputs[0];
+    outputs[1] = m_outputs[1];
+    m_outputs[0] = NULL;
+    m_outputs[1] = NULL;
+    if (outputs[0] && m_audioCallback)
+      outputs[0]->UnRegisterAudioCallback();
+  }
+
+  // don't block the player while the engines play out
+  for (int i = 0; i < 2; i++)
+  {
+    if (!outputs[i])
+      continue;
+    if (drain)
+    {
+      outputs[i]->Resume();
+      outputs[i]->Drain(true);
+    }
+    FreeOutput(outputs[i]);
+  }
+}
+
+void CPAMixer::PauseOutputs(bool pause)
+{
+  if (pause == m_outputsPaused)
+    return;
+
+  for (int i = 0; i < 2; i++)
+  {
+    if (!m_outputs[i])
+      continue;
+    if (pause)
+      m_outputs[i]->Pause();
+    else
+      m_outputs[i]->Resume();
+  }
+  m_outputsPaused = pause;
+  m_sync.Reset();
+}
+
+unsigned int CPAMixer::GetOutputSpace()
+{
+  unsigned int frameSize = m_channels * sizeof(float);
+  unsigned int space = m_outputs[0]->GetSpace() / frameSize;
+  if (m_outputs[1])
+    space = std::min(space, m_outputs[1]->GetSpace() / frameSize + m_discard2);
+  return space;
+}
+
+void CPAMixer::WriteOutputs(float *data, unsigned int frames)
+{
+  const uint8_t *buf = (const uint8_t*)data;
+  m_outputs[0]->AddData(&buf, 0, frames);
+
+  if (m_outputs[1])
+  {
+    unsigned int skip = std::min(m_discard2, frames);
+    m_discard2 -= skip;
+    if (frames > skip)
+      m_outputs[1]->AddData(&buf, skip, frames - skip);
+  }
+}
+
+void CPAMixer::SyncOutputs()
+{
+  if (!m_outputs[1] || m_outputs[0]->IsBuffering() || m_outputs[1]->IsBuffering())
+    return;
+
+  double now = (double)CurrentHostCounter() * DVD_TIME_BASE / CurrentHostFrequency();
+  if (now - m_lastSync < DVD_SEC_TO_TIME(MIXER_SYNC_TIME))
+    return;
+  m_lastSync = now;
+
+  double skew = m_outputs[0]->GetDelay() - m_outputs[1]->GetDelay();
+  if (skew > MIXER_MAX_SKEW)
+  {
+    // the 2nd output is ahead, hold it back with silence
+    unsigned int frameSize = m_channels * sizeof(float);
+    unsigned int frames = std::min((unsigned int)(skew * m_format.m_sampleRate),
+                                   m_outputs[1]->GetSpace() / frameSize);
+    frames = std::min(frames, (unsigned int)m_silence.size() / m_channels);
+    const uint8_t *buf = (const uint8_t*)m_silence.data();
+    m_outputs[1]->AddData(&buf, 0, frames);
+    m_sync.Reset();
+  }
+  else if (skew < -MIXER_MAX_SKEW)
+  {
+    // the 2nd output lags, drop frames of the next mixes
+    m_discard2 = -skew * m_format.m_sampleRate;
+    m_sync.Reset();
+  }
+  else if (m_sync.Update(DVD_SEC_TO_TIME(skew), now))
+    m_outputs[1]->SetResampleRatio(m_sync.GetRatio());
+}
+
+double CPAMixer::GetOutputDelay()
+{
+  CSingleLock lock(m_outputLock);
+  if (!m_outputs[0])
+    return 0.0;
+  return m_outputs[0]->GetDelay();
+}
+
+void CPAMixer::SetAudioCallback(CPAMixerStream *stream, IAudioCallback *callback)
+{
+  CSingleLock lock(m_outputLock);
+  // a track that has handed over must not unregister its successor
+  if (!callback && stream != m_callbackStream)
+    return;
+
+  m_callbackStream = callback ? stream : NULL;
+  m_audioCallback = callback;
+  if (m_outputs[0])
+  {
+    if (callback)
+      m_outputs[0]->RegisterAudioCallback(callback);
+    else
+      m_outputs[0]->UnRegisterAudioCallback();
+  }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2016 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <vector>
+
+#include "cores/AudioEngine/Interfaces/AEStream.h"
+#include "cores/AudioEngine/Utils/AELimiter.h"
+#include "cores/VideoPlayer/Audio2Sync.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+class CPAMixer;
+
+/*!
+ * \brief Track of PAPlayer when both audio outputs are enabled.
+ *
+ * Looks like an engine stream to PAPlayer. The decoded frames are
+ * converted to float once and kept in a small ring buffer until the mixer
+ * picks them up. Volume, replay gain, fades and the gapless slave are
+ * handled by the mixer instead of the engines.
+ */
+class CPAMixerStream : public IAEStream
+{
+  friend class CPAMixer;
+public:
+  virtual unsigned int GetSpace() override;
+  virtual unsigned int AddData(const uint8_t* const *data, unsigned int offset, unsigned int frames, double pts = 0.0) override;
+  virtual double GetDelay() override;
+  virtual CAESyncInfo GetSyncInfo() override;
+  virtual bool IsBuffering() override;
+  virtual double GetCacheTime() override;
+  virtual double GetCacheTotal() override;
+
+  virtual void Pause() override;
+  virtual void Resume() override;
+  virtual void Drain(bool wait) override;
+  virtual bool IsDraining() override;
+  virtual bool IsDrained() override;
+  virtual void Flush() override;
+
+  virtual float GetVolume() override;
+  virtual void SetVolume(float volume) override;
+  virtual float GetReplayGain() override;
+  virtual void SetReplayGain(float factor) override;
+  virtual float GetAmplification() override;
+  virtual void SetAmplification(float amplify) override;
+  virtual void SetFFmpegInfo(int profile, enum AVMatrixEncoding matrix_encoding, enum AVAudioServiceType audio_service_type) override {}
+
+  virtual const unsigned int GetFrameSize() const override;
+  virtual const unsigned int GetChannelCount() const override;
+  virtual const unsigned int GetSampleRate() const override;
+  virtual const enum AEDataFormat GetDataFormat() const override;
+
+  virtual double GetResampleRatio() override { return 1.0; }
+  virtual void SetResampleRatio(double ratio) override {}
+  virtual void SetResampleMode(int mode) override {}
+
+  virtual void RegisterAudioCallback(IAudioCallback* pCallback) override;
+  virtual void UnRegisterAudioCallback() override;
+  virtual void FadeVolume(float from, float target, unsigned int time) override;
+  virtual bool IsFading() override;
+  virtual void RegisterSlave(IAEStream *stream) override;
+  virtual bool HasDSP() override { return false; }
+
+protected:
+  CPAMixerStream(CPAMixer &mixer, const AEAudioFormat &format, bool paused);
+  virtual ~CPAMixerStream() {}
+
+  unsigned int Available() const { return m_used; }
+  unsigned int Mix(float *dest, unsigned int frames);
+
+  CPAMixer &m_mixer;
+  AEAudioFormat m_format;
+  unsigned int m_channels;
+  unsigned int m_frameSize;
+  bool m_planar;                       /* one plane per channel in AddData */
+  AEDataFormat m_packedFormat;         /* sample format of a single plane */
+
+  std::vector<float> m_buffer;
+  unsigned int m_capacity;             /* frames */
+  unsigned int m_readPos;
+  unsigned int m_used;
+
+  bool m_paused;
+  bool m_started;                      /* resumed at least once */
+  bool m_buffering;
+  bool m_draining;
+  bool m_drained;
+  CPAMixerStream *m_slave;
+
+  float m_volume;
+  float m_rgain;
+  CAELimiter m_limiter;
+  bool m_fading;
+  float m_fadingBase;
+  float m_fadingTarget;
+  unsigned int m_fadingTime;
+  int m_fadingSamples;                 /* -1 if a new fade has to be set up */
+  float m_fadingStep;
+};
+
+/*!
+ * \brief Mixes the tracks of PAPlayer once and feeds the result to both
+ * audio engines.
+ *
+ * Each engine gets a single stream for as long as the format does not
+ * change, so crossfades and gapless transitions are computed once in the
+ * player, not in each engine. The 2nd output is kept in step with the
+ * 1st one by CAudio2Sync.
+ */
+class CPAMixer : private CThread
+{
+  friend class CPAMixerStream;
+public:
+  CPAMixer();
+  virtual ~CPAMixer();
+
+  /*!
+   * \brief Create a track, encoded formats are not supported
+   * \return NULL if the format can't be mixed
+   */
+  IAEStream *MakeStream(AEAudioFormat &audioFormat, unsigned int options = 0);
+  void FreeStream(IAEStream *stream);
+
+  /*!
+   * \brief Wait until all tracks have been played out
+   */
+  void Drain();
+
+  /*!
+   * \brief Free the engine streams, all tracks must have been freed before
+   */
+  void Close();
+
+protected:
+  virtual void Process() override;
+
+  /*!
+   * \brief Create an engine stream, the 2nd output is secondary
+   */
+  virtual IAEStream *MakeOutput(AEAudioFormat &format, unsigned int options, bool secondary);
+  virtual void FreeOutput(IAEStream *stream);
+
+  bool Mix();
+  unsigned int MixStreams(unsigned int frames);
+  bool OpenOutputs(const AEAudioFormat &format);
+  void CloseOutputs(bool drain);
+  void PauseOutputs(bool pause);
+  unsigned int GetOutputSpace();
+  void WriteOutputs(float *data, unsigned int frames);
+  void SyncOutputs();
+  double GetOutputDelay();
+  void SetAudioCallback(CPAMixerStream *stream, IAudioCallback *callback);
+  void Wake() { m_wakeEvent.Set(); }
+
+  CCriticalSection m_lock;             /* tracks, never held while calling an engine */
+  CEvent m_wakeEvent;
+  CEvent m_drainEvent;
+  std::list<CPAMixerStream*> m_streams;
+
+  /* the outputs are opened, written and closed by the mixer thread only,
+   * other threads use them under m_outputLock */
+  CCriticalSection m_outputLock;
+  IAEStream *m_outputs[2];
+  AEAudioFormat m_format;              /* format of the engine streams */
+  unsigned int m_channels;
+  bool m_outputsPaused;
+  std::vector<float> m_mixBuffer;
+  std::vector<float> m_silence;
+
+  CAudio2Sync m_sync;
+  double m_lastSync;
+  unsigned int m_discard2;             /* frames to drop from the 2nd output */
+
+  CPAMixerStream *m_callbackStream;   /* m_outputLock */
+  IAudioCallback *m_audioCallback;
+};
@@ -78,9 +78,6 @@ PAPlayer::PAPlayer(IPlayerCallback& callback) :
   memset(&m_playerGUIData, 0, sizeof(m_playerGUIData));
   m_processInfo.reset(CProcessInfo::CreateInstance());
   m_bAudio2 = false;
-  m_iTimeSynced = 0;
-  m_iAudio2Discard = 0;
-  m_iRawFrameSize = 0;
 }
 
 PAPlayer::~PAPlayer()
@@ -112,11 +109,6 @@ void PAPlayer::SoftStart(bool wait/* = false */)
 
     si->m_stream->Resume();
     si->m_stream->FadeVolume(0.0f, 1.0f, FAST_XFADE_TIME);
-    if(m_bAudio2)
-    {
-      si->m_stream2->Resume();
-	  si->m_stream2->FadeVolume(0.0f, 1.0f, FAST_XFADE_TIME);
-    }
   }
   
   if (wait)
@@ -155,8 +147,6 @@ void PAPlayer::SoftStop(bool wait/* = false */, bool close/* = true */)
     StreamInfo* si = *itt;
     if (si->m_stream)
       si->m_stream->FadeVolume(1.0f, 0.0f, FAST_XFADE_TIME);
-    if(m_bAudio2 && si->m_stream2)
-      si->m_stream2->FadeVolume(1.0f, 0.0f, FAST_XFADE_TIME);
 
     if (close)
     {
@@ -202,8 +192,6 @@ void PAPlayer::SoftStop(bool wait/* = false */, bool close/* = true */)
       {
         StreamInfo* si = *itt;
         si->m_stream->Pause();
-        if(m_bAudio2)
-          si->m_stream2->Pause();
       }
     }
   }
@@ -221,18 +209,11 @@ void PAPlayer::CloseAllStreams(bool fade/* = true */)
       
       if (si->m_stream)
       {
-        CAEFactory::FreeStream(si->m_stream);
+        FreeStream(si->m_stream);
         si->m_stream = NULL;
       }
-      if(m_bAudio2 && si->m_stream2)
-      {
-        CAEFactory::FreeStream(si->m_stream2);
-        si->m_stream2 = NULL;
-      }
 
       si->m_decoder.Destroy();
-      if(si->m_usedecoder2)
-        si->m_decoder2.Destroy();
       delete si;
     }
 
@@ -243,21 +224,15 @@ void PAPlayer::CloseAllStreams(bool fade/* = true */)
 
       if (si->m_stream)
       {
-        CAEFactory::FreeStream(si->m_stream);
+        FreeStream(si->m_stream);
         si->m_stream = NULL;
       }
-      if(m_bAudio2 && si->m_stream2)
-      {
-        CAEFactory::FreeStream(si->m_stream2);
-        si->m_stream2 = NULL;
-      }
 
       si->m_decoder.Destroy();
-      if(si->m_usedecoder2)
-        si->m_decoder2.Destroy();
       delete si;
     }
     m_currentStream = NULL;
+    m_mixer.Close();
   }
   else
   {
@@ -371,10 +346,15 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     m_continueStream = false;
   }
 
-  m_bAudio2 = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED) ? true : false;
+  {
+    // tracks of both modes can't be mixed, switch only in between
+    CSingleLock lock(m_streamsLock);
+    if (m_streams.empty() && m_finishing.empty())
+      m_bAudio2 = CAEFactory::IsAudio2Enabled();
+  }
 
   StreamInfo *si = new StreamInfo();
-  si->m_decoder.SetCheckAudio2(m_bAudio2);
+  si->m_decoder.SetDualOutput(m_bAudio2);
   if (!si->m_decoder.Create(file, (file.m_lStartOffset * 1000) / 75))
   {
     CLog::Log(LOGWARNING, "PAPlayer::QueueNextFileEx - Failed to create the decoder");
@@ -387,18 +367,6 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     return false;
   }
 
-  si->m_usedecoder2 = false;
-  if (m_bAudio2)
-  {
-    si->m_decoder2.SetAudio2(true);
-    if (si->m_decoder.IsReusableForAudio2())
-      CLog::Log(LOGINFO, "PAPlayer::QueueNextFileEx - Reuse for 2nd decoder");
-    else if (si->m_decoder2.Create(file, (file.m_lStartOffset * 1000) / 75))
-      si->m_usedecoder2 = true;
-    else
-      CLog::Log(LOGWARNING, "PAPlayer::QueueNextFileEx - Failed to create 2nd decoder");
-  }
-
   /* decode until there is data-available */
   si->m_decoder.Start();
   while(si->m_decoder.GetDataSize(true) == 0)
@@ -411,8 +379,6 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
       CLog::Log(LOGINFO, "PAPlayer::QueueNextFileEx - Error reading samples");
 
       si->m_decoder.Destroy();
-      if(si->m_usedecoder2)
-	    si->m_decoder2.Destroy();
       delete si;
       // advance playlist
       if (job)
@@ -425,28 +391,6 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     CThread::Sleep(1);
   }
 
-  if (si->m_usedecoder2)
-  {
-    si->m_decoder2.Start();
-	while(si->m_decoder2.GetDataSize(true) == 0)
-	{
-	  int status = si->m_decoder2.GetStatus();
-	  if (status == STATUS_ENDED   ||
-		  status == STATUS_NO_FILE ||
-		  si->m_decoder2.ReadSamples(PACKET_SIZE) == RET_ERROR)
-	  {
-		CLog::Log(LOGINFO, "PAPlayer::QueueNextFileEx 2nd - Error reading samples");
-
-        si->m_decoder2.Destroy();
-        si->m_usedecoder2 = false;
-        break;
-	  }
-	
-	  /* yield our time so that the main PAP thread doesnt stall */
-	  CThread::Sleep(1);
-	}
-  }
-
   // set m_upcomingCrossfadeMS depending on type of file and user settings
   UpdateCrossfadeTime(file);
 
@@ -456,27 +400,12 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
   si->m_endOffset = file.m_lEndOffset   * 1000 / 75;
   si->m_bytesPerSample = CAEUtil::DataFormatToBits(si->m_audioFormat.m_dataFormat) >> 3;
   si->m_bytesPerFrame = si->m_bytesPerSample * si->m_audioFormat.m_channelLayout.Count();
-  if (si->m_usedecoder2)
-  {
-    si->m_audioFormat2 = si->m_decoder2.GetFormat();
-    si->m_bytesPerSample2 = CAEUtil::DataFormatToBits(si->m_audioFormat2.m_dataFormat) >> 3;
-    si->m_bytesPerFrame2 = si->m_bytesPerSample2 * si->m_audioFormat2.m_channelLayout.Count();
-  }
-  else
-  {
-    si->m_audioFormat2    = si->m_audioFormat;
-    si->m_bytesPerSample2 = si->m_bytesPerSample;
-    si->m_bytesPerFrame2  = si->m_bytesPerFrame;
-  }
   si->m_started = false;
   si->m_finishing = false;
   si->m_framesSent = 0;
-  si->m_framesSent2 = 0;
   si->m_seekNextAtFrame = 0;
   si->m_seekFrame = -1;
-  si->m_seekFrame2 = -1;
   si->m_stream = NULL;
-  si->m_stream2 = NULL;
   si->m_volume = (fadeIn && m_upcomingCrossfadeMS) ? 0.0f : 1.0f;
   si->m_fadeOutTriggered = false;
   si->m_isSlaved = false;
@@ -499,8 +428,6 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     m_currentStream->m_waitOnDrain = true;
     m_currentStream->m_prepareNextAtFrame = 0;
     si->m_decoder.Destroy();
-    if(si->m_usedecoder2)
-      si->m_decoder2.Destroy();
     delete si;
     return false;
   }
@@ -515,8 +442,6 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     CLog::Log(LOGINFO, "PAPlayer::QueueNextFileEx - Error preparing stream");
     
     si->m_decoder.Destroy();
-    if(si->m_usedecoder2)
-      si->m_decoder2.Destroy();
     delete si;
     // advance playlist
     if (job)
@@ -559,10 +484,7 @@ inline bool PAPlayer::PrepareStream(StreamInfo *si)
 
   /* get a paused stream */
   AEAudioFormat format = si->m_audioFormat;
-  si->m_stream = CAEFactory::MakeStream(
-    format,
-    AESTREAM_PAUSED
-  );
+  si->m_stream = MakeStream(format, AESTREAM_PAUSED);
 
   if (!si->m_stream)
   {
@@ -580,45 +502,12 @@ inline bool PAPlayer::PrepareStream(StreamInfo *si)
     // Clipping protecton provided as audio limiting
     si->m_stream->SetAmplification(gain);
 
-  if(m_bAudio2)
-  {
-    AEAudioFormat format = si->m_audioFormat2;
-    si->m_stream2 = CAEFactory::MakeStream(
-      format,
-      AESTREAM_PAUSED,
-      NULL, true
-    );
-
-    if (!si->m_stream2)
-    {
-      CLog::Log(LOGDEBUG, "PAPlayer::PrepareStream 2nd - Failed to get IAEStream");
-      if (si->m_usedecoder2)
-      {
-        si->m_decoder2.Destroy();
-        si->m_usedecoder2 = false;
-      }
-      m_bAudio2 = false;
-    }
-    else
-    {
-      si->m_stream2->SetVolume    (si->m_volume);
-      float peak = 1.0;
-      float gain = si->m_usedecoder2 ? si->m_decoder2.GetReplayGain(peak) : si->m_decoder.GetReplayGain(peak);
-      if (peak == 1.0)
-        si->m_stream2->SetReplayGain(gain);
-      else
-        si->m_stream2->SetAmplification(gain);
-    }
-  }
-
   /* if its not the first stream and crossfade is not enabled */
   if (m_currentStream && m_currentStream != si && !m_upcomingCrossfadeMS)
   {
     /* slave the stream for gapless */
     si->m_isSlaved = true;
     m_currentStream->m_stream->RegisterSlave(si->m_stream);
-    if(m_bAudio2)
-      m_currentStream->m_stream2->RegisterSlave(si->m_stream2);
   }
 
   /* fill the stream's buffer */
@@ -640,24 +529,6 @@ inline bool PAPlayer::PrepareStream(StreamInfo *si)
     CThread::Sleep(1);
   }
 
-  while(si->m_usedecoder2 && si->m_stream2->IsBuffering())
-  {
-    int status = si->m_decoder2.GetStatus();
-    if (status == STATUS_ENDED   ||
-        status == STATUS_NO_FILE ||
-        si->m_decoder2.ReadSamples(PACKET_SIZE) == RET_ERROR)
-    {
-      CLog::Log(LOGINFO, "PAPlayer::PrepareStream 2nd - Stream Finished");
-      break;
-    }
-
-    if (!QueueData2(si))
-      break;
-
-    /* yield our time so that the main PAP thread doesnt stall */
-    CThread::Sleep(1);
-  }
-
   CLog::Log(LOGINFO, "PAPlayer::PrepareStream - Ready");
 
   return true;
@@ -729,12 +600,15 @@ void PAPlayer::Process()
     }
 
     GetTimeInternal(); //update for GUI
-
-    SyncStreams2();
   }
 
   if(m_isFinished && !m_bStop)
+  {
+    // the last track has left the mixer, let the engines play it out
+    if (m_bAudio2)
+      m_mixer.Drain();
     m_callback.OnPlayBackEnded();
+  }
   else
     m_callback.OnPlayBackStopped();
 }
@@ -753,12 +627,10 @@ inline void PAPlayer::ProcessStreams(double &freeBufferTime)
   for(StreamList::iterator itt = m_finishing.begin(); itt != m_finishing.end();)
   {
     StreamInfo* si = *itt;
-    if (si->m_stream->IsDrained() && (!m_bAudio2 || si->m_stream2->IsDrained()))
+    if (si->m_stream->IsDrained())
     {      
       itt = m_finishing.erase(itt);
-      CAEFactory::FreeStream(si->m_stream);
-      if(m_bAudio2)
-        CAEFactory::FreeStream(si->m_stream2);
+      FreeStream(si->m_stream);
       delete si;
       CLog::Log(LOGDEBUG, "PAPlayer::ProcessStreams - Stream Freed");
     }
@@ -786,8 +658,6 @@ inline void PAPlayer::ProcessStreams(double &freeBufferTime)
         if (si->m_waitOnDrain)
         {
           si->m_stream->Drain(true);
-          if(m_bAudio2)
-            si->m_stream2->Drain(true);
           si->m_waitOnDrain = false;
         }
         si->m_prepareTriggered = true;
@@ -808,8 +678,6 @@ inline void PAPlayer::ProcessStreams(double &freeBufferTime)
             if (si->m_waitOnDrain)
             {
               si->m_stream->Drain(true);
-              if(m_bAudio2)
-                si->m_stream2->Drain(true);
               si->m_waitOnDrain = false;
             }
             m_callback.OnQueueNextItem();
@@ -828,15 +696,6 @@ inline void PAPlayer::ProcessStreams(double &freeBufferTime)
       si->m_stream->UnRegisterAudioCallback();
       si->m_decoder.Destroy();      
       si->m_stream->Drain(false);
-      if(m_bAudio2)
-      {
-        if (si->m_usedecoder2)
-        {
-          si->m_decoder2.Destroy();
-          si->m_usedecoder2 = false;
-        }
-        si->m_stream2->Drain(false);
-      }
       m_finishing.push_back(si);
       return;
     }
@@ -865,8 +724,6 @@ inline void PAPlayer::ProcessStreams(double &freeBufferTime)
         if (m_upcomingCrossfadeMS)
         {
           si->m_stream->FadeVolume(1.0f, 0.0f, m_upcomingCrossfadeMS);
-          if(m_bAudio2)
-            si->m_stream2->FadeVolume(1.0f, 0.0f, m_upcomingCrossfadeMS);
           si->m_fadeOutTriggered = true;
         }
         m_currentStream = NULL;
@@ -890,12 +747,6 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
     if (!si->m_isSlaved)
       si->m_stream->Resume();
     si->m_stream->FadeVolume(0.0f, 1.0f, m_upcomingCrossfadeMS);
-    if(m_bAudio2)
-    {
-      if (!si->m_isSlaved)
-        si->m_stream2->Resume();
-      si->m_stream2->FadeVolume(0.0f, 1.0f, m_upcomingCrossfadeMS);
-    }
     m_callback.OnPlayBackStarted();
   }
 
@@ -913,9 +764,7 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
     {
       time = (int64_t)((float)si->m_seekFrame / (float)si->m_audioFormat.m_sampleRate * 1000.0f);
       si->m_framesSent = (int)(si->m_seekFrame - ((float)si->m_startOffset * (float)si->m_audioFormat.m_sampleRate) / 1000.0f);
-      si->m_framesSent2 = (int)(si->m_seekFrame2 - ((float)si->m_startOffset * (float)si->m_audioFormat2.m_sampleRate) / 1000.0f);
       si->m_seekFrame  = -1;
-      si->m_seekFrame2  = -1;
       m_playerGUIData.m_time = time; //update for GUI
       si->m_seekNextAtFrame = 0;
     }
@@ -923,7 +772,6 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
     else
     {
       si->m_framesSent      += si->m_audioFormat.m_sampleRate * (m_playbackSpeed  - 1);
-      si->m_framesSent2     += si->m_audioFormat2.m_sampleRate * (m_playbackSpeed  - 1);
       si->m_seekNextAtFrame  = si->m_framesSent + si->m_audioFormat.m_sampleRate / 2;
       time = (int64_t)(((float)si->m_framesSent / (float)si->m_audioFormat.m_sampleRate * 1000.0f) + (float)si->m_startOffset);
     }
@@ -933,14 +781,11 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
     {
       time = si->m_startOffset;
       si->m_framesSent      = 0;
-      si->m_framesSent2     = 0;
       si->m_seekNextAtFrame = 0;
       SetSpeed(1);
     }
 
     si->m_decoder.Seek(time);
-    if(si->m_usedecoder2)
-      si->m_decoder2.Seek(time);
   }
 
   int status = si->m_decoder.GetStatus();
@@ -990,12 +835,6 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
   if (!QueueData(si))
     return false;
 
-  if (si->m_usedecoder2)
-  {
-    si->m_decoder2.ReadSamples(PACKET_SIZE);
-    QueueData2(si);
-  }
-
   /* update free buffer time if we are running */
   if (si->m_started)
   {
@@ -1011,21 +850,6 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
 
       freeBufferTime = std::max(freeBufferTime , free_space);
     }
-    if (m_bAudio2)
-    {
-      if (si->m_stream2->IsBuffering())
-        freeBufferTime = 1.0;
-      else
-      {
-        double free_space;
-        if (si->m_audioFormat2.m_dataFormat != AE_FMT_RAW)
-          free_space = (double)(si->m_stream2->GetSpace() / si->m_bytesPerSample2) / si->m_audioFormat2.m_sampleRate;
-        else
-          free_space = (double) si->m_stream2->GetSpace() * si->m_audioFormat2.m_streamInfo.GetDuration() / 1000;
-
-        freeBufferTime = std::max(freeBufferTime , free_space);
-      }
-    }
   }
 
   return true;
@@ -1033,10 +857,7 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
 
 bool PAPlayer::QueueData(StreamInfo *si)
 {
-  bool bAudio2 = m_bAudio2 && !si->m_usedecoder2 && si->m_stream2;
   unsigned int space = si->m_stream->GetSpace();
-  if (bAudio2)
-    space = std::min(space, si->m_stream2->GetSpace());
 
   if (si->m_audioFormat.m_dataFormat != AE_FMT_RAW)
   {
@@ -1057,31 +878,9 @@ bool PAPlayer::QueueData(StreamInfo *si)
     unsigned int frames = samples/si->m_audioFormat.m_channelLayout.Count();
     unsigned int added = si->m_stream->AddData(&data, 0, frames, 0);
     si->m_framesSent += added;
-
-    if (bAudio2)
-    {
-      if(samples > m_iAudio2Discard)
-      {
-        m_iAudio2Discard = 0;
-        samples -= m_iAudio2Discard;
-      }
-      else
-      {
-        m_iAudio2Discard -= samples;
-        samples = samples - (samples * si->m_bytesPerSample / si->m_bytesPerFrame * si->m_bytesPerFrame / si->m_bytesPerSample);
-      }
-      if(samples)
-      {
-        frames = samples/si->m_audioFormat.m_channelLayout.Count();
-        added = si->m_stream2->AddData(&data, 0, frames, 0);
-      }
-      si->m_framesSent2 = si->m_framesSent;
-    }
   }
   else
   {
-    m_iRawFrameSize = 0;
-
     if (!space)
       return true;
 
@@ -1096,16 +895,6 @@ bool PAPlayer::QueueData(StreamInfo *si)
         return false;
       }
       si->m_framesSent += si->m_audioFormat.m_streamInfo.GetDuration() / 1000 * si->m_audioFormat.m_streamInfo.m_sampleRate;
-
-      if (bAudio2)
-      {
-        m_iRawFrameSize = size;
-        if (m_iAudio2Discard)
-          m_iAudio2Discard--;
-        else
-          added = si->m_stream2->AddData(&data, 0, size, 0);
-        si->m_framesSent2 = si->m_framesSent;
-      }
     }
   }
 
@@ -1115,155 +904,20 @@ bool PAPlayer::QueueData(StreamInfo *si)
   return true;
 }
 
-bool PAPlayer::QueueData2(StreamInfo *si)
+IAEStream *PAPlayer::MakeStream(AEAudioFormat &format, unsigned int options)
 {
-  if (!si->m_usedecoder2)
-    return false;
-
-  unsigned int space   = si->m_stream2->GetSpace();
-
-  if (si->m_audioFormat2.m_dataFormat != AE_FMT_RAW)
-  {
-    unsigned int samples = std::min(si->m_decoder2.GetDataSize(false), space / si->m_bytesPerSample2);
-    if (!samples)
-      return true;
-
-    // we want complete frames
-    samples -= samples % si->m_audioFormat2.m_channelLayout.Count();
-
-    uint8_t* data = (uint8_t*)si->m_decoder2.GetData(samples);
-    if (!data)
-    {
-      CLog::Log(LOGERROR, "PAPlayer::QueueData 2nd - Failed to get data from the decoder");
-      return false;
-    }
-
-	if(samples > m_iAudio2Discard)
-    {
-      si->m_framesSent2 += m_iAudio2Discard/si->m_audioFormat2.m_channelLayout.Count();
-      m_iAudio2Discard = 0;
-      samples -= m_iAudio2Discard;
-    }
-    else
-    {
-      si->m_framesSent2 += samples/si->m_audioFormat2.m_channelLayout.Count();
-      m_iAudio2Discard -= samples;
-      samples = samples - (samples * si->m_bytesPerSample2 / si->m_bytesPerFrame2 * si->m_bytesPerFrame2 / si->m_bytesPerSample2);
-    }
-    if(samples)
-    {
-      unsigned int frames = samples/si->m_audioFormat2.m_channelLayout.Count();
-      unsigned int added = si->m_stream2->AddData(&data, 0, frames, 0);
-      si->m_framesSent2 += added;
-    }
-  }
-  else
-  {
-    m_iRawFrameSize = 0;
-	  
-    if (!space)
-      return true;
-
-    int size;
-    uint8_t *data = si->m_decoder2.GetRawData(size);
-    if (data && size)
-    {
-      m_iRawFrameSize = size;
-      if (m_iAudio2Discard)
-        m_iAudio2Discard--;
-      else
-      {
-        int added = si->m_stream2->AddData(&data, 0, size, 0);
-        if (added != size)
-        {
-          CLog::Log(LOGERROR, "PAPlayer::QueueData 2nd - unknown error");
-          return false;
-        }
-      }
-      si->m_framesSent2 += si->m_audioFormat2.m_streamInfo.GetDuration() / 1000 * si->m_audioFormat2.m_streamInfo.m_sampleRate;
-    }
-  }
-
-  return true;
+  // with both outputs enabled the tracks are mixed once and fanned out
+  if (m_bAudio2)
+    return m_mixer.MakeStream(format, options);
+  return CAEFactory::MakeStream(format, options);
 }
 
-inline void PAPlayer::SyncStreams2()
+void PAPlayer::FreeStream(IAEStream *stream)
 {
-  if(!m_bAudio2)
-    return;
-
-  if(CAEFactory::IsDumb() || CAEFactory::IsDumb(true))
-    return;
-
-  if(!m_currentStream || !m_currentStream->m_stream || !m_currentStream->m_stream2)
-    return;
-
-  if(m_currentStream->m_usedecoder2)
-    return;
-
-  if(m_playbackSpeed != 1)
-    return;
-
-  int iTimeSynced = (int)((double)clock()/CLOCKS_PER_SEC*1000);
-  if(iTimeSynced - m_iTimeSynced < 50)
-    return;
-  m_iTimeSynced = iTimeSynced;
-
-  double time1 = ((double)m_currentStream->m_framesSent / (double)m_currentStream->m_audioFormat.m_sampleRate);
-  double time2 = ((double)m_currentStream->m_framesSent2 / (double)m_currentStream->m_audioFormat2.m_sampleRate);
-  time1 -= m_currentStream->m_stream->GetDelay();
-  time2 -= m_currentStream->m_stream2->GetDelay();
-  double timediff = time2 - time1;
-
-  m_iAudio2Discard = 0;
-  if (timediff > 0.05)
-  {
-    if (m_currentStream->m_audioFormat2.m_dataFormat != AE_FMT_RAW)
-    {
-      unsigned int padsize = (unsigned int)(timediff * (double)m_currentStream->m_audioFormat2.m_sampleRate) * m_currentStream->m_bytesPerFrame2;
-      if(padsize > m_currentStream->m_stream2->GetSpace())
-        padsize = (m_currentStream->m_stream2->GetSpace() / m_currentStream->m_bytesPerFrame2) * m_currentStream->m_bytesPerFrame2;
-      if(padsize)
-      {
-        uint8_t* padbuf = (uint8_t*)malloc(padsize);
-        if(padbuf)
-        {
-          memset(padbuf, 0, padsize);
-          m_currentStream->m_stream2->AddData(&padbuf, 0, padsize/m_currentStream->m_bytesPerFrame2, 0);
-          free(padbuf);
-        }
-      }
-    }
-    else
-    {
-      unsigned int padfrms = (unsigned int)(timediff * 1000.0 / m_currentStream->m_audioFormat2.m_streamInfo.GetDuration());
-      if(padfrms > m_currentStream->m_stream2->GetSpace())
-        padfrms = m_currentStream->m_stream2->GetSpace();
-	  unsigned int padsize = padfrms * m_iRawFrameSize;
-      if(padsize)
-      {
-        uint8_t* padbuf = (uint8_t*)malloc(padsize);
-        if(padbuf)
-        {
-          memset(padbuf, 0, padsize);
-          m_currentStream->m_stream2->AddData(&padbuf, 0, padsize, 0);
-          free(padbuf);
-        }
-      }
-    }
-  }
-  else if(timediff < -0.05)
-  {
-    if (m_currentStream->m_audioFormat2.m_dataFormat != AE_FMT_RAW)
-    {
-      unsigned int discardsize = (unsigned int)(-timediff * (double)m_currentStream->m_audioFormat2.m_sampleRate) * m_currentStream->m_bytesPerFrame2;
-      m_iAudio2Discard = discardsize / m_currentStream->m_bytesPerSample2;
-    }
-    else
-    {
-      m_iAudio2Discard = (unsigned int)(-timediff * 1000.0 / m_currentStream->m_audioFormat2.m_streamInfo.GetDuration());
-    }
-  }
+  if (m_bAudio2)
+    m_mixer.FreeStream(stream);
+  else
+    CAEFactory::FreeStream(stream);
 }
 
 void PAPlayer::OnExit()
@@ -1482,7 +1136,6 @@ void PAPlayer::SeekTime(int64_t iTime /*=0*/)
     SetSpeed(1);
 
   m_currentStream->m_seekFrame = (int)((float)m_currentStream->m_audioFormat.m_sampleRate * ((float)iTime + (float)m_currentStream->m_startOffset) / 1000.0f);
-  m_currentStream->m_seekFrame2 = (int)((float)m_currentStream->m_audioFormat2.m_sampleRate * ((float)iTime + (float)m_currentStream->m_startOffset) / 1000.0f);
   m_callback.OnPlayBackSeek((int)iTime, seekOffset);
 }
 
@@ -27,6 +27,7 @@
 #include "cores/IPlayer.h"
 #include "threads/Thread.h"
 #include "AudioDecoder.h"
+#include "PAMixer.h"
 #include "threads/CriticalSection.h"
 #include "utils/Job.h"
 
@@ -105,16 +106,10 @@ private:
     AEAudioFormat m_audioFormat;
     unsigned int m_bytesPerSample;       /* number of bytes per audio sample */
     unsigned int m_bytesPerFrame;        /* number of bytes per audio frame */
-    bool          m_usedecoder2;
-    CAudioDecoder m_decoder2;            /* the stream decoder */
-    AEAudioFormat m_audioFormat2;
-    unsigned int  m_bytesPerSample2;     /* number of bytes per audio sample */
-    unsigned int  m_bytesPerFrame2;      /* number of bytes per audio frame */
 
     bool m_started;                      /* if playback of this stream has been started */
     bool m_finishing;                    /* if this stream is finishing */
     int m_framesSent;                    /* number of frames sent to the stream */
-    int m_framesSent2;                   /* number of frames sent to the stream */
     int m_prepareNextAtFrame;            /* when to prepare the next stream */
     bool m_prepareTriggered;             /* if the next stream has been prepared */
     int m_playNextAtFrame;               /* when to start playing the next stream */
@@ -122,10 +117,8 @@ private:
     bool m_fadeOutTriggered;             /* if the stream has been told to fade out */
     int m_seekNextAtFrame;               /* the FF/RR sample to seek at */
     int m_seekFrame;                     /* the exact position to seek too, -1 for none */
-    int m_seekFrame2;                    /* the exact position to seek too, -1 for none */
 
     IAEStream* m_stream;                 /* the playback stream */
-    IAEStream* m_stream2;                /* the playback stream */
     float m_volume;                      /* the initial volume level to set the stream to on creation */
 
     bool m_isSlaved;                     /* true if the stream has been slaved to another */
@@ -155,10 +148,8 @@ private:
   bool                m_continueStream;
   int64_t             m_newForcedPlayerTime;
   int64_t             m_newForcedTotalTime;
-  bool                m_bAudio2;
-  int                 m_iTimeSynced;
-  unsigned int        m_iAudio2Discard;
-  unsigned int        m_iRawFrameSize;
+  bool                m_bAudio2;             /* tracks are mixed by m_mixer for both outputs */
+  CPAMixer            m_mixer;
   std::unique_ptr<CProcessInfo> m_processInfo;
 
   bool QueueNextFileEx(const CFileItem &file, bool fadeIn = true, bool job = false);
@@ -169,8 +160,8 @@ private:
   bool PrepareStream(StreamInfo *si);
   bool ProcessStream(StreamInfo *si, double &freeBufferTime);
   bool QueueData(StreamInfo *si);
-  bool QueueData2(StreamInfo *si);
-  void SyncStreams2();
+  IAEStream *MakeStream(AEAudioFormat &format, unsigned int options);
+  void FreeStream(IAEStream *stream);
   int64_t GetTotalTime64();
   void UpdateCrossfadeTime(const CFileItem& file);
   void UpdateStreamInfoPlayNextAtFrame(StreamInfo *si, unsigned int crossFadingTime);
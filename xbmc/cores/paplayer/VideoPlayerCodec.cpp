@@ -167,19 +167,8 @@ bool VideoPlayerCodec::Init(const CFileItem &file, unsigned int filecache)
 
   CDVDStreamInfo hint(*pStream, true);
 
-  m_pAudioCodec = CDVDFactoryCodec::CreateAudioCodec(hint, *m_processInfo.get(), true, true, m_bAudio2);
-  if (m_bCheckAudio2)
-  {
-    CDVDAudioCodec* pAudioCodec2 = CDVDFactoryCodec::CreateAudioCodec(hint, *m_processInfo.get(), true, true, true);
-    if (!m_pAudioCodec)
-      m_pAudioCodec = pAudioCodec2;
-    else if (pAudioCodec2)
-    {
-      if (pAudioCodec2->NeedPassthrough() != m_pAudioCodec->NeedPassthrough())
-        m_bReusableForAudio2 = false;
-      delete pAudioCodec2;
-    }
-  }
+  // a bitstream can't be mixed for both outputs
+  m_pAudioCodec = CDVDFactoryCodec::CreateAudioCodec(hint, *m_processInfo.get(), !m_bDualOutput, true);
   if (!m_pAudioCodec)
   {
     CLog::Log(LOGERROR, "%s: Could not create audio codec", __FUNCTION__);
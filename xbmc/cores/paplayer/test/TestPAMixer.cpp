@@ -0,0 +1,289 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/paplayer/PAMixer.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#define RATE     48000
+#define CHANNELS 2
+
+/* engine stream that keeps what it gets */
+class CFakeOutput : public IAEStream
+{
+public:
+  CFakeOutput(const AEAudioFormat &format, bool secondary) :
+    m_format(format), m_secondary(secondary), m_paused(false), m_drained(false), m_freed(false) {}
+
+  std::vector<float> GetData()
+  {
+    CSingleLock lock(m_section);
+    return m_data;
+  }
+
+  virtual unsigned int GetSpace() override { return RATE * GetFrameSize(); }
+  virtual unsigned int AddData(const uint8_t* const *data, unsigned int offset, unsigned int frames, double pts = 0.0) override
+  {
+    CSingleLock lock(m_section);
+    const float *src = (const float*)data[0] + offset * CHANNELS;
+    m_data.insert(m_data.end(), src, src + frames * CHANNELS);
+    return frames;
+  }
+  virtual double GetDelay() override { return 0.0; }
+  virtual CAESyncInfo GetSyncInfo() override { return CAESyncInfo(); }
+  virtual bool IsBuffering() override { return false; }
+  virtual double GetCacheTime() override { return 0.0; }
+  virtual double GetCacheTotal() override { return 1.0; }
+
+  virtual void Pause() override { m_paused = true; }
+  virtual void Resume() override { m_paused = false; }
+  virtual void Drain(bool wait) override { m_drained = true; }
+  virtual bool IsDraining() override { return false; }
+  virtual bool IsDrained() override { return m_drained; }
+  virtual void Flush() override {}
+
+  virtual float GetVolume() override { return 1.0f; }
+  virtual void SetVolume(float volume) override {}
+  virtual float GetReplayGain() override { return 1.0f; }
+  virtual void SetReplayGain(float factor) override {}
+  virtual float GetAmplification() override { return 1.0f; }
+  virtual void SetAmplification(float amplify) override {}
+  virtual void SetFFmpegInfo(int profile, enum AVMatrixEncoding matrix_encoding, enum AVAudioServiceType audio_service_type) override {}
+
+  virtual const unsigned int GetFrameSize() const override { return CHANNELS * sizeof(float); }
+  virtual const unsigned int GetChannelCount() const override { return CHANNELS; }
+  virtual const unsigned int GetSampleRate() const override { return m_format.m_sampleRate; }
+  virtual const enum AEDataFormat GetDataFormat() const override { return m_format.m_dataFormat; }
+
+  virtual double GetResampleRatio() override { return 1.0; }
+  virtual void SetResampleRatio(double ratio) override {}
+  virtual void SetResampleMode(int mode) override {}
+
+  virtual void RegisterAudioCallback(IAudioCallback* pCallback) override {}
+  virtual void UnRegisterAudioCallback() override {}
+  virtual void RegisterSlave(IAEStream *stream) override {}
+  virtual bool HasDSP() override { return false; }
+
+  AEAudioFormat m_format;
+  bool m_secondary;
+  bool m_paused;
+  bool m_drained;
+  bool m_freed;
+
+private:
+  CCriticalSection m_section;
+  std::vector<float> m_data;
+};
+
+class CTestMixer : public CPAMixer
+{
+public:
+  ~CTestMixer()
+  {
+    // the destructor of CPAMixer would free the outputs through its own FreeOutput
+    Close();
+    for (std::vector<CFakeOutput*>::iterator it = m_made.begin(); it != m_made.end(); ++it)
+      delete *it;
+  }
+
+  std::vector<CFakeOutput*> GetOutputs()
+  {
+    CSingleLock lock(m_section);
+    return m_made;
+  }
+
+  /* keeps the mixer from picking up changes made while it is held */
+  CCriticalSection &GetLock() { return m_lock; }
+
+protected:
+  virtual IAEStream *MakeOutput(AEAudioFormat &format, unsigned int options, bool secondary) override
+  {
+    CSingleLock lock(m_section);
+    m_made.push_back(new CFakeOutput(format, secondary));
+    return m_made.back();
+  }
+
+  virtual void FreeOutput(IAEStream *stream) override
+  {
+    static_cast<CFakeOutput*>(stream)->m_freed = true;
+  }
+
+  CCriticalSection m_section;
+  std::vector<CFakeOutput*> m_made;
+};
+
+class TestPAMixer : public testing::Test
+{
+protected:
+  IAEStream *MakeTrack(bool paused, AEDataFormat dataFormat = AE_FMT_FLOAT)
+  {
+    AEAudioFormat format;
+    format.m_dataFormat = dataFormat;
+    format.m_sampleRate = RATE;
+    format.m_channelLayout = AE_CH_LAYOUT_2_0;
+    return m_mixer.MakeStream(format, paused ? AESTREAM_PAUSED : 0);
+  }
+
+  static void AddConstant(IAEStream *stream, float value, unsigned int frames)
+  {
+    std::vector<float> data(frames * CHANNELS, value);
+    const uint8_t *buf = (const uint8_t*)data.data();
+    ASSERT_EQ(frames, stream->AddData(&buf, 0, frames));
+  }
+
+  /* waits until both outputs got frames, returns what output 1 got */
+  std::vector<float> WaitForFrames(unsigned int frames)
+  {
+    unsigned int timeout = XbmcThreads::SystemClockMillis() + 5000;
+    while (XbmcThreads::SystemClockMillis() < timeout)
+    {
+      std::vector<CFakeOutput*> outputs = m_mixer.GetOutputs();
+      if (outputs.size() >= 2 &&
+          outputs[0]->GetData().size() >= frames * CHANNELS &&
+          outputs[1]->GetData().size() >= frames * CHANNELS)
+        break;
+      XbmcThreads::ThreadSleep(5);
+    }
+    std::vector<CFakeOutput*> outputs = m_mixer.GetOutputs();
+    return outputs.empty() ? std::vector<float>() : outputs[0]->GetData();
+  }
+
+  CTestMixer m_mixer;
+};
+
+TEST_F(TestPAMixer, Crossfade)
+{
+  const unsigned int frames = RATE / 10;
+  IAEStream *outgoing = MakeTrack(true);
+  IAEStream *incoming = MakeTrack(true);
+  ASSERT_TRUE(outgoing && incoming);
+  AddConstant(outgoing, 1.0f, frames);
+  AddConstant(incoming, 1.0f, frames);
+
+  {
+    CSingleLock lock(m_mixer.GetLock());
+    outgoing->FadeVolume(1.0f, 0.0f, 100);
+    incoming->FadeVolume(0.0f, 1.0f, 100);
+    outgoing->Resume();
+    incoming->Resume();
+  }
+  // the outgoing track can't finish while the incoming one has no data
+  outgoing->Drain(false);
+  incoming->Drain(true);
+  EXPECT_TRUE(outgoing->IsDrained());
+
+  // both tracks are mixed into a single pair of engine streams
+  std::vector<float> data = WaitForFrames(frames);
+  ASSERT_EQ(frames * CHANNELS, data.size());
+  ASSERT_EQ(2u, m_mixer.GetOutputs().size());
+  EXPECT_TRUE(m_mixer.GetOutputs()[1]->m_secondary);
+  EXPECT_EQ(data, m_mixer.GetOutputs()[1]->GetData());
+
+  // the ramps add up to full scale all the way through
+  for (size_t i = 0; i < data.size(); i++)
+    ASSERT_NEAR(1.0f, data[i], 1e-3f) << "sample " << i;
+
+  m_mixer.FreeStream(outgoing);
+  m_mixer.FreeStream(incoming);
+}
+
+TEST_F(TestPAMixer, GaplessHandover)
+{
+  const unsigned int frames = RATE / 10;
+  IAEStream *first = MakeTrack(false);
+  IAEStream *second = MakeTrack(true);
+  ASSERT_TRUE(first && second);
+  first->RegisterSlave(second);
+  AddConstant(second, 0.5f, frames);
+  AddConstant(first, 0.25f, frames);
+
+  first->Drain(true);
+  EXPECT_TRUE(first->IsDrained());
+  second->Drain(true);
+
+  // the 2nd track starts right after the last frame of the 1st one
+  std::vector<float> data = WaitForFrames(2 * frames);
+  ASSERT_EQ(2 * frames * CHANNELS, data.size());
+  for (size_t i = 0; i < data.size(); i++)
+    ASSERT_FLOAT_EQ(i < frames * CHANNELS ? 0.25f : 0.5f, data[i]) << "sample " << i;
+
+  // no reopen of the engine streams in between
+  EXPECT_EQ(2u, m_mixer.GetOutputs().size());
+
+  m_mixer.FreeStream(first);
+  m_mixer.FreeStream(second);
+}
+
+TEST_F(TestPAMixer, Drain)
+{
+  const unsigned int frames = RATE / 20;
+  IAEStream *track = MakeTrack(false);
+  ASSERT_TRUE(track != NULL);
+  AddConstant(track, 0.5f, frames);
+
+  EXPECT_FALSE(track->IsDrained());
+  track->Drain(true);
+  EXPECT_TRUE(track->IsDrained());
+  EXPECT_EQ(0u, track->GetSpace());
+  EXPECT_EQ(frames * CHANNELS, WaitForFrames(frames).size());
+  m_mixer.FreeStream(track);
+
+  // the engines play out what they got before their streams are freed
+  m_mixer.Drain();
+  std::vector<CFakeOutput*> outputs = m_mixer.GetOutputs();
+  ASSERT_EQ(2u, outputs.size());
+  for (size_t i = 0; i < outputs.size(); i++)
+  {
+    EXPECT_TRUE(outputs[i]->m_drained);
+    EXPECT_TRUE(outputs[i]->m_freed);
+  }
+}
+
+TEST_F(TestPAMixer, PlanarInput)
+{
+  const unsigned int frames = RATE / 20;
+  IAEStream *track = MakeTrack(false, AE_FMT_S16NEP);
+  ASSERT_TRUE(track != NULL);
+  EXPECT_EQ(CHANNELS * sizeof(int16_t), track->GetFrameSize());
+
+  // one plane per channel, added in two parts to cover the offset
+  std::vector<int16_t> left(frames, 16384);
+  std::vector<int16_t> right(frames, -8192);
+  const uint8_t *planes[CHANNELS] = { (const uint8_t*)left.data(), (const uint8_t*)right.data() };
+  ASSERT_EQ(frames / 2, track->AddData(planes, 0, frames / 2));
+  ASSERT_EQ(frames - frames / 2, track->AddData(planes, frames / 2, frames - frames / 2));
+  track->Drain(true);
+
+  // the engine streams get interleaved float
+  std::vector<float> data = WaitForFrames(frames);
+  ASSERT_EQ(frames * CHANNELS, data.size());
+  for (size_t i = 0; i < data.size(); i += CHANNELS)
+  {
+    ASSERT_FLOAT_EQ(0.5f, data[i]) << "frame " << i / CHANNELS;
+    ASSERT_FLOAT_EQ(-0.25f, data[i + 1]) << "frame " << i / CHANNELS;
+  }
+
+  m_mixer.FreeStream(track);
+}
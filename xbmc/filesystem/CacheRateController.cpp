@@ -0,0 +1,199 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CacheRateController.h"
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+
+using namespace XFILE;
+
+const unsigned int CCacheRateController::READ_TIME;
+const unsigned int CCacheRateController::REFILL_TIME;
+const unsigned int CCacheRateController::MAX_WAIT;
+const unsigned int CCacheRateController::BANDWIDTH_SAMPLES;
+
+CCacheRateController::CCacheRateController()
+{
+  Reset(1, 1, 0, 0, 1.0f);
+}
+
+void CCacheRateController::Reset(unsigned int minReadSize, unsigned int maxReadSize, int64_t maxForward,
+                                 unsigned int targetTime, float maxFactor)
+{
+  CSingleLock lock(m_section);
+  m_minReadSize = std::max(minReadSize, 1u);
+  m_maxReadSize = std::max(maxReadSize, m_minReadSize);
+  m_maxForward = maxForward;
+  m_targetTime = targetTime;
+  m_maxFactor = maxFactor;
+
+  m_mediaRate = 0;
+  m_target = 0;
+  m_paced = false;
+  m_pacingRate = 0;
+  m_readSize = m_minReadSize;
+  m_tokens = 0;
+  m_stamp = 0;
+
+  memset(m_samples, 0, sizeof(m_samples));
+  m_sampleIndex = 0;
+  m_sampleBytes = 0;
+  m_sampleTime = 0;
+  m_bandwidth = 0;
+}
+
+void CCacheRateController::Restart(unsigned int now)
+{
+  CSingleLock lock(m_section);
+  m_paced = false;
+  m_pacingRate = 0;
+  m_tokens = 0;
+  m_stamp = now;
+  m_sampleBytes = 0;
+  m_sampleTime = 0;
+}
+
+void CCacheRateController::SetMediaRate(unsigned int rate)
+{
+  CSingleLock lock(m_section);
+  m_mediaRate = rate;
+}
+
+unsigned int CCacheRateController::GetWaitTime(int64_t forward, unsigned int now)
+{
+  CSingleLock lock(m_section);
+  Update(forward);
+
+  unsigned int elapsed = now - m_stamp;
+  m_stamp = now;
+
+  if (!m_paced)
+  {
+    m_tokens = m_readSize;
+    return 0;
+  }
+
+  // token bucket, at most two reads in a burst
+  m_tokens = std::min(m_tokens + (int64_t)m_pacingRate * elapsed / 1000, (int64_t)(2 * m_readSize));
+  if (m_tokens >= (int64_t)m_readSize)
+    return 0;
+  if (m_pacingRate == 0)
+    return MAX_WAIT;
+
+  int64_t wait = ((int64_t)m_readSize - m_tokens) * 1000 / m_pacingRate + 1;
+  return (unsigned int)std::min(wait, (int64_t)MAX_WAIT);
+}
+
+void CCacheRateController::OnRead(size_t bytes, unsigned int duration)
+{
+  CSingleLock lock(m_section);
+  m_tokens = std::max(m_tokens - (int64_t)bytes, -(int64_t)(2 * m_maxReadSize));
+
+  // paced reads show the pacing rate, not what the source can deliver
+  if (m_paced)
+  {
+    m_sampleBytes = 0;
+    m_sampleTime = 0;
+    return;
+  }
+
+  m_sampleBytes += bytes;
+  m_sampleTime += duration;
+  if (m_sampleTime < READ_TIME)
+    return;
+
+  int64_t rate = m_sampleBytes * 1000 / m_sampleTime;
+  m_samples[m_sampleIndex] = (unsigned int)std::min(rate, (int64_t)std::numeric_limits<unsigned int>::max());
+  m_sampleIndex = (m_sampleIndex + 1) % BANDWIDTH_SAMPLES;
+  m_bandwidth = *std::max_element(m_samples, m_samples + BANDWIDTH_SAMPLES);
+  m_sampleBytes = 0;
+  m_sampleTime = 0;
+}
+
+size_t CCacheRateController::GetReadSize()
+{
+  CSingleLock lock(m_section);
+  return m_readSize;
+}
+
+unsigned int CCacheRateController::GetBandwidth()
+{
+  CSingleLock lock(m_section);
+  return m_bandwidth;
+}
+
+unsigned int CCacheRateController::GetPacingRate()
+{
+  CSingleLock lock(m_section);
+  return m_paced ? m_pacingRate : 0;
+}
+
+int64_t CCacheRateController::GetTarget()
+{
+  CSingleLock lock(m_section);
+  return m_target;
+}
+
+int64_t CCacheRateController::GetPrefetchLevel()
+{
+  CSingleLock lock(m_section);
+  int64_t level = m_maxForward / 2;
+
+  // pacing holds the cache near the target, with a target below half of
+  // the cache that level is never reached, start where pacing starts
+  int64_t target = CalcTarget();
+  if (m_mediaRate > 0 && target > 0)
+    level = std::min(level, target / 2);
+  return level;
+}
+
+int64_t CCacheRateController::CalcTarget() const
+{
+  int64_t target = (int64_t)m_mediaRate * m_targetTime;
+  if (m_maxForward > 0)
+    target = std::min(target, m_maxForward * 3 / 4);
+  return target;
+}
+
+void CCacheRateController::Update(int64_t forward)
+{
+  m_target = CalcTarget();
+
+  // refill at full speed, then close the gap to the target within REFILL_TIME
+  int64_t missing = m_target - forward;
+  m_paced = m_mediaRate > 0 && missing <= m_target / 2;
+  if (m_paced)
+  {
+    int64_t rate = (int64_t)m_mediaRate + missing / REFILL_TIME;
+    rate = std::min(rate, (int64_t)(m_mediaRate * m_maxFactor));
+    m_pacingRate = (unsigned int)std::max(rate, (int64_t)0);
+  }
+  else
+    m_pacingRate = 0;
+
+  int64_t size = m_bandwidth > 0 ? (int64_t)m_bandwidth * READ_TIME / 1000 : m_minReadSize;
+  if (m_paced)
+    size = std::min(size, (int64_t)m_pacingRate * READ_TIME / 1000);
+  size = size / m_minReadSize * m_minReadSize;
+  m_readSize = (size_t)std::max(std::min(size, (int64_t)m_maxReadSize), (int64_t)m_minReadSize);
+}
@@ -0,0 +1,118 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace XFILE
+{
+
+/**
+ * Paces the reads of the cache thread to keep a number of seconds of media
+ * cached. With less than half of that cached the source is read as fast as
+ * it delivers, above that the rate follows the media rate plus a share of
+ * what is missing. Like BBR the bandwidth of the source is the max of the
+ * recent delivery rates, sampled only while reads are not paced, and reads
+ * are sized to take about READ_TIME.
+ */
+class CCacheRateController
+{
+public:
+  static const unsigned int READ_TIME = 100;      // ms a read should take
+  static const unsigned int REFILL_TIME = 4;      // s to make up for what is missing
+  static const unsigned int MAX_WAIT = 100;       // ms, waits are checked again after this
+  static const unsigned int BANDWIDTH_SAMPLES = 10;
+
+  CCacheRateController();
+
+  /*!
+   \param minReadSize chunk size of the source, reads are a multiple of it
+   \param maxReadSize largest read
+   \param maxForward bytes the cache holds ahead of the reader, 0 if unlimited
+   \param targetTime seconds of media to keep cached
+   \param maxFactor limit of the paced rate as a multiple of the media rate
+   */
+  void Reset(unsigned int minReadSize, unsigned int maxReadSize, int64_t maxForward,
+             unsigned int targetTime, float maxFactor);
+
+  /*!
+   \brief Start over after a seek, the bandwidth estimate is kept
+   */
+  void Restart(unsigned int now);
+
+  /*!
+   \param rate bytes per second the player consumes
+   */
+  void SetMediaRate(unsigned int rate);
+
+  /*!
+   \param forward bytes cached ahead of the reader
+   \param now current time in ms
+   \return ms to wait before the next read, 0 to read now
+   */
+  unsigned int GetWaitTime(int64_t forward, unsigned int now);
+
+  /*!
+   \param duration ms the read took
+   */
+  void OnRead(size_t bytes, unsigned int duration);
+
+  size_t GetReadSize();
+  unsigned int GetBandwidth();
+  unsigned int GetPacingRate(); // 0 while not paced
+  int64_t GetTarget();
+
+  /*!
+   \brief Bytes cached ahead of the reader from which the cache thread can
+          spend time on reads elsewhere, like the index at the end of a file
+   */
+  int64_t GetPrefetchLevel();
+
+protected:
+  void Update(int64_t forward);
+  int64_t CalcTarget() const;
+
+  unsigned int m_minReadSize;
+  unsigned int m_maxReadSize;
+  int64_t m_maxForward;
+  unsigned int m_targetTime;
+  float m_maxFactor;
+
+  unsigned int m_mediaRate;
+  int64_t m_target;
+  bool m_paced;
+  unsigned int m_pacingRate;
+  size_t m_readSize;
+  int64_t m_tokens;
+  unsigned int m_stamp;
+
+  unsigned int m_samples[BANDWIDTH_SAMPLES];
+  unsigned int m_sampleIndex;
+  int64_t m_sampleBytes;
+  unsigned int m_sampleTime;
+  unsigned int m_bandwidth;
+
+  CCriticalSection m_section;
+};
+
+}
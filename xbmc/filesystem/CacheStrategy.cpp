@@ -52,6 +52,36 @@ CCacheStrategy::~CCacheStrategy()
 {
 }
 
+int CCacheStrategy::WriteToCacheAt(int64_t iFilePosition, const char *pBuffer, size_t iSize)
+{
+  return CACHE_RC_ERROR;
+}
+
+size_t CCacheStrategy::GetWriteBufferSize(size_t iSize) const
+{
+  return 0;
+}
+
+char *CCacheStrategy::GetWriteBuffer(size_t &iSize)
+{
+  iSize = 0;
+  return NULL;
+}
+
+int CCacheStrategy::CommitWriteBuffer(size_t iSize)
+{
+  return CACHE_RC_ERROR;
+}
+
+int64_t CCacheStrategy::CachedRangeEndPos()
+{
+  return CachedDataEndPos();
+}
+
+void CCacheStrategy::SkipCachedRange()
+{
+}
+
 void CCacheStrategy::EndOfInput() {
   m_bEndOfInput = true;
 }
@@ -321,6 +351,21 @@ int CDoubleCache::WriteToCache(const char *pBuffer, size_t iSize)
   return m_pCache->WriteToCache(pBuffer, iSize);
 }
 
+size_t CDoubleCache::GetWriteBufferSize(size_t iSize) const
+{
+  return m_pCache->GetWriteBufferSize(iSize);
+}
+
+char *CDoubleCache::GetWriteBuffer(size_t &iSize)
+{
+  return m_pCache->GetWriteBuffer(iSize);
+}
+
+int CDoubleCache::CommitWriteBuffer(size_t iSize)
+{
+  return m_pCache->CommitWriteBuffer(iSize);
+}
+
 int CDoubleCache::ReadFromCache(char *pBuffer, size_t iMaxSize)
 {
   return m_pCache->ReadFromCache(pBuffer, iMaxSize);
@@ -407,6 +452,16 @@ bool CDoubleCache::IsCachedPosition(int64_t iFilePosition)
   return m_pCache->IsCachedPosition(iFilePosition) || (m_pCacheOld && m_pCacheOld->IsCachedPosition(iFilePosition));
 }
 
+int64_t CDoubleCache::CachedRangeEndPos()
+{
+  return m_pCache->CachedRangeEndPos();
+}
+
+void CDoubleCache::SkipCachedRange()
+{
+  m_pCache->SkipCachedRange();
+}
+
 CCacheStrategy *CDoubleCache::CreateNew()
 {
   return new CDoubleCache(m_pCache->CreateNew());
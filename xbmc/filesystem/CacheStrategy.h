@@ -45,6 +45,28 @@ public:
 
   virtual size_t GetMaxWriteSize(const size_t& iRequestSize) = 0;
   virtual int WriteToCache(const char *pBuffer, size_t iSize) = 0;
+  /*!
+   \brief Store data away from the write position, e.g. prefetched ahead of a seek
+   \return bytes stored, CACHE_RC_ERROR if the strategy keeps a single range only
+   */
+  virtual int WriteToCacheAt(int64_t iFilePosition, const char *pBuffer, size_t iSize);
+  /*!
+   \brief Contiguous space GetWriteBuffer would hand out, the cache is left as it is
+   \return 0 if the strategy only copies in WriteToCache
+   */
+  virtual size_t GetWriteBufferSize(size_t iSize) const;
+  /*!
+   \brief Space the next write goes to, so the source can be read into the cache in place
+   \param iSize space wanted, set to the contiguous space available
+   \return NULL if the strategy only copies in WriteToCache
+   \sa CommitWriteBuffer
+   */
+  virtual char *GetWriteBuffer(size_t &iSize);
+  /*!
+   \brief Hand iSize bytes written to the space of GetWriteBuffer to the reader,
+          0 gives the space back untouched
+   */
+  virtual int CommitWriteBuffer(size_t iSize);
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) = 0;
   virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis) = 0;
 
@@ -66,6 +88,17 @@ public:
   virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition) = 0;
   virtual int64_t CachedDataEndPos() = 0;
   virtual bool IsCachedPosition(int64_t iFilePosition) = 0;
+  /*!
+   \brief End of the data cached from the write position on without a gap,
+          i.e. a range kept from before a seek the writer has run into
+   \return CachedDataEndPos() if the strategy keeps a single range only
+   \sa SkipCachedRange
+   */
+  virtual int64_t CachedRangeEndPos();
+  /*!
+   \brief Continue writing at CachedRangeEndPos(), the source is expected to follow
+   */
+  virtual void SkipCachedRange();
 
   virtual CCacheStrategy *CreateNew() = 0;
 
@@ -121,6 +154,9 @@ public:
 
   virtual size_t GetMaxWriteSize(const size_t& iRequestSize) ;
   virtual int WriteToCache(const char *pBuffer, size_t iSize) ;
+  virtual size_t GetWriteBufferSize(size_t iSize) const;
+  virtual char *GetWriteBuffer(size_t &iSize);
+  virtual int CommitWriteBuffer(size_t iSize);
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) ;
   virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis) ;
 
@@ -133,6 +169,8 @@ public:
   virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
   virtual int64_t CachedDataEndPos();
   virtual bool IsCachedPosition(int64_t iFilePosition);
+  virtual int64_t CachedRangeEndPos();
+  virtual void SkipCachedRange();
 
   virtual CCacheStrategy *CreateNew();
 
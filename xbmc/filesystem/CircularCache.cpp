@@ -34,6 +34,7 @@ CCircularCache::CCircularCache(size_t front, size_t back)
  , m_buf(NULL)
  , m_size(front + back)
  , m_size_back(back)
+ , m_reserved(0)
 #ifdef TARGET_WINDOWS
  , m_handle(INVALID_HANDLE_VALUE)
 #endif
@@ -60,6 +61,7 @@ int CCircularCache::Open()
   m_beg = 0;
   m_end = 0;
   m_cur = 0;
+  m_reserved = 0;
   return CACHE_RC_OK;
 }
 
@@ -142,6 +144,69 @@ int CCircularCache::WriteToCache(const char *buf, size_t len)
   return len;
 }
 
+/**
+ * Space WriteToCache would write to, up to the buffer
+ * wrap point.
+ */
+size_t CCircularCache::GetWriteBufferSize(size_t len) const
+{
+  CSingleLock lock(m_sync);
+
+  size_t pos   = m_end % m_size;
+  size_t back  = (size_t)(m_cur - m_beg);
+  size_t front = (size_t)(m_end - m_cur);
+
+  size_t limit = m_size - std::min(back, m_size_back) - front;
+  size_t wrap  = m_size - pos;
+
+  return std::min(len, std::min(limit, wrap));
+}
+
+/**
+ * Returns m_buf at m_end % m_size. The history that space
+ * overwrites stays in m_beg until the write is committed,
+ * but a reader can't seek back into it meanwhile.
+ */
+char *CCircularCache::GetWriteBuffer(size_t &len)
+{
+  CSingleLock lock(m_sync);
+
+  len = GetWriteBufferSize(len);
+  if(len == 0)
+    return NULL;
+
+  m_reserved = len;
+  return (char*)m_buf + m_end % m_size;
+}
+
+int CCircularCache::CommitWriteBuffer(size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  m_reserved = 0;
+  if(len == 0)
+    return 0;
+
+  m_end += len;
+
+  // drop history that was overwritten
+  if(m_end - m_beg > (int64_t)m_size)
+    m_beg = m_end - m_size;
+
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Start of the data a reader can seek to, history that is
+ * being overwritten in place is excluded.
+ */
+int64_t CCircularCache::GetValidBegin() const
+{
+  return std::max(m_beg, m_end + (int64_t)m_reserved - (int64_t)m_size);
+}
+
 /**
  * Reads data from cache. Will only read up till
  * the buffer wrap point. So multiple calls
@@ -222,7 +287,7 @@ int64_t CCircularCache::Seek(int64_t pos)
     lock.Enter();
   }
 
-  if(pos >= m_beg && pos <= m_end)
+  if(pos >= GetValidBegin() && pos <= m_end)
   {
     m_cur = pos;
     return pos;
@@ -242,6 +307,7 @@ bool CCircularCache::Reset(int64_t pos, bool clearAnyway)
   m_end = pos;
   m_beg = pos;
   m_cur = pos;
+  m_reserved = 0;
 
   return true;
 }
@@ -260,7 +326,7 @@ int64_t CCircularCache::CachedDataEndPos()
 
 bool CCircularCache::IsCachedPosition(int64_t iFilePosition)
 {
-  return iFilePosition >= m_beg && iFilePosition <= m_end;
+  return iFilePosition >= GetValidBegin() && iFilePosition <= m_end;
 }
 
 CCacheStrategy *CCircularCache::CreateNew()
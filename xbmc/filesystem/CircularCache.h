@@ -38,6 +38,9 @@ public:
 
     virtual size_t GetMaxWriteSize(const size_t& iRequestSize) ;
     virtual int WriteToCache(const char *buf, size_t len) ;
+    virtual size_t GetWriteBufferSize(size_t len) const;
+    virtual char *GetWriteBuffer(size_t &len);
+    virtual int CommitWriteBuffer(size_t len);
     virtual int ReadFromCache(char *buf, size_t len) ;
     virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis) ;
 
@@ -50,13 +53,16 @@ public:
 
     virtual CCacheStrategy *CreateNew();
 protected:
+    int64_t GetValidBegin() const;
+
     int64_t           m_beg;       /**< index in file (not buffer) of beginning of valid data */
     int64_t           m_end;       /**< index in file (not buffer) of end of valid data */
     int64_t           m_cur;       /**< current reading index in file */
     uint8_t          *m_buf;       /**< buffer holding data */
     size_t            m_size;      /**< size of data buffer used (m_buf) */
     size_t            m_size_back; /**< guaranteed size of back buffer (actual size can be smaller, or larger if front buffer doesn't need it) */
-    CCriticalSection  m_sync;
+    size_t            m_reserved;  /**< space handed out by GetWriteBuffer, the history it overwrites can't be sought to */
+    mutable CCriticalSection m_sync;
     CEvent            m_written;
 #ifdef TARGET_WINDOWS
     HANDLE            m_handle;
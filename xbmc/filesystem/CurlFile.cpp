@@ -65,6 +65,8 @@ curl_proxytype proxyType2CUrlProxyType[] = {
 #define FILLBUFFER_NO_DATA    1
 #define FILLBUFFER_FAIL       2
 
+#define RANGE_SIZE            (2 * 1024 * 1024)
+
 // curl calls this routine to debug
 extern "C" int debug_callback(CURL_HANDLE *handle, curl_infotype info, char *output, size_t size, void *data)
 {
@@ -112,6 +114,18 @@ extern "C" size_t write_callback(char *buffer,
   return state->WriteCallback(buffer, size, nitems);
 }
 
+/* curl calls this routine with the data of a range request */
+extern "C" size_t range_write_callback(char *buffer,
+               size_t size,
+               size_t nitems,
+               void *userp)
+{
+  if(userp == NULL) return 0;
+
+  CCurlFile::CReadState::CRangeRequest *range = (CCurlFile::CReadState::CRangeRequest *)userp;
+  return range->WriteCallback(buffer, size, nitems);
+}
+
 extern "C" size_t read_callback(char *buffer,
                size_t size,
                size_t nitems,
@@ -248,6 +262,26 @@ size_t CCurlFile::CReadState::WriteCallback(char *buffer, size_t size, size_t ni
   return size * nitems;
 }
 
+size_t CCurlFile::CReadState::CRangeRequest::WriteCallback(char *buffer, size_t size, size_t nitems)
+{
+  size_t amount = size * nitems;
+
+  // a server that ignores the range sends the whole file, reassembly would be wrong
+  long response = 0;
+  if (CURLE_OK != g_curlInterface.easy_getinfo(m_handle, CURLINFO_RESPONSE_CODE, &response) || response != 206)
+    return 0;
+
+  if ((int64_t)amount > m_end - m_start + 1)
+  {
+    CLog::Log(LOGERROR, "CCurlFile::CRangeRequest::WriteCallback - Received more than requested for range ending at %" PRId64, m_end);
+    return 0;
+  }
+
+  m_data.insert(m_data.end(), buffer, buffer + amount);
+  m_start += amount;
+  return amount;
+}
+
 CCurlFile::CReadState::CReadState()
 {
   m_easyHandle = NULL;
@@ -267,6 +301,7 @@ CCurlFile::CReadState::CReadState()
   m_bRetry = true;
   m_curlHeaderList = NULL;
   m_curlAliasList = NULL;
+  m_rangeNext = 0;
 }
 
 CCurlFile::CReadState::~CReadState()
@@ -380,6 +415,8 @@ long CCurlFile::CReadState::Connect(unsigned int size)
 
 void CCurlFile::CReadState::Disconnect()
 {
+  StopRanges();
+
   if(m_multiHandle && m_easyHandle)
     g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
 
@@ -402,6 +439,95 @@ void CCurlFile::CReadState::Disconnect()
   m_curlAliasList = NULL;
 }
 
+/*
+ * Continues the transfer with a range request of RANGE_SIZE per connection.
+ * The connections share the multi handle, the data of a range is kept until
+ * all ranges before it are in the ring buffer. Once the first range is
+ * consumed its connection requests the next range not requested yet.
+ */
+bool CCurlFile::CReadState::StartRanges(const std::string &url, unsigned int connections)
+{
+  if (!m_ranges.empty() || m_fileSize <= 0)
+    return false;
+
+  // everything up to here is already in our buffers
+  int64_t start = m_filePos + m_buffer.getMaxReadSize() + m_overflowSize;
+  if (start >= m_fileSize)
+    return false;
+
+  m_rangeUrl = url;
+  m_rangeNext = start;
+  for (unsigned int i = 0; i < connections && m_rangeNext < m_fileSize; i++)
+  {
+    CRangeRequest *range = new CRangeRequest();
+    range->m_handle = NULL;
+    range->m_retries = 0;
+    g_curlInterface.easy_duplicate(m_easyHandle, NULL, &range->m_handle, NULL);
+    if (!range->m_handle)
+    {
+      delete range;
+      break;
+    }
+    m_ranges.push_back(range);
+    RequestRange(range);
+  }
+
+  if (m_ranges.empty())
+    return false;
+
+  // the single transfer is superseded by the ranges
+  g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
+  m_stillRunning = 1;
+
+  CLog::Log(LOGDEBUG, "CCurlFile::CReadState::StartRanges - Fetching from %" PRId64" on %u connections", start, (unsigned int)m_ranges.size());
+  return true;
+}
+
+void CCurlFile::CReadState::StopRanges()
+{
+  while (!m_ranges.empty())
+  {
+    CRangeRequest *range = m_ranges.front();
+    m_ranges.pop_front();
+    if (range->m_handle)
+    {
+      if (m_multiHandle)
+        g_curlInterface.multi_remove_handle(m_multiHandle, range->m_handle);
+      g_curlInterface.easy_release(&range->m_handle, NULL);
+    }
+    delete range;
+  }
+  m_rangeNext = 0;
+}
+
+/* request the next range not requested yet with the handle of range */
+bool CCurlFile::CReadState::RequestRange(CRangeRequest *range)
+{
+  if (m_rangeNext >= m_fileSize)
+    return false;
+
+  range->m_start = m_rangeNext;
+  range->m_end = XMIN(m_rangeNext + RANGE_SIZE, m_fileSize) - 1;
+  range->m_data.clear();
+  range->m_data.reserve((size_t)(range->m_end - range->m_start + 1));
+  range->m_read = 0;
+  range->m_done = false;
+  range->m_retries = 0;
+  m_rangeNext = range->m_end + 1;
+
+  std::string bytes = StringUtils::Format("%" PRId64"-%" PRId64, range->m_start, range->m_end);
+  CURL_HANDLE* h = range->m_handle;
+  g_curlInterface.easy_setopt(h, CURLOPT_URL, m_rangeUrl.c_str());
+  g_curlInterface.easy_setopt(h, CURLOPT_WRITEDATA, range);
+  g_curlInterface.easy_setopt(h, CURLOPT_WRITEFUNCTION, range_write_callback);
+  g_curlInterface.easy_setopt(h, CURLOPT_WRITEHEADER, NULL);
+  g_curlInterface.easy_setopt(h, CURLOPT_HEADERFUNCTION, NULL);
+  g_curlInterface.easy_setopt(h, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0);
+  g_curlInterface.easy_setopt(h, CURLOPT_RANGE, bytes.c_str());
+  g_curlInterface.multi_add_handle(m_multiHandle, h);
+  return true;
+}
+
 
 CCurlFile::~CCurlFile()
 {
@@ -443,6 +569,7 @@ CCurlFile::CCurlFile()
   m_httpresponse = -1;
   m_acceptCharset = "UTF-8,*;q=0.8"; /* prefer UTF-8 if available */
   m_allowRetry = true;
+  m_rangeConnections = g_advancedSettings.m_curlRangeConnections;
 }
 
 //Has to be called before Open()
@@ -698,6 +825,24 @@ void CCurlFile::SetCorrectHeaders(CReadState* state)
   }
 }
 
+/*
+ * A single connection is often limited by the server or by the latency of
+ * the route, so with <curlrangeconnections> above 1 the rest of the file is
+ * fetched as ranges on several connections. Only once the server answered
+ * with 206 it is known to honor ranges.
+ */
+void CCurlFile::StartRanges(long response)
+{
+  if (m_rangeConnections <= 1 || !m_seekable || response != 206 || !m_acceptencoding.empty())
+    return;
+
+  CURL url(m_url);
+  if (!url.IsProtocol("http") && !url.IsProtocol("https"))
+    return;
+
+  m_state->StartRanges(m_url, m_rangeConnections);
+}
+
 void CCurlFile::ParseAndCorrectUrl(CURL &url2)
 {
   std::string strProtocol = url2.GetTranslatedProtocol();
@@ -1086,6 +1231,8 @@ bool CCurlFile::Open(const CURL& url)
     m_url = efurl;
   }
 
+  StartRanges(m_httpresponse);
+
   return true;
 }
 
@@ -1353,6 +1500,7 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   }
 
   SetCorrectHeaders(m_state);
+  StartRanges(response);
 
   return m_state->m_filePos;
 }
@@ -1535,10 +1683,10 @@ ssize_t CCurlFile::CReadState::Read(void* lpBuf, size_t uiBufSize)
 /* use to attempt to fill the read buffer up to requested number of bytes */
 int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
 {
+  if (!m_ranges.empty())
+    return FillBufferFromRanges(want);
+
   int retry = 0;
-  fd_set fdread;
-  fd_set fdwrite;
-  fd_set fdexcep;
 
   // only attempt to fill buffer if transactions still running and buffer
   // doesnt exceed required size already
@@ -1550,15 +1698,7 @@ int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
     /* if there is data in overflow buffer, try to use that first */
     if (m_overflowSize)
     {
-      unsigned amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
-      m_buffer.WriteData(m_overflowBuffer, amount);
-
-      if (amount < m_overflowSize)
-        memmove(m_overflowBuffer, m_overflowBuffer + amount, m_overflowSize - amount);
-
-      m_overflowSize -= amount;
-      // Shrink memory:
-      m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
+      FlushOverflowBuffer();
       continue;
     }
 
@@ -1672,86 +1812,215 @@ int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
     {
       case CURLM_OK:
       {
-        int maxfd = -1;
-        FD_ZERO(&fdread);
-        FD_ZERO(&fdwrite);
-        FD_ZERO(&fdexcep);
+        if (!WaitForTransfers())
+          return FILLBUFFER_FAIL;
+      }
+      break;
+      case CURLM_CALL_MULTI_PERFORM:
+      {
+        // we don't keep calling here as that can easily overwrite our buffer which we want to avoid
+        // docs says we should call it soon after, but aslong as we are reading data somewhere
+        // this aught to be soon enough. should stay in socket otherwise
+        continue;
+      }
+      break;
+      default:
+      {
+        CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Multi perform failed with code %d, aborting", result);
+        return FILLBUFFER_FAIL;
+      }
+      break;
+    }
+  }
+  return FILLBUFFER_OK;
+}
 
-        // get file descriptors from the transfers
-        g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+void CCurlFile::CReadState::FlushOverflowBuffer()
+{
+  unsigned amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
+  m_buffer.WriteData(m_overflowBuffer, amount);
 
-        long timeout = 0;
-        if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1 || timeout < 200)
-          timeout = 200;
+  if (amount < m_overflowSize)
+    memmove(m_overflowBuffer, m_overflowBuffer + amount, m_overflowSize - amount);
 
-        XbmcThreads::EndTime endTime(timeout);
-        int rc;
+  m_overflowSize -= amount;
+  // Shrink memory:
+  m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
+}
 
-        do
-        {
-          /* On success the value of maxfd is guaranteed to be >= -1. We call
-           * select(maxfd + 1, ...); specially in case of (maxfd == -1) there are
-           * no fds ready yet so we call select(0, ...) --or Sleep() on Windows--
-           * to sleep 100ms, which is the minimum suggested value in the
-           * curl_multi_fdset() doc.
-           */
-          if (maxfd == -1)
-          {
+/* wait until one of the transfers of the multi handle has something to do */
+bool CCurlFile::CReadState::WaitForTransfers()
+{
+  fd_set fdread;
+  fd_set fdwrite;
+  fd_set fdexcep;
+
+  int maxfd = -1;
+  FD_ZERO(&fdread);
+  FD_ZERO(&fdwrite);
+  FD_ZERO(&fdexcep);
+
+  // get file descriptors from the transfers
+  g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+
+  long timeout = 0;
+  if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1 || timeout < 200)
+    timeout = 200;
+
+  XbmcThreads::EndTime endTime(timeout);
+  int rc;
+
+  do
+  {
+    /* On success the value of maxfd is guaranteed to be >= -1. We call
+     * select(maxfd + 1, ...); specially in case of (maxfd == -1) there are
+     * no fds ready yet so we call select(0, ...) --or Sleep() on Windows--
+     * to sleep 100ms, which is the minimum suggested value in the
+     * curl_multi_fdset() doc.
+     */
+    if (maxfd == -1)
+    {
 #ifdef TARGET_WINDOWS
-            /* Windows does not support using select() for sleeping without a dummy
-             * socket. Instead use Windows' Sleep() and sleep for 100ms which is the
-             * minimum suggested value in the curl_multi_fdset() doc.
-             */
-            Sleep(100);
-            rc = 0;
+      /* Windows does not support using select() for sleeping without a dummy
+       * socket. Instead use Windows' Sleep() and sleep for 100ms which is the
+       * minimum suggested value in the curl_multi_fdset() doc.
+       */
+      Sleep(100);
+      rc = 0;
 #else
-            /* Portable sleep for platforms other than Windows. */
-            struct timeval wait = { 0, 100 * 1000 }; /* 100ms */
-            rc = select(0, NULL, NULL, NULL, &wait);
+      /* Portable sleep for platforms other than Windows. */
+      struct timeval wait = { 0, 100 * 1000 }; /* 100ms */
+      rc = select(0, NULL, NULL, NULL, &wait);
 #endif
-          }
-          else
-          {
-            unsigned int time_left = endTime.MillisLeft();
-            struct timeval wait = { (int)time_left / 1000, ((int)time_left % 1000) * 1000 };
-            rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &wait);
-          }
+    }
+    else
+    {
+      unsigned int time_left = endTime.MillisLeft();
+      struct timeval wait = { (int)time_left / 1000, ((int)time_left % 1000) * 1000 };
+      rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &wait);
+    }
 #ifdef TARGET_WINDOWS
-        } while(rc == SOCKET_ERROR && WSAGetLastError() == WSAEINTR);
+  } while(rc == SOCKET_ERROR && WSAGetLastError() == WSAEINTR);
 #else
-        } while(rc == SOCKET_ERROR && errno == EINTR);
+  } while(rc == SOCKET_ERROR && errno == EINTR);
 #endif
 
-        if(rc == SOCKET_ERROR)
-        {
+  if(rc == SOCKET_ERROR)
+  {
 #ifdef TARGET_WINDOWS
-          char buf[256];
-          strerror_s(buf, 256, WSAGetLastError());
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", buf);
+    char buf[256];
+    strerror_s(buf, 256, WSAGetLastError());
+    CLog::Log(LOGERROR, "CCurlFile::WaitForTransfers - Failed with socket error:%s", buf);
 #else
-          char const * str = strerror(errno);
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", str);
+    char const * str = strerror(errno);
+    CLog::Log(LOGERROR, "CCurlFile::WaitForTransfers - Failed with socket error:%s", str);
 #endif
 
-          return FILLBUFFER_FAIL;
-        }
+    return false;
+  }
+
+  return true;
+}
+
+/* fill the read buffer from the range requests, in file order */
+int8_t CCurlFile::CReadState::FillBufferFromRanges(unsigned int want)
+{
+  while ((unsigned int)m_buffer.getMaxReadSize() < want && m_buffer.getMaxWriteSize() > 0)
+  {
+    if (m_cancelled)
+      return FILLBUFFER_NO_DATA;
+
+    if (m_overflowSize)
+    {
+      FlushOverflowBuffer();
+      continue;
+    }
+
+    if (m_ranges.empty())
+    {
+      // everything up to the end of the file was received
+      m_stillRunning = 0;
+      return FILLBUFFER_OK;
+    }
+
+    CRangeRequest *head = m_ranges.front();
+    if (head->m_read < head->m_data.size())
+    {
+      unsigned int amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), (unsigned int)(head->m_data.size() - head->m_read));
+      m_buffer.WriteData(&head->m_data[head->m_read], amount);
+      head->m_read += amount;
+      continue;
+    }
+
+    if (head->m_done)
+    {
+      // reuse the connection for the next range
+      m_ranges.pop_front();
+      if (RequestRange(head))
+        m_ranges.push_back(head);
+      else
+      {
+        g_curlInterface.easy_release(&head->m_handle, NULL);
+        delete head;
       }
-      break;
-      case CURLM_CALL_MULTI_PERFORM:
+      continue;
+    }
+
+    int running = 0;
+    CURLMcode result = g_curlInterface.multi_perform(m_multiHandle, &running);
+    if (result == CURLM_CALL_MULTI_PERFORM)
+      continue;
+    if (result != CURLM_OK)
+    {
+      CLog::Log(LOGERROR, "CCurlFile::FillBufferFromRanges - Multi perform failed with code %d, aborting", result);
+      return FILLBUFFER_FAIL;
+    }
+
+    int msgs;
+    CURLMsg* msg;
+    while ((msg = g_curlInterface.multi_info_read(m_multiHandle, &msgs)))
+    {
+      if (msg->msg != CURLMSG_DONE)
+        continue;
+
+      std::deque<CRangeRequest*>::iterator it = m_ranges.begin();
+      while (it != m_ranges.end() && (*it)->m_handle != msg->easy_handle)
+        ++it;
+      if (it == m_ranges.end())
+        continue;
+
+      CRangeRequest *range = *it;
+      CURLcode code = msg->data.result;
+      g_curlInterface.multi_remove_handle(m_multiHandle, range->m_handle);
+      if (code == CURLE_OK && range->m_start > range->m_end)
       {
-        // we don't keep calling here as that can easily overwrite our buffer which we want to avoid
-        // docs says we should call it soon after, but aslong as we are reading data somewhere
-        // this aught to be soon enough. should stay in socket otherwise
+        range->m_done = true;
         continue;
       }
-      break;
-      default:
+
+      // a response other than 206 will not get better by asking again
+      long httpCode = 0;
+      g_curlInterface.easy_getinfo(range->m_handle, CURLINFO_RESPONSE_CODE, &httpCode);
+      if ((httpCode != 0 && httpCode != 206) || range->m_retries >= g_advancedSettings.m_curlretries)
       {
-        CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Multi perform failed with code %d, aborting", result);
+        CLog::Log(LOGERROR, "CCurlFile::FillBufferFromRanges - Range ending at %" PRId64" failed at %" PRId64": %s(%d), HTTP %ld",
+                  range->m_end, range->m_start, g_curlInterface.easy_strerror(code), code, httpCode);
         return FILLBUFFER_FAIL;
       }
-      break;
+
+      // continue the range where it broke off
+      range->m_retries++;
+      CLog::Log(LOGWARNING, "CCurlFile::FillBufferFromRanges - Reconnect range at %" PRId64", (re)try %i", range->m_start, range->m_retries);
+      std::string bytes = StringUtils::Format("%" PRId64"-%" PRId64, range->m_start, range->m_end);
+      g_curlInterface.easy_setopt(range->m_handle, CURLOPT_RANGE, bytes.c_str());
+      g_curlInterface.multi_add_handle(m_multiHandle, range->m_handle);
     }
+
+    if (head->m_read < head->m_data.size() || head->m_done)
+      continue;
+
+    if (!WaitForTransfers())
+      return FILLBUFFER_FAIL;
   }
   return FILLBUFFER_OK;
 }
@@ -1933,6 +2202,16 @@ int CCurlFile::IoControl(EIoControl request, void* param)
 double CCurlFile::GetDownloadSpeed()
 {
   double res = 0.0f;
+  if (!m_state->m_ranges.empty())
+  {
+    for (std::deque<CReadState::CRangeRequest*>::iterator it = m_state->m_ranges.begin(); it != m_state->m_ranges.end(); ++it)
+    {
+      double speed = 0.0f;
+      g_curlInterface.easy_getinfo((*it)->m_handle, CURLINFO_SPEED_DOWNLOAD, &speed);
+      res += speed;
+    }
+    return res;
+  }
   g_curlInterface.easy_getinfo(m_state->m_easyHandle, CURLINFO_SPEED_DOWNLOAD, &res);
   return res;
 }
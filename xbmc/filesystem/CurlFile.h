@@ -21,8 +21,10 @@
 
 #include "IFile.h"
 #include "utils/RingBuffer.h"
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
 #include "utils/HttpHeader.h"
 
 namespace XCURL
@@ -92,6 +94,7 @@ namespace XFILE
 
       void ClearRequestHeaders();
       void SetBufferSize(unsigned int size);
+      void SetRangeConnections(unsigned int connections)         { m_rangeConnections = connections; }
 
       const CHttpHeader& GetHttpHeader() const { return m_state->m_httpheader; }
       std::string GetServerReportedCharset(void);
@@ -151,6 +154,34 @@ namespace XFILE
           void         SetResume(void);
           long         Connect(unsigned int size);
           void         Disconnect();
+
+          /* a byte range fetched on a connection of its own */
+          struct CRangeRequest
+          {
+            XCURL::CURL_HANDLE* m_handle;
+            int64_t             m_start;    // next byte to receive
+            int64_t             m_end;      // last byte of the range
+            std::vector<char>   m_data;
+            size_t              m_read;     // bytes moved to the ring buffer
+            bool                m_done;
+            int                 m_retries;
+
+            size_t WriteCallback(char *buffer, size_t size, size_t nitems);
+          };
+
+          std::deque<CRangeRequest*> m_ranges; // in file order, the first one feeds the ring buffer
+          int64_t         m_rangeNext;      // first byte not requested yet
+          std::string     m_rangeUrl;
+
+          /*!
+           \brief Replace the transfer by several range requests running in parallel
+           */
+          bool         StartRanges(const std::string &url, unsigned int connections);
+          void         StopRanges();
+          bool         RequestRange(CRangeRequest *range);
+          int8_t       FillBufferFromRanges(unsigned int want);
+          void         FlushOverflowBuffer();
+          bool         WaitForTransfers();
       };
 
     protected:
@@ -158,6 +189,7 @@ namespace XFILE
       void SetCommonOptions(CReadState* state);
       void SetRequestHeaders(CReadState* state);
       void SetCorrectHeaders(CReadState* state);
+      void StartRanges(long response);
       bool Service(const std::string& strURL, std::string& strHTML);
 
     protected:
@@ -198,6 +230,7 @@ namespace XFILE
       bool            m_skipshout;
       bool            m_postdataset;
       bool            m_allowRetry;
+      unsigned int    m_rangeConnections;
 
       CRingBuffer     m_buffer;           // our ringhold buffer
       char *          m_overflowBuffer;   // in the rare case we would overflow the above buffer
@@ -25,6 +25,8 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "PersistentCache.h"
+#include "SegmentCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "settings/AdvancedSettings.h"
@@ -44,6 +46,7 @@
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
+#define READ_CACHE_MAX_CHUNK_SIZE (2*1024*1024)
 
 class CWriteRate
 {
@@ -101,11 +104,15 @@ CFileCache::CFileCache(const unsigned int flags)
   , m_readPos(0)
   , m_writePos(0)
   , m_chunkSize(0)
+  , m_maxChunkSize(0)
   , m_writeRate(0)
   , m_writeRateActual(0)
   , m_forwardCacheSize(0)
   , m_fileSize(0)
   , m_flags(flags)
+  , m_prefetchPos(-1)
+  , m_persistentChunkIndex(-1)
+  , m_persistentBufferPos(-1)
 {
 }
 
@@ -113,9 +120,13 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache /* = true */)
   : CThread("FileCacheStrategy")
   , m_seekPossible(0)
   , m_chunkSize(0)
+  , m_maxChunkSize(0)
   , m_writeRate(0)
   , m_writeRateActual(0)
   , m_forwardCacheSize(0)
+  , m_prefetchPos(-1)
+  , m_persistentChunkIndex(-1)
+  , m_persistentBufferPos(-1)
 {
   m_pCache = pCache;
   m_bDeleteCache = bDeleteCache;
@@ -177,8 +188,23 @@ bool CFileCache::Open(const CURL& url)
   m_chunkSize = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_SIZE);
   m_fileSize = m_source.GetLength();
 
+  // keep seekable files on disk across sessions if enabled, mtime tells a changed file apart
+  m_persistentKey.clear();
+  m_persistentChunkIndex = -1;
+  m_persistentBufferPos = -1;
+  if (m_seekPossible > 0 && CPersistentCache::GetInstance().IsEnabled())
+  {
+    struct __stat64 st;
+    if (m_source.Stat(&st) == 0 || CFile::Stat(m_sourcePath, &st) == 0)
+      m_persistentKey = CPersistentCache::GetFileKey(m_sourcePath, m_fileSize, st.st_mtime);
+    if (!m_persistentKey.empty())
+      m_persistentBuffer.reserve(CPersistentCache::CHUNK_SIZE);
+  }
+
+  m_prefetchPos = -1;
   if (!m_pCache)
   {
+    bool segmented = false;
     if (g_advancedSettings.m_cacheMemSize == 0)
     {
       // Use cache on disk
@@ -200,18 +226,31 @@ bool CFileCache::Open(const CURL& url)
 
       size_t back = cacheSize / 4;
       size_t front = cacheSize - back;
-      
-      if (m_flags & READ_MULTI_STREAM)
+
+      if (m_flags & READ_AUDIO_VIDEO)
+      {
+        // playback jumps between chapters and streams and reads the index at
+        // the end of the file, keep what was cached around earlier positions
+        m_pCache = new CSegmentCache(cacheSize, front, back, m_fileSize);
+        segmented = true;
+        if (m_seekPossible > 0 && m_fileSize > (int64_t)cacheSize)
+          m_prefetchPos = m_fileSize - CSegmentCache::GetTailSize(cacheSize);
+      }
+      else
       {
-        // READ_MULTI_STREAM requires double buffering, so use half the amount of memory for each buffer
-        front /= 2;
-        back /= 2;
+        if (m_flags & READ_MULTI_STREAM)
+        {
+          // READ_MULTI_STREAM requires double buffering, so use half the amount of memory for each buffer
+          front /= 2;
+          back /= 2;
+        }
+        m_pCache = new CCircularCache(front, back);
       }
-      m_pCache = new CCircularCache(front, back);
       m_forwardCacheSize = front;
     }
 
-    if (m_flags & READ_MULTI_STREAM)
+    // the segment cache keeps several ranges by itself
+    if ((m_flags & READ_MULTI_STREAM) && !segmented)
     {
       // If READ_MULTI_STREAM flag is set: Double buffering is required
       m_pCache = new CDoubleCache(m_pCache);
@@ -230,6 +269,15 @@ bool CFileCache::Open(const CURL& url)
   m_writePos = 0;
   m_writeRate = 1024 * 1024;
   m_writeRateActual = 0;
+
+  // reads grow with the bandwidth of the source, but each keeps to a part of the cache
+  m_maxChunkSize = READ_CACHE_MAX_CHUNK_SIZE;
+  if (m_forwardCacheSize > 0)
+    m_maxChunkSize = std::min(m_maxChunkSize, (unsigned)(m_forwardCacheSize / 4));
+  m_maxChunkSize = std::max(m_maxChunkSize / m_chunkSize * m_chunkSize, m_chunkSize);
+  m_rateController.Reset(m_chunkSize, m_maxChunkSize, m_forwardCacheSize,
+                         g_advancedSettings.m_cacheTargetTime, g_advancedSettings.m_cacheReadFactor);
+  m_rateController.SetMediaRate(m_writeRate);
   m_seekEvent.Reset();
   m_seekEnded.Reset();
 
@@ -247,14 +295,13 @@ void CFileCache::Process()
   }
 
   // create our read buffer
-  std::unique_ptr<char[]> buffer(new char[m_chunkSize]);
+  std::unique_ptr<char[]> buffer(new char[m_maxChunkSize]);
   if (buffer.get() == NULL)
   {
     CLog::Log(LOGERROR, "%s - failed to allocate read buffer", __FUNCTION__);
     return;
   }
 
-  CWriteRate limiter;
   CWriteRate average;
   bool cacheReachEOF = false;
 
@@ -272,7 +319,12 @@ void CFileCache::Process()
       bool sourceSeekFailed = false;
       if (!cacheReachEOF)
       {
-        m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
+        // data found on disk is read from there, the source seeks once it is needed
+        if (!m_persistentKey.empty() &&
+            CPersistentCache::GetInstance().HasChunk(m_persistentKey, cacheMaxPos / CPersistentCache::CHUNK_SIZE))
+          m_nSeekResult = cacheMaxPos;
+        else
+          m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
         if (m_nSeekResult != cacheMaxPos)
         {
           CLog::Log(LOGERROR,"CFileCache::Process - Error %d seeking. Seek returned %" PRId64, (int)GetLastError(), m_nSeekResult);
@@ -287,25 +339,52 @@ void CFileCache::Process()
         m_writePos = m_pCache->CachedDataEndPos();
         assert(m_writePos == cacheMaxPos);
         average.Reset(m_writePos, bCompleteReset); // Can only recalculate new average from scratch after a full reset (empty cache)
-        limiter.Reset(m_writePos);
+        m_rateController.Restart(XbmcThreads::SystemClockMillis());
         m_nSeekResult = m_seekPos;
       }
 
       m_seekEnded.Set();
     }
 
-    while (m_writeRate)
+    // the writer ran into a range that was cached before, continue after it
+    int64_t cachedEnd = m_pCache->CachedRangeEndPos();
+    if (cachedEnd > m_writePos && !cacheReachEOF && m_seekPossible != 0)
     {
-      if (m_writePos - m_readPos < m_writeRate * g_advancedSettings.m_cacheReadFactor)
+      cacheReachEOF = (cachedEnd == m_fileSize);
+      // reads from the persistent cache seek the source once it is needed
+      if (cacheReachEOF || !m_persistentKey.empty() || m_source.Seek(cachedEnd, SEEK_SET) == cachedEnd)
       {
-        limiter.Reset(m_writePos);
-        break;
+        CLog::Log(LOGDEBUG, "CFileCache::Process - skipping cached data from %" PRId64" to %" PRId64, m_writePos, cachedEnd);
+        m_pCache->SkipCachedRange();
+        m_writePos = cachedEnd;
+        average.Reset(m_writePos, false);
       }
+      else
+      {
+        CLog::Log(LOGERROR, "CFileCache::Process - failed to seek past cached data to %" PRId64, cachedEnd);
+        m_seekPossible = m_source.IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
+        if (m_source.GetPosition() != m_writePos && m_source.Seek(m_writePos, SEEK_SET) != m_writePos)
+          break; // while (!m_bStop)
+      }
+    }
 
-      if (limiter.Rate(m_writePos) < m_writeRate * g_advancedSettings.m_cacheReadFactor)
+    // enough is cached ahead, use the time to fetch the end of the
+    // file where the first seek goes to read the index
+    if (m_prefetchPos >= 0 && m_writePos - m_readPos >= m_rateController.GetPrefetchLevel())
+    {
+      if (!Prefetch(buffer.get()))
+        break; // while (!m_bStop)
+      continue;
+    }
+
+    // pace the reads to keep the target amount of media cached
+    while (!m_bStop)
+    {
+      unsigned int wait = m_rateController.GetWaitTime(m_writePos - m_readPos, XbmcThreads::SystemClockMillis());
+      if (wait == 0)
         break;
 
-      if (m_seekEvent.WaitMSec(100))
+      if (m_seekEvent.WaitMSec(wait))
       {
         if (!m_bStop)
           m_seekEvent.Set();
@@ -313,7 +392,7 @@ void CFileCache::Process()
       }
     }
 
-    size_t maxWrite = m_pCache->GetMaxWriteSize(m_chunkSize);
+    size_t maxWrite = m_pCache->GetMaxWriteSize(m_rateController.GetReadSize());
 
     /* Only read from source if there's enough write space in the cache
      * else we may keep disposing data and seeking back on (slow) source
@@ -325,8 +404,19 @@ void CFileCache::Process()
     }
 
     ssize_t iRead = 0;
+    bool inPlace = false;
     if (!cacheReachEOF)
-      iRead = m_source.Read(buffer.get(), maxWrite);
+    {
+      unsigned int readStart = XbmcThreads::SystemClockMillis();
+      size_t space = m_pCache->GetWriteBufferSize(maxWrite);
+      inPlace = space > 0 && space >= std::min(maxWrite, (size_t)m_chunkSize);
+      if (inPlace)
+        iRead = ReadSourceInPlace(maxWrite);
+      else
+        iRead = ReadSource(buffer.get(), maxWrite);
+      if (iRead > 0)
+        m_rateController.OnRead(iRead, XbmcThreads::SystemClockMillis() - readStart);
+    }
     if (iRead == 0)
     {
       // Check for actual EOF and retry as long as we still have data in our cache
@@ -376,8 +466,9 @@ void CFileCache::Process()
       break; // while (!m_bStop)
     }
 
+    // data read in place is in the cache already
     int iTotalWrite = 0;
-    while (!m_bStop && (iTotalWrite < iRead))
+    while (!inPlace && !m_bStop && (iTotalWrite < iRead))
     {
       int iWrite = 0;
       iWrite = m_pCache->WriteToCache(buffer.get() + iTotalWrite, iRead - iTotalWrite);
@@ -414,6 +505,169 @@ void CFileCache::Process()
   }
 }
 
+bool CFileCache::Prefetch(char *buffer)
+{
+  int64_t pos = m_pCache->CachedDataEndPosIfSeekTo(m_prefetchPos);
+  m_prefetchPos = -1;
+  if (pos >= m_fileSize)
+    return true;
+
+  CLog::Log(LOGDEBUG, "CFileCache::Prefetch - fetching %" PRId64" bytes at the end of the file", m_fileSize - pos);
+  if (m_source.Seek(pos, SEEK_SET) == pos)
+  {
+    while (pos < m_fileSize && !m_bStop)
+    {
+      // a seek of the reader goes first
+      if (m_seekEvent.WaitMSec(0))
+      {
+        if (!m_bStop)
+          m_seekEvent.Set();
+        break;
+      }
+
+      ssize_t iRead = m_source.Read(buffer, (size_t)std::min((int64_t)m_chunkSize, m_fileSize - pos));
+      if (iRead <= 0)
+        break;
+      if (m_pCache->WriteToCacheAt(pos, buffer, iRead) < iRead)
+        break;
+      pos += iRead;
+    }
+  }
+
+  // continue where the cache left off
+  if (m_source.Seek(m_writePos, SEEK_SET) != m_writePos)
+  {
+    CLog::Log(LOGERROR, "CFileCache::Prefetch - failed to seek back to %" PRId64, m_writePos);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Reads at the write position, from the persistent cache if
+ * the chunk is there and from the source otherwise
+ */
+ssize_t CFileCache::ReadSource(char *buffer, size_t size)
+{
+  if (m_persistentKey.empty())
+    return m_source.Read(buffer, size);
+
+  const int64_t chunkSize = CPersistentCache::CHUNK_SIZE;
+  int64_t index = m_writePos / chunkSize;
+  if (index != m_persistentChunkIndex)
+  {
+    m_persistentChunk.Close();
+    m_persistentChunkIndex = -1;
+    if (CPersistentCache::GetInstance().OpenChunk(m_persistentKey, index, m_persistentChunk))
+      m_persistentChunkIndex = index;
+  }
+
+  if (m_persistentChunkIndex == index)
+  {
+    int64_t offset = m_writePos - index * chunkSize;
+    if (m_persistentChunk.Seek(offset, SEEK_SET) == offset)
+    {
+      ssize_t iRead = m_persistentChunk.Read(buffer, size);
+      if (iRead > 0)
+        return iRead;
+    }
+    CLog::Log(LOGWARNING, "CFileCache::ReadSource - failed to read cached chunk %" PRId64", using source", index);
+    m_persistentChunk.Close();
+    m_persistentChunkIndex = -1;
+  }
+
+  if (m_source.GetPosition() != m_writePos && m_source.Seek(m_writePos, SEEK_SET) != m_writePos)
+  {
+    CLog::Log(LOGERROR, "CFileCache::ReadSource - failed to seek source to %" PRId64, m_writePos);
+    return -1;
+  }
+
+  ssize_t iRead = m_source.Read(buffer, size);
+  if (iRead > 0)
+    StorePersistent(m_writePos, buffer, iRead);
+  return iRead;
+}
+
+/**
+ * Reads into the storage of the cache strategy, which saves copying
+ * every byte through the read buffer. The space comes in pieces up to
+ * the wrap point or the end of a block, pieces shorter than a chunk
+ * are left to the next read to keep source reads aligned. Advances
+ * the write position by what was read.
+ */
+ssize_t CFileCache::ReadSourceInPlace(size_t size)
+{
+  ssize_t total = 0;
+  while ((size_t)total < size)
+  {
+    size_t wanted = size - total;
+    size_t space = m_pCache->GetWriteBufferSize(wanted);
+    if (space == 0 || space < std::min(wanted, (size_t)m_chunkSize))
+      break;
+
+    char *target = m_pCache->GetWriteBuffer(space);
+    if (!target)
+      break;
+
+    // a failed read gives the space back, the cache keeps what was there
+    ssize_t iRead = ReadSource(target, space);
+    if (m_pCache->CommitWriteBuffer(iRead > 0 ? iRead : 0) < 0)
+    {
+      CLog::Log(LOGERROR, "CFileCache::ReadSourceInPlace - error writing to cache");
+      m_bStop = true;
+      return -1;
+    }
+    if (iRead <= 0)
+      return total > 0 ? total : iRead;
+
+    m_writePos += iRead;
+    total += iRead;
+
+    if ((size_t)iRead < space)
+      break;
+  }
+  return total;
+}
+
+/**
+ * Assembles whole chunks from contiguous reads, a seek drops
+ * the partial chunk and continues at the next chunk boundary
+ */
+void CFileCache::StorePersistent(int64_t pos, const char *buffer, size_t size)
+{
+  const int64_t chunkSize = CPersistentCache::CHUNK_SIZE;
+  if (m_persistentBufferPos < 0 || pos != m_persistentBufferPos + (int64_t)m_persistentBuffer.size())
+  {
+    m_persistentBuffer.clear();
+    int64_t start = (pos + chunkSize - 1) / chunkSize * chunkSize;
+    if (start >= pos + (int64_t)size)
+    {
+      m_persistentBufferPos = -1;
+      return;
+    }
+    buffer += start - pos;
+    size -= (size_t)(start - pos);
+    m_persistentBufferPos = start;
+  }
+
+  while (size > 0)
+  {
+    size_t count = std::min(size, (size_t)chunkSize - m_persistentBuffer.size());
+    m_persistentBuffer.insert(m_persistentBuffer.end(), buffer, buffer + count);
+    buffer += count;
+    size -= count;
+
+    int64_t end = m_persistentBufferPos + m_persistentBuffer.size();
+    if ((int64_t)m_persistentBuffer.size() == chunkSize || end == m_fileSize)
+    {
+      CPersistentCache::GetInstance().StoreChunk(m_persistentKey, m_persistentBufferPos / chunkSize,
+                                                 m_persistentBuffer.data(), m_persistentBuffer.size());
+      m_persistentBuffer.clear();
+      m_persistentBufferPos = end;
+    }
+  }
+}
+
 void CFileCache::OnExit()
 {
   m_bStop = true;
@@ -545,6 +799,10 @@ void CFileCache::Close()
   if (m_pCache)
     m_pCache->Close();
 
+  m_persistentChunk.Close();
+  m_persistentChunkIndex = -1;
+  std::vector<char>().swap(m_persistentBuffer);
+
   m_source.Close();
 }
 
@@ -592,12 +850,17 @@ int CFileCache::IoControl(EIoControl request, void* param)
     status->level   = (m_forwardCacheSize == 0) ? 0.0 : (float) status->forward / m_forwardCacheSize;
     status->maxrate = m_writeRate;
     status->currate = m_writeRateActual;
+    status->bandwidth = m_rateController.GetBandwidth();
+    status->pacerate = m_rateController.GetPacingRate();
+    status->readsize = m_rateController.GetReadSize();
+    status->target = m_rateController.GetTarget();
     return 0;
   }
 
   if (request == IOCTRL_CACHE_SETRATE)
   {
     m_writeRate = *(unsigned*)param;
+    m_rateController.SetMediaRate(m_writeRate);
     return 0;
   }
 
@@ -21,10 +21,12 @@
 
 #include "IFile.h"
 #include "CacheStrategy.h"
+#include "CacheRateController.h"
 #include "threads/CriticalSection.h"
 #include "File.h"
 #include "threads/Thread.h"
 #include <atomic>
+#include <vector>
 
 namespace XFILE
 {
@@ -63,6 +65,11 @@ namespace XFILE
     virtual std::string GetContentCharset(void);
 
   private:
+    bool Prefetch(char *buffer);
+    ssize_t ReadSource(char *buffer, size_t size);
+    ssize_t ReadSourceInPlace(size_t size);
+    void StorePersistent(int64_t pos, const char *buffer, size_t size);
+
     CCacheStrategy *m_pCache;
     bool      m_bDeleteCache;
     int        m_seekPossible;
@@ -75,11 +82,19 @@ namespace XFILE
     int64_t      m_readPos;
     int64_t      m_writePos;
     unsigned     m_chunkSize;
+    unsigned     m_maxChunkSize; /**< largest read from the source */
     unsigned     m_writeRate;
     unsigned     m_writeRateActual;
     int64_t      m_forwardCacheSize;
     std::atomic<int64_t> m_fileSize;
     unsigned int m_flags;
+    CCacheRateController m_rateController;
+    int64_t      m_prefetchPos; /**< start of a range to fetch while the reader is busy, -1 for none */
+    std::string  m_persistentKey; /**< key in CPersistentCache, empty if not kept there */
+    CFile        m_persistentChunk;
+    int64_t      m_persistentChunkIndex; /**< index of the chunk open for reading, -1 for none */
+    std::vector<char> m_persistentBuffer; /**< chunk being read from the source */
+    int64_t      m_persistentBufferPos;
     CCriticalSection m_sync;
   };
 
@@ -64,6 +64,10 @@ struct SCacheStatus
   unsigned maxrate;  /**< maximum number of bytes per second cache is allowed to fill */
   unsigned currate;  /**< average read rate from source file since last position change */
   float    level;    /**< cache level (0.0 - 1.0) */
+  unsigned bandwidth; /**< estimated number of bytes per second the source delivers */
+  unsigned pacerate;  /**< number of bytes per second reads are paced at, 0 while refilling */
+  unsigned readsize;  /**< number of bytes per read from the source */
+  uint64_t target;    /**< number of bytes the cache tries to keep forward of current position */
 };
 
 typedef enum {
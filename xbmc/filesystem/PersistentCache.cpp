@@ -0,0 +1,226 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PersistentCache.h"
+#include "Directory.h"
+#include "File.h"
+#include "FileItem.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "PlatformDefs.h" //for PRId64
+
+#include <algorithm>
+
+using namespace XFILE;
+
+const size_t CPersistentCache::CHUNK_SIZE;
+
+CPersistentCache& CPersistentCache::GetInstance()
+{
+  static CPersistentCache cache(URIUtils::AddFileToFolder(g_advancedSettings.m_cachePath, "chunkcache/"),
+                                (int64_t)g_advancedSettings.m_cacheDiskSize * 1024 * 1024);
+  return cache;
+}
+
+CPersistentCache::CPersistentCache(const std::string &path, int64_t maxBytes)
+  : m_path(path)
+  , m_maxBytes(maxBytes)
+  , m_bytes(0)
+  , m_loaded(false)
+{
+  URIUtils::AddSlashAtEnd(m_path);
+}
+
+std::string CPersistentCache::GetFileKey(const std::string &url, int64_t size, int64_t mtime)
+{
+  if (size <= 0 || mtime == 0)
+    return "";
+
+  return XBMC::XBMC_MD5::GetMD5(StringUtils::Format("%s|%" PRId64"|%" PRId64, url.c_str(), size, mtime));
+}
+
+bool CPersistentCache::HasChunk(const std::string &key, int64_t index)
+{
+  CSingleLock lock(m_lock);
+  Load();
+  return m_index.find(GetChunkName(key, index)) != m_index.end();
+}
+
+bool CPersistentCache::OpenChunk(const std::string &key, int64_t index, CFile &file)
+{
+  std::string name = GetChunkName(key, index);
+  {
+    CSingleLock lock(m_lock);
+    Load();
+    std::map<std::string, ChunkList::iterator>::iterator it = m_index.find(name);
+    if (it == m_index.end())
+      return false;
+    m_chunks.splice(m_chunks.begin(), m_chunks, it->second);
+  }
+
+  if (!file.Open(GetChunkPath(name), READ_NO_CACHE))
+  {
+    CLog::Log(LOGWARNING, "CPersistentCache::OpenChunk - failed to open %s, dropping it", name.c_str());
+    CSingleLock lock(m_lock);
+    std::map<std::string, ChunkList::iterator>::iterator it = m_index.find(name);
+    if (it != m_index.end())
+    {
+      m_bytes -= it->second->size;
+      m_chunks.erase(it->second);
+      m_index.erase(it);
+    }
+    return false;
+  }
+  return true;
+}
+
+void CPersistentCache::StoreChunk(const std::string &key, int64_t index, const char *data, size_t size)
+{
+  std::string name = GetChunkName(key, index);
+  {
+    CSingleLock lock(m_lock);
+    Load();
+    if (m_index.find(name) != m_index.end())
+      return;
+  }
+
+  // write under a temporary name, an interrupted write must not leave a short chunk
+  std::string path = GetChunkPath(name);
+  std::string tmpPath = path + ".tmp";
+  CFile file;
+  if (!file.OpenForWrite(tmpPath, true))
+  {
+    CLog::Log(LOGERROR, "CPersistentCache::StoreChunk - failed to create %s", tmpPath.c_str());
+    return;
+  }
+  bool written = file.Write(data, size) == (ssize_t)size;
+  file.Close();
+  if (!written || !CFile::Rename(tmpPath, path))
+  {
+    CLog::Log(LOGERROR, "CPersistentCache::StoreChunk - failed to write %s", path.c_str());
+    CFile::Delete(tmpPath);
+    return;
+  }
+
+  std::vector<std::string> evicted;
+  {
+    CSingleLock lock(m_lock);
+    Insert(name, size);
+    Evict(evicted);
+  }
+  Delete(evicted);
+}
+
+int64_t CPersistentCache::GetUsedSize()
+{
+  CSingleLock lock(m_lock);
+  Load();
+  return m_bytes;
+}
+
+std::string CPersistentCache::GetChunkName(const std::string &key, int64_t index)
+{
+  return StringUtils::Format("%s-%" PRId64".chunk", key.c_str(), index);
+}
+
+std::string CPersistentCache::GetChunkPath(const std::string &name) const
+{
+  return m_path + name;
+}
+
+/**
+ * Reads the index from the directory on first use. Access times are not
+ * kept on disk, chunks of previous sessions are ordered by creation.
+ */
+void CPersistentCache::Load()
+{
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  if (!CDirectory::Exists(m_path))
+  {
+    if (!CDirectory::Create(m_path))
+      CLog::Log(LOGERROR, "CPersistentCache::Load - failed to create %s", m_path.c_str());
+    return;
+  }
+
+  CFileItemList items;
+  if (!CDirectory::GetDirectory(m_path, items, "", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE))
+    return;
+
+  std::vector<CFileItemPtr> chunks;
+  std::vector<std::string> stale;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CFileItemPtr item = items[i];
+    if (item->m_bIsFolder)
+      continue;
+    if (URIUtils::HasExtension(item->GetPath(), ".chunk"))
+      chunks.push_back(item);
+    else if (URIUtils::HasExtension(item->GetPath(), ".tmp"))
+      stale.push_back(URIUtils::GetFileName(item->GetPath()));
+  }
+
+  std::sort(chunks.begin(), chunks.end(), [](const CFileItemPtr &a, const CFileItemPtr &b)
+  {
+    return a->m_dateTime < b->m_dateTime;
+  });
+  for (std::vector<CFileItemPtr>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+    Insert(URIUtils::GetFileName((*it)->GetPath()), (*it)->m_dwSize);
+
+  CLog::Log(LOGDEBUG, "CPersistentCache::Load - %u chunks, %" PRId64" bytes in %s",
+            (unsigned int)m_chunks.size(), m_bytes, m_path.c_str());
+
+  Evict(stale);
+  Delete(stale);
+}
+
+void CPersistentCache::Insert(const std::string &name, int64_t size)
+{
+  Chunk chunk;
+  chunk.name = name;
+  chunk.size = size;
+  m_chunks.push_front(chunk);
+  m_index[name] = m_chunks.begin();
+  m_bytes += size;
+}
+
+void CPersistentCache::Evict(std::vector<std::string> &names)
+{
+  while (m_bytes > m_maxBytes && !m_chunks.empty())
+  {
+    const Chunk &chunk = m_chunks.back();
+    names.push_back(chunk.name);
+    m_bytes -= chunk.size;
+    m_index.erase(chunk.name);
+    m_chunks.pop_back();
+  }
+}
+
+void CPersistentCache::Delete(const std::vector<std::string> &names)
+{
+  for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+    CFile::Delete(GetChunkPath(*it));
+}
@@ -0,0 +1,103 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include <list>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace XFILE
+{
+class CFile;
+
+/**
+ * Chunks of cached files kept on disk across sessions, so resuming or
+ * watching a title again is read locally instead of from the network.
+ * Chunks are keyed by url, size and modification time of the file, the
+ * chunks of a file that changed are no longer found and age out. Once the
+ * size limit is exceeded the least recently used chunks are deleted.
+ */
+class CPersistentCache
+{
+public:
+  static const size_t CHUNK_SIZE = 1024 * 1024;
+
+  /*!
+   \brief Cache in <cachepath>/chunkcache limited by <cache><disksize>
+   */
+  static CPersistentCache& GetInstance();
+
+  /*!
+   \param path directory the chunks are stored in
+   \param maxBytes size limit of all chunks, 0 disables the cache
+   */
+  CPersistentCache(const std::string &path, int64_t maxBytes);
+
+  bool IsEnabled() const { return m_maxBytes > 0; }
+
+  /*!
+   \brief Key of a version of a file
+   \return empty if a change of the file could not be detected
+   */
+  static std::string GetFileKey(const std::string &url, int64_t size, int64_t mtime);
+
+  bool HasChunk(const std::string &key, int64_t index);
+
+  /*!
+   \brief Open a chunk for reading and mark it as recently used
+   */
+  bool OpenChunk(const std::string &key, int64_t index, CFile &file);
+
+  /*!
+   \param size CHUNK_SIZE, less for the last chunk of a file only
+   */
+  void StoreChunk(const std::string &key, int64_t index, const char *data, size_t size);
+
+  int64_t GetUsedSize();
+
+protected:
+  struct Chunk
+  {
+    std::string name;
+    int64_t size;
+  };
+  typedef std::list<Chunk> ChunkList;
+
+  static std::string GetChunkName(const std::string &key, int64_t index);
+  std::string GetChunkPath(const std::string &name) const;
+  void Load();
+  void Insert(const std::string &name, int64_t size);
+  void Evict(std::vector<std::string> &names);
+  void Delete(const std::vector<std::string> &names);
+
+  std::string m_path;
+  int64_t m_maxBytes;
+  int64_t m_bytes;
+  bool m_loaded;
+  ChunkList m_chunks; // most recently used first
+  std::map<std::string, ChunkList::iterator> m_index;
+  CCriticalSection m_lock;
+};
+
+}
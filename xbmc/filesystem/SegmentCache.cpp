@@ -0,0 +1,490 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+#include "threads/SystemClock.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "PlatformDefs.h" //for PRId64
+#include "SegmentCache.h"
+
+using namespace XFILE;
+
+const size_t CSegmentCache::BLOCK_SIZE;
+
+CSegmentCache::CSegmentCache(size_t size, size_t front, size_t back, int64_t fileSize)
+ : CCacheStrategy()
+ , m_cur(0)
+ , m_end(0)
+ , m_size(std::max(size, front + 2 * BLOCK_SIZE))
+ , m_size_front(front)
+ , m_size_back(back)
+ , m_fileSize(fileSize)
+ , m_seekHits(0)
+ , m_seekMisses(0)
+{
+  if (m_fileSize > 0)
+    m_hotTail = std::max((int64_t)0, m_fileSize - (int64_t)GetTailSize(m_size));
+  else
+    m_hotTail = std::numeric_limits<int64_t>::max();
+}
+
+CSegmentCache::~CSegmentCache()
+{
+  Close();
+}
+
+size_t CSegmentCache::GetTailSize(size_t size)
+{
+  return std::min(size / 8, (size_t)4 * 1024 * 1024);
+}
+
+int CSegmentCache::Open()
+{
+  CSingleLock lock(m_sync);
+  m_blocks.clear();
+  m_lru.clear();
+  m_ranges.clear();
+  m_cur = 0;
+  m_end = 0;
+  return CACHE_RC_OK;
+}
+
+void CSegmentCache::Close()
+{
+  CSingleLock lock(m_sync);
+  if (m_seekHits + m_seekMisses > 0)
+    CLog::Log(LOGDEBUG, "CSegmentCache::Close - %u of %u seeks found cached data, %u ranges in %u blocks",
+              m_seekHits, m_seekHits + m_seekMisses, (unsigned int)m_ranges.size(), (unsigned int)m_blocks.size());
+  m_blocks.clear();
+  m_lru.clear();
+  m_free.clear();
+  m_ranges.clear();
+}
+
+size_t CSegmentCache::GetMaxWriteSize(const size_t& iRequestSize)
+{
+  CSingleLock lock(m_sync);
+
+  size_t front = (size_t)(m_end - m_cur);
+  size_t limit = front < m_size_front ? m_size_front - front : 0;
+
+  return std::min(iRequestSize, limit);
+}
+
+int CSegmentCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  len = GetMaxWriteSize(len);
+  if (len == 0)
+    return 0;
+
+  size_t written = Write(m_end, buf, len);
+  m_end += written;
+
+  if (written > 0)
+    m_written.Set();
+
+  return written;
+}
+
+int CSegmentCache::WriteToCacheAt(int64_t iFilePosition, const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+  return Write(iFilePosition, buf, len);
+}
+
+size_t CSegmentCache::GetWriteBufferSize(size_t len) const
+{
+  CSingleLock lock(m_sync);
+
+  size_t front = (size_t)(m_end - m_cur);
+  size_t limit = front < m_size_front ? m_size_front - front : 0;
+  size_t offset = (size_t)(m_end % BLOCK_SIZE);
+
+  return std::min(std::min(len, limit), BLOCK_SIZE - offset);
+}
+
+/**
+ * Returns the block at m_end with the space up to its end. The
+ * block holds data ahead of the reader and is not evicted until
+ * the write is committed.
+ */
+char *CSegmentCache::GetWriteBuffer(size_t &len)
+{
+  CSingleLock lock(m_sync);
+
+  size_t offset = (size_t)(m_end % BLOCK_SIZE);
+  len = GetWriteBufferSize(len);
+  if (len == 0)
+    return NULL;
+
+  uint8_t *data = GetBlock(m_end / BLOCK_SIZE, true);
+  if (!data)
+  {
+    len = 0;
+    return NULL;
+  }
+  return (char*)data + offset;
+}
+
+int CSegmentCache::CommitWriteBuffer(size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  if (len == 0)
+    return 0;
+
+  AddRange(m_end, m_end + len);
+  m_end += len;
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Reads data from cache. Will only read up till the end of
+ * a block, so multiple calls may be needed.
+ */
+int CSegmentCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  size_t front = (size_t)(m_end - m_cur);
+  size_t offset = (size_t)(m_cur % BLOCK_SIZE);
+  size_t avail = std::min(BLOCK_SIZE - offset, front);
+
+  if (avail == 0)
+  {
+    if (IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  if (len > avail)
+    len = avail;
+
+  if (len == 0)
+    return 0;
+
+  uint8_t *data = GetBlock(m_cur / BLOCK_SIZE, false);
+  if (!data)
+  {
+    CLog::Log(LOGERROR, "CSegmentCache::ReadFromCache - block at %" PRId64" missing", m_cur);
+    return CACHE_RC_ERROR;
+  }
+
+  memcpy(buf, data + offset, len);
+  m_cur += len;
+
+  m_space.Set();
+
+  return len;
+}
+
+int64_t CSegmentCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = m_end - m_cur;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > m_size_front)
+    minimum = m_size_front;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = m_end - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CSegmentCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what we have, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000)
+  {
+    m_cur = m_end;
+    lock.Leave();
+    WaitForData((size_t)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  // within the range that is being written the reader moves freely,
+  // other ranges need the writer to continue from their end
+  RangeMap::iterator it = FindRange(m_end);
+  int64_t start = (it != m_ranges.end()) ? it->first : m_end;
+  if (pos >= start && pos <= m_end)
+  {
+    m_cur = pos;
+    m_seekHits++;
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+bool CSegmentCache::Reset(int64_t pos, bool clearAnyway)
+{
+  CSingleLock lock(m_sync);
+  if (clearAnyway)
+  {
+    m_blocks.clear();
+    m_lru.clear();
+    m_ranges.clear();
+  }
+  else
+  {
+    RangeMap::iterator it = FindRange(pos);
+    if (it != m_ranges.end())
+    {
+      m_cur = pos;
+      m_end = it->second;
+      m_seekHits++;
+      return false;
+    }
+  }
+
+  m_cur = pos;
+  m_end = pos;
+  m_seekMisses++;
+  return true;
+}
+
+int64_t CSegmentCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  RangeMap::iterator it = FindRange(iFilePosition);
+  if (it != m_ranges.end())
+    return it->second;
+  return iFilePosition;
+}
+
+int64_t CSegmentCache::CachedDataEndPos()
+{
+  return m_end;
+}
+
+bool CSegmentCache::IsCachedPosition(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return iFilePosition == m_end || FindRange(iFilePosition) != m_ranges.end();
+}
+
+/**
+ * Writes that reach an older range are merged with it, the
+ * write position stays behind until it is skipped.
+ */
+int64_t CSegmentCache::CachedRangeEndPos()
+{
+  CSingleLock lock(m_sync);
+  RangeMap::iterator it = FindRange(m_end);
+  if (it != m_ranges.end())
+    return std::max(m_end, it->second);
+  return m_end;
+}
+
+void CSegmentCache::SkipCachedRange()
+{
+  CSingleLock lock(m_sync);
+  int64_t end = CachedRangeEndPos();
+  if (end > m_end)
+  {
+    m_end = end;
+    m_written.Set();
+  }
+}
+
+CCacheStrategy *CSegmentCache::CreateNew()
+{
+  return new CSegmentCache(m_size, m_size_front, m_size_back, m_fileSize);
+}
+
+float CSegmentCache::GetHitRate()
+{
+  CSingleLock lock(m_sync);
+  unsigned int seeks = m_seekHits + m_seekMisses;
+  return seeks ? (float)m_seekHits / seeks : 0.0f;
+}
+
+size_t CSegmentCache::GetUsedSize()
+{
+  CSingleLock lock(m_sync);
+  return m_blocks.size() * BLOCK_SIZE;
+}
+
+CSegmentCache::RangeMap::iterator CSegmentCache::FindRange(int64_t pos)
+{
+  RangeMap::iterator it = m_ranges.upper_bound(pos);
+  if (it == m_ranges.begin())
+    return m_ranges.end();
+  --it;
+  if (pos <= it->second)
+    return it;
+  return m_ranges.end();
+}
+
+void CSegmentCache::AddRange(int64_t start, int64_t end)
+{
+  // merge with ranges that overlap or touch
+  RangeMap::iterator it = m_ranges.upper_bound(start);
+  if (it != m_ranges.begin())
+  {
+    RangeMap::iterator prev = it;
+    --prev;
+    if (prev->second >= start)
+    {
+      start = prev->first;
+      end = std::max(end, prev->second);
+      it = m_ranges.erase(prev);
+    }
+  }
+  while (it != m_ranges.end() && it->first <= end)
+  {
+    end = std::max(end, it->second);
+    it = m_ranges.erase(it);
+  }
+  m_ranges[start] = end;
+}
+
+void CSegmentCache::RemoveRange(int64_t start, int64_t end)
+{
+  RangeMap::iterator it = m_ranges.upper_bound(start);
+  if (it != m_ranges.begin())
+    --it;
+  while (it != m_ranges.end() && it->first < end)
+  {
+    int64_t rangeStart = it->first;
+    int64_t rangeEnd = it->second;
+    if (rangeEnd <= start)
+    {
+      ++it;
+      continue;
+    }
+    it = m_ranges.erase(it);
+    if (rangeStart < start)
+      m_ranges[rangeStart] = start;
+    if (rangeEnd > end)
+      m_ranges[end] = rangeEnd;
+  }
+}
+
+uint8_t *CSegmentCache::GetBlock(int64_t index, bool create)
+{
+  std::map<int64_t, Block>::iterator it = m_blocks.find(index);
+  if (it != m_blocks.end())
+  {
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    return it->second.data.get();
+  }
+
+  if (!create)
+    return NULL;
+
+  while (m_blocks.size() * BLOCK_SIZE >= m_size)
+  {
+    if (!EvictBlock())
+      return NULL;
+  }
+
+  Block &block = m_blocks[index];
+  if (!m_free.empty())
+  {
+    block.data = std::move(m_free.back());
+    m_free.pop_back();
+  }
+  else
+    block.data.reset(new uint8_t[BLOCK_SIZE]);
+  m_lru.push_front(index);
+  block.lru = m_lru.begin();
+  return block.data.get();
+}
+
+/**
+ * 0 for blocks that go first, 1 for the back buffer and the
+ * head and tail of the file, 2 for the data ahead of the reader
+ */
+int CSegmentCache::GetEvictPriority(int64_t index) const
+{
+  int64_t start = index * (int64_t)BLOCK_SIZE;
+  int64_t end = start + BLOCK_SIZE;
+  if (index >= m_cur / (int64_t)BLOCK_SIZE && index <= m_end / (int64_t)BLOCK_SIZE)
+    return 2;
+  if ((end > m_cur - (int64_t)m_size_back && start < m_cur) || index == 0 || end > m_hotTail)
+    return 1;
+  return 0;
+}
+
+bool CSegmentCache::EvictBlock()
+{
+  std::list<int64_t>::reverse_iterator victim = m_lru.rend();
+  for (std::list<int64_t>::reverse_iterator it = m_lru.rbegin(); it != m_lru.rend(); ++it)
+  {
+    int priority = GetEvictPriority(*it);
+    if (priority == 0)
+    {
+      victim = it;
+      break;
+    }
+    if (priority == 1 && victim == m_lru.rend())
+      victim = it;
+  }
+  if (victim == m_lru.rend())
+    return false;
+
+  int64_t index = *victim;
+  std::map<int64_t, Block>::iterator block = m_blocks.find(index);
+  m_free.push_back(std::move(block->second.data));
+  m_lru.erase(block->second.lru);
+  m_blocks.erase(block);
+  RemoveRange(index * (int64_t)BLOCK_SIZE, (index + 1) * (int64_t)BLOCK_SIZE);
+  return true;
+}
+
+size_t CSegmentCache::Write(int64_t pos, const char *buf, size_t len)
+{
+  size_t written = 0;
+  while (written < len)
+  {
+    size_t offset = (size_t)(pos % BLOCK_SIZE);
+    size_t count = std::min(len - written, BLOCK_SIZE - offset);
+    uint8_t *data = GetBlock(pos / BLOCK_SIZE, true);
+    if (!data)
+      break;
+    memcpy(data + offset, buf + written, count);
+    AddRange(pos, pos + count);
+    pos += count;
+    written += count;
+  }
+  return written;
+}
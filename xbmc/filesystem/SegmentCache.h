@@ -0,0 +1,126 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHESEGMENT_H
+#define CACHESEGMENT_H
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace XFILE {
+
+/**
+ * Memory cache made of fixed size blocks that keeps any number of
+ * non-contiguous ranges of the file. Unlike CCircularCache a seek does not
+ * throw away what was cached, seeking back into a range continues from its
+ * end. When the memory budget is used up the least recently used block goes,
+ * except for the data ahead of the read position, the back buffer and the
+ * head and tail of the file come next to last.
+ */
+class CSegmentCache : public CCacheStrategy
+{
+public:
+  static const size_t BLOCK_SIZE = 128 * 1024;
+
+  /*!
+   \param size memory budget
+   \param front max data ahead of the read position
+   \param back data behind the read position kept in preference to older ranges
+   \param fileSize length of the file if known, <= 0 otherwise
+   */
+  CSegmentCache(size_t size, size_t front, size_t back, int64_t fileSize);
+  virtual ~CSegmentCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual size_t GetMaxWriteSize(const size_t& iRequestSize);
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int WriteToCacheAt(int64_t iFilePosition, const char *buf, size_t len);
+  virtual size_t GetWriteBufferSize(size_t len) const;
+  virtual char *GetWriteBuffer(size_t &len);
+  virtual int CommitWriteBuffer(size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual bool Reset(int64_t pos, bool clearAnyway=true);
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+  virtual int64_t CachedRangeEndPos();
+  virtual void SkipCachedRange();
+
+  virtual CCacheStrategy *CreateNew();
+
+  /*!
+   \brief Share of seeks that found their position cached
+   */
+  float GetHitRate();
+  size_t GetUsedSize();
+
+  /*!
+   \brief Size of the tail of a file kept in preference, indexes of most containers are there
+   */
+  static size_t GetTailSize(size_t size);
+
+protected:
+  typedef std::map<int64_t, int64_t> RangeMap; // start -> end of cached data
+
+  struct Block
+  {
+    std::unique_ptr<uint8_t[]> data;
+    std::list<int64_t>::iterator lru;
+  };
+
+  RangeMap::iterator FindRange(int64_t pos);
+  void AddRange(int64_t start, int64_t end);
+  void RemoveRange(int64_t start, int64_t end);
+  uint8_t *GetBlock(int64_t index, bool create);
+  bool EvictBlock();
+  int GetEvictPriority(int64_t index) const;
+  size_t Write(int64_t pos, const char *buf, size_t len);
+
+  int64_t           m_cur;       /**< current reading index in file */
+  int64_t           m_end;       /**< index in file where the next write goes */
+  size_t            m_size;
+  size_t            m_size_front;
+  size_t            m_size_back;
+  int64_t           m_fileSize;
+  int64_t           m_hotTail;   /**< start of the tail of the file, kept in preference */
+  std::map<int64_t, Block> m_blocks;
+  std::list<int64_t> m_lru;      /**< block indexes, most recently used first */
+  std::vector<std::unique_ptr<uint8_t[]> > m_free;
+  RangeMap          m_ranges;
+  unsigned int      m_seekHits;
+  unsigned int      m_seekMisses;
+  mutable CCriticalSection m_sync;
+  CEvent            m_written;
+};
+
+} // namespace XFILE
+#endif
@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/CacheRateController.h"
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+static const unsigned int CHUNK = 64 * 1024;
+static const unsigned int MB = 1024 * 1024;
+
+// reads as the cache thread does with a source delivering bandwidth bytes
+// per second and a player consuming rate, returns the bytes cached ahead
+static int64_t Simulate(CCacheRateController &controller, unsigned int bandwidth, unsigned int rate,
+                   unsigned int millis, int64_t forward, unsigned int &now, int64_t &read)
+{
+  controller.SetMediaRate(rate);
+  read = 0;
+  for (unsigned int end = now + millis; now < end; )
+  {
+    unsigned int wait = controller.GetWaitTime(forward, now);
+    if (wait > 0)
+    {
+      now += wait;
+      forward -= (int64_t)rate * wait / 1000;
+      continue;
+    }
+    size_t size = controller.GetReadSize();
+    unsigned int duration = std::max(1u, (unsigned int)((int64_t)size * 1000 / bandwidth));
+    controller.OnRead(size, duration);
+    now += duration;
+    forward += size - (int64_t)rate * duration / 1000;
+    read += size;
+  }
+  return forward;
+}
+
+TEST(TestCacheRateController, RefillsAtFullSpeed)
+{
+  CCacheRateController controller;
+  controller.Reset(CHUNK, 16 * CHUNK, 200 * MB, 20, 4.0f);
+
+  unsigned int now = 1000;
+  int64_t read;
+  controller.Restart(now);
+  Simulate(controller, 20 * MB, 5 * MB, 1000, 0, now, read);
+
+  // unpaced while the cache is low, reads grow with the bandwidth
+  EXPECT_EQ(0u, controller.GetPacingRate());
+  EXPECT_NEAR(20.0 * MB, controller.GetBandwidth(), 1.0 * MB);
+  EXPECT_EQ(16u * CHUNK, controller.GetReadSize());
+  EXPECT_NEAR(20.0 * MB, read, 1.0 * MB);
+}
+
+TEST(TestCacheRateController, HoldsTarget)
+{
+  CCacheRateController controller;
+  controller.Reset(CHUNK, 16 * CHUNK, 200 * MB, 20, 4.0f);
+
+  unsigned int now = 1000;
+  int64_t read;
+  controller.Restart(now);
+  int64_t forward = Simulate(controller, 40 * MB, 5 * MB, 60000, 0, now, read);
+
+  // settles at the target without flooding the link
+  EXPECT_EQ(100 * (int64_t)MB, controller.GetTarget());
+  EXPECT_NEAR(100.0 * MB, forward, 10.0 * MB);
+  forward = Simulate(controller, 40 * MB, 5 * MB, 10000, forward, now, read);
+  EXPECT_NEAR(50.0 * MB, read, 2.0 * MB);
+  EXPECT_NEAR(5.0 * MB, controller.GetPacingRate(), 1.0 * MB);
+  EXPECT_NEAR(40.0 * MB, controller.GetBandwidth(), 2.0 * MB);
+}
+
+TEST(TestCacheRateController, TargetLimitedByCache)
+{
+  CCacheRateController controller;
+  controller.Reset(CHUNK, 16 * CHUNK, 20 * MB, 20, 4.0f);
+  controller.SetMediaRate(5 * MB);
+  controller.GetWaitTime(0, 0);
+  EXPECT_EQ(15 * (int64_t)MB, controller.GetTarget());
+}
+
+TEST(TestCacheRateController, CatchesUp)
+{
+  CCacheRateController controller;
+  controller.Reset(CHUNK, 16 * CHUNK, 200 * MB, 20, 4.0f);
+
+  unsigned int now = 1000;
+  int64_t read;
+  controller.Restart(now);
+  int64_t forward = Simulate(controller, 40 * MB, 5 * MB, 60000, 0, now, read);
+
+  // the player took a burst, the paced rate goes up but stays below the limit
+  forward -= 30 * MB;
+  controller.GetWaitTime(forward, now);
+  EXPECT_GT(controller.GetPacingRate(), 5u * MB);
+  EXPECT_LE(controller.GetPacingRate(), 20u * MB);
+  forward = Simulate(controller, 40 * MB, 5 * MB, 20000, forward, now, read);
+  EXPECT_NEAR(100.0 * MB, forward, 10.0 * MB);
+}
+
+TEST(TestCacheRateController, PrefetchWhilePaced)
+{
+  CCacheRateController controller;
+  controller.Reset(CHUNK, 16 * CHUNK, 200 * MB, 20, 4.0f);
+
+  // without a media rate the cache has to be half full
+  EXPECT_EQ(100 * (int64_t)MB, controller.GetPrefetchLevel());
+
+  // a stream of 1 MB/s is held at 20 MB, far below half of the cache
+  unsigned int now = 1000;
+  int64_t read;
+  controller.Restart(now);
+  int64_t forward = Simulate(controller, 40 * MB, MB, 60000, 0, now, read);
+  EXPECT_EQ(20 * (int64_t)MB, controller.GetTarget());
+  EXPECT_GT(controller.GetPacingRate(), 0u);
+  EXPECT_LT(forward, 100 * (int64_t)MB);
+
+  // the prefetch of the index still gets its turn
+  EXPECT_EQ(10 * (int64_t)MB, controller.GetPrefetchLevel());
+  EXPECT_GE(forward, controller.GetPrefetchLevel());
+}
@@ -0,0 +1,115 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/CircularCache.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace XFILE;
+
+static const size_t FRONT = 1000;
+static const size_t BACK = 400;
+
+// byte at a file position
+static char Pattern(int64_t pos)
+{
+  return (char)(pos * 13 + (pos >> 9));
+}
+
+// writes len bytes in place at the write position
+static void FillInPlace(CCircularCache &cache, size_t len)
+{
+  while (len > 0)
+  {
+    int64_t pos = cache.CachedDataEndPos();
+    size_t space = len;
+    char *data = cache.GetWriteBuffer(space);
+    ASSERT_TRUE(data != NULL);
+    for (size_t i = 0; i < space; i++)
+      data[i] = Pattern(pos + i);
+    ASSERT_EQ((int)space, cache.CommitWriteBuffer(space));
+    len -= space;
+  }
+}
+
+// reads len bytes at the read position and checks them
+static void Check(CCircularCache &cache, int64_t pos, size_t len)
+{
+  std::vector<char> buf(len);
+  while (len > 0)
+  {
+    int read = cache.ReadFromCache(buf.data(), len);
+    ASSERT_GT(read, 0);
+    for (int i = 0; i < read; i++)
+      ASSERT_EQ(Pattern(pos + i), buf[i]) << "position " << pos + i;
+    pos += read;
+    len -= read;
+  }
+}
+
+TEST(TestCircularCache, WriteInPlace)
+{
+  CCircularCache cache(FRONT, BACK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  for (int64_t pos = 0; pos < 20 * (int64_t)FRONT; pos += 300)
+  {
+    FillInPlace(cache, 300);
+    Check(cache, pos, 300);
+  }
+
+  // the back buffer is kept for seeks
+  int64_t end = cache.CachedDataEndPos();
+  EXPECT_EQ(end - (int64_t)BACK, cache.Seek(end - BACK));
+  Check(cache, end - BACK, BACK);
+}
+
+TEST(TestCircularCache, QueryKeepsHistory)
+{
+  CCircularCache cache(FRONT, BACK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  FillInPlace(cache, FRONT);
+  Check(cache, 0, FRONT);
+  FillInPlace(cache, BACK);
+  Check(cache, FRONT, BACK);
+
+  // the buffer is full, the next write replaces the oldest history
+  size_t space = cache.GetWriteBufferSize(FRONT);
+  EXPECT_EQ(FRONT, space);
+  EXPECT_TRUE(cache.IsCachedPosition(0));
+
+  // history is kept until a write is committed
+  char *data = cache.GetWriteBuffer(space);
+  ASSERT_TRUE(data != NULL);
+  EXPECT_FALSE(cache.IsCachedPosition(0));
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(0));
+  EXPECT_EQ(0, cache.CommitWriteBuffer(0));
+  EXPECT_TRUE(cache.IsCachedPosition(0));
+  EXPECT_EQ(0, cache.Seek(0));
+  Check(cache, 0, FRONT + BACK);
+
+  // and dropped once it is
+  FillInPlace(cache, 100);
+  EXPECT_FALSE(cache.IsCachedPosition(99));
+  EXPECT_TRUE(cache.IsCachedPosition(100));
+}
@@ -0,0 +1,406 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "filesystem/CurlFile.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "URL.h"
+#include "utils/StringUtils.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+static const int64_t FILE_SIZE = 8 * 1024 * 1024 + 12345;
+static const unsigned int CONNECTION_RATE = 4 * 1024 * 1024; // bytes per second
+static const int64_t RANGE_SIZE = 2 * 1024 * 1024;          // as requested by CCurlFile
+static const int64_t DROP_AFTER = 256 * 1024;                // bytes of a range sent before a drop
+
+static char Content(int64_t pos)
+{
+  return (char)(pos * 31 + (pos >> 16));
+}
+
+/* how the server treats range requests that don't start at 0 */
+struct RangeServerState
+{
+  enum Mode
+  {
+    RANGES_HONORED,
+    RANGES_IGNORED,         // answered with 200 and the whole file
+    RANGE_DROPPED_ONCE,     // the first one breaks off after DROP_AFTER bytes
+  };
+
+  RangeServerState() : mode(RANGES_HONORED), dropped(false), droppedAt(-1), resumed(0) {}
+
+  std::atomic<int> mode;
+  std::atomic<bool> dropped;
+  std::atomic<int64_t> droppedAt;  // file position the dropped range broke off at
+  std::atomic<unsigned int> resumed; // range requests continuing from there
+};
+
+/* serves one connection, each response is throttled to CONNECTION_RATE */
+class CRangeConnection : public CThread
+{
+public:
+  CRangeConnection(int fd, RangeServerState &state) :
+    CThread("RangeConnection"), m_fd(fd), m_state(state), m_rangeRequests(0)
+  {
+    struct timeval timeout = { 5, 0 };
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  }
+
+  ~CRangeConnection()
+  {
+    // wakes up a blocking recv/send, the stop event ends the throttling
+    shutdown(m_fd, SHUT_RDWR);
+    StopThread();
+    close(m_fd);
+  }
+
+  unsigned int GetRangeRequests() const { return m_rangeRequests; }
+
+protected:
+  virtual void Process()
+  {
+    std::string request;
+    while (ReadRequest(request) && SendResponse(request))
+      ;
+    // the client must not wait for the rest of a response that broke off
+    shutdown(m_fd, SHUT_RDWR);
+  }
+
+  bool ReadRequest(std::string &request)
+  {
+    size_t end;
+    while ((end = m_input.find("\r\n\r\n")) == std::string::npos)
+    {
+      char buf[1024];
+      ssize_t len = recv(m_fd, buf, sizeof(buf), 0);
+      if (len <= 0)
+        return false;
+      m_input.append(buf, len);
+    }
+    request = m_input.substr(0, end);
+    m_input.erase(0, end + 4);
+    return true;
+  }
+
+  bool SendResponse(const std::string &request)
+  {
+    int64_t start = 0;
+    int64_t last = FILE_SIZE - 1;
+    bool partial = false;
+    std::string lower(request);
+    StringUtils::ToLower(lower);
+    size_t range = lower.find("\nrange: bytes=");
+    if (range != std::string::npos)
+    {
+      long long first, second;
+      int fields = sscanf(request.c_str() + range + 14, "%lld-%lld", &first, &second);
+      if (fields >= 1)
+      {
+        start = first;
+        if (fields == 2 && second < last)
+          last = second;
+        partial = true;
+        m_rangeRequests++;
+      }
+    }
+
+    bool drop = false;
+    if (partial && start > 0)
+    {
+      if (start == m_state.droppedAt)
+        m_state.resumed++;
+
+      if (m_state.mode == RangeServerState::RANGES_IGNORED)
+      {
+        start = 0;
+        last = FILE_SIZE - 1;
+        partial = false;
+      }
+      else if (m_state.mode == RangeServerState::RANGE_DROPPED_ONCE)
+      {
+        bool expected = false;
+        drop = m_state.dropped.compare_exchange_strong(expected, true);
+      }
+    }
+
+    std::string header;
+    if (partial)
+      header = StringUtils::Format("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %lld-%lld/%lld\r\n",
+                                   (long long)start, (long long)last, (long long)FILE_SIZE);
+    else
+      header = "HTTP/1.1 200 OK\r\n";
+    header += StringUtils::Format("Content-Length: %lld\r\nAccept-Ranges: bytes\r\n"
+                                  "Content-Type: application/octet-stream\r\n\r\n", (long long)(last - start + 1));
+    if (!Send(header.c_str(), header.size()))
+      return false;
+
+    unsigned int begin = XbmcThreads::SystemClockMillis();
+    int64_t sent = 0;
+    std::vector<char> buf(16 * 1024);
+    while (start + sent <= last && !m_bStop)
+    {
+      size_t len = (size_t)std::min((int64_t)buf.size(), last - start - sent + 1);
+      for (size_t i = 0; i < len; i++)
+        buf[i] = Content(start + sent + i);
+      if (!Send(buf.data(), len))
+        return false;
+      sent += len;
+
+      if (drop && sent >= DROP_AFTER)
+      {
+        m_state.droppedAt = start + sent;
+        return false;
+      }
+
+      unsigned int due = (unsigned int)(sent * 1000 / CONNECTION_RATE);
+      unsigned int elapsed = XbmcThreads::SystemClockMillis() - begin;
+      if (due > elapsed)
+        Sleep(due - elapsed);
+    }
+    return true;
+  }
+
+  bool Send(const char *data, size_t size)
+  {
+    while (size > 0)
+    {
+      ssize_t len = send(m_fd, data, size, MSG_NOSIGNAL);
+      if (len <= 0)
+        return false;
+      data += len;
+      size -= len;
+    }
+    return true;
+  }
+
+  int m_fd;
+  RangeServerState &m_state;
+  std::string m_input;
+  std::atomic<unsigned int> m_rangeRequests;
+};
+
+/* minimal http server for a single file that honors ranges */
+class CRangeServer : public CThread
+{
+public:
+  CRangeServer() : CThread("RangeServer"), m_fd(-1), m_port(0)
+  {
+    m_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(m_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0 && listen(m_fd, 16) == 0
+     && getsockname(m_fd, (struct sockaddr*)&addr, &len) == 0)
+      m_port = ntohs(addr.sin_port);
+  }
+
+  ~CRangeServer()
+  {
+    StopThread();
+    close(m_fd);
+    for (std::vector<CRangeConnection*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+      delete *it;
+  }
+
+  unsigned int GetPort() const { return m_port; }
+
+  RangeServerState &GetState() { return m_state; }
+
+  /* number of connections accepted so far */
+  unsigned int GetConnections()
+  {
+    CSingleLock lock(m_section);
+    return m_connections.size();
+  }
+
+  /* number of requests with a range header over all connections */
+  unsigned int GetRangeRequests()
+  {
+    CSingleLock lock(m_section);
+    unsigned int requests = 0;
+    for (std::vector<CRangeConnection*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+      requests += (*it)->GetRangeRequests();
+    return requests;
+  }
+
+  std::string GetURL() const
+  {
+    return StringUtils::Format("http://127.0.0.1:%u/file.bin", m_port);
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(m_fd, &fds);
+      struct timeval wait = { 0, 100 * 1000 };
+      if (select(m_fd + 1, &fds, NULL, NULL, &wait) <= 0)
+        continue;
+
+      int fd = accept(m_fd, NULL, NULL);
+      if (fd < 0)
+        continue;
+
+      CRangeConnection *connection = new CRangeConnection(fd, m_state);
+      connection->Create();
+      CSingleLock lock(m_section);
+      m_connections.push_back(connection);
+    }
+  }
+
+  int m_fd;
+  unsigned int m_port;
+  RangeServerState m_state;
+  CCriticalSection m_section;
+  std::vector<CRangeConnection*> m_connections;
+};
+
+class TestCurlFile : public testing::Test
+{
+protected:
+  TestCurlFile()
+  {
+    m_server.Create();
+  }
+
+  /* read the file from pos to the end, returns false on an error or a mismatch */
+  bool ReadAll(CCurlFile &file, int64_t pos)
+  {
+    std::vector<char> buf(64 * 1024);
+    while (pos < FILE_SIZE)
+    {
+      ssize_t len = file.Read(buf.data(), buf.size());
+      if (len <= 0)
+        return false;
+      for (ssize_t i = 0; i < len; i++)
+      {
+        if (buf[i] != Content(pos + i))
+          return false;
+      }
+      pos += len;
+    }
+    return true;
+  }
+
+  CRangeServer m_server;
+};
+
+TEST_F(TestCurlFile, SingleConnection)
+{
+  ASSERT_NE(0u, m_server.GetPort());
+  CCurlFile file;
+  file.SetRangeConnections(1);
+  ASSERT_TRUE(file.Open(CURL(m_server.GetURL())));
+  EXPECT_EQ(FILE_SIZE, file.GetLength());
+  EXPECT_TRUE(ReadAll(file, 0));
+  file.Close();
+
+  // the whole file comes with the first response
+  EXPECT_EQ(1u, m_server.GetConnections());
+  EXPECT_LE(m_server.GetRangeRequests(), 1u);
+}
+
+TEST_F(TestCurlFile, RangeConnectionsReassembleInOrder)
+{
+  ASSERT_NE(0u, m_server.GetPort());
+  CCurlFile file;
+  file.SetRangeConnections(4);
+  ASSERT_TRUE(file.Open(CURL(m_server.GetURL())));
+  EXPECT_EQ(FILE_SIZE, file.GetLength());
+  EXPECT_TRUE(ReadAll(file, 0));
+  file.Close();
+
+  // the first request plus one per range, fetched side by side
+  EXPECT_GE(m_server.GetConnections(), 4u);
+  EXPECT_GE(m_server.GetRangeRequests(), (unsigned int)(FILE_SIZE / RANGE_SIZE + 1));
+}
+
+TEST_F(TestCurlFile, RangeConnectionsSeek)
+{
+  ASSERT_NE(0u, m_server.GetPort());
+  CCurlFile file;
+  file.SetRangeConnections(4);
+  ASSERT_TRUE(file.Open(CURL(m_server.GetURL())));
+
+  int64_t pos = FILE_SIZE / 2 + 123;
+  EXPECT_EQ(pos, file.Seek(pos, SEEK_SET));
+  char buf[1000];
+  ASSERT_EQ((ssize_t)sizeof(buf), file.Read(buf, sizeof(buf)));
+  for (size_t i = 0; i < sizeof(buf); i++)
+    ASSERT_EQ(Content(pos + i), buf[i]);
+
+  pos = 1000;
+  EXPECT_EQ(pos, file.Seek(pos, SEEK_SET));
+  EXPECT_TRUE(ReadAll(file, pos));
+  file.Close();
+}
+
+TEST_F(TestCurlFile, RangeIgnoredFailsRead)
+{
+  ASSERT_NE(0u, m_server.GetPort());
+  m_server.GetState().mode = RangeServerState::RANGES_IGNORED;
+  CCurlFile file;
+  file.SetRangeConnections(4);
+  ASSERT_TRUE(file.Open(CURL(m_server.GetURL())));
+
+  // the whole file in answer to a range can't be put in place
+  EXPECT_FALSE(ReadAll(file, 0));
+  file.Close();
+}
+
+TEST_F(TestCurlFile, RangeDroppedResumes)
+{
+  ASSERT_NE(0u, m_server.GetPort());
+  m_server.GetState().mode = RangeServerState::RANGE_DROPPED_ONCE;
+  CCurlFile file;
+  file.SetRangeConnections(4);
+  ASSERT_TRUE(file.Open(CURL(m_server.GetURL())));
+  EXPECT_TRUE(ReadAll(file, 0));
+  file.Close();
+
+  // the broken range was asked for again from where it broke off
+  EXPECT_TRUE(m_server.GetState().dropped);
+  EXPECT_EQ(1u, m_server.GetState().resumed);
+}
+
+#endif
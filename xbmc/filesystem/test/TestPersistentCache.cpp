@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/PersistentCache.h"
+#include "filesystem/SpecialProtocol.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+static const size_t CHUNK = CPersistentCache::CHUNK_SIZE;
+
+class TestPersistentCache : public testing::Test
+{
+protected:
+  TestPersistentCache()
+  {
+    m_path = CSpecialProtocol::TranslatePath("special://temp/persistentcachetest/");
+    CDirectory::RemoveRecursive(m_path);
+  }
+
+  ~TestPersistentCache()
+  {
+    CDirectory::RemoveRecursive(m_path);
+  }
+
+  static std::vector<char> Chunk(char value, size_t size = CHUNK)
+  {
+    return std::vector<char>(size, value);
+  }
+
+  static bool CheckChunk(CPersistentCache &cache, const std::string &key, int64_t index, char value, size_t size = CHUNK)
+  {
+    CFile file;
+    if (!cache.OpenChunk(key, index, file))
+      return false;
+    std::vector<char> buf(CHUNK + 1);
+    return file.Read(buf.data(), buf.size()) == (ssize_t)size && buf[0] == value && buf[size - 1] == value;
+  }
+
+  std::string m_path;
+};
+
+TEST_F(TestPersistentCache, FileKey)
+{
+  std::string key = CPersistentCache::GetFileKey("smb://server/movie.mkv", 1000, 12345);
+  EXPECT_FALSE(key.empty());
+  EXPECT_EQ(key, CPersistentCache::GetFileKey("smb://server/movie.mkv", 1000, 12345));
+  EXPECT_NE(key, CPersistentCache::GetFileKey("smb://server/movie.mkv", 1001, 12345));
+  EXPECT_NE(key, CPersistentCache::GetFileKey("smb://server/movie.mkv", 1000, 12346));
+  EXPECT_TRUE(CPersistentCache::GetFileKey("smb://server/movie.mkv", 1000, 0).empty());
+  EXPECT_TRUE(CPersistentCache::GetFileKey("smb://server/movie.mkv", 0, 12345).empty());
+}
+
+TEST_F(TestPersistentCache, StoreAndRead)
+{
+  CPersistentCache cache(m_path, 4 * CHUNK);
+  EXPECT_FALSE(cache.HasChunk("a", 0));
+
+  cache.StoreChunk("a", 0, Chunk('0').data(), CHUNK);
+  cache.StoreChunk("a", 1, Chunk('1', 100).data(), 100);
+  EXPECT_TRUE(cache.HasChunk("a", 0));
+  EXPECT_FALSE(cache.HasChunk("b", 0));
+  EXPECT_TRUE(CheckChunk(cache, "a", 0, '0'));
+  EXPECT_TRUE(CheckChunk(cache, "a", 1, '1', 100));
+  EXPECT_EQ((int64_t)CHUNK + 100, cache.GetUsedSize());
+}
+
+TEST_F(TestPersistentCache, LeastRecentlyUsedGoes)
+{
+  CPersistentCache cache(m_path, 2 * CHUNK + CHUNK / 2);
+  cache.StoreChunk("a", 0, Chunk('a').data(), CHUNK);
+  cache.StoreChunk("b", 0, Chunk('b').data(), CHUNK);
+  EXPECT_TRUE(CheckChunk(cache, "a", 0, 'a'));
+
+  cache.StoreChunk("c", 0, Chunk('c').data(), CHUNK);
+  EXPECT_TRUE(cache.HasChunk("a", 0));
+  EXPECT_FALSE(cache.HasChunk("b", 0));
+  EXPECT_TRUE(cache.HasChunk("c", 0));
+  EXPECT_LE(cache.GetUsedSize(), (int64_t)(2 * CHUNK + CHUNK / 2));
+}
+
+TEST_F(TestPersistentCache, KeptAcrossSessions)
+{
+  {
+    CPersistentCache cache(m_path, 4 * CHUNK);
+    cache.StoreChunk("a", 3, Chunk('3').data(), CHUNK);
+  }
+
+  // an interrupted write is cleaned up
+  CFile tmp;
+  ASSERT_TRUE(tmp.OpenForWrite(m_path + "b-0.chunk.tmp", true));
+  tmp.Write(Chunk('x', 10).data(), 10);
+  tmp.Close();
+
+  CPersistentCache cache(m_path, 4 * CHUNK);
+  EXPECT_TRUE(CheckChunk(cache, "a", 3, '3'));
+  EXPECT_FALSE(cache.HasChunk("b", 0));
+  EXPECT_EQ((int64_t)CHUNK, cache.GetUsedSize());
+  EXPECT_FALSE(CFile::Exists(m_path + "b-0.chunk.tmp"));
+}
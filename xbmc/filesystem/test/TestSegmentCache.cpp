@@ -0,0 +1,243 @@
+/*
+ *      Copyright (C) 2005-2016 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/SegmentCache.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace XFILE;
+
+static const size_t BLOCK = CSegmentCache::BLOCK_SIZE;
+
+// byte at a file position
+static char Pattern(int64_t pos)
+{
+  return (char)((pos * 7 + pos / 251) & 0xFF);
+}
+
+// write len bytes at the write position, as the cache thread does
+static void Fill(CSegmentCache &cache, int64_t len)
+{
+  std::vector<char> buf(BLOCK);
+  while (len > 0)
+  {
+    int64_t pos = cache.CachedDataEndPos();
+    size_t count = cache.GetMaxWriteSize(std::min((int64_t)buf.size(), len));
+    ASSERT_GT(count, 0u);
+    for (size_t i = 0; i < count; i++)
+      buf[i] = Pattern(pos + i);
+    int written = cache.WriteToCache(buf.data(), count);
+    ASSERT_EQ((int)count, written);
+    len -= written;
+  }
+}
+
+// read len bytes at the read position and check them
+static void Check(CSegmentCache &cache, int64_t pos, int64_t len)
+{
+  std::vector<char> buf(BLOCK);
+  while (len > 0)
+  {
+    int read = cache.ReadFromCache(buf.data(), (size_t)std::min((int64_t)buf.size(), len));
+    ASSERT_GT(read, 0);
+    for (int i = 0; i < read; i++)
+      ASSERT_EQ(Pattern(pos + i), buf[i]) << "position " << pos + i;
+    pos += read;
+    len -= read;
+  }
+}
+
+TEST(TestSegmentCache, ReadWrite)
+{
+  CSegmentCache cache(8 * BLOCK, 6 * BLOCK, 2 * BLOCK, 0);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  char c;
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(&c, 1));
+
+  Fill(cache, 3 * BLOCK + 100);
+  EXPECT_EQ((int64_t)(3 * BLOCK + 100), cache.WaitForData(0, 0));
+  Check(cache, 0, 3 * BLOCK + 100);
+
+  // forward space is limited, reading makes room
+  Fill(cache, 6 * BLOCK);
+  EXPECT_EQ(0u, cache.GetMaxWriteSize(1));
+  Check(cache, 3 * BLOCK + 100, BLOCK);
+  EXPECT_EQ(BLOCK, cache.GetMaxWriteSize(2 * BLOCK));
+
+  cache.EndOfInput();
+  Check(cache, 4 * BLOCK + 100, 5 * BLOCK);
+  EXPECT_EQ(0, cache.ReadFromCache(&c, 1));
+}
+
+TEST(TestSegmentCache, SeekKeepsRanges)
+{
+  CSegmentCache cache(16 * BLOCK, 4 * BLOCK, BLOCK, 0);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  Fill(cache, 2 * BLOCK);
+  Check(cache, 0, 2 * BLOCK);
+
+  // seek away, nothing cached there
+  int64_t chapter = 100 * BLOCK + 10;
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(chapter));
+  EXPECT_FALSE(cache.IsCachedPosition(chapter));
+  EXPECT_TRUE(cache.Reset(chapter, false));
+  Fill(cache, 2 * BLOCK);
+  Check(cache, chapter, BLOCK);
+
+  // back to the start, the first range is still there and the writer
+  // continues from its end
+  EXPECT_TRUE(cache.IsCachedPosition(BLOCK));
+  EXPECT_EQ((int64_t)(2 * BLOCK), cache.CachedDataEndPosIfSeekTo(BLOCK));
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(BLOCK));
+  EXPECT_FALSE(cache.Reset(BLOCK, false));
+  EXPECT_EQ((int64_t)(2 * BLOCK), cache.CachedDataEndPos());
+  Check(cache, BLOCK, BLOCK);
+
+  // and the chapter is kept as well
+  EXPECT_EQ(chapter + (int64_t)(2 * BLOCK), cache.CachedDataEndPosIfSeekTo(chapter + 5));
+  EXPECT_FALSE(cache.Reset(chapter + 5, false));
+  Check(cache, chapter + 5, 2 * BLOCK - 5);
+
+  // seeks within the range being written need no reset
+  EXPECT_EQ(chapter, cache.Seek(chapter));
+  Check(cache, chapter, 10);
+
+  EXPECT_FLOAT_EQ(3.0f / 4.0f, cache.GetHitRate());
+}
+
+TEST(TestSegmentCache, SkipCachedRange)
+{
+  CSegmentCache cache(16 * BLOCK, 8 * BLOCK, BLOCK, 0);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // a range at the start and one a bit later
+  Fill(cache, 2 * BLOCK);
+  EXPECT_TRUE(cache.Reset(4 * BLOCK, false));
+  Fill(cache, 2 * BLOCK);
+
+  // back to the start, nothing to skip before the gap is filled
+  EXPECT_FALSE(cache.Reset(BLOCK, false));
+  EXPECT_EQ((int64_t)(2 * BLOCK), cache.CachedRangeEndPos());
+  Fill(cache, 2 * BLOCK);
+
+  // the writer reached the later range and continues after it
+  EXPECT_EQ((int64_t)(4 * BLOCK), cache.CachedDataEndPos());
+  EXPECT_EQ((int64_t)(6 * BLOCK), cache.CachedRangeEndPos());
+  cache.SkipCachedRange();
+  EXPECT_EQ((int64_t)(6 * BLOCK), cache.CachedDataEndPos());
+  EXPECT_EQ((int64_t)(6 * BLOCK), cache.CachedRangeEndPos());
+  Check(cache, BLOCK, 5 * BLOCK);
+}
+
+TEST(TestSegmentCache, Budget)
+{
+  CSegmentCache cache(8 * BLOCK, 4 * BLOCK, BLOCK, 0);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // ranges far apart, the oldest goes first
+  for (int64_t range = 0; range < 6; range++)
+  {
+    cache.Reset(range * 100 * BLOCK, false);
+    Fill(cache, 2 * BLOCK);
+    Check(cache, range * 100 * BLOCK, 2 * BLOCK);
+    EXPECT_LE(cache.GetUsedSize(), 8 * BLOCK);
+  }
+  EXPECT_FALSE(cache.IsCachedPosition(100 * BLOCK + 1));
+  EXPECT_TRUE(cache.IsCachedPosition(400 * BLOCK + 1));
+  EXPECT_TRUE(cache.IsCachedPosition(500 * BLOCK + 1));
+
+  // the head of the file outlives older ranges
+  EXPECT_TRUE(cache.IsCachedPosition(1));
+
+  // data ahead of the reader is never dropped
+  cache.Reset(1000 * BLOCK, false);
+  Fill(cache, 4 * BLOCK);
+  for (int64_t range = 0; range < 4; range++)
+  {
+    EXPECT_EQ(2 * BLOCK, (size_t)cache.WriteToCacheAt((2000 + range * 10) * BLOCK,
+                                                      std::vector<char>(2 * BLOCK).data(), 2 * BLOCK));
+  }
+  Check(cache, 1000 * BLOCK, 4 * BLOCK);
+}
+
+TEST(TestSegmentCache, Prefetch)
+{
+  int64_t fileSize = 1000 * BLOCK;
+  CSegmentCache cache(16 * BLOCK, 8 * BLOCK, 2 * BLOCK, fileSize);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  Fill(cache, BLOCK);
+
+  // the tail is stored next to the data being read
+  int64_t tail = fileSize - CSegmentCache::GetTailSize(16 * BLOCK);
+  std::vector<char> buf(fileSize - tail);
+  for (size_t i = 0; i < buf.size(); i++)
+    buf[i] = Pattern(tail + i);
+  EXPECT_EQ((int)buf.size(), cache.WriteToCacheAt(tail, buf.data(), buf.size()));
+  EXPECT_EQ((int64_t)BLOCK, cache.CachedDataEndPos());
+  Check(cache, 0, BLOCK);
+
+  // and survives playback going on
+  for (int64_t pos = BLOCK; pos < 21 * (int64_t)BLOCK; pos += BLOCK)
+  {
+    Fill(cache, BLOCK);
+    Check(cache, pos, BLOCK);
+  }
+  EXPECT_EQ(fileSize, cache.CachedDataEndPosIfSeekTo(fileSize - 100));
+  EXPECT_FALSE(cache.Reset(fileSize - 100, false));
+  Check(cache, fileSize - 100, 100);
+}
+
+TEST(TestSegmentCache, WriteInPlace)
+{
+  CSegmentCache cache(8 * BLOCK, 4 * BLOCK, BLOCK, 0);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  Fill(cache, 100);
+
+  // the space ends with the block
+  size_t len = 2 * BLOCK;
+  char *data = cache.GetWriteBuffer(len);
+  ASSERT_TRUE(data != NULL);
+  EXPECT_EQ(BLOCK - 100, len);
+  for (size_t i = 0; i < len; i++)
+    data[i] = Pattern(100 + i);
+  EXPECT_EQ((int)len, cache.CommitWriteBuffer(len));
+  EXPECT_EQ((int64_t)BLOCK, cache.CachedDataEndPos());
+
+  // and is limited by the forward space
+  Fill(cache, 3 * BLOCK - 10);
+  len = BLOCK;
+  data = cache.GetWriteBuffer(len);
+  ASSERT_TRUE(data != NULL);
+  EXPECT_EQ(10u, len);
+  for (size_t i = 0; i < len; i++)
+    data[i] = Pattern(4 * BLOCK - 10 + i);
+  cache.CommitWriteBuffer(len);
+  len = 1;
+  EXPECT_TRUE(cache.GetWriteBuffer(len) == NULL);
+  EXPECT_EQ(0u, len);
+
+  Check(cache, 0, 4 * BLOCK);
+}
@@ -483,5 +483,5 @@ void CGUIAudioManager::SetVolume(float level)
 
 void CGUIAudioManager::CheckAudio2()
 {
-  m_bAudio2 = CSettings::GetInstance().GetBool(CSettings::SETTING_AUDIOOUTPUT2_ENABLED);
+  m_bAudio2 = CAEFactory::IsAudio2Enabled();
 }
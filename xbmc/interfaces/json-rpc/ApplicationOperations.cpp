@@ -29,6 +29,8 @@
 #include "GUIInfoManager.h"
 #include "system.h"
 #include "CompileInfo.h"
+#include "cores/AudioEngine/AEFactory.h"
+#include "cores/AudioEngine/Utils/AEEngineCounters.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 #include <string.h>
@@ -55,6 +57,24 @@ JSONRPC_STATUS CApplicationOperations::GetProperties(const std::string &method,
   return OK;
 }
 
+JSONRPC_STATUS CApplicationOperations::GetAudioEngineStats(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CAEEngineCounters *counters = CAEFactory::GetCounters();
+  if (!counters)
+    return FailedToExecute;
+
+  result = CVariant(CVariant::VariantTypeObject);
+  counters->Serialize(result["primary"]);
+
+  counters = CAEFactory::GetCounters(true);
+  if (counters)
+    counters->Serialize(result["secondary"]);
+
+  CAEFactory::SerializeResampleCache(result["resamplecache"]);
+
+  return OK;
+}
+
 JSONRPC_STATUS CApplicationOperations::SetVolume(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   bool up = false;
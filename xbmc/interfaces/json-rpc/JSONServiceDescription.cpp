@@ -221,6 +221,7 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
 
 // Application operations
   { "Application.GetProperties",                    CApplicationOperations::GetProperties },
+  { "Application.GetAudioEngineStats",              CApplicationOperations::GetAudioEngineStats },
   { "Application.SetVolume",                        CApplicationOperations::SetVolume },
   { "Application.SetMute",                          CApplicationOperations::SetMute },
   { "Application.Quit",                             CApplicationOperations::Quit },
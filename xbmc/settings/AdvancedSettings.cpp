@@ -118,6 +118,8 @@ void CAdvancedSettings::Initialize()
   //default hold time of 25 ms, this allows a 20 hertz sine to pass undistorted
   m_limiterHold = 0.025f;
   m_limiterRelease = 0.1f;
+  m_audioLatencyCalibrationDevice = "hw:Loopback,1,0";
+  m_audioAlsaMmap = true;
 
   m_seekSteps = { 10, 30, 60, 180, 300, 600, 1800 };
 
@@ -319,6 +321,7 @@ void CAdvancedSettings::Initialize()
   m_curlconnecttimeout = 30;
   m_curllowspeedtime = 20;
   m_curlretries = 2;
+  m_curlRangeConnections = 1;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
 
@@ -360,6 +363,10 @@ void CAdvancedSettings::Initialize()
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_cacheReadFactor = 4.0f;
+  // seconds of media kept cached, reads are paced once half of it is there
+  m_cacheTargetTime = 20;
+  // chunks of cached files kept on disk across sessions, in MB
+  m_cacheDiskSize = 0;
 
   m_addonPackageFolderSize = 200;
 
@@ -526,6 +533,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
 
     XMLUtils::GetFloat(pElement, "limiterhold", m_limiterHold, 0.0f, 100.0f);
     XMLUtils::GetFloat(pElement, "limiterrelease", m_limiterRelease, 0.001f, 100.0f);
+    XMLUtils::GetString(pElement, "latencycalibrationdevice", m_audioLatencyCalibrationDevice);
+    XMLUtils::GetBoolean(pElement, "alsammap", m_audioAlsaMmap);
   }
 
   pElement = pRootElement->FirstChildElement("omx");
@@ -790,6 +799,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "curlclienttimeout", m_curlconnecttimeout, 1, 1000);
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
+    XMLUtils::GetInt(pElement, "curlrangeconnections", m_curlRangeConnections, 1, 8);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
   }
 
@@ -799,6 +809,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "memorysize", m_cacheMemSize);
     XMLUtils::GetUInt(pElement, "buffermode", m_cacheBufferMode, 0, 4);
     XMLUtils::GetFloat(pElement, "readfactor", m_cacheReadFactor);
+    XMLUtils::GetUInt(pElement, "targettime", m_cacheTargetTime, 1, 600);
+    XMLUtils::GetUInt(pElement, "disksize", m_cacheDiskSize);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -143,6 +143,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_VideoPlayerIgnoreDTSinWAV;
     float m_limiterHold;
     float m_limiterRelease;
+    std::string m_audioLatencyCalibrationDevice;
+    bool m_audioAlsaMmap;
 
     bool  m_omxDecodeStartWithValidFrame;
 
@@ -297,6 +299,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curlconnecttimeout;
     int m_curllowspeedtime;
     int m_curlretries;
+    int m_curlRangeConnections;
     bool m_curlDisableIPV6;
 
     bool m_fullScreen;
@@ -344,6 +347,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     unsigned int m_cacheMemSize;
     unsigned int m_cacheBufferMode;
     float m_cacheReadFactor;
+    unsigned int m_cacheTargetTime; ///< \brief seconds of media the cache keeps ahead while playing
+    unsigned int m_cacheDiskSize; ///< \brief size limit of the persistent chunk cache in MB, 0 to disable it
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
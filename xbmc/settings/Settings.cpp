@@ -359,9 +359,15 @@ const std::string CSettings::SETTING_AUDIOOUTPUT_PROCESSQUALITY = "audiooutput.p
 const std::string CSettings::SETTING_AUDIOOUTPUT_ATEMPOTHRESHOLD = "audiooutput.atempothreshold";
 const std::string CSettings::SETTING_AUDIOOUTPUT_STREAMSILENCE = "audiooutput.streamsilence";
 const std::string CSettings::SETTING_AUDIOOUTPUT_STREAMNOISE = "audiooutput.streamnoise";
+const std::string CSettings::SETTING_AUDIOOUTPUT_LATENCY = "audiooutput.latency";
+const std::string CSettings::SETTING_AUDIOOUTPUT_LOWLATENCY = "audiooutput.lowlatency";
+const std::string CSettings::SETTING_AUDIOOUTPUT_CALIBRATELATENCY = "audiooutput.calibratelatency";
+const std::string CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTION = "audiooutput.roomcorrection";
+const std::string CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTIONFILE = "audiooutput.roomcorrectionfile";
 const std::string CSettings::SETTING_AUDIOOUTPUT_DSPADDONSENABLED = "audiooutput.dspaddonsenabled";
 const std::string CSettings::SETTING_AUDIOOUTPUT_DSPSETTINGS = "audiooutput.dspsettings";
 const std::string CSettings::SETTING_AUDIOOUTPUT_DSPRESETDB = "audiooutput.dspresetdb";
+const std::string CSettings::SETTING_AUDIOOUTPUT_DSPPIPELINE = "audiooutput.dsppipeline";
 const std::string CSettings::SETTING_AUDIOOUTPUT_GUISOUNDMODE = "audiooutput.guisoundmode";
 const std::string CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGH = "audiooutput.passthrough";
 const std::string CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGHDEVICE = "audiooutput.passthroughdevice";
@@ -383,6 +389,11 @@ const std::string CSettings::SETTING_AUDIOOUTPUT2_PROCESSQUALITY = "audiooutput2
 const std::string CSettings::SETTING_AUDIOOUTPUT2_ATEMPOTHRESHOLD = "audiooutput2.atempothreshold";
 const std::string CSettings::SETTING_AUDIOOUTPUT2_STREAMSILENCE = "audiooutput2.streamsilence";
 const std::string CSettings::SETTING_AUDIOOUTPUT2_STREAMNOISE = "audiooutput2.streamnoise";
+const std::string CSettings::SETTING_AUDIOOUTPUT2_LATENCY = "audiooutput2.latency";
+const std::string CSettings::SETTING_AUDIOOUTPUT2_LOWLATENCY = "audiooutput2.lowlatency";
+const std::string CSettings::SETTING_AUDIOOUTPUT2_CALIBRATELATENCY = "audiooutput2.calibratelatency";
+const std::string CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTION = "audiooutput2.roomcorrection";
+const std::string CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE = "audiooutput2.roomcorrectionfile";
 const std::string CSettings::SETTING_AUDIOOUTPUT2_DSPADDONSENABLED = "audiooutput2.dspaddonsenabled";
 const std::string CSettings::SETTING_AUDIOOUTPUT2_DSPSETTINGS = "audiooutput2.dspsettings";
 const std::string CSettings::SETTING_AUDIOOUTPUT2_DSPRESETDB = "audiooutput2.dspresetdb";
@@ -396,6 +407,7 @@ const std::string CSettings::SETTING_AUDIOOUTPUT2_DTSPASSTHROUGH = "audiooutput2
 const std::string CSettings::SETTING_AUDIOOUTPUT2_TRUEHDPASSTHROUGH = "audiooutput2.truehdpassthrough";
 const std::string CSettings::SETTING_AUDIOOUTPUT2_DTSHDPASSTHROUGH = "audiooutput2.dtshdpassthrough";
 const std::string CSettings::SETTING_AUDIOOUTPUT2_VOLUMESTEPS = "audiooutput2.volumesteps";
+const std::string CSettings::SETTING_AUDIOOUTPUT2_SHAREDENGINE = "audiooutput2.sharedengine";
 const std::string CSettings::SETTING_INPUT_PERIPHERALS = "input.peripherals";
 const std::string CSettings::SETTING_INPUT_ENABLEMOUSE = "input.enablemouse";
 const std::string CSettings::SETTING_INPUT_ASKNEWCONTROLLERS = "input.asknewcontrollers";
@@ -1112,6 +1124,11 @@ void CSettings::InitializeISettingCallbacks()
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGHDEVICE);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_STREAMSILENCE);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_STREAMNOISE);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_LATENCY);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_LOWLATENCY);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_CALIBRATELATENCY);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTION);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_ROOMCORRECTIONFILE);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_MAINTAINORIGINALVOLUME);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT_DSPADDONSENABLED);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_ENABLED);
@@ -1133,6 +1150,11 @@ void CSettings::InitializeISettingCallbacks()
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_PASSTHROUGHDEVICE);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_STREAMSILENCE);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_STREAMNOISE);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_LATENCY);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_LOWLATENCY);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_CALIBRATELATENCY);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTION);
+  settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_MAINTAINORIGINALVOLUME);
   settingSet.insert(CSettings::SETTING_AUDIOOUTPUT2_DSPADDONSENABLED);
   settingSet.insert(CSettings::SETTING_LOOKANDFEEL_SKIN);
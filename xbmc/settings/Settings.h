@@ -316,9 +316,15 @@ public:
   static const std::string SETTING_AUDIOOUTPUT_ATEMPOTHRESHOLD;
   static const std::string SETTING_AUDIOOUTPUT_STREAMSILENCE;
   static const std::string SETTING_AUDIOOUTPUT_STREAMNOISE;
+  static const std::string SETTING_AUDIOOUTPUT_LATENCY;
+  static const std::string SETTING_AUDIOOUTPUT_LOWLATENCY;
+  static const std::string SETTING_AUDIOOUTPUT_CALIBRATELATENCY;
+  static const std::string SETTING_AUDIOOUTPUT_ROOMCORRECTION;
+  static const std::string SETTING_AUDIOOUTPUT_ROOMCORRECTIONFILE;
   static const std::string SETTING_AUDIOOUTPUT_DSPADDONSENABLED;
   static const std::string SETTING_AUDIOOUTPUT_DSPSETTINGS;
   static const std::string SETTING_AUDIOOUTPUT_DSPRESETDB;
+  static const std::string SETTING_AUDIOOUTPUT_DSPPIPELINE;
   static const std::string SETTING_AUDIOOUTPUT_GUISOUNDMODE;
   static const std::string SETTING_AUDIOOUTPUT_PASSTHROUGH;
   static const std::string SETTING_AUDIOOUTPUT_PASSTHROUGHDEVICE;
@@ -340,6 +346,11 @@ public:
   static const std::string SETTING_AUDIOOUTPUT2_ATEMPOTHRESHOLD;
   static const std::string SETTING_AUDIOOUTPUT2_STREAMSILENCE;
   static const std::string SETTING_AUDIOOUTPUT2_STREAMNOISE;
+  static const std::string SETTING_AUDIOOUTPUT2_LATENCY;
+  static const std::string SETTING_AUDIOOUTPUT2_LOWLATENCY;
+  static const std::string SETTING_AUDIOOUTPUT2_CALIBRATELATENCY;
+  static const std::string SETTING_AUDIOOUTPUT2_ROOMCORRECTION;
+  static const std::string SETTING_AUDIOOUTPUT2_ROOMCORRECTIONFILE;
   static const std::string SETTING_AUDIOOUTPUT2_DSPADDONSENABLED;
   static const std::string SETTING_AUDIOOUTPUT2_DSPSETTINGS;
   static const std::string SETTING_AUDIOOUTPUT2_DSPRESETDB;
@@ -353,6 +364,7 @@ public:
   static const std::string SETTING_AUDIOOUTPUT2_TRUEHDPASSTHROUGH;
   static const std::string SETTING_AUDIOOUTPUT2_DTSHDPASSTHROUGH;
   static const std::string SETTING_AUDIOOUTPUT2_VOLUMESTEPS;
+  static const std::string SETTING_AUDIOOUTPUT2_SHAREDENGINE;
   static const std::string SETTING_INPUT_PERIPHERALS;
   static const std::string SETTING_INPUT_ENABLEMOUSE;
   static const std::string SETTING_INPUT_ASKNEWCONTROLLERS;
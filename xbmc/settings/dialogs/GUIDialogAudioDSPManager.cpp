@@ -22,6 +22,7 @@
 
 #include "FileItem.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSP.h"
+#include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSPProcess.h"
 #include "dialogs/GUIDialogTextViewer.h"
 #include "dialogs/GUIDialogOK.h"
 #include "dialogs/GUIDialogBusy.h"
@@ -31,6 +32,7 @@
 #include "guilib/GUIListContainer.h"
 #include "guilib/GUIRadioButtonControl.h"
 #include "input/Key.h"
+#include "threads/SystemClock.h"
 #include "utils/StringUtils.h"
 
 #define CONTROL_LIST_AVAILABLE                  20
@@ -74,6 +76,7 @@ CGUIDialogAudioDSPManager::CGUIDialogAudioDSPManager(void)
   m_bMovingMode               = false;
   m_bContainsChanges          = false;
   m_bContinousSaving          = true;
+  m_iLastProcessInfo          = 0;
   m_iSelected[LIST_AVAILABLE] = 0;
   m_iSelected[LIST_ACTIVE]    = 0;
 
@@ -200,6 +203,19 @@ void CGUIDialogAudioDSPManager::OnInitWindow()
   SetSelectedModeType();
 }
 
+void CGUIDialogAudioDSPManager::FrameMove()
+{
+  // cpu usage and overruns of the running modes are refreshed once a second
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (now - m_iLastProcessInfo >= 1000)
+  {
+    m_iLastProcessInfo = now;
+    UpdateProcessInfo();
+  }
+
+  CGUIDialog::FrameMove();
+}
+
 void CGUIDialogAudioDSPManager::OnDeinitWindow(int nextWindowID)
 {
   if (m_bContainsChanges)
@@ -762,6 +778,38 @@ void CGUIDialogAudioDSPManager::Update()
   pDlgBusy->Close();
 }
 
+void CGUIDialogAudioDSPManager::UpdateProcessInfo(void)
+{
+  std::vector<CActiveAEDSPModePtr> modes;
+  CActiveAEDSPProcessPtr process = CServiceBroker::GetADSP().GetDSPProcess(CServiceBroker::GetADSP().GetActiveStreamId());
+  if (process)
+    process->GetActiveModes(AE_DSP_MODE_TYPE_UNDEFINED, modes);
+
+  for (int i = 0; i < AE_DSP_MODE_TYPE_MAX; ++i)
+  {
+    for (int iItem = 0; iItem < m_activeItems[i]->Size(); ++iItem)
+    {
+      CFileItemPtr pItem = m_activeItems[i]->Get(iItem);
+      int addonId = (int)pItem->GetProperty("AddonId").asInteger();
+      unsigned int addonModeNumber = (unsigned int)pItem->GetProperty("AddonModeNumber").asInteger();
+
+      std::string processInfo;
+      for (unsigned int iMode = 0; iMode < modes.size(); ++iMode)
+      {
+        if (modes[iMode] && modes[iMode]->AddonID() == addonId && modes[iMode]->AddonModeNumber() == addonModeNumber)
+        {
+          processInfo = StringUtils::Format(g_localizeStrings.Get(37058).c_str(),
+                                            modes[iMode]->CPUUsage(),
+                                            modes[iMode]->Budget(),
+                                            modes[iMode]->Overruns());
+          break;
+        }
+      }
+      pItem->SetProperty("ProcessInfo", processInfo);
+    }
+  }
+}
+
 void CGUIDialogAudioDSPManager::SetSelectedModeType(void)
 {
   /* lock our display, as this window is rendered from the player thread */
@@ -43,6 +43,7 @@ namespace ActiveAE
   protected:
     virtual void OnInitWindow();
     virtual void OnDeinitWindow(int nextWindowID);
+    virtual void FrameMove();
 
     virtual bool OnPopupMenu(int iItem, int listType);
     virtual bool OnContextButton(int itemNumber, CONTEXT_BUTTON button, int listType);
@@ -66,6 +67,7 @@ namespace ActiveAE
     void Renumber(void);
     bool UpdateDatabase(CGUIDialogBusy* pDlgBusy);
     void SetSelectedModeType(void);
+    void UpdateProcessInfo(void);
 
     //! helper function prototypes
     static void                 helper_LogError(const char *function);
@@ -77,6 +79,7 @@ namespace ActiveAE
     bool m_bMovingMode;
     bool m_bContainsChanges;
     bool m_bContinousSaving;    // if true, all settings are directly saved
+    unsigned int m_iLastProcessInfo; // time of the last cpu usage and overrun update
 
     int m_iCurrentType;
     int m_iSelected[AE_DSP_MODE_TYPE_MAX];
@@ -29,6 +29,7 @@ RFFT::RFFT(int size, bool windowed) :
   m_size(size), m_windowed(windowed)
 {
   m_cfg = kiss_fftr_alloc(m_size,0,nullptr,nullptr);
+  m_icfg = kiss_fftr_alloc(m_size,1,nullptr,nullptr);
 }
 
 RFFT::~RFFT()
@@ -38,6 +39,7 @@ RFFT::~RFFT()
   // to SIMD (which might be used during kiss_fftr_alloc
   //in the C'tor).
   KISS_FFT_FREE(m_cfg);
+  KISS_FFT_FREE(m_icfg);
 }
 
 void RFFT::calc(const float* input, float* output)
@@ -75,6 +77,16 @@ void RFFT::calc(const float* input, float* output)
   }
 }
 
+void RFFT::forward(const float* input, kiss_fft_cpx* output)
+{
+  kiss_fftr(m_cfg, input, output);
+}
+
+void RFFT::inverse(const kiss_fft_cpx* input, float* output)
+{
+  kiss_fftri(m_icfg, input, output);
+}
+
 #include <iostream>
 
 void RFFT::hann(std::vector<kiss_fft_scalar>& data)
@@ -38,6 +38,16 @@ public:
   //! \param input Input data of size 2*m_size
   //! \param output Output data of size m_size.
   void calc(const float* input, float* output);
+
+  //! \brief Transform a single channel of real data.
+  //! \param input Time data of size m_size.
+  //! \param output Spectrum of size m_size/2+1.
+  void forward(const float* input, kiss_fft_cpx* output);
+
+  //! \brief Inverse transform of a single channel, not normalized.
+  //! \param input Spectrum of size m_size/2+1.
+  //! \param output Time data of size m_size, scaled by m_size.
+  void inverse(const kiss_fft_cpx* input, float* output);
 protected:
   //! \brief Apply a Hann window to a buffer.
   //! \param data Vector with data to apply window to.
@@ -46,4 +56,5 @@ protected:
   size_t m_size;       //!< Size for a single channel.
   bool m_windowed;     //!< Whether or not a Hann window is applied.
   kiss_fftr_cfg m_cfg; //!< FFT plan
+  kiss_fftr_cfg m_icfg; //!< Inverse FFT plan
 };
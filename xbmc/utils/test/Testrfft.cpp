@@ -51,3 +51,21 @@ TEST(TestRFFT, SimpleSignal)
     EXPECT_NEAR(output[2*i+1], ((i==freq2[0]||i==freq2[1])?1.0:0.0), 1e-7);
   }
 }
+
+TEST(TestRFFT, RoundTrip)
+{
+  const int size = 64;
+  std::vector<float> input(size), output(size);
+  std::vector<kiss_fft_cpx> spectrum(size/2+1);
+  for (size_t i=0;i<size;++i)
+    input[i] = sin(3.0*2.0*M_PI*i/size) + 0.5*cos(11.0*2.0*M_PI*i/size);
+  RFFT transform(size, false);
+
+  transform.forward(&input[0], &spectrum[0]);
+  EXPECT_NEAR(spectrum[3].i, -size/2.0, 1e-4);
+  EXPECT_NEAR(spectrum[11].r, size/4.0, 1e-4);
+
+  transform.inverse(&spectrum[0], &output[0]);
+  for (size_t i=0;i<size;++i)
+    EXPECT_NEAR(output[i]/size, input[i], 1e-6);
+}